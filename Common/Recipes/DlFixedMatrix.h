@@ -0,0 +1,93 @@
+/*++++++++++++++++++++++++++
+ **	DlFixedMatrix.h
+ **
+ **	Purpose:
+ **
+ **		Define a matrix whose size is fixed at compile time.
+ **
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ **	Author:		David C. Salmon
+ **	Created:	Sat, Oct 17, 2026
+ **	Modified:
+ */
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_DlFixedMatrix
+#define _H_DlFixedMatrix
+
+#include "DlArray.h"
+#include <algorithm>
+
+namespace DlArray {
+
+	//	alignment of the values, enough for a vector register of doubles.
+	const DlUInt32 kFixedMatrixAlign = 32;
+
+// define a row major matrix of NR by NC values held in the object itself, so
+// it can live on the stack without any heap allocation. Indexing matches
+// DlMatrix, so m[i][j] is row i and column j counted from OFFSET.
+template <class T, DlUInt32 NR, DlUInt32 NC, DlUInt32 OFFSET=kDefaultArrayOffset>
+class DlFixedMatrix
+{
+public:
+
+	// a row, indexed from OFFSET
+	class Row
+	{
+	public:
+		explicit Row(T* p) : _p(p) {}
+		T& operator[] (DlUInt32 j) const { return _p[j - OFFSET]; }
+	private:
+		T*	_p;
+	};
+
+	class ConstRow
+	{
+	public:
+		explicit ConstRow(const T* p) : _p(p) {}
+		const T& operator[] (DlUInt32 j) const { return _p[j - OFFSET]; }
+	private:
+		const T*	_p;
+	};
+
+	// zero matrix
+	DlFixedMatrix() { fill(T()); }
+
+	static DlUInt32 rows() { return NR; }
+	static DlUInt32 cols() { return NC; }
+
+	void fill(const T& value) { std::fill(_arr, _arr + NR * NC, value); }
+
+	Row row(DlUInt32 i) { return Row(_arr + (i - OFFSET) * NC); }
+	ConstRow row(DlUInt32 i) const { return ConstRow(_arr + (i - OFFSET) * NC); }
+
+	Row operator[] (DlUInt32 i) { return row(i); }
+	ConstRow operator[] (DlUInt32 i) const { return row(i); }
+
+	// the values, contiguous by rows
+	T* data() { return _arr; }
+	const T* data() const { return _arr; }
+
+private:
+
+	alignas(kFixedMatrixAlign) T	_arr[NR * NC];
+};
+
+}
+
+#endif
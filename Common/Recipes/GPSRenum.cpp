@@ -1237,11 +1237,13 @@ C     ... START OF OUTER REPEAT LOOP
 	while(1) 
 	{
 /*
-C         ... FIND AN UNASSIGNED NODE
+C         ... FIND AN UNASSIGNED NODE. NODES OUTSIDE THE COMPONENT
+C             BEING NUMBERED HAVE A ZERO STATUS.
 */
+		node = 0;
 		for (DlInt32 i = root; i <= itsNeq; i++) 
 		{
-			if (status[i] >= 0) 
+			if (status[i] > 0) 
 			{
 				node = i;
 				break;
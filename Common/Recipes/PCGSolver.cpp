@@ -0,0 +1,392 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		PCGSolver.cpp
+ *
+ *	Contains:	preconditioned conjugate gradient solver
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "DlPlatform.h"
+#include "recipes.h"
+#include "PCGSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//	the number of times the incomplete factorization is retried with a
+//	larger diagonal shift before giving up.
+const DlInt32 kMaxShifts = 12;
+const DlFloat64 kFirstShift = 1.0e-3;
+
+//------------------------------------------------------------------------------
+//	PCGSolver::PCGSolver											constructor
+//
+//		Build the matrix structure.
+//
+//	connect				->	one-based array of connectivity for upper triangle.
+//	starts				->	one-based start of each equation in connect.
+//	precond				->	the preconditioner to use.
+//------------------------------------------------------------------------------
+PCGSolver::PCGSolver(const array_type & connect, const array_type & starts,
+					 Preconditioner precond)
+	: itsNeq(std::max(static_cast<DlInt32>(starts.size()) - 1, 0))
+	, itsPrecond(precond)
+	, itsTolerance(1.0e-10)
+	, itsMaxIterations(0)
+	, itsIterations(0)
+	, itsResidual(0)
+{
+	std::vector<DlInt32> rows;
+	rows.reserve(connect.size() + itsNeq);
+
+	itsColStart.resize(itsNeq + 1);
+	itsColStart[0] = 0;
+
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		rows.push_back(i);
+		for (DlInt32 k = starts[i] - 1; k < starts[i+1] - 1; k++) {
+			DlInt32 r = connect[k] - 1;
+			if (r != i) {
+				_RecipesAssert(r > i && r < itsNeq);
+				rows.push_back(r);
+			}
+		}
+		itsColStart[i+1] = static_cast<DlInt32>(rows.size());
+	}
+
+	itsRows.resize(rows.size());
+	if (rows.size() > 0)
+		std::copy(rows.begin(), rows.end(), &itsRows[0]);
+	itsValues.resize(rows.size(), 0.0);
+	itsDiag.resize(itsNeq, 0.0);
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::clear
+//
+//		zero the matrix values.
+//
+//------------------------------------------------------------------------------
+void
+PCGSolver::clear()
+{
+	if (itsValues.size() > 0)
+		itsValues = 0.0;
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::add
+//
+//		add to the matrix term for equations i and j. The term must be part
+//		of the connectivity used to build the matrix.
+//
+//	i					->	one-based equation.
+//	j					->	one-based equation.
+//	value				->	the value to add.
+//------------------------------------------------------------------------------
+void
+PCGSolver::add(DlInt32 i, DlInt32 j, DlFloat64 value)
+{
+	if (i > j)
+		std::swap(i, j);
+
+	DlInt32 loc = find(i - 1, j - 1);
+	_RecipesAssert(loc >= 0);
+	itsValues[loc] += value;
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::multiply
+//
+//		compute y = A x using the symmetric lower triangle.
+//
+//	x					->	the vector to multiply, zero based.
+//	y					<-	the result, zero based.
+//------------------------------------------------------------------------------
+void
+PCGSolver::multiply(const DlFloat64* x, DlFloat64* y) const
+{
+	std::fill(y, y + itsNeq, 0.0);
+
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		DlInt32 k = itsColStart[i];
+		DlFloat64 xi = x[i];
+		DlFloat64 yi = itsValues[k] * xi;
+		for (k++; k < itsColStart[i+1]; k++) {
+			DlInt32 j = itsRows[k];
+			DlFloat64 a = itsValues[k];
+			y[j] += a * xi;
+			yi += a * x[j];
+		}
+		y[i] += yi;
+	}
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::factor
+//
+//		check the diagonal and build the preconditioner. Throws
+//		EqSolveFailure if a diagonal term is not positive, or if the
+//		incomplete factorization fails even with a diagonal shift.
+//
+//	posDef				->	true if the matrix is known to be positive-definite
+//	progress			->	the progress reporter object
+//------------------------------------------------------------------------------
+void
+PCGSolver::factor(bool posDef, EqSolveProgress* progress)
+{
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		DlFloat64 d = itsValues[itsColStart[i]];
+		if (d < 1.0e-10) {
+			throw EqSolveFailure(!posDef && d < 0 ? EqSolveFailure::NonPositiveDefinite :
+								 EqSolveFailure::Singular, i + 1);
+		}
+		itsDiag[i] = d;
+	}
+
+	if (itsPrecond != IncompleteCholesky)
+		return;
+
+	//	the incomplete factor can break down for matrices that are not
+	//	diagonally dominant. If so, factor a slightly shifted matrix.
+	DlFloat64 shift = 0;
+	DlInt32 failed = 0;
+	for (DlInt32 tries = 0; tries < kMaxShifts; tries++) {
+		if (progress && !progress->Processing(tries + 1, kMaxShifts))
+			throw EqSolveFailure(EqSolveFailure::UserCancelled, 0);
+
+		if (incompleteFactor(shift, failed))
+			return;
+
+		shift = shift == 0 ? kFirstShift : 2 * shift;
+	}
+
+	throw EqSolveFailure(EqSolveFailure::NonPositiveDefinite, failed + 1);
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::solve
+//
+//		solve for a block of rhs vectors by preconditioned conjugate
+//		gradients, starting from zero.
+//
+//	vv					<->	the rhs vectors, column-major (neq by nrhs)
+//	nrhs				->	the number of rhs vectors
+//	progress			->	the progress reporter object
+//------------------------------------------------------------------------------
+void
+PCGSolver::solve(std::valarray<DlFloat64>* vv, DlInt32 nrhs, EqSolveProgress* progress)
+{
+	itsIterations = 0;
+	itsResidual = 0;
+
+	if (itsNeq == 0)
+		return;
+
+	DlInt32 maxIter = itsMaxIterations > 0 ? itsMaxIterations : 2 * itsNeq;
+
+	std::vector<DlFloat64> r(itsNeq);
+	std::vector<DlFloat64> z(itsNeq);
+	std::vector<DlFloat64> p(itsNeq);
+	std::vector<DlFloat64> q(itsNeq);
+
+	auto dot = [this](const std::vector<DlFloat64>& a, const std::vector<DlFloat64>& b) {
+		DlFloat64 sum = 0;
+		for (DlInt32 i = 0; i < itsNeq; i++)
+			sum += a[i] * b[i];
+		return sum;
+	};
+
+	for (DlInt32 rhs = 0; rhs < nrhs; rhs++) {
+		DlFloat64* x = &(*vv)[static_cast<size_t>(rhs) * itsNeq];
+
+		std::copy(x, x + itsNeq, r.begin());
+		std::fill(x, x + itsNeq, 0.0);
+
+		DlFloat64 bnorm = std::sqrt(dot(r, r));
+		if (bnorm == 0)
+			continue;
+
+		precondition(&r[0], &z[0]);
+		p = z;
+		DlFloat64 rz = dot(r, z);
+
+		DlInt32 iter = 0;
+		DlFloat64 resid = 1.0;
+		while (resid > itsTolerance) {
+			if (++iter > maxIter)
+				throw EqSolveFailure(EqSolveFailure::NotConverged, maxIter);
+
+			multiply(&p[0], &q[0]);
+			DlFloat64 pq = dot(p, q);
+			if (pq <= 0)
+				throw EqSolveFailure(EqSolveFailure::NonPositiveDefinite, iter);
+
+			DlFloat64 alpha = rz / pq;
+			for (DlInt32 i = 0; i < itsNeq; i++) {
+				x[i] += alpha * p[i];
+				r[i] -= alpha * q[i];
+			}
+
+			resid = std::sqrt(dot(r, r)) / bnorm;
+			if (progress && !progress->Iteration(iter, maxIter, resid))
+				throw EqSolveFailure(EqSolveFailure::UserCancelled, iter);
+
+			precondition(&r[0], &z[0]);
+			DlFloat64 rzNext = dot(r, z);
+			DlFloat64 beta = rzNext / rz;
+			rz = rzNext;
+
+			for (DlInt32 i = 0; i < itsNeq; i++)
+				p[i] = z[i] + beta * p[i];
+		}
+
+		itsIterations = std::max(itsIterations, iter);
+		itsResidual = std::max(itsResidual, resid);
+	}
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::incompleteFactor											private
+//
+//		compute the incomplete LDL' factor with no fill, of the matrix with
+//		its diagonal scaled by 1 + shift.
+//
+//	shift				->	the relative diagonal shift.
+//	failed				<-	the zero-based equation that broke down.
+//	return				<-	true if successful.
+//------------------------------------------------------------------------------
+bool
+PCGSolver::incompleteFactor(DlFloat64 shift, DlInt32& failed)
+{
+	itsFactor.resize(itsValues.size());
+	itsFactor = itsValues;
+	for (DlInt32 i = 0; i < itsNeq; i++)
+		itsFactor[itsColStart[i]] *= 1.0 + shift;
+
+	for (DlInt32 k = 0; k < itsNeq; k++) {
+		DlInt32 first = itsColStart[k] + 1;
+		DlInt32 last = itsColStart[k+1];
+
+		DlFloat64 d = itsFactor[itsColStart[k]];
+		if (d <= 1.0e-10 * itsDiag[k]) {
+			failed = k;
+			return false;
+		}
+
+		for (DlInt32 p = first; p < last; p++)
+			itsFactor[p] /= d;
+
+		//	update the terms of the trailing matrix that are in the pattern
+		for (DlInt32 p = first; p < last; p++) {
+			DlInt32 i = itsRows[p];
+			DlFloat64 ti = itsFactor[p] * d;
+			for (DlInt32 q = p; q < last; q++) {
+				DlInt32 loc = find(i, itsRows[q]);
+				if (loc >= 0)
+					itsFactor[loc] -= itsFactor[q] * ti;
+			}
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::precondition												private
+//
+//		apply the preconditioner, z = M^-1 r.
+//
+//	r					->	the residual.
+//	z					<-	the preconditioned residual.
+//------------------------------------------------------------------------------
+void
+PCGSolver::precondition(const DlFloat64* r, DlFloat64* z) const
+{
+	switch (itsPrecond) {
+	case Jacobi:
+		for (DlInt32 i = 0; i < itsNeq; i++)
+			z[i] = r[i] / itsDiag[i];
+		break;
+
+	case SymmetricGaussSeidel:
+		//	forward (D + L) y = r by columns, then scale by D
+		std::copy(r, r + itsNeq, z);
+		for (DlInt32 i = 0; i < itsNeq; i++) {
+			DlFloat64 yi = z[i] / itsDiag[i];
+			for (DlInt32 k = itsColStart[i] + 1; k < itsColStart[i+1]; k++)
+				z[itsRows[k]] -= itsValues[k] * yi;
+			z[i] = yi * itsDiag[i];
+		}
+
+		//	then backward (D + L)' z = y by rows
+		for (DlInt32 i = itsNeq - 1; i >= 0; i--) {
+			DlFloat64 sum = z[i];
+			for (DlInt32 k = itsColStart[i] + 1; k < itsColStart[i+1]; k++)
+				sum -= itsValues[k] * z[itsRows[k]];
+			z[i] = sum / itsDiag[i];
+		}
+		break;
+
+	case IncompleteCholesky:
+		std::copy(r, r + itsNeq, z);
+		for (DlInt32 i = 0; i < itsNeq; i++) {
+			DlFloat64 zi = z[i];
+			for (DlInt32 k = itsColStart[i] + 1; k < itsColStart[i+1]; k++)
+				z[itsRows[k]] -= itsFactor[k] * zi;
+		}
+
+		for (DlInt32 i = 0; i < itsNeq; i++)
+			z[i] /= itsFactor[itsColStart[i]];
+
+		for (DlInt32 i = itsNeq - 1; i >= 0; i--) {
+			DlFloat64 sum = z[i];
+			for (DlInt32 k = itsColStart[i] + 1; k < itsColStart[i+1]; k++)
+				sum -= itsFactor[k] * z[itsRows[k]];
+			z[i] = sum;
+		}
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+//	PCGSolver::find														private
+//
+//		find the term for row in column col.
+//
+//	col					->	the zero-based column.
+//	row					->	the zero-based row, row >= col.
+//	return				<-	the index of the term, or -1 if not present.
+//------------------------------------------------------------------------------
+DlInt32
+PCGSolver::find(DlInt32 col, DlInt32 row) const
+{
+	const DlInt32* rows = &itsRows[0];
+	const DlInt32* first = rows + itsColStart[col];
+	const DlInt32* last = rows + itsColStart[col+1];
+	const DlInt32* loc = std::lower_bound(first, last, row);
+
+	return (loc != last && *loc == row) ? static_cast<DlInt32>(loc - rows) : -1;
+}
@@ -0,0 +1,122 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		PCGSolver.h
+ *
+ *	Contains:	preconditioned conjugate gradient solver interface
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_PCGSolver
+#define _H_PCGSolver
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+#include "matrix.h"
+#include <valarray>
+
+//---------------------------------- Class -------------------------------------
+
+//	Iterative solver for symmetric positive definite matrices. The matrix is
+//	held in compressed column form for the lower triangle, which is also
+//	compressed row form for the upper triangle. Values are added with add()
+//	using one-based equation numbers, the preconditioner is built with
+//	factor(), and rhs vectors are solved with solve().
+//
+//	Only the matrix and the preconditioner are stored, so the memory is a
+//	small multiple of the number of matrix terms.
+class PCGSolver
+{
+	typedef std::valarray<DlInt32> array_type;
+
+public:
+	typedef enum {
+		Jacobi,					//	diagonal scaling
+		SymmetricGaussSeidel,	//	(D + L) D^-1 (D + L)'
+		IncompleteCholesky		//	LDL' with no fill
+	} Preconditioner;
+
+	//	connect and starts are as for SparseLDL.
+	PCGSolver(const array_type & connect, const array_type & starts,
+			  Preconditioner precond = IncompleteCholesky);
+
+	DlInt32 size() const { return itsNeq; }
+
+	//	the number of matrix and preconditioner terms held.
+	DlInt64 storedSize() const { return itsValues.size() + itsFactor.size() + itsDiag.size(); }
+
+	//	converged when the 2-norm of the residual relative to the rhs is
+	//	less than tolerance.
+	DlFloat64 tolerance() const { return itsTolerance; }
+	void setTolerance(DlFloat64 tolerance) { itsTolerance = tolerance; }
+
+	//	the iteration cap. Zero allows twice the number of equations.
+	DlInt32 maxIterations() const { return itsMaxIterations; }
+	void setMaxIterations(DlInt32 maxIter) { itsMaxIterations = maxIter; }
+
+	//	the largest iteration count and final residual from the last solve.
+	DlInt32 iterations() const { return itsIterations; }
+	DlFloat64 residual() const { return itsResidual; }
+
+	//	zero the matrix values.
+	void clear();
+
+	//	add value to the term for one-based equations i and j.
+	void add(DlInt32 i, DlInt32 j, DlFloat64 value);
+
+	//	y = A x, zero based.
+	void multiply(const DlFloat64* x, DlFloat64* y) const;
+
+	//	check the diagonal and build the preconditioner.
+	void factor(bool positiveDefinite = true, EqSolveProgress* progress = 0);
+
+	//	solve for nrhs vectors held column-major in v (neq by nrhs). Throws
+	//	EqSolveFailure::NotConverged if the iteration cap is reached.
+	void solve(std::valarray<DlFloat64>* v, DlInt32 nrhs = 1,
+			   EqSolveProgress* progress = 0);
+
+private:
+
+	bool incompleteFactor(DlFloat64 shift, DlInt32& failed);
+	void precondition(const DlFloat64* r, DlFloat64* z) const;
+	DlInt32 find(DlInt32 col, DlInt32 row) const;
+
+	DlInt32				itsNeq;
+	Preconditioner		itsPrecond;
+	DlFloat64			itsTolerance;
+	DlInt32				itsMaxIterations;
+	DlInt32				itsIterations;
+	DlFloat64			itsResidual;
+
+	//	lower triangle, zero based. Column i holds rows j >= i, diagonal first.
+	array_type			itsColStart;
+	array_type			itsRows;
+	std::valarray<DlFloat64>	itsValues;
+
+	//	the incomplete factor, in the same pattern, and its diagonal.
+	std::valarray<DlFloat64>	itsFactor;
+	std::valarray<DlFloat64>	itsDiag;
+};
+
+#endif
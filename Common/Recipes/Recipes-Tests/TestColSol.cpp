@@ -11,6 +11,8 @@
 
 #include "colsol.h"
 #include "matio.h"
+#include "DlThreadPool.h"
+#include "SkylineFile.h"
 
 #include <valarray>
 #include <vector>
@@ -127,3 +129,192 @@ TEST(TestColSol, invert)
 	}
 
 }
+
+// build a diagonally dominant skyline matrix with ragged column heights.
+static void buildSkyline(DlInt32 n, std::valarray<DlInt32>& maxa, std::valarray<DlFloat64>& a)
+{
+	maxa.resize(n + 1);
+	maxa[0] = 1;
+	for (DlInt32 i = 0; i < n; i++) {
+		DlInt32 height = std::min(i, (i * 7) % 13);
+		maxa[i+1] = maxa[i] + height + 1;
+	}
+	
+	a.resize(maxa[n] - 1);
+	for (DlInt32 i = 0; i < n; i++) {
+		DlInt32 d = maxa[i] - 1;
+		a[d] = 30.0;
+		for (DlInt32 k = d + 1; k < maxa[i+1] - 1; k++)
+			a[k] = 1.0 / (1 + (i + k) % 5);
+	}
+}
+
+TEST(TestColSol, parallel)
+{
+	const DlInt32 n = 500;
+	std::valarray<DlInt32>		maxa;
+	std::valarray<DlFloat64>	serial;
+	buildSkyline(n, maxa, serial);
+	std::valarray<DlFloat64>	parallel(serial);
+	
+	colsolDecomp(n, serial, maxa);
+	
+	DlThreadPool pool(4);
+	ASSERT_EQ(pool.GetThreadCount(), 4);
+	
+	// use a narrow panel so columns span several panels.
+	colsolDecompParallel(n, parallel, maxa, pool, true, nullptr, 5);
+	
+	for (size_t i = 0; i < serial.size(); i++)
+		ASSERT_EQ(serial[i], parallel[i]);
+	
+	// the default panel width too.
+	buildSkyline(n, maxa, parallel);
+	colsolDecompParallel(n, parallel, maxa, pool);
+	
+	for (size_t i = 0; i < serial.size(); i++)
+		ASSERT_EQ(serial[i], parallel[i]);
+}
+
+TEST(TestColSol, multipleRhs)
+{
+	const DlInt32 n = 200;
+	const DlInt32 nrhs = 3;
+	std::valarray<DlInt32>		maxa;
+	std::valarray<DlFloat64>	a;
+	buildSkyline(n, maxa, a);
+	
+	colsolDecomp(n, a, maxa);
+	
+	std::valarray<DlFloat64> block(n * nrhs);
+	for (DlInt32 i = 0; i < n * nrhs; i++)
+		block[i] = 1.0 + (i % 7) - (i % 3);
+	
+	std::valarray<DlFloat64> single(block);
+	
+	colsolBackSubMulti(n, a, maxa, &block, nrhs);
+	
+	for (DlInt32 r = 0; r < nrhs; r++) {
+		std::valarray<DlFloat64> rhs(single[std::slice(r * n, n, 1)]);
+		colsolBackSub(n, a, maxa, &rhs);
+		for (DlInt32 i = 0; i < n; i++)
+			ASSERT_EQ(rhs[i], block[r * n + i]);
+	}
+}
+
+TEST(TestColSol, refactorFrom)
+{
+	const DlInt32 n = 300;
+	const DlInt32 first = 170;
+	std::valarray<DlInt32>		maxa;
+	std::valarray<DlFloat64>	matrix;
+	buildSkyline(n, maxa, matrix);
+	
+	std::valarray<DlFloat64>	partial(matrix);
+	colsolDecomp(n, partial, maxa);
+	
+	// change the matrix from column first on, then refactor only those columns.
+	for (DlInt32 i = first; i <= n; i++)
+		matrix[maxa[i-1] - 1] += 0.5 * (i % 3);
+	
+	std::valarray<DlFloat64>	full(matrix);
+	colsolDecomp(n, full, maxa);
+	
+	DlInt32 start = maxa[first-1] - 1;
+	partial[std::slice(start, matrix.size() - start, 1)] = 
+		matrix[std::slice(start, matrix.size() - start, 1)];
+	colsolDecompFrom(n, partial, maxa, first);
+	
+	for (size_t i = 0; i < full.size(); i++)
+		ASSERT_EQ(full[i], partial[i]);
+	
+	// and in parallel
+	partial[std::slice(start, matrix.size() - start, 1)] = 
+		matrix[std::slice(start, matrix.size() - start, 1)];
+	DlThreadPool pool(3);
+	colsolDecompParallel(n, partial, maxa, pool, true, nullptr, 7, first);
+	
+	for (size_t i = 0; i < full.size(); i++)
+		ASSERT_EQ(full[i], partial[i]);
+}
+
+TEST(TestColSol, mixedPrecision)
+{
+	const DlInt32 n = 400;
+	const DlInt32 nrhs = 3;
+	std::valarray<DlInt32>		maxa;
+	std::valarray<DlFloat64>	a;
+	buildSkyline(n, maxa, a);
+	
+	std::valarray<DlFloat64> block(n * nrhs);
+	for (DlInt32 i = 0; i < n * nrhs; i++)
+		block[i] = 1.0 + (i % 7) - (i % 3);
+	
+	std::valarray<DlFloat64> exact(block);
+	std::valarray<DlFloat64> factor(a);
+	colsolDecomp(n, factor, maxa);
+	colsolBackSubMulti(n, factor, maxa, &exact, nrhs);
+	
+	ColsolMixed mixed(n, a, maxa);
+	EXPECT_EQ(a.size(), 0);
+	mixed.factor();
+	mixed.solve(&block, nrhs);
+	
+	EXPECT_FALSE(mixed.isDouble());
+	EXPECT_GT(mixed.iterations(), 0);
+	for (DlInt32 i = 0; i < n * nrhs; i++)
+		ASSERT_NEAR(block[i], exact[i], 1.0e-12 * (1.0 + fabs(exact[i])));
+	
+	// two equations that are the same in single precision fall back to double.
+	const DlFloat64 nearly[] = { 1.0, 1.0, 1.0 - 1.0e-9 };
+	const DlInt32 nearlyDiag[] = { 1, 2, 4 };
+	std::valarray<DlFloat64>	b(nearly, DlArrayElements(nearly));
+	std::valarray<DlInt32>		bMaxa(nearlyDiag, DlArrayElements(nearlyDiag));
+	
+	DlThreadPool pool(2);
+	ColsolMixed singular(2, b, bMaxa);
+	singular.factor(true, nullptr, &pool);
+	
+	std::valarray<DlFloat64> v(2);
+	v[0] = 1.0;
+	v[1] = 1.0 + 1.0e-9;
+	singular.solve(&v);
+	
+	EXPECT_TRUE(singular.isDouble());
+	EXPECT_NEAR(v[0], 0.0, 1.0e-6);
+	EXPECT_NEAR(v[1], 1.0, 1.0e-6);
+}
+
+TEST(TestColSol, outOfCore)
+{
+	const DlInt32 n = 300;
+	const DlInt32 nrhs = 2;
+	std::valarray<DlInt32>		maxa;
+	std::valarray<DlFloat64>	a;
+	buildSkyline(n, maxa, a);
+	
+	SkylineFile file;
+	file.write(0, a.size(), &a[0]);
+	EXPECT_EQ(file.size(), static_cast<DlInt64>(a.size()));
+	
+	// a small budget so the panels and the blocks to their left are a few columns.
+	const DlInt64 memory = 40 * sizeof(DlFloat64);
+	colsolDecomp(n, a, maxa);
+	colsolDecompFile(n, file, maxa, memory);
+	
+	std::valarray<DlFloat64> factor(a.size());
+	file.read(0, factor.size(), &factor[0]);
+	for (size_t i = 0; i < a.size(); i++)
+		ASSERT_EQ(a[i], factor[i]);
+	
+	std::valarray<DlFloat64> block(n * nrhs);
+	for (DlInt32 i = 0; i < n * nrhs; i++)
+		block[i] = 1.0 + (i % 5) - (i % 4);
+	std::valarray<DlFloat64> inCore(block);
+	
+	colsolBackSubMulti(n, a, maxa, &inCore, nrhs);
+	colsolBackSubFile(n, file, maxa, &block, nrhs, memory);
+	
+	for (DlInt32 i = 0; i < n * nrhs; i++)
+		ASSERT_EQ(inCore[i], block[i]);
+}
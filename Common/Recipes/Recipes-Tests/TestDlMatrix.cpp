@@ -10,6 +10,7 @@
 #include "TestDlMatrix.h"
 #include "DlArray.h"
 #include "DlMatrix.h"
+#include "DlFixedMatrix.h"
 
 #include "matio.h"
 
@@ -204,4 +205,29 @@ TEST(TestDlMatrix, Matio)
 
 	printf("\n");
 
-}
\ No newline at end of file
+}
+TEST(TestDlMatrix, Fixed)
+{
+	DlFixedMatrix<DlFloat64, 6, 6> m;
+	
+	ASSERT_EQ(m.rows(), 6);
+	ASSERT_EQ(m.cols(), 6);
+	ASSERT_EQ(reinterpret_cast<uintptr_t>(m.data()) % kFixedMatrixAlign, 0);
+	
+	for (auto i = 1; i <= 6; i++)
+		for (auto j = 1; j <= 6; j++)
+			ASSERT_EQ(m[i][j], 0);
+	
+	// same indexing and layout as DlMatrix
+	for (auto i = 1; i <= 6; i++)
+		for (auto j = 1; j <= 6; j++)
+			m[i][j] = kTestMatrix[i][j];
+	
+	for (auto i = 1; i <= 6; i++) {
+		DlFixedMatrix<DlFloat64, 6, 6>::Row row(m.row(i));
+		for (auto j = 1; j <= 6; j++) {
+			ASSERT_EQ(row[j], 10 * i + j);
+			ASSERT_EQ(m.data()[(i-1) * 6 + j - 1], 10 * i + j);
+		}
+	}
+}
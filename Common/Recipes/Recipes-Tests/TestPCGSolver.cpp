@@ -0,0 +1,136 @@
+//
+//  TestPCGSolver.cpp
+//  Common_Recipes
+//
+//  Created by David Salmon on 10/17/26.
+//
+//
+
+#include "DlPlatform.h"
+#include "TestPCGSolver.h"
+
+#include "PCGSolver.h"
+
+#include <cmath>
+#include <valarray>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// build the connectivity for a grid of size by size nodes with the
+// five point stencil. Equations are numbered row by row.
+static void buildGrid(DlInt32 size, std::valarray<DlInt32>& connect, std::valarray<DlInt32>& starts)
+{
+	DlInt32 neq = size * size;
+	std::vector<DlInt32> c;
+	starts.resize(neq + 1);
+	starts[0] = 1;
+	for (DlInt32 i = 0; i < neq; i++) {
+		c.push_back(i + 1);
+		if ((i + 1) % size != 0)
+			c.push_back(i + 2);
+		if (i + size < neq)
+			c.push_back(i + size + 1);
+		starts[i+1] = static_cast<DlInt32>(c.size()) + 1;
+	}
+	connect.resize(c.size());
+	for (size_t i = 0; i < c.size(); i++)
+		connect[i] = c[i];
+}
+
+static void fillGrid(PCGSolver& m, const std::valarray<DlInt32>& connect,
+					 const std::valarray<DlInt32>& starts)
+{
+	for (DlInt32 i = 1; i < static_cast<DlInt32>(starts.size()); i++)
+		for (DlInt32 k = starts[i-1]; k < starts[i]; k++) {
+			DlInt32 j = connect[k-1];
+			m.add(i, j, i == j ? 4.01 : -1.0);
+		}
+}
+
+class CountingProgress : public EqSolveProgress
+{
+public:
+	CountingProgress() : calls(0), last(1.0) {}
+	
+	virtual bool SetStage(Stage) { return true; }
+	virtual bool Processing(DlInt32, DlInt32) { return true; }
+	virtual bool Iteration(DlInt32, DlInt32, DlFloat64 residual) {
+		calls++;
+		last = residual;
+		return true;
+	}
+
+	DlInt32 calls;
+	DlFloat64 last;
+};
+
+TEST(TestPCGSolver, solve)
+{
+	const DlInt32 size = 30;
+	const DlInt32 neq = size * size;
+	const DlInt32 nrhs = 2;
+	
+	std::valarray<DlInt32> connect;
+	std::valarray<DlInt32> starts;
+	buildGrid(size, connect, starts);
+	
+	std::valarray<DlFloat64> b(neq * nrhs);
+	for (DlInt32 i = 0; i < neq * nrhs; i++)
+		b[i] = 1.0 + (i % 5);
+	
+	const PCGSolver::Preconditioner precond[] = {
+		PCGSolver::Jacobi, PCGSolver::SymmetricGaussSeidel, PCGSolver::IncompleteCholesky
+	};
+	
+	DlInt32 iterations[3];
+	for (DlInt32 p = 0; p < 3; p++) {
+		PCGSolver m(connect, starts, precond[p]);
+		ASSERT_EQ(m.size(), neq);
+		m.setTolerance(1.0e-12);
+		fillGrid(m, connect, starts);
+		m.factor();
+		
+		CountingProgress progress;
+		std::valarray<DlFloat64> x(b);
+		m.solve(&x, nrhs, &progress);
+		
+		EXPECT_GT(progress.calls, 0);
+		EXPECT_LE(progress.last, 1.0e-12);
+		EXPECT_LE(m.residual(), 1.0e-12);
+		iterations[p] = m.iterations();
+		
+		// check A x = b
+		std::vector<DlFloat64> ax(neq);
+		for (DlInt32 r = 0; r < nrhs; r++) {
+			m.multiply(&x[r * neq], &ax[0]);
+			for (DlInt32 i = 0; i < neq; i++)
+				EXPECT_NEAR(ax[i], b[r * neq + i], 1.0e-9);
+		}
+	}
+	
+	// the better preconditioners should take fewer iterations
+	EXPECT_LT(iterations[1], iterations[0]);
+	EXPECT_LT(iterations[2], iterations[0]);
+}
+
+TEST(TestPCGSolver, notConverged)
+{
+	std::valarray<DlInt32> connect;
+	std::valarray<DlInt32> starts;
+	buildGrid(20, connect, starts);
+	
+	PCGSolver m(connect, starts, PCGSolver::Jacobi);
+	m.setMaxIterations(3);
+	fillGrid(m, connect, starts);
+	m.factor();
+	
+	std::valarray<DlFloat64> x(1.0, m.size());
+	try {
+		m.solve(&x);
+		FAIL() << "expected EqSolveFailure";
+	} catch (EqSolveFailure& e) {
+		EXPECT_EQ(e.getReason(), EqSolveFailure::NotConverged);
+		EXPECT_EQ(e.getEquation(), 3);
+	}
+}
@@ -0,0 +1,14 @@
+//
+//  TestPCGSolver.h
+//  Common_Recipes
+//
+//  Created by David Salmon on 10/17/26.
+//
+//
+
+#ifndef __Common_Recipes__TestPCGSolver__
+#define __Common_Recipes__TestPCGSolver__
+
+#include <iostream>
+
+#endif /* defined(__Common_Recipes__TestPCGSolver__) */
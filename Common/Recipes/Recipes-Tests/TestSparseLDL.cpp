@@ -0,0 +1,155 @@
+//
+//  TestSparseLDL.cpp
+//  Common_Recipes
+//
+//  Created by David Salmon on 10/17/26.
+//
+//
+
+#include "DlPlatform.h"
+#include "TestSparseLDL.h"
+
+#include "SparseLDL.h"
+#include "colsol.h"
+
+#include <valarray>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// build the connectivity for a grid of size by size nodes with the
+// five point stencil. Equations are numbered row by row.
+static void buildGrid(DlInt32 size, std::valarray<DlInt32>& connect, std::valarray<DlInt32>& starts)
+{
+	DlInt32 neq = size * size;
+	std::vector<DlInt32> c;
+	starts.resize(neq + 1);
+	starts[0] = 1;
+	for (DlInt32 i = 0; i < neq; i++) {
+		c.push_back(i + 1);
+		if ((i + 1) % size != 0)
+			c.push_back(i + 2);
+		if (i + size < neq)
+			c.push_back(i + size + 1);
+		starts[i+1] = static_cast<DlInt32>(c.size()) + 1;
+	}
+	connect.resize(c.size());
+	for (size_t i = 0; i < c.size(); i++)
+		connect[i] = c[i];
+}
+
+// the value of the matrix term for equations i and j.
+static DlFloat64 gridValue(DlInt32 i, DlInt32 j)
+{
+	return i == j ? 4.5 : -1.0 + 0.01 * ((i + j) % 7);
+}
+
+static void fillGrid(SparseLDL& m, const std::valarray<DlInt32>& connect,
+					 const std::valarray<DlInt32>& starts)
+{
+	for (DlInt32 i = 1; i < static_cast<DlInt32>(starts.size()); i++)
+		for (DlInt32 k = starts[i-1]; k < starts[i]; k++)
+			m.add(i, connect[k-1], gridValue(i, connect[k-1]));
+}
+
+TEST(TestSparseLDL, solve)
+{
+	const DlInt32 size = 30;
+	const DlInt32 neq = size * size;
+	const DlInt32 nrhs = 2;
+	
+	std::valarray<DlInt32> connect;
+	std::valarray<DlInt32> starts;
+	buildGrid(size, connect, starts);
+	
+	SparseLDL m(connect, starts);
+	ASSERT_EQ(m.size(), neq);
+	EXPECT_LT(m.supernodeCount(), neq);
+	
+	// nested dissection should beat the band of the natural order.
+	EXPECT_LT(m.factorSize(), (DlInt64)neq * (size + 1));
+	
+	fillGrid(m, connect, starts);
+	m.factor();
+	
+	std::valarray<DlFloat64> b(neq * nrhs);
+	for (DlInt32 i = 0; i < neq * nrhs; i++)
+		b[i] = 1.0 + (i % 5);
+	
+	std::valarray<DlFloat64> x(b);
+	m.solve(&x, nrhs);
+	
+	// check the residual
+	for (DlInt32 r = 0; r < nrhs; r++) {
+		std::valarray<DlFloat64> ax(0.0, neq);
+		for (DlInt32 i = 1; i <= neq; i++) {
+			for (DlInt32 k = starts[i-1]; k < starts[i]; k++) {
+				DlInt32 j = connect[k-1];
+				DlFloat64 v = gridValue(i, j);
+				ax[i-1] += v * x[r * neq + j - 1];
+				if (j != i)
+					ax[j-1] += v * x[r * neq + i - 1];
+			}
+		}
+		for (DlInt32 i = 0; i < neq; i++)
+			EXPECT_NEAR(ax[i], b[r * neq + i], 1.0e-10);
+	}
+	
+	// refactor with new values
+	m.clear();
+	fillGrid(m, connect, starts);
+	m.factor();
+	std::valarray<DlFloat64> y(b);
+	m.solve(&y, nrhs);
+	for (DlInt32 i = 0; i < neq * nrhs; i++)
+		ASSERT_EQ(x[i], y[i]);
+}
+
+TEST(TestSparseLDL, singular)
+{
+	std::valarray<DlInt32> connect;
+	std::valarray<DlInt32> starts;
+	buildGrid(10, connect, starts);
+	
+	SparseLDL m(connect, starts);
+	fillGrid(m, connect, starts);
+	
+	// remove the diagonal from equation 37
+	m.add(37, 37, -gridValue(37, 37));
+	
+	try {
+		m.factor();
+		FAIL();
+	} catch(const EqSolveFailure& fail) {
+		EXPECT_EQ(fail.getReason(), EqSolveFailure::Singular);
+	}
+}
+
+TEST(TestSparseLDL, disconnected)
+{
+	// two separate chains and an isolated equation.
+	const DlInt32 connectData[] = { 1, 2,  2, 3,  3,  4, 5,  5,  6 };
+	const DlInt32 startData[] = { 1, 3, 5, 6, 8, 9, 10 };
+	std::valarray<DlInt32> connect(connectData, DlArrayElements(connectData));
+	std::valarray<DlInt32> starts(startData, DlArrayElements(startData));
+	
+	SparseLDL m(connect, starts);
+	ASSERT_EQ(m.size(), 6);
+	
+	for (DlInt32 i = 1; i <= 6; i++)
+		m.add(i, i, 2.0);
+	m.add(1, 2, -1.0);
+	m.add(2, 3, -1.0);
+	m.add(4, 5, -1.0);
+	m.factor();
+	
+	std::valarray<DlFloat64> x(1.0, 6);
+	m.solve(&x);
+	
+	EXPECT_NEAR(x[0], 1.5, 1.0e-12);
+	EXPECT_NEAR(x[1], 2.0, 1.0e-12);
+	EXPECT_NEAR(x[2], 1.5, 1.0e-12);
+	EXPECT_NEAR(x[3], 1.0, 1.0e-12);
+	EXPECT_NEAR(x[4], 1.0, 1.0e-12);
+	EXPECT_NEAR(x[5], 0.5, 1.0e-12);
+}
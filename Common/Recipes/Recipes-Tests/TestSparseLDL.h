@@ -0,0 +1,14 @@
+//
+//  TestSparseLDL.h
+//  Common_Recipes
+//
+//  Created by David Salmon on 10/17/26.
+//
+//
+
+#ifndef __Common_Recipes__TestSparseLDL__
+#define __Common_Recipes__TestSparseLDL__
+
+#include <iostream>
+
+#endif /* defined(__Common_Recipes__TestSparseLDL__) */
@@ -0,0 +1,156 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		SkylineFile.cpp
+ *
+ *	Contains:	skyline matrix kept in a file for the out-of-core solver
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "DlPlatform.h"
+#include "SkylineFile.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+//	terms written at a time when clearing the file.
+const DlInt64 kClearBlock = 1 << 16;
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::SkylineFile	-	open the file.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * path			->	the file to use, or null for a temporary file
+ * ----------------------------------------------------------------------------
+ */
+SkylineFile::SkylineFile(const char* path)
+	: itsFile(0)
+	, itsSize(0)
+	, itsPosition(0)
+{
+	if (path) {
+		itsFile = std::fopen(path, "w+b");
+		itsPath = path;
+	} else {
+		itsFile = std::tmpfile();
+	}
+	
+	if (!itsFile)
+		throw std::runtime_error("The skyline file could not be created.");
+}
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::~SkylineFile	-	close and remove the file.
+ * ----------------------------------------------------------------------------
+ */
+SkylineFile::~SkylineFile()
+{
+	std::fclose(itsFile);
+	if (!itsPath.empty())
+		std::remove(itsPath.c_str());
+}
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::clear	-	fill the file with size zero terms.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * size			->	the number of terms
+ * ----------------------------------------------------------------------------
+ */
+void
+SkylineFile::clear(DlInt64 size)
+{
+	std::vector<DlFloat64> zeros(std::min(size, kClearBlock), 0.0);
+	
+	itsSize = size;
+	for (DlInt64 first = 0; first < size; first += kClearBlock)
+		write(first, std::min(kClearBlock, size - first), zeros.data());
+}
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::read	-	read a run of terms.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * first		->	the first term, zero based
+ * count		->	the number of terms
+ * values		<-	the terms
+ * ----------------------------------------------------------------------------
+ */
+void
+SkylineFile::read(DlInt64 first, DlInt64 count, DlFloat64* values) const
+{
+	seek(first);
+	if (std::fread(values, sizeof(DlFloat64), count, itsFile) != static_cast<size_t>(count))
+		throw std::runtime_error("The skyline file could not be read.");
+	itsPosition += count;
+}
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::write	-	write a run of terms.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * first		->	the first term, zero based
+ * count		->	the number of terms
+ * values		->	the terms
+ * ----------------------------------------------------------------------------
+ */
+void
+SkylineFile::write(DlInt64 first, DlInt64 count, const DlFloat64* values)
+{
+	seek(first);
+	if (std::fwrite(values, sizeof(DlFloat64), count, itsFile) != static_cast<size_t>(count))
+		throw std::runtime_error("The skyline file could not be written.");
+	itsPosition += count;
+	itsSize = std::max(itsSize, itsPosition);
+}
+
+/* ----------------------------------------------------------------------------
+ * SkylineFile::seek	-	move to a term, unless already there. Standard C
+ *							requires a seek between a read and a write, and
+ *							a zero length one costs nothing.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * term			->	the term, zero based
+ * ----------------------------------------------------------------------------
+ */
+void
+SkylineFile::seek(DlInt64 term) const
+{
+	DlInt64 offset = (term - itsPosition) * static_cast<DlInt64>(sizeof(DlFloat64));
+	
+#if defined(_WIN32)
+	int result = _fseeki64(itsFile, offset, SEEK_CUR);
+#else
+	int result = fseeko(itsFile, static_cast<off_t>(offset), SEEK_CUR);
+#endif
+	
+	if (result != 0)
+		throw std::runtime_error("The skyline file could not be positioned.");
+	itsPosition = term;
+}
@@ -0,0 +1,77 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		SkylineFile.h
+ *
+ *	Contains:	skyline matrix kept in a file for the out-of-core solver
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_SkylineFile
+#define _H_SkylineFile
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+
+#include <cstdio>
+#include <string>
+
+//---------------------------------- Class -------------------------------------
+
+//	A skyline matrix held in a file rather than in memory, for
+//	colsolDecompFile and colsolBackSubFile. The terms are stored in the
+//	order of the skyline vector, so term i of the file is a[i+1] of the
+//	one-based matrix colsol works with, and a run of columns is one run of
+//	the file. Reads and writes of neighbouring runs in order do not seek.
+//
+//	Errors reading or writing the file throw std::runtime_error.
+class SkylineFile
+{
+public:
+	//	with no path the file is a temporary one, removed when closed.
+	SkylineFile(const char* path = 0);
+	~SkylineFile();
+
+	DlInt64	size() const { return itsSize; }
+
+	//	set the number of terms, all zero.
+	void	clear(DlInt64 size);
+
+	//	read or write count terms starting from term first (zero based).
+	void	read(DlInt64 first, DlInt64 count, DlFloat64* values) const;
+	void	write(DlInt64 first, DlInt64 count, const DlFloat64* values);
+
+private:
+	SkylineFile(const SkylineFile& f);
+	SkylineFile& operator=(const SkylineFile& f);
+
+	void	seek(DlInt64 term) const;
+
+	std::FILE*			itsFile;
+	std::string			itsPath;		//	removed when closed, if set
+	DlInt64				itsSize;
+	mutable DlInt64		itsPosition;	//	the term the file is at
+};
+
+#endif
@@ -0,0 +1,853 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		SparseLDL.cpp
+ *
+ *	Contains:	sparse supernodal LDL' solver
+ *
+ *	The equations are ordered by nested dissection of the adjacency graph,
+ *	using the middle of a rooted level structure as the separator. The
+ *	elimination tree is postordered so that the columns of each supernode
+ *	are contiguous, and the numeric factorization is multifrontal: each
+ *	supernode assembles its columns of the matrix and the update matrices
+ *	of its children into a dense front, factors the supernode columns and
+ *	passes the remaining update to its parent.
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "DlPlatform.h"
+#include "recipes.h"
+#include "SparseLDL.h"
+
+#include <algorithm>
+#include <cmath>
+
+//	subgraphs this small are not dissected further.
+const DlInt32 kLeafSize = 32;
+
+//	the number of searches for a pseudo-peripheral root.
+const DlInt32 kRootSearches = 4;
+
+static void checkPivot(DlFloat64 d, DlInt32 eq, bool posDef);
+
+//------------------------------------------------------------------------------
+//	SparseLDL::SparseLDL											constructor
+//
+//		Build the matrix structure, order the equations and compute the
+//		structure of the factor.
+//
+//	connect				->	one-based array of connectivity for upper triangle.
+//	starts				->	one-based start of each equation in connect.
+//------------------------------------------------------------------------------
+SparseLDL::SparseLDL(const array_type & connect, const array_type & starts)
+	: itsNeq(static_cast<DlInt32>(starts.size()) - 1)
+	, itsFactorSize(0)
+	, itsNextLabel(0)
+	, itsStamp(0)
+{
+	if (itsNeq <= 0) {
+		itsNeq = 0;
+		itsSuperStart.resize(1, 0);
+		itsSuperRowStart.resize(1, 0);
+		return;
+	}
+
+	buildAdjacency(connect, starts);
+	orderNestedDissection();
+
+	//	order the elimination tree so that supernodes are contiguous
+	buildPermuted();
+	buildEliminationTree();
+	postorder();
+
+	buildPermuted();
+	buildEliminationTree();
+	buildSupernodes();
+
+	//	the ordering work space is no longer needed
+	std::vector<DlInt32>().swap(itsLabel);
+	std::vector<DlInt32>().swap(itsMark);
+	std::vector<DlInt32>().swap(itsOrder);
+	itsAdj.resize(0);
+	itsAdjStart.resize(0);
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::clear
+//
+//		zero the matrix values.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::clear()
+{
+	if (itsValues.size() > 0)
+		itsValues = 0.0;
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::add
+//
+//		add to the matrix term for equations i and j. The term must be part
+//		of the connectivity used to build the matrix.
+//
+//	i					->	one-based equation.
+//	j					->	one-based equation.
+//	value				->	the value to add.
+//------------------------------------------------------------------------------
+void
+SparseLDL::add(DlInt32 i, DlInt32 j, DlFloat64 value)
+{
+	if (i > j)
+		std::swap(i, j);
+
+	const DlInt32* first = &itsRows[0] + itsColStart[i-1];
+	const DlInt32* last = &itsRows[0] + itsColStart[i];
+	const DlInt32* loc = std::lower_bound(first, last, j - 1);
+
+	_RecipesAssert(loc != last && *loc == j - 1);
+	itsValues[loc - &itsRows[0]] += value;
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::factor
+//
+//		factor the matrix. Throws EqSolveFailure if the matrix is singular or
+//		the user cancels.
+//
+//	posDef				->	true if the matrix is known to be positive-definite
+//	progress			->	the progress reporter object
+//------------------------------------------------------------------------------
+void
+SparseLDL::factor(bool posDef, EqSolveProgress* progress)
+{
+	//	update matrices waiting for their parent, dense lower triangles.
+	struct Update {
+		std::vector<DlInt32>	rows;
+		std::vector<DlFloat64>	values;
+	};
+
+	DlInt32 nSuper = supernodeCount();
+	std::vector<Update> stack;
+	std::vector<DlInt32> children(nSuper, 0);
+	std::vector<DlInt32> rel(itsNeq, 0);
+	std::vector<DlFloat64> front;
+	std::vector<DlFloat64> t;
+
+	for (DlInt32 s = 0; s < nSuper; s++) {
+		if (itsSuperParent[s] >= 0)
+			children[itsSuperParent[s]]++;
+	}
+
+	for (DlInt32 s = 0; s < nSuper; s++) {
+		DlInt32 f = itsSuperStart[s];
+		DlInt32 w = itsSuperStart[s+1] - f;
+		DlInt32 m = itsSuperRowStart[s+1] - itsSuperRowStart[s];
+		const DlInt32* rows = &itsSuperRows[itsSuperRowStart[s]];
+
+		if (progress && !progress->Processing(f + w, itsNeq))
+			throw EqSolveFailure(EqSolveFailure::UserCancelled, f + 1);
+
+		for (DlInt32 i = 0; i < m; i++)
+			rel[rows[i]] = i;
+
+		//	assemble the matrix terms for the supernode columns
+		front.assign(static_cast<size_t>(m) * m, 0.0);
+		for (DlInt32 j = 0; j < w; j++) {
+			DlInt32 c = f + j;
+			for (DlInt32 k = itsPermStart[c]; k < itsPermStart[c+1]; k++)
+				front[rel[itsPermRows[k]] + static_cast<size_t>(j) * m] +=
+					itsValues[itsPermIndex[k]];
+		}
+
+		//	and the updates from the children
+		for (DlInt32 n = 0; n < children[s]; n++) {
+			const Update& u = stack.back();
+			DlInt32 nu = static_cast<DlInt32>(u.rows.size());
+			for (DlInt32 jj = 0; jj < nu; jj++) {
+				DlFloat64* col = &front[static_cast<size_t>(rel[u.rows[jj]]) * m];
+				const DlFloat64* ucol = &u.values[static_cast<size_t>(jj) * nu];
+				for (DlInt32 ii = jj; ii < nu; ii++)
+					col[rel[u.rows[ii]]] += ucol[ii];
+			}
+			stack.pop_back();
+		}
+
+		//	factor the supernode columns, updating the rest of the front
+		t.resize(m);
+		for (DlInt32 k = 0; k < w; k++) {
+			DlFloat64* lk = &front[static_cast<size_t>(k) * m];
+			DlFloat64 d = lk[k];
+			checkPivot(d, itsPerm[f + k] + 1, posDef);
+			itsDiag[f + k] = d;
+			if (progress)
+				progress->Pivot(itsPerm[f + k] + 1, d);
+
+			for (DlInt32 i = k + 1; i < m; i++) {
+				t[i] = lk[i];
+				lk[i] /= d;
+			}
+
+			for (DlInt32 j = k + 1; j < m; j++) {
+				DlFloat64 tj = t[j];
+				if (tj != 0.0) {
+					DlFloat64* col = &front[static_cast<size_t>(j) * m];
+					for (DlInt32 i = j; i < m; i++)
+						col[i] -= lk[i] * tj;
+				}
+			}
+		}
+
+		std::copy(front.begin(), front.begin() + static_cast<size_t>(m) * w,
+				  &itsFactor[itsSuperValStart[s]]);
+
+		//	pass the remainder to the parent
+		if (m > w) {
+			DlInt32 nu = m - w;
+			stack.push_back(Update());
+			Update& u = stack.back();
+			u.rows.assign(rows + w, rows + m);
+			u.values.resize(static_cast<size_t>(nu) * nu);
+			for (DlInt32 jj = 0; jj < nu; jj++) {
+				const DlFloat64* col = &front[static_cast<size_t>(jj + w) * m + w];
+				std::copy(col + jj, col + nu, &u.values[static_cast<size_t>(jj) * nu + jj]);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::operations
+//
+//		estimate the floating point operations from the column counts of the
+//		factor. Eliminating a column with r terms below the diagonal takes r
+//		divides and a multiply and subtract for each of the r (r + 1) / 2
+//		terms it updates.
+//
+//	factorOps			<-	the operations to factor the matrix
+//	solveOps			<-	the operations to solve for one vector
+//------------------------------------------------------------------------------
+void
+SparseLDL::operations(DlFloat64& factorOps, DlFloat64& solveOps) const
+{
+	factorOps = 0;
+	solveOps = 0;
+
+	for (DlInt32 c = 0; c < itsNeq; c++) {
+		DlFloat64 r = itsColCount[c] - 1;
+		factorOps += r * r + 2 * r;
+		solveOps += 4 * r + 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::solve
+//
+//		solve for a block of rhs vectors using the factored matrix. The
+//		vectors are interleaved while solving so the inner loops run over the
+//		rhs vectors in contiguous memory.
+//
+//	vv					<->	the rhs vectors, column-major (neq by nrhs)
+//	nrhs				->	the number of rhs vectors
+//	progress			->	the progress reporter object
+//------------------------------------------------------------------------------
+void
+SparseLDL::solve(std::valarray<DlFloat64>* vv, DlInt32 nrhs, EqSolveProgress* progress) const
+{
+	if (nrhs <= 0 || itsNeq == 0)
+		return;
+
+	DlInt32 nSuper = supernodeCount();
+	std::valarray<DlFloat64>& v = *vv;
+	std::valarray<DlFloat64> x(static_cast<size_t>(itsNeq) * nrhs);
+
+	auto row = [&x, nrhs](DlInt32 c) { return &x[static_cast<size_t>(c) * nrhs]; };
+
+	for (DlInt32 r = 0; r < nrhs; r++)
+		for (DlInt32 k = 0; k < itsNeq; k++)
+			row(k)[r] = v[static_cast<size_t>(r) * itsNeq + itsPerm[k]];
+
+	//	forward reduction
+	for (DlInt32 s = 0; s < nSuper; s++) {
+		DlInt32 f = itsSuperStart[s];
+		DlInt32 w = itsSuperStart[s+1] - f;
+		DlInt32 m = itsSuperRowStart[s+1] - itsSuperRowStart[s];
+		const DlInt32* rows = &itsSuperRows[itsSuperRowStart[s]];
+
+		if (progress && !progress->Processing(f + w, itsNeq))
+			throw EqSolveFailure(EqSolveFailure::UserCancelled, f + 1);
+
+		for (DlInt32 k = 0; k < w; k++) {
+			const DlFloat64* lk = &itsFactor[itsSuperValStart[s] + static_cast<DlInt64>(k) * m];
+			const DlFloat64* xc = row(f + k);
+			for (DlInt32 i = k + 1; i < m; i++) {
+				DlFloat64 l = lk[i];
+				DlFloat64* xi = row(rows[i]);
+				for (DlInt32 r = 0; r < nrhs; r++)
+					xi[r] -= l * xc[r];
+			}
+		}
+	}
+
+	for (DlInt32 c = 0; c < itsNeq; c++) {
+		DlFloat64 d = itsDiag[c];
+		DlFloat64* xc = row(c);
+		for (DlInt32 r = 0; r < nrhs; r++)
+			xc[r] /= d;
+	}
+
+	//	back substitution
+	for (DlInt32 s = nSuper - 1; s >= 0; s--) {
+		DlInt32 f = itsSuperStart[s];
+		DlInt32 w = itsSuperStart[s+1] - f;
+		DlInt32 m = itsSuperRowStart[s+1] - itsSuperRowStart[s];
+		const DlInt32* rows = &itsSuperRows[itsSuperRowStart[s]];
+
+		for (DlInt32 k = w - 1; k >= 0; k--) {
+			const DlFloat64* lk = &itsFactor[itsSuperValStart[s] + static_cast<DlInt64>(k) * m];
+			DlFloat64* xc = row(f + k);
+			for (DlInt32 i = k + 1; i < m; i++) {
+				DlFloat64 l = lk[i];
+				const DlFloat64* xi = row(rows[i]);
+				for (DlInt32 r = 0; r < nrhs; r++)
+					xc[r] -= l * xi[r];
+			}
+		}
+	}
+
+	for (DlInt32 r = 0; r < nrhs; r++)
+		for (DlInt32 k = 0; k < itsNeq; k++)
+			v[static_cast<size_t>(r) * itsNeq + itsPerm[k]] = row(k)[r];
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::buildAdjacency											private
+//
+//		Build the zero-based lower triangle, always including the diagonal,
+//		and the full adjacency graph without the diagonal.
+//
+//	connect				->	one-based array of connectivity for upper triangle.
+//	starts				->	one-based start of each equation in connect.
+//------------------------------------------------------------------------------
+void
+SparseLDL::buildAdjacency(const array_type & connect, const array_type & starts)
+{
+	std::vector<DlInt32> rows;
+	rows.reserve(connect.size() + itsNeq);
+
+	itsColStart.resize(itsNeq + 1);
+	itsColStart[0] = 0;
+
+	std::vector<DlInt32> degree(itsNeq + 1, 0);
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		rows.push_back(i);
+		for (DlInt32 k = starts[i] - 1; k < starts[i+1] - 1; k++) {
+			DlInt32 r = connect[k] - 1;
+			if (r != i) {
+				_RecipesAssert(r > i && r < itsNeq);
+				rows.push_back(r);
+				degree[i]++;
+				degree[r]++;
+			}
+		}
+		itsColStart[i+1] = static_cast<DlInt32>(rows.size());
+	}
+
+	itsRows.resize(rows.size());
+	std::copy(rows.begin(), rows.end(), &itsRows[0]);
+	itsValues.resize(rows.size(), 0.0);
+
+	//	the adjacency graph
+	itsAdjStart.resize(itsNeq + 1);
+	itsAdjStart[0] = 0;
+	for (DlInt32 i = 0; i < itsNeq; i++)
+		itsAdjStart[i+1] = itsAdjStart[i] + degree[i];
+
+	itsAdj.resize(itsAdjStart[itsNeq]);
+	std::vector<DlInt32> next(&itsAdjStart[0], &itsAdjStart[0] + itsNeq);
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		for (DlInt32 k = itsColStart[i] + 1; k < itsColStart[i+1]; k++) {
+			DlInt32 r = itsRows[k];
+			itsAdj[next[i]++] = r;
+			itsAdj[next[r]++] = i;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::orderNestedDissection									private
+//
+//		compute the elimination order, itsPerm, by nested dissection.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::orderNestedDissection()
+{
+	itsLabel.assign(itsNeq, 0);
+	itsMark.assign(itsNeq, -1);
+	itsOrder.clear();
+	itsOrder.reserve(itsNeq);
+	itsNextLabel = 0;
+
+	std::vector<DlInt32> nodes(itsNeq);
+	for (DlInt32 i = 0; i < itsNeq; i++)
+		nodes[i] = i;
+
+	dissect(nodes, 0);
+	_RecipesAssert(static_cast<DlInt32>(itsOrder.size()) == itsNeq);
+
+	itsPerm.resize(itsNeq);
+	for (DlInt32 k = 0; k < itsNeq; k++)
+		itsPerm[k] = itsOrder[k];
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::dissect													private
+//
+//		order the subgraph made of nodes, all of which have the given label.
+//		The subgraph is split into two parts by the middle level of a rooted
+//		level structure. The parts are ordered first, then the separator.
+//
+//	nodes				->	the nodes in the subgraph.
+//	label				->	the label of the subgraph.
+//------------------------------------------------------------------------------
+void
+SparseLDL::dissect(std::vector<DlInt32>& nodes, DlInt32 label)
+{
+	DlInt32 n = static_cast<DlInt32>(nodes.size());
+	if (n <= kLeafSize) {
+		itsOrder.insert(itsOrder.end(), nodes.begin(), nodes.end());
+		return;
+	}
+
+	std::vector<DlInt32> order;
+	std::vector<DlInt32> levelStart;
+	DlInt32 depth = buildLevels(nodes[0], label, order, levelStart);
+
+	//	split off everything not connected to the first node
+	if (static_cast<DlInt32>(order.size()) < n) {
+		DlInt32 reached = ++itsNextLabel;
+		DlInt32 rest = ++itsNextLabel;
+		for (auto i : order)
+			itsLabel[i] = reached;
+
+		std::vector<DlInt32> others;
+		others.reserve(n - order.size());
+		for (auto i : nodes) {
+			if (itsLabel[i] == label) {
+				itsLabel[i] = rest;
+				others.push_back(i);
+			}
+		}
+
+		nodes.clear();
+		dissect(order, reached);
+		dissect(others, rest);
+		return;
+	}
+
+	//	look for a deeper level structure, rooted at a node of low degree in
+	//	the last level.
+	for (DlInt32 search = 0; search < kRootSearches; search++) {
+		DlInt32 root = order[levelStart[depth - 1]];
+		for (DlInt32 k = levelStart[depth - 1]; k < levelStart[depth]; k++) {
+			DlInt32 i = order[k];
+			if (itsAdjStart[i+1] - itsAdjStart[i] < itsAdjStart[root+1] - itsAdjStart[root])
+				root = i;
+		}
+
+		std::vector<DlInt32> rootOrder;
+		std::vector<DlInt32> rootStart;
+		DlInt32 rootDepth = buildLevels(root, label, rootOrder, rootStart);
+		if (rootDepth <= depth)
+			break;
+
+		depth = rootDepth;
+		order.swap(rootOrder);
+		levelStart.swap(rootStart);
+	}
+
+	if (depth < 3) {
+		itsOrder.insert(itsOrder.end(), order.begin(), order.end());
+		return;
+	}
+
+	//	choose the separator level that best balances the two parts
+	DlInt32 sep = 1;
+	DlInt32 best = n;
+	for (DlInt32 l = 1; l < depth - 1; l++) {
+		DlInt32 before = levelStart[l];
+		DlInt32 after = n - levelStart[l+1];
+		DlInt32 diff = std::abs(before - after);
+		if (diff < best) {
+			best = diff;
+			sep = l;
+		}
+	}
+
+	DlInt32 first = ++itsNextLabel;
+	DlInt32 second = ++itsNextLabel;
+	DlInt32 separator = ++itsNextLabel;
+
+	std::vector<DlInt32> part1(order.begin(), order.begin() + levelStart[sep]);
+	std::vector<DlInt32> part2(order.begin() + levelStart[sep+1], order.end());
+
+	for (auto i : part1)
+		itsLabel[i] = first;
+	for (auto i : part2)
+		itsLabel[i] = second;
+	for (DlInt32 k = levelStart[sep]; k < levelStart[sep+1]; k++)
+		itsLabel[order[k]] = separator;
+
+	nodes.clear();
+	dissect(part1, first);
+	dissect(part2, second);
+
+	itsOrder.insert(itsOrder.end(), order.begin() + levelStart[sep],
+					order.begin() + levelStart[sep+1]);
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::buildLevels												private
+//
+//		build the rooted level structure for the nodes with label that are
+//		reachable from root.
+//
+//	root				->	the root node.
+//	label				->	the label of the subgraph.
+//	order				<-	the nodes in breadth first order.
+//	levelStart			<-	the start of each level in order.
+//	return				<-	the number of levels.
+//------------------------------------------------------------------------------
+DlInt32
+SparseLDL::buildLevels(DlInt32 root, DlInt32 label, std::vector<DlInt32>& order,
+		std::vector<DlInt32>& levelStart)
+{
+	DlInt32 stamp = ++itsStamp;
+
+	order.clear();
+	levelStart.clear();
+
+	order.push_back(root);
+	itsMark[root] = stamp;
+
+	DlInt32 first = 0;
+	while (first < static_cast<DlInt32>(order.size())) {
+		DlInt32 last = static_cast<DlInt32>(order.size());
+		levelStart.push_back(first);
+		for (DlInt32 k = first; k < last; k++) {
+			DlInt32 i = order[k];
+			for (DlInt32 a = itsAdjStart[i]; a < itsAdjStart[i+1]; a++) {
+				DlInt32 j = itsAdj[a];
+				if (itsMark[j] != stamp && itsLabel[j] == label) {
+					itsMark[j] = stamp;
+					order.push_back(j);
+				}
+			}
+		}
+		first = last;
+	}
+
+	DlInt32 depth = static_cast<DlInt32>(levelStart.size());
+	levelStart.push_back(static_cast<DlInt32>(order.size()));
+	return depth;
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::buildPermuted											private
+//
+//		build the lower triangle of the matrix in the order itsPerm.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::buildPermuted()
+{
+	itsInvPerm.resize(itsNeq);
+	for (DlInt32 k = 0; k < itsNeq; k++)
+		itsInvPerm[itsPerm[k]] = k;
+
+	itsPermStart.resize(itsNeq + 1);
+	itsPermStart = 0;
+
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		for (DlInt32 k = itsColStart[i]; k < itsColStart[i+1]; k++) {
+			DlInt32 c = std::min(itsInvPerm[i], itsInvPerm[itsRows[k]]);
+			itsPermStart[c+1]++;
+		}
+	}
+
+	for (DlInt32 c = 0; c < itsNeq; c++)
+		itsPermStart[c+1] += itsPermStart[c];
+
+	itsPermRows.resize(itsRows.size());
+	itsPermIndex.resize(itsRows.size());
+
+	std::vector<DlInt32> next(&itsPermStart[0], &itsPermStart[0] + itsNeq);
+	for (DlInt32 i = 0; i < itsNeq; i++) {
+		for (DlInt32 k = itsColStart[i]; k < itsColStart[i+1]; k++) {
+			DlInt32 pi = itsInvPerm[i];
+			DlInt32 pr = itsInvPerm[itsRows[k]];
+			DlInt32 c = std::min(pi, pr);
+			DlInt32 loc = next[c]++;
+			itsPermRows[loc] = std::max(pi, pr);
+			itsPermIndex[loc] = k;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::buildEliminationTree										private
+//
+//		compute the elimination tree of the permuted matrix and the number
+//		of terms in each column of the factor, using the row subtrees.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::buildEliminationTree()
+{
+	//	the rows of the permuted lower triangle, excluding the diagonal
+	std::vector<DlInt32> rowStart(itsNeq + 1, 0);
+	for (DlInt32 c = 0; c < itsNeq; c++)
+		for (DlInt32 k = itsPermStart[c]; k < itsPermStart[c+1]; k++)
+			if (itsPermRows[k] != c)
+				rowStart[itsPermRows[k] + 1]++;
+
+	for (DlInt32 r = 0; r < itsNeq; r++)
+		rowStart[r+1] += rowStart[r];
+
+	std::vector<DlInt32> rowCols(rowStart[itsNeq]);
+	std::vector<DlInt32> next(rowStart.begin(), rowStart.end() - 1);
+	for (DlInt32 c = 0; c < itsNeq; c++)
+		for (DlInt32 k = itsPermStart[c]; k < itsPermStart[c+1]; k++)
+			if (itsPermRows[k] != c)
+				rowCols[next[itsPermRows[k]]++] = c;
+
+	//	the tree, with path compression through ancestor
+	itsParent.resize(itsNeq);
+	std::vector<DlInt32> ancestor(itsNeq, -1);
+	for (DlInt32 k = 0; k < itsNeq; k++) {
+		itsParent[k] = -1;
+		for (DlInt32 p = rowStart[k]; p < rowStart[k+1]; p++) {
+			DlInt32 i = rowCols[p];
+			while (i != -1 && i < k) {
+				DlInt32 inext = ancestor[i];
+				ancestor[i] = k;
+				if (inext == -1)
+					itsParent[i] = k;
+				i = inext;
+			}
+		}
+	}
+
+	//	the column counts. Row k of the factor is the union of the paths
+	//	from each column in row k of the matrix up to k.
+	itsColCount.resize(itsNeq);
+	itsColCount = 1;
+	std::vector<DlInt32>& mark = ancestor;
+	std::fill(mark.begin(), mark.end(), -1);
+	for (DlInt32 k = 0; k < itsNeq; k++) {
+		mark[k] = k;
+		for (DlInt32 p = rowStart[k]; p < rowStart[k+1]; p++) {
+			for (DlInt32 j = rowCols[p]; mark[j] != k; j = itsParent[j]) {
+				mark[j] = k;
+				itsColCount[j]++;
+			}
+		}
+	}
+
+	itsFactorSize = 0;
+	for (DlInt32 k = 0; k < itsNeq; k++)
+		itsFactorSize += itsColCount[k];
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::postorder												private
+//
+//		renumber itsPerm in a postorder of the elimination tree.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::postorder()
+{
+	//	child lists, in increasing order
+	std::vector<DlInt32> head(itsNeq, -1);
+	std::vector<DlInt32> next(itsNeq, -1);
+	for (DlInt32 j = itsNeq - 1; j >= 0; j--) {
+		DlInt32 p = itsParent[j];
+		if (p >= 0) {
+			next[j] = head[p];
+			head[p] = j;
+		}
+	}
+
+	std::vector<DlInt32> post;
+	std::vector<DlInt32> stack;
+	post.reserve(itsNeq);
+
+	for (DlInt32 root = 0; root < itsNeq; root++) {
+		if (itsParent[root] != -1)
+			continue;
+
+		stack.push_back(root);
+		while (!stack.empty()) {
+			DlInt32 p = stack.back();
+			DlInt32 child = head[p];
+			if (child == -1) {
+				stack.pop_back();
+				post.push_back(p);
+			} else {
+				head[p] = next[child];
+				stack.push_back(child);
+			}
+		}
+	}
+
+	array_type perm(itsNeq);
+	for (DlInt32 k = 0; k < itsNeq; k++)
+		perm[k] = itsPerm[post[k]];
+	itsPerm = perm;
+}
+
+//------------------------------------------------------------------------------
+//	SparseLDL::buildSupernodes											private
+//
+//		find the fundamental supernodes of the postordered elimination tree
+//		and compute the row structure of each.
+//
+//------------------------------------------------------------------------------
+void
+SparseLDL::buildSupernodes()
+{
+	std::vector<DlInt32> childCount(itsNeq, 0);
+	for (DlInt32 j = 0; j < itsNeq; j++)
+		if (itsParent[j] >= 0)
+			childCount[itsParent[j]]++;
+
+	//	column j joins the supernode of j-1 if it is the only child of j
+	//	and their structures match.
+	std::vector<DlInt32> starts;
+	std::vector<DlInt32> colToSuper(itsNeq);
+	for (DlInt32 j = 0; j < itsNeq; j++) {
+		if (j == 0 || itsParent[j-1] != j || childCount[j] != 1 ||
+				itsColCount[j-1] != itsColCount[j] + 1)
+			starts.push_back(j);
+		colToSuper[j] = static_cast<DlInt32>(starts.size()) - 1;
+	}
+	starts.push_back(itsNeq);
+
+	DlInt32 nSuper = static_cast<DlInt32>(starts.size()) - 1;
+	itsSuperStart.resize(nSuper + 1);
+	std::copy(starts.begin(), starts.end(), &itsSuperStart[0]);
+
+	itsSuperParent.resize(nSuper);
+	std::vector<DlInt32> childHead(nSuper, -1);
+	std::vector<DlInt32> childNext(nSuper, -1);
+	for (DlInt32 s = nSuper - 1; s >= 0; s--) {
+		DlInt32 p = itsParent[itsSuperStart[s+1] - 1];
+		itsSuperParent[s] = p >= 0 ? colToSuper[p] : -1;
+		if (p >= 0) {
+			childNext[s] = childHead[itsSuperParent[s]];
+			childHead[itsSuperParent[s]] = s;
+		}
+	}
+
+	//	the rows of each supernode are its columns, the matrix rows below
+	//	them, and the rows passed up from its children.
+	itsSuperRowStart.resize(nSuper + 1);
+	itsSuperValStart.resize(nSuper + 1);
+	itsSuperRowStart[0] = 0;
+	itsSuperValStart[0] = 0;
+
+	std::vector<DlInt32> superRows;
+	std::vector<DlInt32> mark(itsNeq, -1);
+	for (DlInt32 s = 0; s < nSuper; s++) {
+		DlInt32 f = itsSuperStart[s];
+		DlInt32 l = itsSuperStart[s+1] - 1;
+		DlInt32 base = static_cast<DlInt32>(superRows.size());
+
+		for (DlInt32 c = f; c <= l; c++) {
+			superRows.push_back(c);
+			mark[c] = s;
+		}
+
+		for (DlInt32 c = f; c <= l; c++) {
+			for (DlInt32 k = itsPermStart[c]; k < itsPermStart[c+1]; k++) {
+				DlInt32 r = itsPermRows[k];
+				if (mark[r] != s) {
+					mark[r] = s;
+					superRows.push_back(r);
+				}
+			}
+		}
+
+		for (DlInt32 t = childHead[s]; t != -1; t = childNext[t]) {
+			DlInt32 tw = itsSuperStart[t+1] - itsSuperStart[t];
+			for (DlInt32 k = itsSuperRowStart[t] + tw; k < itsSuperRowStart[t+1]; k++) {
+				DlInt32 r = superRows[k];
+				if (mark[r] != s) {
+					mark[r] = s;
+					superRows.push_back(r);
+				}
+			}
+		}
+
+		std::sort(superRows.begin() + base + (l - f + 1), superRows.end());
+
+		DlInt32 m = static_cast<DlInt32>(superRows.size()) - base;
+		_RecipesAssert(m == itsColCount[f]);
+
+		itsSuperRowStart[s+1] = static_cast<DlInt32>(superRows.size());
+		itsSuperValStart[s+1] = itsSuperValStart[s] + static_cast<DlInt64>(m) * (l - f + 1);
+	}
+
+	itsSuperRows.resize(superRows.size());
+	std::copy(superRows.begin(), superRows.end(), &itsSuperRows[0]);
+
+	itsFactor.resize(itsSuperValStart[nSuper]);
+	itsDiag.resize(itsNeq);
+}
+
+//------------------------------------------------------------------------------
+//	checkPivot															static
+//
+//		throw EqSolveFailure if the pivot is too small. The same test as
+//		colsol.
+//
+//	d					->	the pivot.
+//	eq					->	the one-based equation.
+//	posDef				->	true if the matrix is known to be positive-definite
+//------------------------------------------------------------------------------
+static void
+checkPivot(DlFloat64 d, DlInt32 eq, bool posDef)
+{
+	if (posDef) {
+		if (d < 1.0e-10)
+			throw EqSolveFailure(EqSolveFailure::Singular, eq);
+	} else {
+		if (std::fabs(d) < 1.0e-10)
+			throw EqSolveFailure(
+								 d < 0 ? EqSolveFailure::NonPositiveDefinite :
+								 EqSolveFailure::Singular, eq
+								 );
+	}
+}
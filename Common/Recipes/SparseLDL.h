@@ -0,0 +1,142 @@
+//345678901234567890123456789012345678901234567890123456789012345678901234567890
+/*+
+ *	File:		SparseLDL.h
+ *
+ *	Contains:	sparse supernodal LDL' solver interface
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_SparseLDL
+#define _H_SparseLDL
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+#include "matrix.h"
+#include <valarray>
+#include <vector>
+
+//---------------------------------- Class -------------------------------------
+
+//	Sparse symmetric solver. The matrix is held in compressed column form
+//	for the lower triangle. Construction orders the equations by nested
+//	dissection and computes the supernodal structure of the factor. Values
+//	are then added with add() using the original one-based equation numbers,
+//	factored with factor(), and any number of rhs vectors solved with solve().
+//
+//	factor() and solve() throw EqSolveFailure in the same cases as colsol,
+//	reporting the original equation number.
+class SparseLDL
+{
+	typedef std::valarray<DlInt32> array_type;
+
+public:
+	//	connect and starts have the form produced by GPSRenum's input: for each
+	//	one-based equation i, connect[starts[i-1]-1] through connect[starts[i]-2]
+	//	is the sorted list of equations j >= i coupled to i.
+	SparseLDL(const array_type & connect, const array_type & starts);
+
+	DlInt32 size() const { return itsNeq; }
+
+	//	the number of terms in the factor, including the diagonal.
+	DlInt64 factorSize() const { return itsFactorSize; }
+	DlInt32 supernodeCount() const { return static_cast<DlInt32>(itsSuperStart.size()) - 1; }
+
+	//	estimate the floating point operations to factor the matrix and to
+	//	solve for one vector.
+	void operations(DlFloat64& factorOps, DlFloat64& solveOps) const;
+
+	//	the order used for the factor. mapDof(i) is the position of equation i.
+	DlInt32 mapDof(DlInt32 i) const { return itsInvPerm[i-1] + 1; }
+
+	//	zero the matrix values.
+	void clear();
+
+	//	add value to the term for one-based equations i and j.
+	void add(DlInt32 i, DlInt32 j, DlFloat64 value);
+
+	void factor(bool positiveDefinite = true, EqSolveProgress* progress = 0);
+
+	//	solve for nrhs vectors held column-major in v (neq by nrhs).
+	void solve(std::valarray<DlFloat64>* v, DlInt32 nrhs = 1,
+			   EqSolveProgress* progress = 0) const;
+
+private:
+
+	void buildAdjacency(const array_type & connect, const array_type & starts);
+	void orderNestedDissection();
+	void dissect(std::vector<DlInt32>& nodes, DlInt32 label);
+	DlInt32 buildLevels(DlInt32 root, DlInt32 label, std::vector<DlInt32>& order,
+			std::vector<DlInt32>& levelStart);
+
+	void buildPermuted();
+	void buildEliminationTree();
+	void postorder();
+	void buildSupernodes();
+
+	DlInt32				itsNeq;
+	DlInt64				itsFactorSize;
+
+	//	original lower triangle, zero based. Column i holds rows j >= i.
+	array_type			itsColStart;
+	array_type			itsRows;
+	std::valarray<DlFloat64>	itsValues;
+
+	//	full adjacency graph and work space, used for ordering.
+	array_type			itsAdjStart;
+	array_type			itsAdj;
+	std::vector<DlInt32>	itsLabel;
+	std::vector<DlInt32>	itsMark;
+	std::vector<DlInt32>	itsOrder;
+	DlInt32				itsNextLabel;
+	DlInt32				itsStamp;
+
+	//	itsPerm[k] is the equation eliminated k'th, itsInvPerm the reverse.
+	array_type			itsPerm;
+	array_type			itsInvPerm;
+
+	//	permuted lower triangle. Entry k of column c is permuted row
+	//	itsPermRows[k] with value itsValues[itsPermIndex[k]].
+	array_type			itsPermStart;
+	array_type			itsPermRows;
+	array_type			itsPermIndex;
+
+	array_type			itsParent;		//	elimination tree
+	array_type			itsColCount;	//	terms in each column of L
+
+	//	supernode s has columns itsSuperStart[s] to itsSuperStart[s+1] - 1 and
+	//	rows itsSuperRows[itsSuperRowStart[s]...]. The first rows are the
+	//	columns of the supernode. Its values are a dense column-major block
+	//	at itsFactor[itsSuperValStart[s]].
+	array_type			itsSuperStart;
+	array_type			itsSuperRowStart;
+	array_type			itsSuperRows;
+	std::vector<DlInt64>	itsSuperValStart;
+	array_type			itsSuperParent;
+
+	std::valarray<DlFloat64>	itsFactor;
+	std::valarray<DlFloat64>	itsDiag;
+};
+
+#endif
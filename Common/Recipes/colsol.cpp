@@ -32,9 +32,39 @@
 
 #include "DlPlatform.h"
 #include "colsol.h"
+#include "DlThreadPool.h"
+#include "SkylineFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 using namespace DlArray;
 
+template <class T>
+static void decompFrom(DlInt32 neq, std::valarray<T>& aa, const std::valarray<DlInt32>& maxaa,
+						 DlInt32 firstColumn, bool posDef, EqSolveProgress* progress);
+template <class T>
+static void decompParallel(DlInt32 neq, std::valarray<T>& aa, const std::valarray<DlInt32>& maxaa,
+						 DlThreadPool& pool, bool posDef, EqSolveProgress* progress,
+						 DlInt32 panelWidth, DlInt32 firstColumn);
+template <class T>
+static void backSub(DlInt32 neq, const std::valarray<T>& aa, const std::valarray<DlInt32>& maxaa,
+						 std::valarray<DlFloat64>* vv, EqSolveProgress* progress);
+template <class T>
+static void backSubMulti(DlInt32 neq, const std::valarray<T>& aa, const std::valarray<DlInt32>& maxaa,
+						 std::valarray<DlFloat64>* vv, DlInt32 nrhs, EqSolveProgress* progress);
+template <class T>
+static void reduceColumn(DlOneBasedIter<T>& a, DlOneBasedConstIter<DlInt32>& maxa,
+						 DlInt32 n, DlInt32 kFirst, DlInt32 kLast);
+template <class T>
+static void finishColumn(DlOneBasedIter<T>& a, DlOneBasedConstIter<DlInt32>& maxa,
+						 DlInt32 n, bool posDef);
+template <class T, class Pivot>
+static void finishTerms(T* col, DlInt32 h, DlInt32 n, bool posDef, Pivot pivot);
+
 /* ----------------------------------------------------------------------------
  * Colsol	-	Column skyline solver. Performs LU decomposition and back
  *				substitution for a matrix arranged in skyline form.
@@ -83,69 +113,385 @@ void colsolDecomp(DlInt32 neq,
 			bool posDef,
 			EqSolveProgress* progress)
 {
-	DlOneBasedIter<DlFloat64>		a(aa);
+	colsolDecompFrom(neq, aa, maxaa, 1, posDef, progress);
+}
+
+/* ----------------------------------------------------------------------------
+ * colsolDecompFrom	-	Column skyline solver. Completes the LU decomposition
+ *						of a matrix whose columns before firstColumn are
+ *						already decomposed.
+ *
+ *	Each column of the factor depends only on the same column of the matrix
+ *	and the columns of the factor to its left, so when only columns from
+ *	firstColumn on have changed the columns before it need not be redone.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * aa			<->	the matrix
+ * maxaa		->	the diagonal element index list
+ * firstColumn	->	the first column to decompose
+ * posDef		->	true if the matrix is known to be positive-definite
+ * progress		->	the progress reporter object
+ * ----------------------------------------------------------------------------
+ */
+void colsolDecompFrom(DlInt32 neq,
+			std::valarray<DlFloat64>& aa,
+			const std::valarray<DlInt32>& maxaa,
+			DlInt32 firstColumn,
+			bool posDef,
+			EqSolveProgress* progress)
+{
+	decompFrom(neq, aa, maxaa, firstColumn, posDef, progress);
+}
+
+/* ----------------------------------------------------------------------------
+ * decompFrom	-	colsolDecompFrom for a matrix of any precision.
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+decompFrom(DlInt32 neq,
+			std::valarray<T>& aa,
+			const std::valarray<DlInt32>& maxaa,
+			DlInt32 firstColumn,
+			bool posDef,
+			EqSolveProgress* progress)
+{
+	DlOneBasedIter<T>				a(aa);
 	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
 			
 	/*	Loop over columns */
 
-	for (auto n = 1; n <= neq; n++) {
+	for (auto n = std::max(firstColumn, 1); n <= neq; n++) {
 		if (progress && !progress->Processing(n, neq))
 			throw EqSolveFailure(EqSolveFailure::UserCancelled, n);
-		/*	Get max and min column elements (kh is num elems) */
 		
-		auto kn = maxa[n];
-		auto kl = kn + 1;
-		auto ku = maxa[n+1] - 1;
-		auto kh = ku - kl;
-		
-		/*	Check for elements */
-		
-		if (kh >= 0) {
-			if (kh > 0) {
-				auto k = n - kh;
-				auto ic = 0;
-				auto klt = ku;
-				
-				for (auto j = 1; j <= kh; j++, k++) {
-					ic = ic + 1;
-					klt = klt - 1;
-					auto ki = maxa[k];
-					auto nd = maxa[k+1] - ki - 1;
-					if (nd > 0) {
-						auto kk = ((ic < nd) ? ic : nd);
-						auto c = 0.0;
-						
-						for (auto l = 1; l <= kk; l++)
-							c += a[ki+l] * a[klt+l];
-						
-						a[klt] -= c;
-					}
-				}
-			}
+		/*	Reduce the column against the columns to its left (kh is num elems) */
+		
+		auto kh = maxa[n+1] - maxa[n] - 2;
+		if (kh > 0)
+			reduceColumn(a, maxa, n, n - kh, n - 1);
+		
+		finishColumn(a, maxa, n, posDef);
+		if (progress)
+			progress->Pivot(n, a[maxa[n]]);
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * colsolDecompParallel	-	Column skyline solver. Performs LU decomposition
+ *							for a matrix arranged in skyline form using the
+ *							threads in pool.
+ *
+ *	The columns are processed in panels. The rows of a panel column above the
+ *	panel depend only on columns that are already factored, so each panel
+ *	column is reduced against them in parallel. The rows within the panel
+ *	are then finished in order on the calling thread. Each term is computed
+ *	with the same operations as colsolDecomp, so the results are identical.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * aa			<->	the matrix
+ * maxaa		->	the diagonal element index list
+ * pool			->	the threads to use
+ * posDef		->	true if the matrix is known to be positive-definite
+ * progress		->	the progress reporter object
+ * panelWidth	->	the number of columns per panel, or zero for default
+ * firstColumn	->	the first column to decompose, as for colsolDecompFrom
+ * ----------------------------------------------------------------------------
+ */
+void colsolDecompParallel(DlInt32 neq,
+			std::valarray<DlFloat64>& aa,
+			const std::valarray<DlInt32>& maxaa,
+			DlThreadPool& pool,
+			bool posDef,
+			EqSolveProgress* progress,
+			DlInt32 panelWidth,
+			DlInt32 firstColumn)
+{
+	decompParallel(neq, aa, maxaa, pool, posDef, progress, panelWidth, firstColumn);
+}
+
+/* ----------------------------------------------------------------------------
+ * decompParallel	-	colsolDecompParallel for a matrix of any precision.
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+decompParallel(DlInt32 neq,
+			std::valarray<T>& aa,
+			const std::valarray<DlInt32>& maxaa,
+			DlThreadPool& pool,
+			bool posDef,
+			EqSolveProgress* progress,
+			DlInt32 panelWidth,
+			DlInt32 firstColumn)
+{
+	if (pool.GetThreadCount() <= 1) {
+		decompFrom(neq, aa, maxaa, firstColumn, posDef, progress);
+		return;
+	}
+
+	DlOneBasedIter<T>				a(aa);
+	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
+	
+	if (panelWidth <= 0)
+		panelWidth = std::max<DlInt32>(16, 4 * pool.GetThreadCount());
+	
+	/*	Loop over panels */
+	
+	for (DlInt32 first = std::max(firstColumn, 1); first <= neq; first += panelWidth) {
+		DlInt32 last = std::min(first + panelWidth - 1, neq);
+		
+		/*	Reduce each column for the rows above the panel */
+		
+		pool.ParallelFor(first, last + 1, [&a, &maxa, first](DlInt32 n) {
+			DlInt32 top = n - (maxa[n+1] - maxa[n] - 2);
+			if (top < first)
+				reduceColumn(a, maxa, n, top, first - 1);
+		});
+		
+		/*	Then the rows within the panel, in order */
+		
+		for (DlInt32 n = first; n <= last; n++) {
+			if (progress && !progress->Processing(n, neq))
+				throw EqSolveFailure(EqSolveFailure::UserCancelled, n);
 			
-			auto k = n;
-			auto b = 0.0;
+			DlInt32 top = n - (maxa[n+1] - maxa[n] - 2);
+			if (n > first)
+				reduceColumn(a, maxa, n, std::max(top, first), n - 1);
+			
+			finishColumn(a, maxa, n, posDef);
+			if (progress)
+				progress->Pivot(n, a[maxa[n]]);
+		}
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * colsolBackSubMulti	-	Column skyline solver. Performs LU back substitution
+ *							for a block of rhs vectors in one pass over the
+ *							decomposed matrix in aa.
+ *
+ *	The vectors are interleaved while solving, so that the inner loops run
+ *	over the rhs vectors in contiguous memory. The results for each vector
+ *	are identical to colsolBackSub.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * aa			->	the matrix
+ * maxaa		->	the diagonal element index list
+ * vv			<->	the rhs vectors, column-major (neq by nrhs)
+ * nrhs			->	the number of rhs vectors
+ * progress		->	the progress reporter object
+ * ----------------------------------------------------------------------------
+ */
+void
+colsolBackSubMulti(DlInt32 neq,
+			  const std::valarray<DlFloat64>& aa,
+			  const std::valarray<DlInt32>& maxaa,
+			  std::valarray<DlFloat64>* vv,
+			  DlInt32 nrhs,
+			  EqSolveProgress* progress)
+{
+	backSubMulti(neq, aa, maxaa, vv, nrhs, progress);
+}
+
+/* ----------------------------------------------------------------------------
+ * backSubMulti	-	colsolBackSubMulti for a factor of any precision. The
+ *					vectors are always double precision.
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+backSubMulti(DlInt32 neq,
+			  const std::valarray<T>& aa,
+			  const std::valarray<DlInt32>& maxaa,
+			  std::valarray<DlFloat64>* vv,
+			  DlInt32 nrhs,
+			  EqSolveProgress* progress)
+{
+	if (nrhs <= 0)
+		return;
+	
+	if (nrhs == 1) {
+		backSub(neq, aa, maxaa, vv, progress);
+		return;
+	}
+	
+	DlOneBasedConstIter<T>			a(aa);
+	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
+	
+	/*	interleave the vectors. Row n of w holds equation n for each rhs */
+	std::valarray<DlFloat64> w(neq * nrhs);
+	for (DlInt32 r = 0; r < nrhs; r++)
+		for (DlInt32 i = 0; i < neq; i++)
+			w[i * nrhs + r] = (*vv)[r * neq + i];
+	
+	std::valarray<DlFloat64> c(nrhs);
+	auto row = [&w, nrhs](DlInt32 n) { return &w[(n - 1) * nrhs]; };
+	
+	/*	Reduce rhs vectors */
+	
+	for (auto n = 1; n <= neq; n++) {
+		if (progress && !progress->Processing(n, neq))
+			throw EqSolveFailure(EqSolveFailure::UserCancelled, n);
+		DlInt32 kl = maxa[n] + 1;
+		DlInt32 ku = maxa[n+1] - 1;
+		
+		if (ku >= kl) {
+			DlInt32 k = n;
+			c = 0.0;
 			
 			for (auto kk = kl; kk <= ku; kk++) {
-				auto ki = maxa[--k];
-				auto c = a[kk] / a[ki];
-				b += c * a[kk];
-				a[kk] = c;
+				const DlFloat64 akk = a[kk];
+				const DlFloat64* vk = row(--k);
+				for (DlInt32 r = 0; r < nrhs; r++)
+					c[r] += akk * vk[r];
 			}
-			a[kn] -= b;
+			
+			DlFloat64* vn = row(n);
+			for (DlInt32 r = 0; r < nrhs; r++)
+				vn[r] -= c[r];
 		}
+	}
+	
+	/*	back substitute */
+	
+	for (auto n = 1; n <= neq; n++) {
+		const DlFloat64 d = a[maxa[n]];
+		DlFloat64* vn = row(n);
+		for (DlInt32 r = 0; r < nrhs; r++)
+			vn[r] /= d;
+	}
+	
+	if (neq > 1) {
+		auto n = neq;
 		
-		if (posDef) {
-			if (a[kn] < 1.0e-10)
-				throw EqSolveFailure(EqSolveFailure::Singular, n);
-		} else {
-			if (fabs(a[kn]) < 1.0e-10)
-				throw EqSolveFailure(
-									 a[kn] < 0 ? EqSolveFailure::NonPositiveDefinite :
-									 EqSolveFailure::Singular, n
-									 );
+		for (auto l = 2; l <= neq; l++, n--) {
+			auto kl = maxa[n] + 1;
+			auto ku = maxa[n+1] - 1;
+			const DlFloat64* vn = row(n);
+			if (ku >= kl)
+				for (auto k = n, kk = kl; kk <= ku; kk++) {
+					const DlFloat64 akk = a[kk];
+					DlFloat64* vk = row(--k);
+					for (DlInt32 r = 0; r < nrhs; r++)
+						vk[r] -= akk * vn[r];
+				}
 		}
 	}
+	
+	/*	and put the results back */
+	for (DlInt32 r = 0; r < nrhs; r++)
+		for (DlInt32 i = 0; i < neq; i++)
+			(*vv)[r * neq + i] = w[i * nrhs + r];
+}
+
+/* ----------------------------------------------------------------------------
+ * reduceColumn	-	subtract the contributions of the factored columns from
+ *					the terms of column n in rows kFirst through kLast. The
+ *					rows of column n above kFirst must already be reduced.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * a			<->	the matrix
+ * maxa			->	the diagonal element index list
+ * n			->	the column
+ * kFirst		->	the first row to reduce
+ * kLast		->	the last row to reduce
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+reduceColumn(DlOneBasedIter<T>& a, DlOneBasedConstIter<DlInt32>& maxa,
+			 DlInt32 n, DlInt32 kFirst, DlInt32 kLast)
+{
+	auto kh = maxa[n+1] - maxa[n] - 2;
+	auto ic = kFirst - (n - kh);
+	auto klt = maxa[n] + n - kFirst + 1;
+	
+	for (auto k = kFirst; k <= kLast; k++) {
+		ic = ic + 1;
+		klt = klt - 1;
+		auto ki = maxa[k];
+		auto nd = maxa[k+1] - ki - 1;
+		if (nd > 0) {
+			auto kk = ((ic < nd) ? ic : nd);
+			auto c = 0.0;
+			
+			for (auto l = 1; l <= kk; l++)
+				c += a[ki+l] * a[klt+l];
+			
+			a[klt] -= c;
+		}
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * finishColumn	-	scale the reduced terms of column n by the diagonals and
+ *					update the diagonal term. Throws EqSolveFailure if the
+ *					diagonal is too small.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * a			<->	the matrix
+ * maxa			->	the diagonal element index list
+ * n			->	the column
+ * posDef		->	true if the matrix is known to be positive-definite
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+finishColumn(DlOneBasedIter<T>& a, DlOneBasedConstIter<DlInt32>& maxa,
+			 DlInt32 n, bool posDef)
+{
+	finishTerms(&a[maxa[n]], maxa[n+1] - maxa[n] - 1, n, posDef,
+				[&a, &maxa](DlInt32 k) { return a[maxa[k]]; });
+}
+
+/* ----------------------------------------------------------------------------
+ * finishTerms	-	the work of finishColumn on the terms of one column,
+ *					wherever they are held. col[0] is the diagonal and
+ *					col[l] is the term in row n - l.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * col			<->	the terms of the column
+ * h			->	the number of terms above the diagonal
+ * n			->	the column
+ * posDef		->	true if the matrix is known to be positive-definite
+ * pivot		->	pivot(k) is the factored diagonal of column k
+ * ----------------------------------------------------------------------------
+ */
+template <class T, class Pivot>
+static void
+finishTerms(T* col, DlInt32 h, DlInt32 n, bool posDef, Pivot pivot)
+{
+	if (h > 0) {
+		auto b = 0.0;
+		
+		for (auto l = 1; l <= h; l++) {
+			auto c = col[l] / pivot(n - l);
+			b += c * col[l];
+			col[l] = c;
+		}
+		col[0] -= b;
+	}
+	
+	if (posDef) {
+		if (col[0] < 1.0e-10)
+			throw EqSolveFailure(EqSolveFailure::Singular, n);
+	} else {
+		if (fabs(col[0]) < 1.0e-10)
+			throw EqSolveFailure(
+								 col[0] < 0 ? EqSolveFailure::NonPositiveDefinite :
+								 EqSolveFailure::Singular, n
+								 );
+	}
 }
 
 /* ----------------------------------------------------------------------------
@@ -167,10 +513,26 @@ colsolBackSub(DlInt32 neq,
 			  const std::valarray<DlInt32>& maxaa,
 			  std::valarray<DlFloat64>* vv,
 			  EqSolveProgress* progress)
+{
+	backSub(neq, aa, maxaa, vv, progress);
+}
+
+/* ----------------------------------------------------------------------------
+ * backSub	-	colsolBackSub for a factor of any precision. The vector is
+ *				always double precision.
+ * ----------------------------------------------------------------------------
+ */
+template <class T>
+static void
+backSub(DlInt32 neq,
+			  const std::valarray<T>& aa,
+			  const std::valarray<DlInt32>& maxaa,
+			  std::valarray<DlFloat64>* vv,
+			  EqSolveProgress* progress)
 {
 	/*	Reduce rhs vector */
 	DlOneBasedIter<DlFloat64>		v(*vv);
-	DlOneBasedConstIter<DlFloat64>	a(aa);
+	DlOneBasedConstIter<T>			a(aa);
 	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
 
 	for (auto n = 1; n <= neq; n++) {
@@ -208,3 +570,466 @@ colsolBackSub(DlInt32 neq,
 	}
 
 }
+
+/* ----------------------------------------------------------------------------
+ * colsolOperations	-	Estimate the floating point operations to factor a
+ *						skyline and to back substitute one vector. Each
+ *						column is counted as if the columns to its left
+ *						reach as high as it does, so the factor count is
+ *						an upper bound.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * maxaa		->	the diagonal element index list
+ * factorOps	<-	the operations to factor the matrix
+ * solveOps		<-	the operations to back substitute one vector
+ * ----------------------------------------------------------------------------
+ */
+void
+colsolOperations(DlInt32 neq,
+			const std::valarray<DlInt32>& maxaa,
+			DlFloat64& factorOps,
+			DlFloat64& solveOps)
+{
+	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
+	
+	factorOps = 0;
+	solveOps = 0;
+	
+	for (DlInt32 n = 1; n <= neq; n++) {
+		DlFloat64 h = maxa[n+1] - maxa[n] - 1;
+		
+		/*	a multiply and add for each term of the reduction, then a
+			divide, multiply and add for each term of the column */
+		
+		factorOps += h * h + 3 * h;
+		
+		/*	the forward and back passes, and the divide by the diagonal */
+		
+		solveOps += 4 * h + 1;
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * lastColumnFitting	-	the last column of a run starting at first whose
+ *							terms number no more than limit, stopping at
+ *							lastColumn. The run has at least one column.
+ * ----------------------------------------------------------------------------
+ */
+static DlInt32
+lastColumnFitting(DlOneBasedConstIter<DlInt32>& maxa, DlInt32 first, DlInt32 lastColumn,
+				  DlInt64 limit)
+{
+	DlInt32 last = first;
+	while (last < lastColumn && maxa[last+2] - maxa[first] <= limit)
+		last++;
+	return last;
+}
+
+/* ----------------------------------------------------------------------------
+ * colsolDecompFile	-	Column skyline solver. Performs LU decomposition
+ *						for a matrix arranged in skyline form and held in
+ *						a file.
+ *
+ *	Each term is reduced and scaled with the same operations, in the same
+ *	order, as colsolDecomp. The diagonal of every factored column is kept
+ *	in memory for scaling the columns to its right.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * a			<->	the matrix
+ * maxaa		->	the diagonal element index list
+ * memory		->	the bytes of the matrix to hold in memory
+ * posDef		->	true if the matrix is known to be positive-definite
+ * progress		->	the progress reporter object
+ * ----------------------------------------------------------------------------
+ */
+void colsolDecompFile(DlInt32 neq,
+			SkylineFile& a,
+			const std::valarray<DlInt32>& maxaa,
+			DlInt64 memory,
+			bool posDef,
+			EqSolveProgress* progress)
+{
+	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
+	
+	const DlInt64 limit = std::max<DlInt64>(memory / 2 / sizeof(DlFloat64), 1);
+	
+	std::vector<DlFloat64> diag(neq + 1);
+	std::vector<DlFloat64> panel;
+	std::vector<DlFloat64> block;
+	
+	auto height = [&maxa](DlInt32 n) { return maxa[n+1] - maxa[n] - 1; };
+	
+	/*	column k of a run read from the file starting at term base */
+	auto column = [&maxa](std::vector<DlFloat64>& run, DlInt64 base, DlInt32 k) {
+		return &run[maxa[k] - 1 - base];
+	};
+	
+	/*	reduce the term in row k of column n, whose top row is tn */
+	auto reduce = [&height](const DlFloat64* colK, DlFloat64* colN, DlInt32 n, DlInt32 k,
+						   DlInt32 tn) {
+		auto kk = std::min(k - tn, height(k));
+		auto c = 0.0;
+		for (auto l = 1; l <= kk; l++)
+			c += colK[l] * colN[n-k+l];
+		colN[n-k] -= c;
+	};
+	
+	for (DlInt32 first = 1, last; first <= neq; first = last + 1) {
+		last = lastColumnFitting(maxa, first, neq, limit);
+		
+		DlInt64 base = maxa[first] - 1;
+		panel.resize(maxa[last+1] - maxa[first]);
+		a.read(base, panel.size(), panel.data());
+		
+		DlInt32 top = first;
+		for (DlInt32 n = first; n <= last; n++)
+			top = std::min(top, n - height(n));
+		
+		/*	Reduce the panel against blocks of the factored columns */
+		
+		for (DlInt32 bf = top, bl; bf < first; bf = bl + 1) {
+			bl = lastColumnFitting(maxa, bf, first - 1, limit);
+			
+			DlInt64 blockBase = maxa[bf] - 1;
+			block.resize(maxa[bl+1] - maxa[bf]);
+			a.read(blockBase, block.size(), block.data());
+			
+			for (DlInt32 n = first; n <= last; n++) {
+				DlInt32 tn = n - height(n);
+				DlFloat64* colN = column(panel, base, n);
+				for (DlInt32 k = std::max(tn + 1, bf); k <= bl; k++)
+					reduce(column(block, blockBase, k), colN, n, k, tn);
+			}
+		}
+		
+		/*	Then the rows within the panel, in order */
+		
+		for (DlInt32 n = first; n <= last; n++) {
+			if (progress && !progress->Processing(n, neq))
+				throw EqSolveFailure(EqSolveFailure::UserCancelled, n);
+			
+			DlInt32 tn = n - height(n);
+			DlFloat64* colN = column(panel, base, n);
+			for (DlInt32 k = std::max(tn + 1, first); k < n; k++)
+				reduce(column(panel, base, k), colN, n, k, tn);
+			
+			finishTerms(colN, height(n), n, posDef,
+						[&diag](DlInt32 k) { return diag[k]; });
+			
+			diag[n] = colN[0];
+			if (progress)
+				progress->Pivot(n, diag[n]);
+		}
+		
+		a.write(base, panel.size(), panel.data());
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * colsolBackSubFile	-	Column skyline solver. Performs LU back
+ *							substitution for a block of rhs vectors with the
+ *							decomposed matrix in a file.
+ *
+ *	The factor is read in order for the reduction, which also collects the
+ *	diagonals, then in reverse order of blocks for the back substitution.
+ *	Each vector gets the same results as colsolBackSub.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * a			->	the matrix
+ * maxaa		->	the diagonal element index list
+ * vv			<->	the rhs vectors, column-major (neq by nrhs)
+ * nrhs			->	the number of rhs vectors
+ * memory		->	the bytes of the matrix to hold in memory
+ * progress		->	the progress reporter object
+ * ----------------------------------------------------------------------------
+ */
+void
+colsolBackSubFile(DlInt32 neq,
+			  const SkylineFile& a,
+			  const std::valarray<DlInt32>& maxaa,
+			  std::valarray<DlFloat64>* vv,
+			  DlInt32 nrhs,
+			  DlInt64 memory,
+			  EqSolveProgress* progress)
+{
+	DlOneBasedConstIter<DlInt32>	maxa(maxaa);
+	
+	const DlInt64 limit = std::max<DlInt64>(memory / sizeof(DlFloat64), 1);
+	
+	std::vector<DlFloat64> diag(neq + 1);
+	std::vector<DlFloat64> block;
+	
+	auto height = [&maxa](DlInt32 n) { return maxa[n+1] - maxa[n] - 1; };
+	auto v = [vv, neq](DlInt32 r, DlInt32 n) -> DlFloat64& { return (*vv)[r * neq + n - 1]; };
+	
+	/*	Reduce rhs vectors */
+	
+	for (DlInt32 first = 1, last; first <= neq; first = last + 1) {
+		last = lastColumnFitting(maxa, first, neq, limit);
+		
+		DlInt64 base = maxa[first] - 1;
+		block.resize(maxa[last+1] - maxa[first]);
+		a.read(base, block.size(), block.data());
+		
+		for (DlInt32 n = first; n <= last; n++) {
+			if (progress && !progress->Processing(n, neq))
+				throw EqSolveFailure(EqSolveFailure::UserCancelled, n);
+			
+			const DlFloat64* colN = &block[maxa[n] - 1 - base];
+			diag[n] = colN[0];
+			
+			auto h = height(n);
+			if (h > 0) {
+				for (DlInt32 r = 0; r < nrhs; r++) {
+					DlInt32 k = n;
+					DlFloat64 c = 0.0;
+					for (auto l = 1; l <= h; l++)
+						c += colN[l] * v(r, --k);
+					v(r, n) -= c;
+				}
+			}
+		}
+	}
+	
+	/*	back substitute */
+	
+	for (DlInt32 r = 0; r < nrhs; r++)
+		for (DlInt32 n = 1; n <= neq; n++)
+			v(r, n) /= diag[n];
+	
+	for (DlInt32 last = neq, first; last >= 1; last = first - 1) {
+		first = last;
+		while (first > 1 && maxa[last+1] - maxa[first-1] <= limit)
+			first--;
+		
+		DlInt64 base = maxa[first] - 1;
+		block.resize(maxa[last+1] - maxa[first]);
+		a.read(base, block.size(), block.data());
+		
+		for (DlInt32 n = last; n >= first; n--) {
+			const DlFloat64* colN = &block[maxa[n] - 1 - base];
+			auto h = height(n);
+			for (DlInt32 r = 0; r < nrhs; r++) {
+				const DlFloat64 vn = v(r, n);
+				for (auto l = 1, k = n; l <= h; l++)
+					v(r, --k) -= colN[l] * vn;
+			}
+		}
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * ColsolMixed::ColsolMixed	-	take the assembled matrix.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * neq			->	the number of equations
+ * aa			<->	the matrix, left empty
+ * maxaa		->	the diagonal element index list
+ * ----------------------------------------------------------------------------
+ */
+ColsolMixed::ColsolMixed(DlInt32 neq, std::valarray<DlFloat64>& aa,
+						 const std::valarray<DlInt32>& maxaa)
+	: itsNeq(neq)
+	, itsMaxa(maxaa)
+	, itsNorm(0)
+	, itsTolerance(std::sqrt(static_cast<DlFloat64>(std::max(neq, 1))) * DBL_EPSILON)
+	, itsMaxIterations(30)
+	, itsIterations(0)
+	, itsPositiveDefinite(true)
+{
+	itsMatrix.swap(aa);
+}
+
+/* ----------------------------------------------------------------------------
+ * ColsolMixed::factor	-	factor a single precision copy of the matrix, or
+ *							the matrix itself if that fails.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * posDef		->	true if the matrix is known to be positive-definite
+ * progress		->	the progress reporter object
+ * pool			->	the threads to use, or null
+ * ----------------------------------------------------------------------------
+ */
+void
+ColsolMixed::factor(bool posDef, EqSolveProgress* progress, DlThreadPool* pool)
+{
+	DlOneBasedConstIter<DlFloat64>	a(itsMatrix);
+	DlOneBasedConstIter<DlInt32>	maxa(itsMaxa);
+	
+	itsPositiveDefinite = posDef;
+	itsDouble.resize(0);
+	
+	/*	the largest row sum of the symmetric matrix */
+	
+	std::valarray<DlFloat64> rowSum(0.0, itsNeq);
+	for (auto n = 1; n <= itsNeq; n++) {
+		auto kn = maxa[n];
+		rowSum[n-1] += std::fabs(a[kn]);
+		for (auto kk = kn + 1, k = n - 1; kk < maxa[n+1]; kk++, k--) {
+			rowSum[n-1] += std::fabs(a[kk]);
+			rowSum[k-1] += std::fabs(a[kk]);
+		}
+	}
+	itsNorm = itsNeq > 0 ? rowSum.max() : 0.0;
+	
+	itsFactor.resize(itsMatrix.size());
+	for (size_t i = 0; i < itsMatrix.size(); i++)
+		itsFactor[i] = static_cast<DlFloat32>(itsMatrix[i]);
+	
+	try {
+		if (pool)
+			decompParallel(itsNeq, itsFactor, itsMaxa, *pool, posDef, progress, 0, 1);
+		else
+			decompFrom(itsNeq, itsFactor, itsMaxa, 1, posDef, progress);
+	} catch (EqSolveFailure& failure) {
+		if (failure.getReason() == EqSolveFailure::UserCancelled)
+			throw;
+		
+		/*	a pivot lost to rounding in single precision may be fine in double */
+		factorDouble(progress, pool);
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * ColsolMixed::solve	-	solve for each vector with the single precision
+ *							factor and refine the solutions. Each step
+ *							solves for the correction from the residual of
+ *							the vectors that have not yet met the tolerance.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * vv			<->	the rhs vectors, column-major (neq by nrhs)
+ * nrhs			->	the number of rhs vectors
+ * progress		->	the progress reporter object
+ * pool			->	the threads to use for a double precision factor, or null
+ * ----------------------------------------------------------------------------
+ */
+void
+ColsolMixed::solve(std::valarray<DlFloat64>* vv, DlInt32 nrhs, EqSolveProgress* progress,
+				   DlThreadPool* pool)
+{
+	itsIterations = 0;
+	if (nrhs <= 0)
+		return;
+	
+	if (isDouble()) {
+		backSubMulti(itsNeq, itsDouble, itsMaxa, vv, nrhs, progress);
+		return;
+	}
+	
+	const std::valarray<DlFloat64> b(*vv);
+	std::valarray<DlFloat64> r(itsNeq * nrhs);
+	std::vector<DlFloat64> last(nrhs, std::numeric_limits<DlFloat64>::infinity());
+	
+	backSubMulti(itsNeq, itsFactor, itsMaxa, vv, nrhs, progress);
+	
+	for (DlInt32 step = 0; ; step++) {
+		bool converged = true;
+		bool stalled = false;
+		
+		for (DlInt32 c = 0; c < nrhs; c++) {
+			const DlFloat64* x = &(*vv)[c * itsNeq];
+			DlFloat64* rc = &r[c * itsNeq];
+			residual(&b[c * itsNeq], x, rc);
+			
+			DlFloat64 rNorm = 0;
+			DlFloat64 xNorm = 0;
+			for (DlInt32 i = 0; i < itsNeq; i++) {
+				rNorm = std::max(rNorm, std::fabs(rc[i]));
+				xNorm = std::max(xNorm, std::fabs(x[i]));
+			}
+			
+			if (rNorm <= itsTolerance * itsNorm * xNorm) {
+				std::fill(rc, rc + itsNeq, 0.0);
+				continue;
+			}
+			
+			/*	written so a residual that is not a number stalls too */
+			converged = false;
+			if (!(rNorm < 0.5 * last[c]))
+				stalled = true;
+			last[c] = rNorm;
+		}
+		
+		if (converged) {
+			itsIterations = step;
+			return;
+		}
+		
+		if (stalled || step == itsMaxIterations) {
+			itsIterations = step;
+			factorDouble(progress, pool);
+			*vv = b;
+			backSubMulti(itsNeq, itsDouble, itsMaxa, vv, nrhs, progress);
+			return;
+		}
+		
+		backSubMulti(itsNeq, itsFactor, itsMaxa, &r, nrhs, static_cast<EqSolveProgress*>(0));
+		*vv += r;
+	}
+}
+
+/* ----------------------------------------------------------------------------
+ * ColsolMixed::factorDouble	-	factor the matrix in double precision and
+ *									release the single precision factor.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * progress		->	the progress reporter object
+ * pool			->	the threads to use, or null
+ * ----------------------------------------------------------------------------
+ */
+void
+ColsolMixed::factorDouble(EqSolveProgress* progress, DlThreadPool* pool)
+{
+	itsFactor.resize(0);
+	itsDouble.resize(itsMatrix.size());
+	itsDouble = itsMatrix;
+	
+	if (pool)
+		decompParallel(itsNeq, itsDouble, itsMaxa, *pool, itsPositiveDefinite, progress, 0, 1);
+	else
+		decompFrom(itsNeq, itsDouble, itsMaxa, 1, itsPositiveDefinite, progress);
+}
+
+/* ----------------------------------------------------------------------------
+ * ColsolMixed::residual	-	compute r = b - Ax with the symmetric skyline
+ *								matrix in double precision.
+ *
+ * (-> input param, <- output param, <-> i/o param)
+ *
+ * b			->	the rhs vector
+ * x			->	the solution
+ * r			<-	the residual
+ * ----------------------------------------------------------------------------
+ */
+void
+ColsolMixed::residual(const DlFloat64* b, const DlFloat64* x, DlFloat64* r) const
+{
+	DlOneBasedConstIter<DlFloat64>	a(itsMatrix);
+	DlOneBasedConstIter<DlInt32>	maxa(itsMaxa);
+	
+	std::copy(b, b + itsNeq, r);
+	
+	for (auto n = 1; n <= itsNeq; n++) {
+		auto kn = maxa[n];
+		DlFloat64 xn = x[n-1];
+		DlFloat64 c = a[kn] * xn;
+		
+		/*	the terms above the diagonal of column n are rows n-1, n-2, ... */
+		for (auto kk = kn + 1, k = n - 1; kk < maxa[n+1]; kk++, k--) {
+			c += a[kk] * x[k-1];
+			r[k-1] -= a[kk] * xn;
+		}
+		
+		r[n-1] -= c;
+	}
+}
@@ -38,6 +38,9 @@
 #include "matrix.h"
 #include "DlArray.h"
 
+class DlThreadPool;
+class SkylineFile;
+
 void
 colsol(bool decompose, DlInt32 neq, 
 		std::valarray<DlFloat64>& a,
@@ -53,6 +56,28 @@ colsolDecomp(DlInt32 neq,
 	   bool positiveDefinite = true,
 	   EqSolveProgress* progress = 0);
 
+//	same as colsolDecomp, but columns before firstColumn already hold the
+//	factor. Columns from firstColumn on must hold the assembled matrix.
+void
+colsolDecompFrom(DlInt32 neq,
+	   std::valarray<DlFloat64>& a,
+	   const std::valarray<DlInt32>& maxa,
+	   DlInt32 firstColumn,
+	   bool positiveDefinite = true,
+	   EqSolveProgress* progress = 0);
+
+//	same as colsolDecompFrom, but the updates for each panel of panelWidth columns
+//	are spread across pool. panelWidth of zero picks a width from the pool size.
+void
+colsolDecompParallel(DlInt32 neq,
+	   std::valarray<DlFloat64>& a,
+	   const std::valarray<DlInt32>& maxa,
+	   DlThreadPool& pool,
+	   bool positiveDefinite = true,
+	   EqSolveProgress* progress = 0,
+	   DlInt32 panelWidth = 0,
+	   DlInt32 firstColumn = 1);
+
 void
 colsolBackSub(DlInt32 neq,
 	  const std::valarray<DlFloat64>& a,
@@ -60,4 +85,93 @@ colsolBackSub(DlInt32 neq,
 	  std::valarray<DlFloat64>* v,
 	  EqSolveProgress* progress = 0);
 
+//	back substitute nrhs vectors at once. v holds the vectors column-major,
+//	so vector r is v[r * neq] through v[r * neq + neq - 1].
+void
+colsolBackSubMulti(DlInt32 neq,
+	  const std::valarray<DlFloat64>& a,
+	  const std::valarray<DlInt32>& maxa,
+	  std::valarray<DlFloat64>* v,
+	  DlInt32 nrhs,
+	  EqSolveProgress* progress = 0);
+
+//	same as colsolDecomp for a matrix held in file, keeping about memory bytes
+//	of it in memory. The columns are factored in panels that fill half of
+//	that; each panel is reduced against the columns to its left, read in
+//	order in blocks that fill the other half, and written back. The results
+//	are identical to colsolDecomp.
+void
+colsolDecompFile(DlInt32 neq,
+	   SkylineFile& a,
+	   const std::valarray<DlInt32>& maxa,
+	   DlInt64 memory,
+	   bool positiveDefinite = true,
+	   EqSolveProgress* progress = 0);
+
+//	same as colsolBackSubMulti for a factor held in file, read forward and then
+//	backward in blocks of about memory bytes.
+void
+colsolBackSubFile(DlInt32 neq,
+	  const SkylineFile& a,
+	  const std::valarray<DlInt32>& maxa,
+	  std::valarray<DlFloat64>* v,
+	  DlInt32 nrhs,
+	  DlInt64 memory,
+	  EqSolveProgress* progress = 0);
+
+//	estimate the floating point operations to factor the skyline given by maxa,
+//	and to back substitute one vector with the factor.
+void
+colsolOperations(DlInt32 neq,
+	  const std::valarray<DlInt32>& maxa,
+	  DlFloat64& factorOps,
+	  DlFloat64& solveOps);
+
+//	Skyline solver that factors a single precision copy of the matrix, so the
+//	factor and each back substitution move half the memory, then refines each
+//	solution against the double precision matrix until
+//	|b - Ax| <= tolerance * |A| |x| in the infinity norm. If the single
+//	precision factor fails, or a refinement step does not halve the residual,
+//	the matrix is factored in double precision and used from then on.
+class ColsolMixed
+{
+public:
+	//	takes the values of the assembled matrix a, leaving it empty.
+	ColsolMixed(DlInt32 neq, std::valarray<DlFloat64>& a,
+				const std::valarray<DlInt32>& maxa);
+
+	//	the default is sqrt(neq) times the double precision epsilon.
+	void	setTolerance(DlFloat64 tolerance)	{ itsTolerance = tolerance; }
+	void	setMaxIterations(DlInt32 count)		{ itsMaxIterations = count; }
+
+	void	factor(bool positiveDefinite = true, EqSolveProgress* progress = 0,
+				   DlThreadPool* pool = 0);
+
+	//	solve for nrhs vectors held column-major in v (neq by nrhs). pool is
+	//	used if the matrix must be factored again in double precision.
+	void	solve(std::valarray<DlFloat64>* v, DlInt32 nrhs = 1,
+				  EqSolveProgress* progress = 0, DlThreadPool* pool = 0);
+
+	//	true once the solver has fallen back to a double precision factor.
+	bool	isDouble() const { return itsDouble.size() > 0; }
+
+	//	the most refinement steps any vector took in the last solve.
+	DlInt32	iterations() const { return itsIterations; }
+
+private:
+	void	factorDouble(EqSolveProgress* progress, DlThreadPool* pool);
+	void	residual(const DlFloat64* b, const DlFloat64* x, DlFloat64* r) const;
+
+	DlInt32						itsNeq;
+	std::valarray<DlFloat64>	itsMatrix;		//	assembled matrix
+	std::valarray<DlInt32>		itsMaxa;
+	std::valarray<DlFloat32>	itsFactor;		//	single precision factor
+	std::valarray<DlFloat64>	itsDouble;		//	double factor, after a fall back
+	DlFloat64					itsNorm;		//	infinity norm of the matrix
+	DlFloat64					itsTolerance;
+	DlInt32						itsMaxIterations;
+	DlInt32						itsIterations;
+	bool						itsPositiveDefinite;
+};
+
 #endif
@@ -51,6 +51,12 @@ public:
 	virtual bool SetStage(Stage stage) = 0;
 	//	return false to cancel analysis
 	virtual bool Processing(DlInt32 i, DlInt32 n) = 0;
+	//	called by iterative solvers after each iteration with the relative
+	//	residual. return false to cancel analysis
+	virtual bool Iteration(DlInt32 i, DlInt32 maxIter, DlFloat64 residual);
+	//	called by the factorizations with the pivot of equation i once the
+	//	equation is factored.
+	virtual void Pivot(DlInt32 i, DlFloat64 pivot);
 }; 
 
 class EqSolveFailure
@@ -60,7 +66,8 @@ public:
 		Singular,
 		NonPositiveDefinite,
 		UserCancelled,
-		NeedPivot
+		NeedPivot,
+		NotConverged		//	equation is the iteration count
 	} Reason;
 	
 	EqSolveFailure(Reason reason, DlInt32 eq) 
@@ -132,4 +139,13 @@ inline EqSolveProgress::~EqSolveProgress()
 {
 }
 
+inline bool EqSolveProgress::Iteration(DlInt32 i, DlInt32 maxIter, DlFloat64)
+{
+	return Processing(i, maxIter);
+}
+
+inline void EqSolveProgress::Pivot(DlInt32, DlFloat64)
+{
+}
+
 #endif
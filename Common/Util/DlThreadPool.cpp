@@ -0,0 +1,187 @@
+/*
+ *  DlThreadPool.cpp
+ *
+ *  Created by David Salmon on Sat Oct 17 2026.
+ *  Copyright (c) 2026 David C. Salmon. All rights reserved.
+ *
+ *  Contains DlThreadPool, a fixed set of worker threads used to run the
+ *	iterations of a loop in parallel.
+ */
+
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "DlPlatform.h"
+#include "DlThreadPool.h"
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::DlThreadPool                                        constructor
+ *
+ * Start the worker threads. The calling thread also runs tasks, so one
+ *	fewer worker than threadCount is created.
+ *
+ * DlUInt32 threadCount	-> the total number of threads, or zero for default.
+ *----------------------------------------------------------------------------*/
+DlThreadPool::DlThreadPool(DlUInt32 threadCount)
+	: _task(0)
+	, _next(0)
+	, _last(0)
+	, _generation(0)
+	, _busy(0)
+	, _quit(false)
+{
+	if (threadCount == 0)
+		threadCount = DefaultThreadCount();
+
+	for (DlUInt32 i = 1; i < threadCount; i++)
+		_workers.push_back(std::thread(&DlThreadPool::workerLoop, this));
+}
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::~DlThreadPool                                        destructor
+ *
+ * Stop and join the worker threads.
+ *
+ *----------------------------------------------------------------------------*/
+DlThreadPool::~DlThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		_quit = true;
+	}
+	_start.notify_all();
+
+	for (auto& t : _workers)
+		t.join();
+}
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::DefaultThreadCount                                       static
+ *
+ * Return the number of hardware threads.
+ *
+ * return				<- the thread count, at least one.
+ *----------------------------------------------------------------------------*/
+DlUInt32
+DlThreadPool::DefaultThreadCount()
+{
+	DlUInt32 n = std::thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::ParallelFor
+ *
+ * Run task(i) for first <= i < last and wait for completion. Rethrows the
+ *	first exception thrown by a task.
+ *
+ * DlInt32 first		-> the first index.
+ * DlInt32 last			-> one past the last index.
+ * const Task& task		-> the task to run for each index.
+ *----------------------------------------------------------------------------*/
+void
+DlThreadPool::ParallelFor(DlInt32 first, DlInt32 last, const Task& task)
+{
+	if (last <= first)
+		return;
+
+	//	not worth waking the workers
+	if (_workers.empty() || last - first == 1) {
+		for (DlInt32 i = first; i < last; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		_task = &task;
+		_next = first;
+		_last = last;
+		_error = nullptr;
+		_busy = static_cast<DlUInt32>(_workers.size());
+		_generation++;
+	}
+	_start.notify_all();
+
+	runTasks();
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> guard(_lock);
+		_done.wait(guard, [this]{ return _busy == 0; });
+		_task = 0;
+		error = _error;
+		_error = nullptr;
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::workerLoop                                              private
+ *
+ * Wait for work and run it until the pool is destroyed.
+ *
+ *----------------------------------------------------------------------------*/
+void
+DlThreadPool::workerLoop()
+{
+	DlUInt32 seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(_lock);
+			_start.wait(guard, [this, seen]{ return _quit || _generation != seen; });
+			if (_quit)
+				return;
+			seen = _generation;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+			if (--_busy == 0)
+				_done.notify_one();
+		}
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * DlThreadPool::runTasks                                                private
+ *
+ * Claim and run indices until none remain. An exception records the error
+ *	and stops the other threads from claiming more work.
+ *
+ *----------------------------------------------------------------------------*/
+void
+DlThreadPool::runTasks()
+{
+	for (;;) {
+		DlInt32 i = _next++;
+		if (i >= _last)
+			return;
+
+		try {
+			(*_task)(i);
+		} catch(...) {
+			std::lock_guard<std::mutex> guard(_lock);
+			if (!_error)
+				_error = std::current_exception();
+			_next = _last;
+		}
+	}
+}
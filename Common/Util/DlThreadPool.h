@@ -0,0 +1,90 @@
+/*
+ *  DlThreadPool.h
+ *
+ *  Created by David Salmon on Sat Oct 17 2026.
+ *  Copyright (c) 2026 David C. Salmon. All rights reserved.
+ *
+ *  Contains DlThreadPool, a fixed set of worker threads used to run the
+ *	iterations of a loop in parallel.
+ */
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_DlThreadPool
+#define _H_DlThreadPool
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A pool of worker threads. ParallelFor runs task(i) for each i in
+ *	[first, last) using the workers and the calling thread, and returns
+ *	when all of the iterations are complete. The first exception thrown by
+ *	a task stops the remaining iterations and is rethrown to the caller.
+ *
+ *	ParallelFor must not be called from inside a task, or from more than
+ *	one thread at a time.
+ */
+class DlThreadPool {
+public:
+	typedef std::function<void (DlInt32)> Task;
+
+	//	threadCount is the total number of threads, including the caller.
+	//	Zero uses DefaultThreadCount().
+	explicit DlThreadPool(DlUInt32 threadCount = 0);
+	~DlThreadPool();
+
+	DlUInt32 GetThreadCount() const;
+
+	void ParallelFor(DlInt32 first, DlInt32 last, const Task& task);
+
+	//	the number of hardware threads, at least one.
+	static DlUInt32 DefaultThreadCount();
+
+private:
+	DlThreadPool(const DlThreadPool&);
+	DlThreadPool& operator =(const DlThreadPool&);
+
+	void workerLoop();
+	void runTasks();
+
+	std::vector<std::thread>	_workers;
+
+	std::mutex					_lock;
+	std::condition_variable		_start;
+	std::condition_variable		_done;
+
+	const Task*					_task;
+	std::atomic<DlInt32>		_next;
+	DlInt32						_last;
+	DlUInt32					_generation;
+	DlUInt32					_busy;
+	bool						_quit;
+	std::exception_ptr			_error;
+};
+
+inline
+DlUInt32 DlThreadPool::GetThreadCount() const
+{
+	return static_cast<DlUInt32>(_workers.size() + 1);
+}
+
+#endif
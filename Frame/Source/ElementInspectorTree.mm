@@ -538,7 +538,7 @@ doFormat(DlFloat64 value, UnitType units)
 			} else {
 				curr -= ElementLoadCount;
 				if (curr < elem.CountResultTypes()) {
-					const LoadCaseResults* results = s->GetResults();
+					std::shared_ptr<const LoadCaseResults> results = s->GetResults();
 					if (results) {
 						ElementForce frc = results->GetElementForce(_index);
 						const PropertyType* resType = elem.GetResultType(curr);
@@ -51,7 +51,7 @@ typedef struct DrawElementInfo
 	bool					disp;
 	bool					elements;
 	bool					loads;
-	const LoadCaseResults*	results;
+	std::shared_ptr<const LoadCaseResults>	results;
 	PointEnumerator			pts;
 }	DrawElementInfo;
 
@@ -668,7 +668,7 @@ doDrawNode(Node n, DlInt32 index, void* ctx)
 			info->shear = (flags & ShowShear) != 0;
 			info->disp = (flags & ShowDisplacement) != 0;
 		} else {
-			info->results = 0;
+			info->results.reset();
 			info->axial = info->shear = info->moment = info->disp = false;
 		}
 		return true;
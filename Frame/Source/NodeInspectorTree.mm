@@ -553,7 +553,7 @@ doFormat(DlFloat64 value, UnitType units)
 		{
 			if (s->Analyzed()) {
 				int dof = _item - 5;
-				const LoadCaseResults* res = s->GetResults();
+				std::shared_ptr<const LoadCaseResults> res = s->GetResults();
 				DlInt32 eqNum = theNode.GetEquationNumber(dof);
 				DlFloat64 val;
 				
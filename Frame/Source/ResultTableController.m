@@ -222,9 +222,9 @@
 		val = DlString((long)row + 1, DlIntFormat(0, DlIntFormatType::Decimal));
 	} else {
 		const FrameStructure* s = [_frameDocument structure];
-		const LoadCaseResults* res = s->GetResults();
+		std::shared_ptr<const LoadCaseResults> res = s->GetResults();
 		
-		if (res != 0) {
+		if (res) {
 			// FIXME: review for efficiency. Perhaps this should be processed in the Element.
 
 			// this is the property in the column
@@ -288,9 +288,9 @@
 	
 //	LoadCase lc = [_frameDocument loadCase];
 	const FrameStructure* s = [_frameDocument structure];
-	const LoadCaseResults* res = s->GetResults();
+	std::shared_ptr<const LoadCaseResults> res = s->GetResults();
 
-	if (res != 0) {
+	if (res) {
 		NSPasteboard* pb = [NSPasteboard generalPasteboard];
 		
 		NSMutableString* theData = [NSMutableString string];
@@ -524,7 +524,7 @@ private:
 bool
 CompareElementValues::operator () (NSUInteger row1, NSUInteger row2)
 {
-	const LoadCaseResults* res = s->GetResults();
+	std::shared_ptr<const LoadCaseResults> res = s->GetResults();
 	DlFloat64 value1, value2;
 	
 	{
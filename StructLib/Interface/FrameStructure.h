@@ -62,6 +62,7 @@ class NodeLoad;
 class ElementLoad;
 class LoadCaseResults;
 class LoadCaseCombination;
+class ResultEnvelope;
 
 class Action;
 class DlListener;
@@ -84,7 +85,8 @@ typedef enum {
 	FailureReasonSingular,
 	FailureReasonNonPositiveDefinite,
 	FailureReasonUserCancelled,
-	FailureReasonNeedPivot
+	FailureReasonNeedPivot,
+	FailureReasonNotConverged
 } FailureReason;
 
 //	structure sent with broadcast
@@ -93,6 +95,7 @@ typedef struct AnalysisBroadcast {
 	FailureReason	reason;		//	failure reason
 	DlInt32			eqNum;		//	current equation
 	DlInt32			total;		//	total equations
+	DlFloat64		residual;	//	relative residual for the iterative solver
 	bool			cancel;		//	set true to cancel
 } AnalysisBroadcast;
 
@@ -101,8 +104,66 @@ typedef struct AnalysisData {
 	DlInt32 elemCount;
 	DlInt32 eqCount;
 	DlInt32	lcCount;
+	DlInt32	initialProfile;	//	skyline size with the original equation numbers
+	DlInt32	profile;		//	skyline size used for the analysis
 } AnalysisData;
 
+//	seconds spent in each phase of the last InitAnalysis, Analyze and CombineResults
+typedef struct AnalysisTimings {
+	DlFloat64	numbering;		//	assigning and renumbering the equations
+	DlFloat64	starts;			//	finding the skyline column starts
+	DlFloat64	assembly;		//	element matrices and the stiffness matrix
+	DlFloat64	factor;			//	factoring the matrix
+	DlFloat64	solve;			//	assembling the loads and solving for them
+	DlFloat64	recovery;		//	element forces and reactions
+	DlFloat64	combination;	//	building the combination results
+} AnalysisTimings;
+
+//	what the last analysis did and what each part of it cost
+typedef struct AnalysisTelemetry {
+	AnalysisTimings	timings;
+	DlInt32		equations;
+	DlInt64		skylineSize;			//	terms in the skyline, including the diagonal
+	DlFloat64	averageColumnHeight;	//	skyline terms per equation
+	DlFloat64	factorFlops;		//	estimated operations to factor, 0 if the factor was kept
+	DlFloat64	solveFlops;			//	estimated operations to solve the load cases
+	DlInt64		peakMatrixBytes;	//	element matrices plus the matrix or its factor
+	DlFloat64	minPivot;			//	the pivot of least magnitude, 0 if none was seen
+	DlInt32		minPivotEquation;	//	the equation of minPivot
+	DlFloat64	maxPivot;			//	the pivot of greatest magnitude
+	std::vector<DlFloat64>	caseSolveTimes;	//	seconds to assemble and solve each load case, 0 if kept
+} AnalysisTelemetry;
+
+typedef enum {
+	AnalysisSolverSkyline,		//	skyline (colsol) factorization
+	AnalysisSolverSparse,		//	sparse supernodal factorization
+	AnalysisSolverIterative		//	preconditioned conjugate gradients
+} AnalysisSolver;
+
+typedef enum {
+	AnalysisPreconditionerJacobi,
+	AnalysisPreconditionerGaussSeidel,		//	symmetric Gauss-Seidel
+	AnalysisPreconditionerIncompleteCholesky
+} AnalysisPreconditioner;
+
+//	options controlling the analysis. Set before InitAnalysis.
+//	incremental, mixedPrecision and solverMemory apply to the skyline solver
+//	only. incremental and mixedPrecision can't both be set; either one holds the
+//	skyline in memory whatever solverMemory allows.
+typedef struct AnalysisOptions {
+	AnalysisSolver	solver;		//	the equation solver
+	bool	minimizeProfile;	//	renumber equations to reduce the skyline profile
+	DlUInt32 solverThreads;		//	threads for skyline assembly and factoring. 1 is serial, 0 uses all cores
+	AnalysisPreconditioner preconditioner;	//	for the iterative solver
+	DlFloat64 tolerance;		//	iterative solver relative residual
+	DlInt32	maxIterations;		//	iterative solver cap. 0 is twice the equations
+	bool	incremental;		//	keep the skyline between analyses and refactor only changed columns
+	DlUInt64 combinationMemory;	//	bytes of combination results to keep. 0 keeps them all
+	bool	mixedPrecision;		//	factor the skyline in single precision and refine each solution
+	DlUInt64 solverMemory;		//	bytes of skyline to hold in memory. A larger one is kept in a file. 0 holds it all
+	bool	reproducibleAssembly;	//	assemble the skyline on one thread in the threaded order, so it is the same for any solverThreads
+} AnalysisOptions;
+
 const DlUInt32 kAnalysisMessage = 3000;
 
 //---------------------------------- Class -------------------------------------
@@ -316,20 +377,61 @@ public:
 //
 	bool	CanAnalyze() const;
 	void	InitAnalysis(AnalysisData* data);
+	
+	const AnalysisOptions&	GetAnalysisOptions() const;
+	void					SetAnalysisOptions(const AnalysisOptions& options);
 	bool	Analyzed() const;
 	
 	//	Analysis
 	void	Analyze(DlListener* listener);
+	
+	//	build the results of all the combinations at once, rather than each
+	//	when it is first asked for.
+	void	CombineResults();
+	
+	const AnalysisTimings&	GetAnalysisTimings() const;
+	
+	//	sizes, operation counts, pivots and times of the last analysis.
+	const AnalysisTelemetry&	GetAnalysisTelemetry() const;
+	
+	//	find the governing forces and displacements over all the load cases
+	//	and combinations.
+	void	ComputeEnvelope(ResultEnvelope& envelope) const;
+	
+	//	sample a force or displacement component along each element at the
+	//	relative locations u, for load case lc. values gets u.size() values
+	//	for each element, in order.
+	void	SampleResults(const ElementEnumerator& elems, LoadCase lc,
+						  ElementResultKind kind, DlInt32 dof,
+						  const std::vector<DlFloat64>& u,
+						  std::vector<DlFloat64>& values) const;
 
 //
 //	io
 //
 	void	Load(StrInputStream& input);
 	void	Save(StrOutputStream& output);
+	
+	//	the binary file is laid out so it can be memory mapped and read
+	//	without a stream. It is only read on hosts with the byte order of
+	//	the one that wrote it, so Save remains the format for exchange.
+	void	LoadBinary(const char* path);
+	void	LoadBinary(const void* image, DlUInt64 length);
+	void	SaveBinary(const char* path) const;
+	void	SaveBinary(std::vector<DlUInt8>& image) const;
 
 
 	void	SaveResults(StrOutputStream& output);
 	void	LoadResults(StrInputStream& input);
+
+	//	the results file keeps each load case as columns that a ResultsFile
+	//	reads one at a time. compress uses a lossless codec on the columns it
+	//	makes smaller. Loading takes the results of a file saved for this
+	//	structure, so it need not be analyzed again.
+	void	SaveResults(const char* path, bool compress = false) const;
+	void	SaveResults(std::vector<DlUInt8>& image, bool compress = false) const;
+	void	LoadResults(const char* path);
+	void	LoadResults(const void* image, DlUInt64 length);
 	
 //
 //	load case
@@ -369,7 +471,9 @@ public:
 	// return the master result types.
 	PropertyTypeEnumerator GetMergedResultTypes() const;
 	
-	const LoadCaseResults*	GetResults() const;
+	// the results of the active load case. The handle keeps them alive
+	// after a later call drops a combination to save memory.
+	std::shared_ptr<const LoadCaseResults>	GetResults() const;
 	void					ClearResults();
 
 	void SetDisplacementMagnifier(DlFloat64 magnifier);
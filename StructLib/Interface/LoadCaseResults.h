@@ -74,6 +74,10 @@ class LoadCaseResults
 public:
 	LoadCaseResults(LoadCase lc, const NodeList& nodes, const ElementList& elems);
 	LoadCaseResults(LoadCase lc, const LoadCaseCombination& combo, const frame_data& data);
+	// a combination whose values were already combined, packed as by Pack.
+	// The scales are left for AddScales.
+	LoadCaseResults(LoadCase lc, const LoadCaseCombination& combo, const frame_data& data,
+					const DlFloat64* values);
 	
 	void SetEndForces(DlInt32 index, const ElementForce& force);
 	void SetReaction(DlInt32 reactIndex, DlFloat64 value);
@@ -100,6 +104,11 @@ public:
 	const std::valarray<DlFloat64>& GetReactions() const;
 
 	std::size_t	LoadCaseSize() const;
+	
+	// the displacements, reactions and element force components laid end
+	// to end. PackedCount is the number of values Pack writes.
+	std::size_t	PackedCount() const;
+	void		Pack(DlFloat64* values) const;
 		
 	void Read(StrInputStream& inp);
 	void Write(StrOutputStream& out) const;
@@ -123,9 +132,12 @@ public:
 	void 	UpdateShearScale(DlFloat64 s);
 	void 	UpdateAxialScale(DlFloat64 s);
 	
+	// narrow the scales to fit res multiplied by factor.
+	void	AddScales(const LoadCaseResults& res, DlFloat64 factor);
 
 private:
 
+	void sizeResults(const frame_data& data);
 	void addLoadCase(const LoadCaseResults* res, DlFloat64 factor);
 
 	LoadCase					_loadCase;
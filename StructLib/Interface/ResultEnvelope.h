@@ -0,0 +1,165 @@
+/*+
+ *	File:		ResultEnvelope.h
+ *
+ *	Contains:	Governing results over all load cases and combinations
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_ResultEnvelope
+#define _H_ResultEnvelope
+
+//+--------------------------------- Includes ----------------------------------
+
+#include "StrDefines.h"
+
+#include <vector>
+
+class frame_data;
+class CombinationEngine;
+class DlThreadPool;
+
+//+--------------------------------- Class -------------------------------------
+
+//	an extreme value and the load case it comes from.
+struct EnvelopeValue
+{
+	DlFloat64	value;
+	LoadCase	loadCase;
+};
+
+//+--------------------------------- Class -------------------------------------
+
+//	The least and greatest of each element force along each element, and of
+//	each node displacement, over every load case and combination. The load
+//	cases are read from their results and the combinations are formed a batch
+//	at a time by the CombinationEngine, so no combination results are kept.
+//	When two load cases give the same extreme the first one governs.
+class ResultEnvelope
+{
+public:
+	ResultEnvelope();
+
+	// find the envelope of the analyzed structure in data.
+	void	Compute(const frame_data& data);
+
+	DlInt32	GetElementCount() const		{ return itsElementCount; }
+	DlInt32	GetNodeCount() const		{ return itsNodeCount; }
+
+	// the extremes of force component which, in element coordinates, along element elem.
+	const EnvelopeValue&	GetMinForce(DlInt32 elem, DlInt32 which) const;
+	const EnvelopeValue&	GetMaxForce(DlInt32 elem, DlInt32 which) const;
+
+	// the extremes of displacement dof at node.
+	const EnvelopeValue&	GetMinDisplacement(DlInt32 node, DlInt32 dof) const;
+	const EnvelopeValue&	GetMaxDisplacement(DlInt32 node, DlInt32 dof) const;
+
+private:
+
+	void	addCases(const frame_data& data, const CombinationEngine& engine,
+					 const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+					 DlThreadPool* pool);
+	void	addElements(const frame_data& data, const CombinationEngine& engine,
+						const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+						DlInt32 first, DlInt32 last);
+	void	addNodes(const frame_data& data, const CombinationEngine& engine,
+					 const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+					 DlInt32 first, DlInt32 last);
+
+	DlInt32						itsElementCount;
+	DlInt32						itsNodeCount;
+
+	//	DOF_PER_NODE values per element or node
+	std::vector<EnvelopeValue>	itsMinForce;
+	std::vector<EnvelopeValue>	itsMaxForce;
+	std::vector<EnvelopeValue>	itsMinDisp;
+	std::vector<EnvelopeValue>	itsMaxDisp;
+};
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::GetMinForce                                                    inline
+//
+//      return the least value of a force along an element.
+//
+//  DlInt32 elem                   -> the element index.
+//  DlInt32 which                  -> the force component.
+//
+//  returns const EnvelopeValue&   <- the value and its load case.
+//----------------------------------------------------------------------------------------
+inline const EnvelopeValue&
+ResultEnvelope::GetMinForce(DlInt32 elem, DlInt32 which) const
+{
+	return itsMinForce[elem * DOF_PER_NODE + which];
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::GetMaxForce                                                    inline
+//
+//      return the greatest value of a force along an element.
+//
+//  DlInt32 elem                   -> the element index.
+//  DlInt32 which                  -> the force component.
+//
+//  returns const EnvelopeValue&   <- the value and its load case.
+//----------------------------------------------------------------------------------------
+inline const EnvelopeValue&
+ResultEnvelope::GetMaxForce(DlInt32 elem, DlInt32 which) const
+{
+	return itsMaxForce[elem * DOF_PER_NODE + which];
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::GetMinDisplacement                                             inline
+//
+//      return the least displacement of a node.
+//
+//  DlInt32 node                   -> the node index.
+//  DlInt32 dof                    -> the degree of freedom.
+//
+//  returns const EnvelopeValue&   <- the value and its load case.
+//----------------------------------------------------------------------------------------
+inline const EnvelopeValue&
+ResultEnvelope::GetMinDisplacement(DlInt32 node, DlInt32 dof) const
+{
+	return itsMinDisp[node * DOF_PER_NODE + dof];
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::GetMaxDisplacement                                             inline
+//
+//      return the greatest displacement of a node.
+//
+//  DlInt32 node                   -> the node index.
+//  DlInt32 dof                    -> the degree of freedom.
+//
+//  returns const EnvelopeValue&   <- the value and its load case.
+//----------------------------------------------------------------------------------------
+inline const EnvelopeValue&
+ResultEnvelope::GetMaxDisplacement(DlInt32 node, DlInt32 dof) const
+{
+	return itsMaxDisp[node * DOF_PER_NODE + dof];
+}
+
+#endif
+
+//	eof
@@ -0,0 +1,128 @@
+/*+
+ *	File:		ResultsFile.h
+ *
+ *	Contains:	Random access to a saved results file
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	FrameStructure::SaveResults writes the results of each load case as
+ *	columns, one for each component of a quantity. A ResultsFile maps the
+ *	file and reads any one column without touching the others, so a single
+ *	load case, or the moments of every element, can be shown without
+ *	reading the rest.
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_ResultsFile
+#define _H_ResultsFile
+
+//---------------------------------- Includes ----------------------------------
+
+#include "StrDefines.h"
+
+#include <memory>
+#include <vector>
+
+class StrMappedFile;
+class StrBinaryReader;
+struct StrBinaryResultCase;
+struct StrBinaryResultColumn;
+
+//---------------------------------- Declares ----------------------------------
+
+//	the quantities saved for each load case. Displacements and reactions
+//	have a value for each node and component XCoord to TCoord. Element
+//	forces have a value for each element and ElementForce component.
+enum ResultQuantity {
+	  ResultDisplacement
+	, ResultReaction
+	, ResultElementForce
+	, ResultQuantityCount
+};
+
+//---------------------------------- Class -------------------------------------
+
+class ResultsFile
+{
+public:
+	//	map the file. throws DlException if it is not a results file.
+	explicit ResultsFile(const char* path);
+	//	read an image in memory, which must outlive this object.
+	ResultsFile(const void* image, DlUInt64 length);
+	~ResultsFile();
+
+	DlUInt32	GetNodeCount() const;
+	DlUInt32	GetElementCount() const;
+
+	//	the load cases saved, in increasing order
+	DlUInt32	GetLoadCaseCount() const;
+	LoadCase	GetLoadCase(DlUInt32 which) const;
+	bool		HasLoadCase(LoadCase lc) const;
+
+	//	the number of values in a column of quantity q
+	DlUInt32	GetColumnLength(ResultQuantity q) const;
+
+	//	read one column, decompressing it if needed. values must hold
+	//	GetColumnLength(q) values. throws DlException if lc was not saved.
+	void		ReadColumn(LoadCase lc, ResultQuantity q, DlInt32 component,
+						   DlFloat64* values) const;
+	void		ReadColumn(LoadCase lc, ResultQuantity q, DlInt32 component,
+						   std::vector<DlFloat64>& values) const;
+
+	//	the values of an uncompressed column in place, or nullptr if the
+	//	column is compressed.
+	const DlFloat64*	MapColumn(LoadCase lc, ResultQuantity q, DlInt32 component) const;
+
+	//	the display scales saved with load case lc
+	const StrBinaryResultCase&	GetCase(LoadCase lc) const;
+
+private:
+	ResultsFile(const ResultsFile& f);
+	ResultsFile& operator=(const ResultsFile& f);
+
+	void	init(const void* image, DlUInt64 length);
+	const StrBinaryResultColumn&	findColumn(LoadCase lc, ResultQuantity q,
+											   DlInt32 component) const;
+
+	std::unique_ptr<StrMappedFile>		itsFile;
+	std::unique_ptr<StrBinaryReader>	itsReader;
+	DlUInt32							itsNodeCount;
+	DlUInt32							itsElementCount;
+	const StrBinaryResultCase*			itsCases;
+	DlUInt32							itsCaseCount;
+	const StrBinaryResultColumn*		itsColumns;
+	DlUInt64							itsColumnCount;
+	const DlUInt8*						itsData;
+	DlUInt64							itsDataLength;
+};
+
+//---------------------------------- Functions ---------------------------------
+
+//	the lossless codec used for compressed columns. Each value is xored with
+//	the one before it and only the bits that differ are kept, so repeated
+//	values take one bit and nearby values a few. The decoder throws
+//	DlException if the data is damaged.
+void	EncodeResultColumn(const DlFloat64* values, DlUInt32 count, std::vector<DlUInt8>& data);
+void	DecodeResultColumn(const DlUInt8* data, DlUInt64 length, DlUInt32 count, DlFloat64* values);
+
+#endif
+
+//	eof
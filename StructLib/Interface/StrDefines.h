@@ -46,6 +46,12 @@ enum {
 	, DOF_PER_NODE
 };
 
+// the result sampled along an element by FrameStructure::SampleResults
+enum ElementResultKind {
+	  ElementResultForce
+	, ElementResultDisplacement
+};
+
 const int kCurrentMajorVersion = 1;
 const int kCurrentMinorVersion = 4;
 
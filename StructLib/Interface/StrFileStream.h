@@ -0,0 +1,115 @@
+/*+
+ *	File:		StrFileStream.h
+ *
+ *	Contains:	Structure input and output streams on a DlStream
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	The values are written in the same order and byte layout as the Frame
+ *	application's FrameReader and FrameWriter, so either may read what the
+ *	other wrote. Neither depends on Cocoa or on the byte order of the host.
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_StrFileStream
+#define _H_StrFileStream
+
+//---------------------------------- Includes ----------------------------------
+
+#include "StrInputStream.h"
+#include "StrOutputStream.h"
+
+#include <vector>
+
+class DlStream;
+
+//---------------------------------- Class -------------------------------------
+
+//	reads a structure from a stream, such as a DlFileStream. Throws
+//	DlException if the stream ends early.
+class StrFileInputStream : public StrInputStream
+{
+public:
+	enum { kDefaultBufferLen = 16384 };
+
+	explicit StrFileInputStream(DlStream& stream, DlUInt32 bufferLen = kDefaultBufferLen);
+	virtual ~StrFileInputStream();
+
+	virtual bool 		GetBool();
+	virtual DlUInt8 	GetByte();
+	virtual DlInt32 	GetInt();
+	virtual DlFloat32 	GetFloat();
+	virtual DlFloat64 	GetDouble();
+	virtual DlString 	GetString();
+
+	//	true if there is nothing left to read.
+	bool	eof();
+
+private:
+	StrFileInputStream(const StrFileInputStream& s);
+	StrFileInputStream& operator=(const StrFileInputStream& s);
+
+	DlUInt8	getOne();
+	void	getBuffer(DlUInt8* buf, DlUInt32 len);
+	bool	fill();
+
+	DlStream&				itsStream;
+	std::vector<DlUInt8>	itsBuffer;
+	DlUInt32				itsPos;
+	DlUInt32				itsLen;
+};
+
+//---------------------------------- Class -------------------------------------
+
+//	writes a structure to a stream. The values are buffered until the buffer
+//	fills, Flush is called or the writer is destroyed.
+class StrFileOutputStream : public StrOutputStream
+{
+public:
+	enum { kDefaultBufferLen = 16384 };
+
+	explicit StrFileOutputStream(DlStream& stream, DlUInt32 bufferLen = kDefaultBufferLen);
+	virtual ~StrFileOutputStream();
+
+	virtual void PutBool(bool val);
+	virtual void PutByte(DlUInt8 val);
+	virtual void PutInt(DlInt32 val);
+	virtual void PutFloat(DlFloat32 val);
+	virtual void PutDouble(DlFloat64 val);
+	virtual void PutString(const char* str);
+
+	//	write the buffered values to the stream. throws DlException
+	void	Flush();
+
+private:
+	StrFileOutputStream(const StrFileOutputStream& s);
+	StrFileOutputStream& operator=(const StrFileOutputStream& s);
+
+	void	putBuffer(const DlUInt8* buf, DlUInt32 len);
+
+	DlStream&				itsStream;
+	std::vector<DlUInt8>	itsBuffer;
+	DlUInt32				itsPos;
+};
+
+#endif
+
+//	eof
@@ -102,6 +102,27 @@ BaseEnumerator::Add(const BaseEnumerator* list)
 	return added;
 }
 
+//----------------------------------------------------------------------------------------
+//  BaseEnumerator::Append
+//
+//      add a block of elements. They are not checked against the list, so
+//		they must be new.
+//
+//  void* const* elems -> the elements.
+//  DlInt32 count      -> the number of elements.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+BaseEnumerator::Append(void* const* elems, DlInt32 count)
+{
+	DlUInt32 first = size();
+	insert(end(), elems, elems + count);
+	for (DlInt32 i = 0; i < count; i++)
+		_map[elems[i]] = first + i;
+	Reset();
+}
+
 //----------------------------------------------------------------------------------------
 //	BaseEnumerator::remove
 //
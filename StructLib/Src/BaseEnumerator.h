@@ -100,6 +100,8 @@ protected:
 	bool			Add(void* elem);
 	//	add a list of elements using add
 	bool			Add(const BaseEnumerator* list);
+	//	add count new elements, none of which are in the list
+	void			Append(void* const* elems, DlInt32 count);
 	//	remove matching elements
 	void			Remove(const BaseEnumerator* list);
 	//	remove a single element
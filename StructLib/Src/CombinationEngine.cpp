@@ -0,0 +1,205 @@
+/*+
+ *	File:		CombinationEngine.cpp
+ *
+ *	Contains:	Combine load case results for many combinations at once
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "CombinationEngine.h"
+#include "frame_data.h"
+
+#include <cmath>
+
+using namespace std;
+
+//	values combined per pass, so a block of each basis row stays in cache
+//	while it is added into every combination in the batch.
+const DlInt32 kBlockValues = 512;
+
+//	combinations nested deeper than this are taken to be circular.
+const DlInt32 kMaxDepth = 32;
+
+//--------------------------------------- Methods ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::CombinationEngine                                       constructor
+//
+//      gather the results of each analyzed load case and the factors of
+//      each combination.
+//
+//  const frame_data& data     -> the analyzed structure.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+CombinationEngine::CombinationEngine(const frame_data& data)
+	: itsBasisCount(0)
+	, itsValueCount(0)
+	, itsReactionOffset(0)
+	, itsElementForceOffset(0)
+	, itsBasisRow(data.CountResults(), -1)
+{
+	const std::size_t numCases = data.CountResults();
+
+	vector<const LoadCaseResults*> basis;
+	for (LoadCase lc = 0; lc < numCases; lc++) {
+		if (data.IsDefinedLoadCase(lc)) {
+			const LoadCaseResults* res = data.GetResults(lc).get();
+			if (res) {
+				itsBasisRow[lc] = basis.size();
+				itsBasisCases.push_back(lc);
+				basis.push_back(res);
+			}
+		}
+	}
+
+	itsBasisCount = basis.size();
+	if (itsBasisCount == 0)
+		return;
+
+	itsValueCount = basis[0]->PackedCount();
+	itsReactionOffset = basis[0]->GetDisplacements().size();
+	itsElementForceOffset = itsReactionOffset + basis[0]->GetReactions().size();
+	itsBasis.resize(static_cast<size_t>(itsBasisCount) * itsValueCount);
+	for (DlInt32 i = 0; i < itsBasisCount; i++)
+		basis[i]->Pack(&itsBasis[static_cast<size_t>(i) * itsValueCount]);
+
+	itsFactorStart.push_back(0);
+	vector<DlFloat64> row(itsBasisCount);
+	for (LoadCase lc = 0; lc < numCases; lc++) {
+		if (data.IsDefinedLoadCase(lc))
+			continue;
+
+		fill(row.begin(), row.end(), 0.0);
+		addFactors(data, lc, 1.0, row, 0);
+
+		for (DlInt32 i = 0; i < itsBasisCount; i++) {
+			if (row[i] != 0) {
+				itsFactorRow.push_back(i);
+				itsFactors.push_back(row[i]);
+			}
+		}
+
+		itsCombinations.push_back(lc);
+		itsFactorStart.push_back(itsFactors.size());
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::addFactors                                                 private
+//
+//      add the factors of combination lc, times scale, to row. Factors on
+//      other combinations are expanded to the load cases they combine.
+//
+//  const frame_data& data         -> the structure.
+//  LoadCase lc                    -> the combination.
+//  DlFloat64 scale                -> the factor on the combination.
+//  std::vector<DlFloat64>& row    <> factor on each row of the basis.
+//  DlInt32 depth                  -> the nesting so far.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+CombinationEngine::addFactors(const frame_data& data, LoadCase lc, DlFloat64 scale,
+							  vector<DlFloat64>& row, DlInt32 depth) const
+{
+	const LoadCaseCombination* combo = data.GetLoadCaseCombination(lc);
+	if (!combo || depth > kMaxDepth)
+		return;
+
+	const vector<DlFloat32>& factors = combo->GetFactors();
+	for (LoadCase i = 0; i < factors.size() && i < itsBasisRow.size(); i++) {
+		if (fabs(factors[i]) <= 1.0e-6)
+			continue;
+
+		if (data.IsDefinedLoadCase(i)) {
+			if (itsBasisRow[i] >= 0)
+				row[itsBasisRow[i]] += scale * factors[i];
+		} else {
+			addFactors(data, i, scale * factors[i], row, depth + 1);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::Combine
+//
+//      form every combination.
+//
+//  std::valarray<DlFloat64>& values   <- one row of GetValueCount() per combination.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+CombinationEngine::Combine(valarray<DlFloat64>& values) const
+{
+	values.resize(static_cast<size_t>(GetCombinationCount()) * itsValueCount);
+	if (values.size() == 0)
+		return;
+
+	for (DlInt32 first = 0; first < GetCombinationCount(); first += kBatchSize) {
+		DlInt32 count = min<DlInt32>(kBatchSize, GetCombinationCount() - first);
+		combine(first, count, &values[static_cast<size_t>(first) * itsValueCount]);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::combine                                                    private
+//
+//      form count combinations starting at first. The values are taken a
+//      block at a time, and each block of the basis is added into every
+//      combination of the batch before moving on, so the inner loop is a
+//      contiguous multiply-add the compiler can vectorize.
+//
+//  DlInt32 first          -> the first combination.
+//  DlInt32 count          -> the number of combinations.
+//  DlFloat64* values      <- count rows of GetValueCount() values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+CombinationEngine::combine(DlInt32 first, DlInt32 count, DlFloat64* values) const
+{
+	const size_t n = itsValueCount;
+	fill(values, values + count * n, 0.0);
+
+	const DlFloat64* basis = &itsBasis[0];
+	for (size_t j0 = 0; j0 < n; j0 += kBlockValues) {
+		const size_t j1 = min(n, j0 + kBlockValues);
+
+		for (DlInt32 c = 0; c < count; c++) {
+			DlFloat64* out = values + c * n;
+			for (DlInt32 k = itsFactorStart[first + c]; k < itsFactorStart[first + c + 1]; k++) {
+				const DlFloat64 f = itsFactors[k];
+				const DlFloat64* in = basis + itsFactorRow[k] * n;
+				for (size_t j = j0; j < j1; j++)
+					out[j] += f * in[j];
+			}
+		}
+	}
+}
+
+//	eof
@@ -0,0 +1,157 @@
+/*+
+ *	File:		CombinationEngine.h
+ *
+ *	Contains:	Combine load case results for many combinations at once
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_CombinationEngine
+#define _H_CombinationEngine
+
+//---------------------------------- Includes ----------------------------------
+
+#include "StrDefines.h"
+
+#include <algorithm>
+#include <valarray>
+#include <vector>
+
+class frame_data;
+
+//---------------------------------- Class -------------------------------------
+
+//	Stacks the packed results (see LoadCaseResults::Pack) of every analyzed
+//	load case into one row-major matrix and forms all the combinations as the
+//	product of the factor table with it. Combinations of combinations are
+//	expanded to factors on the load cases, so each row needs only the basis.
+class CombinationEngine
+{
+public:
+	enum { kBatchSize = 16 };
+
+	explicit CombinationEngine(const frame_data& data);
+
+	DlInt32		GetCombinationCount() const		{ return itsCombinations.size(); }
+	LoadCase	GetLoadCase(DlInt32 which) const	{ return itsCombinations[which]; }
+	DlInt32		GetBasisCount() const			{ return itsBasisCount; }
+	DlInt32		GetValueCount() const			{ return itsValueCount; }
+
+	//	the load case and packed results of each row of the basis.
+	LoadCase			GetBasisLoadCase(DlInt32 row) const	{ return itsBasisCases[row]; }
+	const DlFloat64*	GetBasis(DlInt32 row) const
+							{ return &itsBasis[static_cast<std::size_t>(row) * itsValueCount]; }
+
+	//	where the reactions and element forces start in each packed row.
+	DlInt32		GetReactionOffset() const		{ return itsReactionOffset; }
+	DlInt32		GetElementForceOffset() const	{ return itsElementForceOffset; }
+
+	//	form every combination. Row i of values, GetValueCount() long, holds
+	//	combination i.
+	void		Combine(std::valarray<DlFloat64>& values) const;
+
+	//	form the combinations batchSize at a time, calling
+	//	consumer(DlInt32 which, const DlFloat64* values) for each. The values
+	//	are only good until the call returns.
+	template <class Consumer>
+	void		Stream(Consumer& consumer, DlInt32 batchSize = kBatchSize) const;
+
+	//	as Stream, but hand over each batch whole, as
+	//	consumer(DlInt32 first, DlInt32 count, const DlFloat64* values).
+	template <class Consumer>
+	void		StreamBatches(Consumer& consumer, DlInt32 batchSize = kBatchSize) const;
+
+private:
+
+	void		addFactors(const frame_data& data, LoadCase lc, DlFloat64 scale,
+						   std::vector<DlFloat64>& row, DlInt32 depth) const;
+	void		combine(DlInt32 first, DlInt32 count, DlFloat64* values) const;
+
+	DlInt32						itsBasisCount;
+	DlInt32						itsValueCount;
+	DlInt32						itsReactionOffset;
+	DlInt32						itsElementForceOffset;
+	std::vector<LoadCase>		itsBasisCases;		//	load case of each row
+	std::vector<DlInt32>		itsBasisRow;		//	row of each load case, or -1
+	std::valarray<DlFloat64>	itsBasis;			//	packed results of each load case
+
+	//	the nonzero factors of each combination, by row of the basis
+	std::vector<LoadCase>		itsCombinations;
+	std::vector<DlInt32>		itsFactorStart;
+	std::vector<DlInt32>		itsFactorRow;
+	std::vector<DlFloat64>		itsFactors;
+};
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::StreamBatches                                               inline
+//
+//      form the combinations a batch at a time and hand each batch to consumer.
+//
+//  Consumer& consumer     -> called with the first index, count and values of a batch.
+//  DlInt32 batchSize      -> the number of combinations formed together.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class Consumer>
+inline void
+CombinationEngine::StreamBatches(Consumer& consumer, DlInt32 batchSize) const
+{
+	const DlInt32 numCombos = GetCombinationCount();
+	if (numCombos == 0)
+		return;
+
+	batchSize = std::max(1, std::min(batchSize, numCombos));
+	std::vector<DlFloat64> batch(static_cast<std::size_t>(batchSize) * itsValueCount);
+
+	for (DlInt32 first = 0; first < numCombos; first += batchSize) {
+		DlInt32 count = std::min(batchSize, numCombos - first);
+		combine(first, count, batch.data());
+		consumer(first, count, static_cast<const DlFloat64*>(batch.data()));
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  CombinationEngine::Stream                                                      inline
+//
+//      form the combinations a batch at a time and hand them to consumer.
+//
+//  Consumer& consumer     -> called with the index and values of each combination.
+//  DlInt32 batchSize      -> the number of combinations formed together.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class Consumer>
+inline void
+CombinationEngine::Stream(Consumer& consumer, DlInt32 batchSize) const
+{
+	const std::size_t n = itsValueCount;
+	auto each = [&](DlInt32 first, DlInt32 count, const DlFloat64* values) {
+		for (DlInt32 i = 0; i < count; i++)
+			consumer(first + i, values + i * n);
+	};
+	StreamBatches(each, batchSize);
+}
+
+#endif
+
+//	eof
@@ -32,6 +32,7 @@
 #include "ElemLoadImp.h"
 #include "StrInputStream.h"
 #include "StrOutputStream.h"
+#include "StrBinaryFormat.h"
 
 //---------------------------------- Includes ----------------------------------
 
@@ -46,6 +47,13 @@ ElemLoadImp::ElemLoadImp(StrInputStream & input, const frame_data & )
 		value[i] = input.GetDouble();
 }
 
+ElemLoadImp::ElemLoadImp(const StrBinaryElemLoad& rec)
+	: isCombo(false)
+{
+	for (DlInt32 i = 0; i < ElementLoadCount; i++)
+		value[i] = rec.value[i];
+}
+
 bool
 ElemLoadImp::operator==(const ElemLoadImp& p) const
 {
@@ -65,6 +73,13 @@ ElemLoadImp::Write(StrOutputStream & output, const frame_data & ) const
 		output.PutDouble(value[i]);
 }
 
+void
+ElemLoadImp::WriteRecord(StrBinaryElemLoad& rec) const
+{
+	for (DlInt32 i = 0; i < ElementLoadCount; i++)
+		rec.value[i] = value[i];
+}
+
 void
 ElemLoadImp::Add(const ElemLoadImp* imp, float factor)
 {
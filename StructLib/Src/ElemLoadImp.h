@@ -37,6 +37,7 @@
 class StrInputStream;
 class StrOutputStream;
 class frame_data;
+struct StrBinaryElemLoad;
 
 const UnitType kElementLoadUnits[ElementLoadCount] = {
 	UnitsDistribForce,
@@ -53,10 +54,12 @@ public:
 
 	ElemLoadImp();
 	ElemLoadImp(StrInputStream& input, const frame_data& data);
+	explicit ElemLoadImp(const StrBinaryElemLoad& rec);
 
 	bool 	operator==(const ElemLoadImp& p) const;
 
 	void	Write(StrOutputStream& output, const frame_data& data) const;
+	void	WriteRecord(StrBinaryElemLoad& rec) const;
 
 	DlFloat64 GetValue(ElementLoadType which) const { return value[which]; }
 	void SetValue(ElementLoadType which, DlFloat64 val) { value[which] = val; }
@@ -43,11 +43,12 @@
 
 #include "StrInputStream.h"
 #include "StrOutputStream.h"
+#include "StrBinaryFormat.h"
 
 //ElementImp::CreatorMap* ElementImp::theMap = 0;
 
 #if DlDebugging
-int ElementImp::_idGen = 0;
+std::atomic<int> ElementImp::_idGen(0);
 #endif
 
 //+--------------------------------- Methods -----------------------------------
@@ -84,8 +85,9 @@ ElementImp::Cosines() const
 //  returns nothing
 //----------------------------------------------------------------------------------------
 ElementImp::ElementImp(StrInputStream& inp, const frame_data& data)
+: _version(nullptr)
 #if DlDebugging
-: _id(_idGen++)
+, _id(_idGen++)
 #endif
 
 {
@@ -139,6 +141,55 @@ ElementImp::Write(StrOutputStream& out, const frame_data& data) const
 	}
 }
 
+//----------------------------------------------------------------------------------------
+//  ElementImp::WriteRecord
+//
+//      fill in the binary record for this element, except for its type.
+//
+//  StrBinaryElement& rec                      <- the element.
+//  std::vector<StrBinaryLoadRef>& loads       <- the loads are appended.
+//  const frame_data& data                     -> the data object.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementImp::WriteRecord(StrBinaryElement& rec, std::vector<StrBinaryLoadRef>& loads,
+						const frame_data& data) const
+{
+	rec.nodes[0] = data.NodeToIndex(_nodes[0]);
+	rec.nodes[1] = data.NodeToIndex(_nodes[1]);
+	rec.property = data.PropToIndex(_property);
+
+	rec.firstLoad = loads.size();
+	rec.loadCount = _loads.size();
+	for (auto p : _loads) {
+		StrBinaryLoadRef ref = { p.first, data.ElemLoadToIndex(p.first, p.second) };
+		loads.push_back(ref);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementImp::AssignLoads
+//
+//      assign the loads of a binary element record.
+//
+//  const StrBinaryLoadRef* loads  -> the loads.
+//  DlUInt32 count                 -> the number of loads.
+//  const frame_data& data         -> the data object.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementImp::AssignLoads(const StrBinaryLoadRef* loads, DlUInt32 count, const frame_data& data)
+{
+	_loads.reserve(count);
+	for (DlUInt32 i = 0; i < count; i++) {
+		ElemLoadImp* imp = data.IndexToElemLoad(loads[i].loadCase, loads[i].load);
+		if (imp != nullptr)
+			AssignLoad(loads[i].loadCase, imp);
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  ElementImp::MaxLoadCase
 //
@@ -334,6 +385,34 @@ ElementImp::HasLoad(const ElemLoadImp* l) const
 	return false;
 }
 
+//----------------------------------------------------------------------------------------
+//  ElementImp::SampleResults
+//
+//      sample a force or displacement at several points along the element.
+//
+//  ElementResultKind kind     -> force or displacement.
+//  DlInt32 dof                -> the component.
+//  DlInt32 index              -> the element index.
+//  const DlFloat64* u         -> the locations [0, 1].
+//  DlInt32 count              -> the number of locations.
+//  const LoadCaseResults& res -> the results.
+//  DlFloat64* values          <- the value at each location.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementImp::SampleResults(ElementResultKind kind, DlInt32 dof, DlInt32 index,
+						  const DlFloat64* u, DlInt32 count,
+						  const LoadCaseResults& res, DlFloat64* values) const
+{
+	for (DlInt32 i = 0; i < count; i++) {
+		if (kind == ElementResultForce)
+			values[i] = DOFForceAt(dof, index, u[i], res);
+		else
+			values[i] = DOFDispAt(dof, index, u[i], res);
+	}
+}
+
 // return the applied load for the specified results
 //----------------------------------------------------------------------------------------
 //  ElementImp::GetAppliedLoad
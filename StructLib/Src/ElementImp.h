@@ -42,8 +42,12 @@
 #include "PropertyEnumerator.h"
 #include "StrDefines.h"
 #include "ElementLoad.h"
+#include "StructureVersion.h"
 
 #include "DlMatrix.h"
+#include "DlFixedMatrix.h"
+
+#include <atomic>
 
 class NodeImp;
 class PropertyImp;
@@ -55,6 +59,11 @@ class ElemLoadImp;
 class WorldRect;
 class PointEnumeratorImp;
 class LoadCaseResults;
+struct StrBinaryElement;
+struct StrBinaryLoadRef;
+
+//	element stiffness matrix, sized at compile time so it needs no heap.
+typedef DlArray::DlFixedMatrix<DlFloat64, 2*DOF_PER_NODE, 2*DOF_PER_NODE> ElementMatrix;
 
 //+--------------------------------- Class -------------------------------------
 
@@ -91,10 +100,15 @@ public:
 	ElemLoadImp*	GetLoad(LoadCase which) const;
 	void			AssignLoad(LoadCase which, ElemLoadImp* load);
 	bool			HasLoad(const ElemLoadImp* l) const;
+	//	assign the loads of a binary element record
+	void			AssignLoads(const StrBinaryLoadRef* loads, DlUInt32 count, const frame_data& data);
 	DlUInt32		LoadCount() const;
 	
 	DlFloat64		Length() const;
 
+	//	the stamp of the structure this element is in, bumped by the setters
+	void			SetVersion(StructureVersion* version) { _version = version; }
+
 	void			GetDOF(DlInt32 dof[2*DOF_PER_NODE]) const;
 
 	bool 			Hit(const WorldRect& r) const;
@@ -123,6 +137,7 @@ public:
 	virtual const char* GetType() const = 0;
 
 	virtual void Stiffness(DlArray::DlMatrix<DlFloat64>& m, bool fullMatrix) const = 0;
+	virtual void Stiffness(ElementMatrix& m, bool fullMatrix) const = 0;
 	virtual bool FixedEndForces(DlFloat64 loads[2*DOF_PER_NODE], LoadCase loadCase) const = 0;
 
 	//
@@ -132,6 +147,9 @@ public:
 	virtual DlInt32	Coords(PointEnumeratorImp* pts) const;
 	
 	virtual void Write(StrOutputStream& out, const frame_data& data) const = 0;
+	//	the type is left for the caller
+	void WriteRecord(StrBinaryElement& rec, std::vector<StrBinaryLoadRef>& loads,
+					 const frame_data& data) const;
 
 	//	post analysis
 	//
@@ -140,6 +158,9 @@ public:
 	virtual const PropertyType* GetForceTypeForDOF(DlInt32 dof) const = 0;
 	virtual void GetElementForce(double where, const ElementForce& feForce, LoadCase lc, ElementForce& force) const = 0;
 	virtual ElementForce GetLocalForce(const DlFloat64 globalForces[DOF_PER_NODE]) const = 0;
+	// the least and greatest of each force along the element in load case lc
+	virtual void GetForceRange(const ElementForce& feForce, LoadCase lc,
+							   ElementForce& least, ElementForce& greatest) const = 0;
     
 	// returns a diagram for the force for DOF dof
 	virtual DlInt32 ForceDOFCoords(DlInt32 dof, DlInt32 index, PointEnumeratorImp* pts, const LoadCaseResults& res) const = 0;
@@ -160,6 +181,12 @@ public:
 	// the displacement in the specified dof and location along the beam.
 	virtual DlFloat64 DOFDispAt(DlInt32 dof, DlInt32 index, DlFloat64 u, const LoadCaseResults& res) const = 0;
 
+	// the force or displacement in dof at each of count relative locations u.
+	// By default each is found with DOFForceAt or DOFDispAt.
+	virtual void SampleResults(ElementResultKind kind, DlInt32 dof, DlInt32 index,
+							   const DlFloat64* u, DlInt32 count,
+							   const LoadCaseResults& res, DlFloat64* values) const;
+
 	//
 	// Element results for table
 	//
@@ -171,7 +198,7 @@ public:
 	virtual DlFloat64 GetResultValue(int which, const ElementForce& feForce, const LoadCaseResults& res) const = 0;
 	
 #if DlDebugging
-	static int		_idGen;
+	static std::atomic<int>	_idGen;
 	int				_id;
 #endif
 
@@ -179,6 +206,7 @@ protected:
         
 	NodeImp* _nodes[2];
 	PropertyImp* _property;
+	StructureVersion* _version;
 	
 	LoadList	_loads;
 	
@@ -206,6 +234,7 @@ private:
 inline 
 ElementImp::ElementImp(NodeImp* startNode, NodeImp* endNode, PropertyImp* prop)
 	: _property(prop)
+	, _version(nullptr)
 #if DlDebugging
 	, _id(_idGen++)
 #endif
@@ -240,6 +269,8 @@ inline void
 ElementImp::SetStartNode(const NodeImp* n) 
 {
 	_nodes[0] = const_cast<NodeImp*>(n);
+	if (_version)
+		_version->Reconnected(this);
 }
 
 //----------------------------------------------------------------------------------------
@@ -268,6 +299,8 @@ inline void
 ElementImp::SetEndNode(const NodeImp* n)
 {
 	_nodes[1] = const_cast<NodeImp*>(n);
+	if (_version)
+		_version->Reconnected(this);
 }
 
 //----------------------------------------------------------------------------------------
@@ -295,7 +328,9 @@ ElementImp::GetProperty() const
 inline void
 ElementImp::SetProperty(PropertyImp* imp)
 { 
-	_property = imp; 
+	_property = imp;
+	if (_version)
+		_version->Changed(this);
 }
 
 inline DlUInt32
@@ -40,40 +40,21 @@
 #include "ElemLoadList.h"
 #include "PropertyList.h"
 #include "ElementFactory.h"
+#include "SparseLDL.h"
+#include "PCGSolver.h"
+#include "DlThreadPool.h"
+#include "ElementMatrixCache.h"
+#include "SkylineFile.h"
+#include "StructureVersion.h"
+
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 using namespace DlArray;
 
 //--------------------------------------- Class ------------------------------------------
 
-//----------------------------------------------------------------------------------------
-// class GetAttachedNodes
-//
-//      class to assemble list of elements attached to the nodes in the list.
-//
-//----------------------------------------------------------------------------------------
-class GetAttachedNodes
-{
-public:
-	GetAttachedNodes(const NodeList* list)
-		: _nodeList(list)
-	{
-	}
-			
-	void operator() (const ElementImp* elem, DlInt32)
-	{
-		if (_nodeList->Contains(elem->StartNode()) ||
-			_nodeList->Contains(elem->EndNode()))
-			_elemList.Add(const_cast<ElementImp *>(elem));
-	}
-	
-	const NodeList* _nodeList;
-	ElementEnumerator _elemList;
-private:
-    GetAttachedNodes(const GetAttachedNodes& a);
-    GetAttachedNodes& operator=(const GetAttachedNodes& a);
-};
-
 //----------------------------------------------------------------------------------------
 // class GetSelection
 //
@@ -101,33 +82,6 @@ private:
     GetSelection& operator=(const GetSelection& a);
 };
 
-//----------------------------------------------------------------------------------------
-// class ElementSelector
-//
-//      get the selected elements that are enclosed by the rectangle.
-//
-//----------------------------------------------------------------------------------------
-class ElementSelector 
-{
-public:
-	ElementSelector(const WorldRect & r) : _rect(r) {
-	}
-
-	void operator () (const ElementImp* e, DlInt32)
-	{
-		// if both the nodes are in the rect
-		if ((e->StartNode()->Hit(_rect) && e->EndNode()->Hit(_rect)) || e->Hit(_rect)) {
-			ElementList::GetList(_list)->Add(const_cast<ElementImp*>(e));
-		}
-	}
-
-	ElementEnumerator _list;
-	const WorldRect& _rect;
-private:
-    ElementSelector(const ElementSelector& a);
-    ElementSelector& operator=(const ElementSelector& a);
-};
-
 //----------------------------------------------------------------------------------------
 // class NodeMapper
 //
@@ -145,8 +99,9 @@ private:
 class NodeMapper 
 {
 public:
-	NodeMapper(const NodeCloneMap& theNodeMap) 
-		: _map(theNodeMap) 
+	NodeMapper(ElementList& elems, const NodeCloneMap& theNodeMap) 
+		: _elems(elems)
+		, _map(theNodeMap) 
 	{
 	}
 
@@ -166,10 +121,8 @@ public:
 			_endNodes.push_back(e->EndNode());
 
 			// and update the elements
-			if (i != _map.end())
-				e->SetStartNode(i->second);
-			if (j != _map.end())
-				e->SetEndNode(j->second);
+			_elems.Reconnect(e, i != _map.end() ? i->second : e->StartNode(),
+							 j != _map.end() ? j->second : e->EndNode());
 		}
 	}
 	
@@ -177,6 +130,7 @@ public:
 	ElementList::NodeVector _startNodes;
 	ElementList::NodeVector _endNodes;
 
+	ElementList& _elems;
 	const NodeCloneMap& _map;
 private:
     NodeMapper(const NodeMapper& a);
@@ -187,47 +141,55 @@ private:
 // class ElementDupFinder
 //
 //	Build a set of the elements in incoming that are duplicates of the existing
-//	elements.
+//	elements. The incoming elements are hashed once on their unordered node pair,
+//	so each existing element is a single lookup.
 //----------------------------------------------------------------------------------------
 class ElementDupFinder
 {
 public:
 	ElementDupFinder(const ElementList* incoming)
-		: _list(incoming) {}
+	{
+		_byNodes.reserve(incoming->Length());
+		
+		while (incoming->HasMore()) {
+			const ElementImp* e = incoming->Next();
+			_byNodes[key(e->StartNode(), e->EndNode())].push_back(e);
+		}
+		
+		incoming->Reset();
+	}
 
 	void operator () (const ElementImp* e, DlInt32)
 	{
-		const NodeImp* start = e->StartNode();
-		const NodeImp* end = e->EndNode();
-
-//#if DlDebugging
-//		printf("checking %d -> %d\n", start->_id, end->_id);
-//#endif
-
-		while (_list->HasMore()) {
-			const ElementImp* test = _list->Next();
-			// skip over same element.
-			if (test != e) {
-
-				const NodeImp* tstart = test->StartNode();
-				const NodeImp* tend = test->EndNode();
-
-				if ((start==tstart && end==tend) || (start==tend && end==tstart)) {
+		auto i = _byNodes.find(key(e->StartNode(), e->EndNode()));
+		
+		if (i != _byNodes.end()) {
+			for (const ElementImp* test : i->second) {
+				// skip over same element.
+				if (test != e)
 					elemSet.insert(test);
-//#if DlDebugging
-//					printf("\tadd\n");
-//#endif
-				}
 			}
 		}
-
-		_list->Reset();
 	}
 
 	ElementList::ElementSet elemSet;
 
 private:
-	const ElementList* _list;
+	typedef std::pair<const NodeImp*, const NodeImp*> NodePair;
+
+	struct NodePairHash {
+		std::size_t operator () (const NodePair& p) const
+		{
+			std::hash<const NodeImp*> h;
+			return h(p.first) ^ (h(p.second) * 31);
+		}
+	};
+
+	// order the pair so either direction of an element finds the same entry
+	static NodePair key(const NodeImp* a, const NodeImp* b)
+		{ return a < b ? NodePair(a, b) : NodePair(b, a); }
+
+	std::unordered_map<NodePair, std::vector<const ElementImp*>, NodePairHash> _byNodes;
 };
 
 ////----------------------------------------------------------------------------------------
@@ -252,34 +214,6 @@ private:
 //    MaxLoadCaseFinder& operator=(const MaxLoadCaseFinder& a);
 //};
 
-//----------------------------------------------------------------------------------------
-// class CountAttachedNodes
-//
-//      class to count elements attached to the nodes in the list.
-//
-//----------------------------------------------------------------------------------------
-class CountAttachedNodes
-{
-public:
-	CountAttachedNodes(const NodeImp* n)
-		: itsNode(n)
-		, itsCount(0)
-	{
-	}
-	
-	void operator() (const ElementImp* elem, DlInt32)
-	{
-		if (itsNode == elem->StartNode() || itsNode == elem->EndNode())
-			itsCount++;
-	}
-	
-	const NodeImp*	itsNode;
-	DlInt32 		itsCount;
-private:
-    CountAttachedNodes(const CountAttachedNodes& a);
-    CountAttachedNodes& operator=(const CountAttachedNodes& a);
-};
-
 //----------------------------------------------------------------------------------------
 // class GetElemConnect
 //
@@ -316,22 +250,51 @@ private:
 class DoAssembleStiffness
 {
 public:
-	DoAssembleStiffness(valarray<DlFloat64>& stiffness, const valarray<DlInt32>& maxa)
-		: _stiffness(stiffness), _maxa(maxa) {}
+	DoAssembleStiffness(valarray<DlFloat64>& stiffness, const valarray<DlInt32>& maxa,
+						const ElementMatrixCache* cache)
+		: _stiffness(stiffness), _maxa(maxa), _cache(cache) {}
 
-	void assembleStiffness(const ElementImp* elem);
-	void operator() (const ElementImp* elem, DlInt32)
+	void assembleStiffness(const ElementImp* elem, DlInt32 index);
+	void operator() (const ElementImp* elem, DlInt32 index)
 	{
-		assembleStiffness(elem);
+		assembleStiffness(elem, index);
 	}
 
 	valarray<DlFloat64>& _stiffness;
 	const valarray<DlInt32>& _maxa;
+	const ElementMatrixCache* _cache;
 private:
     DoAssembleStiffness(const DoAssembleStiffness& a);
     DoAssembleStiffness& operator=(const DoAssembleStiffness& a);
 };
 
+//----------------------------------------------------------------------------------------
+// class DoAssembleSparseStiffness
+//
+//      class to assemble the stiffness matrix into a sparse matrix. Matrix
+//		is any class with add(i, j, value), such as SparseLDL or PCGSolver.
+//
+//----------------------------------------------------------------------------------------
+template <class Matrix>
+class DoAssembleSparseStiffness
+{
+public:
+	DoAssembleSparseStiffness(Matrix& stiffness, const ElementMatrixCache* cache)
+		: _stiffness(stiffness), _cache(cache) {}
+
+	void assembleStiffness(const ElementImp* elem, DlInt32 index);
+	void operator() (const ElementImp* elem, DlInt32 index)
+	{
+		assembleStiffness(elem, index);
+	}
+
+	Matrix& _stiffness;
+	const ElementMatrixCache* _cache;
+private:
+    DoAssembleSparseStiffness(const DoAssembleSparseStiffness& a);
+    DoAssembleSparseStiffness& operator=(const DoAssembleSparseStiffness& a);
+};
+
 //----------------------------------------------------------------------------------------
 // class DoAssembleLoads
 //
@@ -341,17 +304,18 @@ private:
 class DoAssembleLoads
 {
 public:
-	DoAssembleLoads(valarray<DlFloat64>& rhs, LoadCase lc)
-		: _rhs(rhs), _lc(lc) {}
+	DoAssembleLoads(valarray<DlFloat64>& rhs, LoadCase lc, const ElementMatrixCache* cache)
+		: _rhs(rhs), _lc(lc), _cache(cache) {}
 
-	void assembleLoads(const ElementImp* elem);
-	void operator() (const ElementImp* elem, DlInt32)
+	void assembleLoads(const ElementImp* elem, DlInt32 index);
+	void operator() (const ElementImp* elem, DlInt32 index)
 	{
-		assembleLoads(elem);
+		assembleLoads(elem, index);
 	}
 
-	valarray<DlFloat64>& 	_rhs;
-	LoadCase				_lc;
+	valarray<DlFloat64>& 		_rhs;
+	LoadCase					_lc;
+	const ElementMatrixCache*	_cache;
     
 private:
     DoAssembleLoads(const DoAssembleLoads& a);
@@ -367,8 +331,8 @@ private:
 class DoRecoverForces
 {
 public:
-	DoRecoverForces(LoadCaseResults& results)
-		: _results(results)
+	DoRecoverForces(LoadCaseResults& results, const ElementMatrixCache* cache)
+		: _results(results), _cache(cache)
 	{
 		_results.InitRatios();
 	}
@@ -379,7 +343,12 @@ public:
 		recoverForces(elem, index);
 	}
 
-	LoadCaseResults&	_results;
+	//	store the forces from K u + FEF, which are chopped in place.
+	static void setForces(LoadCaseResults& results, const ElementImp* elem,
+						DlInt32 index, const DlInt32* dof, DlFloat64* forces);
+
+	LoadCaseResults&			_results;
+	const ElementMatrixCache*	_cache;
 private:
     DoRecoverForces(const DoRecoverForces& a);
     DoRecoverForces& operator=(const DoRecoverForces& a);
@@ -424,7 +393,32 @@ private:
 //
 //----------------------------------------------------------------------------------------
 ElementList::ElementList()
+	: itsVersion(nullptr)
+	, itsGridValid(false)
+	, itsGridGeometry(0)
+	, itsGridLength(0)
+	, itsAttachedValid(false)
+	, itsAttachedConnectivity(0)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::SetVersion
+//
+//      give the elements, and those added later, the stamp of the structure.
+//
+//  StructureVersion* version  -> the stamp.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::SetVersion(StructureVersion* version)
 {
+	itsVersion = version;
+	for (DlInt32 i = 0; i < Length(); i++)
+		ElementAt(i)->SetVersion(version);
+	itsGridValid = false;
+	itsAttachedValid = false;
 }
 
 //----------------------------------------------------------------------------------------
@@ -453,10 +447,30 @@ ElementList::GetListID() const
 ElementEnumerator 
 ElementList::Attached(const NodeList* nodes) const
 {
-	GetAttachedNodes	a(nodes);
-	Foreach(a);
+	const AttachedMap& index = attachedIndex();
+	std::vector<ElementImp*> elems;
+	for (DlInt32 i = 0; i < nodes->Length(); i++) {
+		const std::vector<ElementImp*>& a = attached(index, nodes->ElementAt(i));
+		elems.insert(elems.end(), a.begin(), a.end());
+	}
 	
-	return a._elemList;
+	return inListOrder(elems);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::Attached
+//
+//      Return a list of elements attached to the node. 
+//
+//  const NodeImp* node        -> The node
+//
+//  returns ElementEnumerator  <- The connected elements, in list order.
+//----------------------------------------------------------------------------------------
+ElementEnumerator 
+ElementList::Attached(const NodeImp* node) const
+{
+	std::vector<ElementImp*> elems(attached(attachedIndex(), node));
+	return inListOrder(elems);
 }
 
 
@@ -489,15 +503,30 @@ ElementList::Select(const NodeList* nodes) const
 ElementEnumerator 
 ElementList::Select(const WorldRect& r) const
 {
-	ElementSelector s(r);
-	Foreach(s);
-	return s._list;
+	std::vector<std::pair<DlInt32, ElementImp*> > found;
+	auto hit = [this, &r, &found](ElementImp* e) {
+		// if both the nodes are in the rect
+		if ((e->StartNode()->Hit(r) && e->EndNode()->Hit(r)) || e->Hit(r))
+			found.push_back(std::make_pair(IndexOf(e), e));
+	};
+	grid().Search(r, hit);
+	std::sort(found.begin(), found.end());
+
+	std::vector<ElementImp*> elems(found.size());
+	for (std::size_t i = 0; i < found.size(); i++)
+		elems[i] = found[i].second;
+
+	ElementEnumerator list;
+	if (!elems.empty())
+		GetList(list)->Append(&elems[0], elems.size());
+	return list;
 }
 
 //----------------------------------------------------------------------------------------
 //  ElementList::SelectOne
 //
-//      select a single element within a small rectangle.
+//      select a single element within a small rectangle. Of the elements
+//		near enough, the first in the list.
 //
 //  const WorldRect & r    -> the rectangle around the desired point.
 //  const WorldRect & r    <-> the location along the element.
@@ -510,18 +539,160 @@ ElementList::SelectOne(const WorldRect & r, DlFloat64& loc) const
 	WorldPoint c(r.center());
 	DlFloat64 tol(r.width()/2.0);
 
-	Reset();
-	
-	while(HasMore()) {
-		const ElementImp* e = Next();
+	ElementImp* first = 0;
+	DlInt32 firstIndex = 0;
+	auto near = [this, &c, tol, &loc, &first, &firstIndex](ElementImp* e) {
 		WorldPoint p = c.transform(e->StartNode()->GetCoords(), e->EndNode()->GetCoords());
-		if (p.x() > 0 && p.x() < e->Length() && fabs(p.y()) < tol)
-		{
-			loc = p.x() / e->Length();
-			return const_cast<ElementImp*>(e);
+		if (p.x() > 0 && p.x() < e->Length() && fabs(p.y()) < tol) {
+			DlInt32 index = IndexOf(e);
+			if (!first || index < firstIndex) {
+				first = e;
+				firstIndex = index;
+				loc = p.x() / e->Length();
+			}
+		}
+	};
+
+	//	an element near enough passes within tol of c
+	if (tol > 0)
+		grid().Search(WorldRect(c, tol), near);
+	return first;
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::Moved
+//
+//      move the elements attached to nodes that were just moved to their new
+//		cells. If anything else moved since the grid was built, it is left to
+//		be built again.
+//
+//  const NodeList* movedNodes -> the nodes moved.
+//  DlUInt32 geometry          -> the Geometry stamp before they moved.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::Moved(const NodeList* movedNodes, DlUInt32 geometry)
+{
+	if (!itsVersion || !itsGridValid || itsGridGeometry != geometry)
+		return;
+
+	const AttachedMap& index = attachedIndex();
+	for (DlInt32 i = 0; i < movedNodes->Length(); i++) {
+		for (ElementImp* e : attached(index, movedNodes->ElementAt(i)))
+			itsGrid.Insert(e, WorldRect(e->StartNode()->GetCoords(), e->EndNode()->GetCoords()));
+	}
+	itsGridGeometry = itsVersion->Geometry();
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::Changed                                                        protected
+//
+//      add or remove an element from the grid and the attached index.
+//
+//  bool isAdd             -> true if added.
+//  ElementImp* elem       -> the element.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::Changed(bool isAdd, ElementImp* elem)
+{
+	if (isAdd && itsVersion)
+		elem->SetVersion(itsVersion);
+	
+	if (itsGridValid) {
+		if (isAdd)
+			itsGrid.Insert(elem, WorldRect(elem->StartNode()->GetCoords(), elem->EndNode()->GetCoords()));
+		else
+			itsGrid.Remove(elem);
+	}
+	
+	if (itsAttachedValid) {
+		if (isAdd) {
+			//	adding an element already in the list sends it again.
+			AttachedMap::const_iterator i = itsAttached.find(elem->StartNode());
+			if (i == itsAttached.end() || std::find(i->second.begin(), i->second.end(), elem) == i->second.end())
+				attach(elem);
+		} else {
+			detach(elem, elem->StartNode(), elem->EndNode());
 		}
 	}
-	return 0;
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::Changed                                                        protected
+//
+//      add or remove elements from the grid and the attached index. When
+//		most of the list changed, they are built again when next needed.
+//
+//  bool isAdd                                         -> true if added.
+//  const EnumeratorImp<ElementImp, Element>* list     -> the elements.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::Changed(bool isAdd, const EnumeratorImp<ElementImp, Element>* list)
+{
+	if (isAdd && itsVersion) {
+		for (DlInt32 i = 0; i < list->Length(); i++)
+			list->ElementAt(i)->SetVersion(itsVersion);
+	}
+	
+	if (list == this || list->Length() > Length()) {
+		itsGridValid = false;
+		itsGrid.Reset(1);
+		itsAttachedValid = false;
+		itsAttached.clear();
+		return;
+	}
+
+	for (DlInt32 i = 0; i < list->Length(); i++)
+		Changed(isAdd, list->ElementAt(i));
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::grid                                                             private
+//
+//      return the grid, building it if nodes moved or twice as many elements
+//		were added since it was built. The cells are about the size of an
+//		element, or larger if that would make too many.
+//
+//  returns const SpatialGrid<ElementImp>& <- the grid.
+//----------------------------------------------------------------------------------------
+const SpatialGrid<ElementImp>&
+ElementList::grid() const
+{
+	DlInt32 count = Length();
+	if (itsVersion && itsGridValid && itsGridGeometry == itsVersion->Geometry()
+			&& count <= 2 * itsGridLength + 64)
+		return itsGrid;
+
+	WorldRect bounds;
+	DlFloat64 size = 0;
+	for (DlInt32 i = 0; i < count; i++) {
+		const ElementImp* e = ElementAt(i);
+		WorldRect r(e->StartNode()->GetCoords(), e->EndNode()->GetCoords());
+		if (i == 0)
+			bounds = r;
+		else
+			bounds += r;
+		size += std::max(r.width(), r.height());
+	}
+
+	if (count > 0)
+		size /= count;
+
+	itsGrid.Reset(SpatialGrid<ElementImp>::ChooseCellSize(bounds, count, size));
+	for (DlInt32 i = 0; i < count; i++) {
+		ElementImp* e = ElementAt(i);
+		itsGrid.Insert(e, WorldRect(e->StartNode()->GetCoords(), e->EndNode()->GetCoords()));
+	}
+
+	itsGridValid = itsVersion != nullptr;
+	itsGridGeometry = itsVersion ? itsVersion->Geometry() : 0;
+	itsGridLength = count;
+	return itsGrid;
 }
 
 //----------------------------------------------------------------------------------------
@@ -536,9 +707,7 @@ ElementList::SelectOne(const WorldRect & r, DlFloat64& loc) const
 DlInt32
 ElementList::CountAttached(const NodeImp* n) const
 {
-	CountAttachedNodes c(n);
-	Foreach(c);
-	return c.itsCount;
+	return attached(attachedIndex(), n).size();
 }
 
 //----------------------------------------------------------------------------------------
@@ -554,9 +723,11 @@ ElementList::CountAttached(const NodeImp* n) const
 bool
 ElementList::IsDuplicate(const NodeImp* n1, const NodeImp* n2) const
 {
-	Reset();
-	while(HasMore()) {
-		const ElementImp* e = Next();
+	//	such an element is attached to both, so look through the shorter list.
+	const AttachedMap& index = attachedIndex();
+	const std::vector<ElementImp*>& a1 = attached(index, n1);
+	const std::vector<ElementImp*>& a2 = attached(index, n2);
+	for (const ElementImp* e : a1.size() <= a2.size() ? a1 : a2) {
 
 		const NodeImp* startNode = e->StartNode();
 		if (startNode == n1 || startNode == n2) {
@@ -568,6 +739,160 @@ ElementList::IsDuplicate(const NodeImp* n1, const NodeImp* n2) const
 	return false;
 }
 
+//----------------------------------------------------------------------------------------
+//  ElementList::Reconnect
+//
+//      connect an element to other nodes. If the element is in this list, it is
+//		moved to its new place in the attached index and the grid.
+//
+//  ElementImp* e          -> the element.
+//  const NodeImp* start   -> the new start node.
+//  const NodeImp* end     -> the new end node.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::Reconnect(ElementImp* e, const NodeImp* start, const NodeImp* end)
+{
+	DlUInt32 connectivity = itsVersion ? itsVersion->Connectivity() : 0;
+	DlUInt32 geometry = itsVersion ? itsVersion->Geometry() : 0;
+	const NodeImp* oldStart = e->StartNode();
+	const NodeImp* oldEnd = e->EndNode();
+	
+	e->SetStartNode(start);
+	e->SetEndNode(end);
+	
+	bool listed = Contains(e);
+	if (itsVersion && itsAttachedValid && itsAttachedConnectivity == connectivity) {
+		if (listed) {
+			detach(e, oldStart, oldEnd);
+			attach(e);
+		}
+		itsAttachedConnectivity = itsVersion->Connectivity();
+	}
+	
+	if (itsVersion && itsGridValid && itsGridGeometry == geometry) {
+		if (listed)
+			itsGrid.Insert(e, WorldRect(e->StartNode()->GetCoords(), e->EndNode()->GetCoords()));
+		itsGridGeometry = itsVersion->Geometry();
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::attachedIndex                                                    private
+//
+//      return the index of the elements at each node, building it if an element
+//		was reconnected since it was built. A list without a stamp builds it
+//		each time.
+//
+//  returns const AttachedMap&     <- the index.
+//----------------------------------------------------------------------------------------
+const ElementList::AttachedMap&
+ElementList::attachedIndex() const
+{
+	if (!itsVersion || !itsAttachedValid || itsAttachedConnectivity != itsVersion->Connectivity()) {
+		itsAttached.clear();
+		itsAttached.reserve(Length());
+		for (DlInt32 i = 0; i < Length(); i++)
+			attach(ElementAt(i));
+		
+		itsAttachedValid = itsVersion != nullptr;
+		itsAttachedConnectivity = itsVersion ? itsVersion->Connectivity() : 0;
+	}
+	
+	return itsAttached;
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::attached                                                          private
+//
+//      return the elements attached to a node.
+//
+//  const AttachedMap& index               -> the index, from attachedIndex.
+//  const NodeImp* n                       -> the node.
+//
+//  returns const std::vector<ElementImp*>& <- the elements, in no particular order.
+//----------------------------------------------------------------------------------------
+const std::vector<ElementImp*>&
+ElementList::attached(const AttachedMap& index, const NodeImp* n)
+{
+	static const std::vector<ElementImp*> sNone;
+	AttachedMap::const_iterator i = index.find(n);
+	return i == index.end() ? sNone : i->second;
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::attach                                                           private
+//
+//      add an element to the index under each of its nodes.
+//
+//  ElementImp* e          -> the element.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::attach(ElementImp* e) const
+{
+	itsAttached[e->StartNode()].push_back(e);
+	if (e->EndNode() != e->StartNode())
+		itsAttached[e->EndNode()].push_back(e);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::detach                                                           private
+//
+//      remove an element from the index under the nodes it was attached to.
+//
+//  ElementImp* e          -> the element.
+//  const NodeImp* start   -> its start node when it was added.
+//  const NodeImp* end     -> its end node when it was added.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::detach(ElementImp* e, const NodeImp* start, const NodeImp* end) const
+{
+	const NodeImp* nodes[2] = { start, end };
+	for (DlInt32 k = 0; k < (start == end ? 1 : 2); k++) {
+		AttachedMap::iterator i = itsAttached.find(nodes[k]);
+		if (i == itsAttached.end())
+			continue;
+		
+		std::vector<ElementImp*>& elems = i->second;
+		elems.erase(std::remove(elems.begin(), elems.end(), e), elems.end());
+		if (elems.empty())
+			itsAttached.erase(i);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::inListOrder                                                      private
+//
+//      return a list of elements in the order they are in this list, once each.
+//
+//  const std::vector<ElementImp*>& elems  -> the elements.
+//
+//  returns ElementEnumerator              <- the list.
+//----------------------------------------------------------------------------------------
+ElementEnumerator
+ElementList::inListOrder(const std::vector<ElementImp*>& elems) const
+{
+	std::vector<std::pair<DlInt32, ElementImp*> > found(elems.size());
+	for (std::size_t i = 0; i < elems.size(); i++)
+		found[i] = std::make_pair(IndexOf(elems[i]), elems[i]);
+	std::sort(found.begin(), found.end());
+	found.erase(std::unique(found.begin(), found.end()), found.end());
+	
+	std::vector<ElementImp*> ordered(found.size());
+	for (std::size_t i = 0; i < found.size(); i++)
+		ordered[i] = found[i].second;
+	
+	ElementEnumerator list;
+	if (!ordered.empty())
+		GetList(list)->Append(&ordered[0], ordered.size());
+	return list;
+}
+
 //
 //	PropFinder
 //
@@ -805,7 +1130,7 @@ void
 ElementList::MapNodes(const NodeCloneMap& nodeMap, ElementEnumerator& changedElems, 
 				NodeVector& startNodes, NodeVector& endNodes)
 {
-	NodeMapper mapper(nodeMap);
+	NodeMapper mapper(*this, nodeMap);
 	Foreach(mapper);
 	
 	changedElems = mapper._list;
@@ -880,53 +1205,356 @@ ElementList::GetConnectivity(DlInt32 numEqs, std::valarray<DlInt32>& connect,
 //----------------------------------------------------------------------------------------
 //  ElementList::AssembleStiffness
 //
-//      Assemble the stiffness matrix for the structure.
+//      Assemble the stiffness matrix for the structure. The elements are taken
+//		in list order, or in the order of the parallel assembly if threadOrder is
+//		set, which costs a coloring of the elements but gives the same matrix as
+//		one assembled with any number of threads.
 //
 //  std::valarray<DlFloat64>& mat      <-> the matrix to build.
 //  const std::valarray<DlInt32>& maxa -> the offsets to the diagonal.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
+//  bool threadOrder                   -> true to sum in the parallel order.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
 ElementList::AssembleStiffness(std::valarray<DlFloat64>& mat, 
-					const std::valarray<DlInt32>& maxa) const
+					const std::valarray<DlInt32>& maxa, const ElementMatrixCache* cache,
+					bool threadOrder) const
+{
+	DoAssembleStiffness a(mat, maxa, cache);
+	
+	if (!threadOrder) {
+		Foreach(a);
+		return;
+	}
+	
+	std::vector<DlInt32> order;
+	std::vector<DlInt32> colorStarts;
+	ColorElements(static_cast<DlInt32>(maxa.size()) - 1, order, colorStarts);
+	
+	for (DlInt32 e : order)
+		a.assembleStiffness(ElementAt(e), e);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::AssembleStiffness
+//
+//      Assemble the stiffness matrix for the structure using the threads in pool.
+//		The elements are colored so that no two elements of a color share an 
+//		equation. The colors are assembled in order and the elements of each 
+//		color in parallel, so every matrix term is summed in the same order 
+//		however many threads run.
+//
+//  std::valarray<DlFloat64>& mat      <-> the matrix to build.
+//  const std::valarray<DlInt32>& maxa -> the diagonal indices.
+//  DlThreadPool& pool                 -> the threads to use.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::AssembleStiffness(std::valarray<DlFloat64>& mat, 
+					const std::valarray<DlInt32>& maxa, DlThreadPool& pool,
+					const ElementMatrixCache* cache) const
+{
+	std::vector<DlInt32> order;
+	std::vector<DlInt32> colorStarts;
+	ColorElements(static_cast<DlInt32>(maxa.size()) - 1, order, colorStarts);
+	
+	for (size_t c = 0; c + 1 < colorStarts.size(); c++) {
+		pool.ParallelFor(colorStarts[c], colorStarts[c+1], [&](DlInt32 k) {
+			DoAssembleStiffness a(mat, maxa, cache);
+			a.assembleStiffness(ElementAt(order[k]), order[k]);
+		});
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::AssembleStiffness
+//
+//      Assemble the stiffness matrix for the structure into a file. The columns
+//		are built in panels that fit in memory. Each element is listed once under
+//		every panel holding one of its equations, and each panel takes the terms
+//		of its own elements, in list order, before it is written.
+//
+//  SkylineFile& mat                   <-> the matrix to build.
+//  const std::valarray<DlInt32>& maxa -> the diagonal indices.
+//  DlInt64 memory                     -> the bytes of each panel.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::AssembleStiffness(SkylineFile& mat, const std::valarray<DlInt32>& maxa,
+					DlInt64 memory, const ElementMatrixCache* cache) const
+{
+	DlInt32 neq = static_cast<DlInt32>(maxa.size()) - 1;
+	DlInt64 limit = std::max<DlInt64>(memory / sizeof(DlFloat64), 1);
+	DlInt32 count = Length();
+	
+	//	an element may reach several panels, so compute each matrix once
+	ElementMatrixCache built;
+	if (!cache) {
+		built.Build(*this);
+		cache = &built;
+	}
+	
+	DlOneBasedConstIter<DlInt32> diag(maxa);
+	std::vector<DlInt32> lasts;
+	for (DlInt32 first = 1, last; first <= neq; first = last + 1) {
+		last = first;
+		while (last < neq && diag[last+2] - diag[first] <= limit)
+			last++;
+		lasts.push_back(last);
+	}
+	
+	std::vector<std::vector<DlInt32>> panelElems(lasts.size());
+	for (DlInt32 e = 0; e < count; e++) {
+		const DlInt32* dof = cache->GetDOF(e);
+		for (DlInt32 i = 0; i < 2*DOF_PER_NODE; i++) {
+			if (dof[i] <= 0)
+				continue;
+			size_t p = std::lower_bound(lasts.begin(), lasts.end(), dof[i]) - lasts.begin();
+			if (panelElems[p].empty() || panelElems[p].back() != e)
+				panelElems[p].push_back(e);
+		}
+	}
+	
+	std::vector<DlFloat64> panel;
+	DlInt32 first = 1;
+	for (size_t p = 0; p < lasts.size(); p++) {
+		DlInt32 last = lasts[p];
+		DlInt64 base = diag[first] - 1;
+		panel.assign(diag[last+1] - diag[first], 0.0);
+		
+		for (DlInt32 e : panelElems[p]) {
+			const DlFloat64* m = cache->GetMatrix(e);
+			const DlInt32* dof = cache->GetDOF(e);
+			
+			//	the term in row r and column c, with c in the panel
+			for (DlInt32 i = 0; i < 2*DOF_PER_NODE; ++i) {
+				if (dof[i] <= 0)
+					continue;
+				for (DlInt32 j = i; j < 2*DOF_PER_NODE; j++) {
+					if (dof[j] <= 0)
+						continue;
+					DlInt32 r = std::min(dof[i], dof[j]);
+					DlInt32 c = std::max(dof[i], dof[j]);
+					if (c >= first && c <= last)
+						panel[diag[c] + c - r - 1 - base] += m[i * 2*DOF_PER_NODE + j];
+				}
+			}
+		}
+		
+		mat.write(base, panel.size(), panel.data());
+		first = last + 1;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::ColorElements                                                     private
+//
+//      Greedily color the elements in list order, giving each the lowest color
+//		not already used by an element sharing one of its equations.
+//
+//  DlInt32 numEqs                     -> the number of equations.
+//  std::vector<DlInt32>& order        <- element indices sorted by color.
+//  std::vector<DlInt32>& colorStarts  <- start of each color in order, plus the end.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::ColorElements(DlInt32 numEqs, std::vector<DlInt32>& order,
+						std::vector<DlInt32>& colorStarts) const
+{
+	DlInt32 count = Length();
+	std::vector<DlInt32> colors(count);
+	std::vector<DlInt32> colorCounts;
+	
+	//	the colors used by the elements attached to each equation.
+	std::vector<std::vector<DlInt32>> used(numEqs + 1);
+	std::vector<bool> taken;
+	
+	for (DlInt32 e = 0; e < count; e++) {
+		DlInt32 dof[2*DOF_PER_NODE];
+		ElementAt(e)->GetDOF(dof);
+		
+		taken.assign(colorCounts.size() + 1, false);
+		for (DlInt32 i = 0; i < 2*DOF_PER_NODE; i++) {
+			if (dof[i] > 0) {
+				for (DlInt32 c : used[dof[i]])
+					taken[c] = true;
+			}
+		}
+		
+		DlInt32 color = 0;
+		while (taken[color])
+			color++;
+		
+		colors[e] = color;
+		if (color == static_cast<DlInt32>(colorCounts.size()))
+			colorCounts.push_back(0);
+		colorCounts[color]++;
+		
+		for (DlInt32 i = 0; i < 2*DOF_PER_NODE; i++) {
+			if (dof[i] > 0 && (used[dof[i]].empty() || used[dof[i]].back() != color))
+				used[dof[i]].push_back(color);
+		}
+	}
+	
+	colorStarts.assign(colorCounts.size() + 1, 0);
+	for (size_t c = 0; c < colorCounts.size(); c++)
+		colorStarts[c+1] = colorStarts[c] + colorCounts[c];
+	
+	//	keep list order within each color
+	std::vector<DlInt32> next(colorStarts.begin(), colorStarts.end() - 1);
+	order.resize(count);
+	for (DlInt32 e = 0; e < count; e++)
+		order[next[colors[e]]++] = e;
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::AssembleStiffness
+//
+//      Assemble the stiffness matrix for the structure into a sparse matrix.
+//
+//  SparseLDL& mat                     <-> the matrix to build.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::AssembleStiffness(SparseLDL& mat, const ElementMatrixCache* cache) const
 {
-	DoAssembleStiffness a(mat, maxa);
+	DoAssembleSparseStiffness<SparseLDL> a(mat, cache);
+	Foreach(a);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::AssembleStiffness
+//
+//      Assemble the stiffness matrix for the structure for the iterative solver.
+//
+//  PCGSolver& mat                     <-> the matrix to build.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::AssembleStiffness(PCGSolver& mat, const ElementMatrixCache* cache) const
+{
+	DoAssembleSparseStiffness<PCGSolver> a(mat, cache);
 	Foreach(a);
 }
 
 //----------------------------------------------------------------------------------------
 //  ElementList::AssembleLoads
 //
-//      Assemble the load vector.
+//      Assemble the load vector. The list is indexed rather than iterated, so
+//		several load cases can be assembled at once.
 //
 //  std::valarray<DlFloat64>& rhs  <-> the vector of loads.
 //  LoadCase lc                    -> the current load case.
+//  const ElementMatrixCache* cache -> the element matrices, or nullptr.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
-ElementList::AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc) const
+ElementList::AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc,
+					const ElementMatrixCache* cache) const
 {
-	DoAssembleLoads a(rhs, lc);
-	Foreach(a);
+	DoAssembleLoads a(rhs, lc, cache);
+	DlInt32 count = Length();
+	for (DlInt32 i = 0; i < count; i++)
+		a(ElementAt(i), i);
 }
 
 //----------------------------------------------------------------------------------------
 //  ElementList::RecoverResults
 //
-//      Recover the reactions and forces at StartNode within each element.
+//      Recover the reactions and forces at StartNode within each element. Like
+//		AssembleLoads, this may run for several load cases at once.
 //
-//  LoadCase lc                -> the current load case
-//  LoadCaseResults& results   <-> the results.
+//  LoadCaseResults& results           <-> the results.
+//  const ElementMatrixCache* cache    -> the element matrices, or nullptr.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
-ElementList::RecoverResults(LoadCaseResults& results) const
+ElementList::RecoverResults(LoadCaseResults& results, const ElementMatrixCache* cache) const
 {
-	DoRecoverForces a(results);
-	Foreach(a);
+	DoRecoverForces a(results, cache);
+	DlInt32 count = Length();
+	for (DlInt32 i = 0; i < count; i++)
+		a(ElementAt(i), i);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementList::RecoverResults
+//
+//      Recover the results of several load cases. The cases are split into
+//		batches; for each element of a batch the displacements of every case
+//		are gathered and multiplied by the cached matrix in one product. The
+//		batches are independent, so they run in parallel when there is a pool,
+//		and each case gets the same results as when recovered alone.
+//
+//  const std::vector<LoadCaseResults*>& results   <-> the results of each case.
+//  const ElementMatrixCache& cache                -> the element matrices.
+//  DlThreadPool* pool                             -> the threads to use, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementList::RecoverResults(const std::vector<LoadCaseResults*>& results,
+					const ElementMatrixCache& cache, DlThreadPool* pool) const
+{
+	const DlInt32 kBatch = 16;
+	const DlInt32 kElemDOF = 2*DOF_PER_NODE;
+	
+	DlInt32 cases = static_cast<DlInt32>(results.size());
+	DlInt32 batches = (cases + kBatch - 1) / kBatch;
+	DlInt32 count = Length();
+	
+	auto recover = [&](DlInt32 b) {
+		DlInt32 first = b * kBatch;
+		DlInt32 n = std::min(kBatch, cases - first);
+		
+		DlFloat64 disp[kBatch * kElemDOF];
+		DlFloat64 forces[kBatch * kElemDOF];
+		
+		for (DlInt32 c = 0; c < n; c++)
+			results[first + c]->InitRatios();
+		
+		for (DlInt32 e = 0; e < count; e++) {
+			const ElementImp* elem = ElementAt(e);
+			
+			for (DlInt32 c = 0; c < n; c++) {
+				const LoadCaseResults* res = results[first + c];
+				DlFloat64* d = disp + c * kElemDOF;
+				DlFloat64* f = forces + c * kElemDOF;
+				
+				res->GetDisplacement(elem->StartNode(), d);
+				res->GetDisplacement(elem->EndNode(), d + DOF_PER_NODE);
+				if (!elem->FixedEndForces(f, res->GetLoadCase()))
+					std::memset(f, 0, kElemDOF * sizeof(DlFloat64));
+			}
+			
+			cache.Multiply(e, disp, forces, n);
+			
+			for (DlInt32 c = 0; c < n; c++) {
+				DoRecoverForces::setForces(*results[first + c], elem, e, 
+					cache.GetDOF(e), forces + c * kElemDOF);
+			}
+		}
+	};
+	
+	if (pool && batches > 1) {
+		pool->ParallelFor(0, batches, recover);
+	} else {
+		for (DlInt32 b = 0; b < batches; b++)
+			recover(b);
+	}
 }
 
 //----------------------------------------------------------------------------------------
@@ -1090,28 +1718,38 @@ GetElemConnect::assemble(const ElementImp* elem)
 //      assemble the stiffness for this element.
 //
 //  const ElementImp* elem -> the element
+//  DlInt32 index          -> the index of the element in the list.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void 
-DoAssembleStiffness::assembleStiffness(const ElementImp* elem)
+DoAssembleStiffness::assembleStiffness(const ElementImp* elem, DlInt32 index)
 {
-	DlInt32 dof[2*DOF_PER_NODE];
-	DlMatrix<DlFloat64> m(2*DOF_PER_NODE,2*DOF_PER_NODE);
-	elem->Stiffness(m, false);
+	DlInt32 elemDof[2*DOF_PER_NODE];
+	ElementMatrix em;
+	const DlFloat64* m;
+	const DlInt32* dof;
+	
+	if (_cache) {
+		m = _cache->GetMatrix(index);
+		dof = _cache->GetDOF(index);
+	} else {
+		elem->Stiffness(em, false);
+		elem->GetDOF(elemDof);
+		m = em.data();
+		dof = elemDof;
+	}
 	
 	DlOneBasedConstIter<DlInt32>	maxa(_maxa);
 	DlOneBasedIter<DlFloat64>		a(_stiffness);
 	
-	elem->GetDOF(dof);
-	
 	for (DlInt32 i = 0; i < 2*DOF_PER_NODE; ++i) {
 		DlInt32 r = dof[i];
 		if (r > 0) {
 			for (DlInt32 j = i; j < 2*DOF_PER_NODE; j++) {
 				DlInt32 c = dof[j];
 				if (c > 0) {
-					DlFloat64 kVal = m[i+1][j+1];
+					DlFloat64 kVal = m[i * 2*DOF_PER_NODE + j];
 					if (dof[i] < dof[j]) {
 						r = dof[i];
 						c = dof[j];
@@ -1129,17 +1767,57 @@ DoAssembleStiffness::assembleStiffness(const ElementImp* elem)
 	}
 }
 
+//----------------------------------------------------------------------------------------
+//  DoAssembleSparseStiffness::assembleStiffness
+//
+//      assemble the stiffness for this element.
+//
+//  const ElementImp* elem -> the element
+//  DlInt32 index          -> the index of the element in the list.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class Matrix>
+void 
+DoAssembleSparseStiffness<Matrix>::assembleStiffness(const ElementImp* elem, DlInt32 index)
+{
+	DlInt32 elemDof[2*DOF_PER_NODE];
+	ElementMatrix em;
+	const DlFloat64* m;
+	const DlInt32* dof;
+	
+	if (_cache) {
+		m = _cache->GetMatrix(index);
+		dof = _cache->GetDOF(index);
+	} else {
+		elem->Stiffness(em, false);
+		elem->GetDOF(elemDof);
+		m = em.data();
+		dof = elemDof;
+	}
+	
+	for (DlInt32 i = 0; i < 2*DOF_PER_NODE; ++i) {
+		if (dof[i] > 0) {
+			for (DlInt32 j = i; j < 2*DOF_PER_NODE; j++) {
+				if (dof[j] > 0)
+					_stiffness.add(dof[i], dof[j], m[i * 2*DOF_PER_NODE + j]);
+			}
+		}
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  DoAssembleLoads::assembleLoads
 //
 //      assemble the load vector for this element.
 //
 //  const ElementImp* elem -> the element
+//  DlInt32 index          -> the index of the element in the list.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void 
-DoAssembleLoads::assembleLoads(const ElementImp* elem)
+DoAssembleLoads::assembleLoads(const ElementImp* elem, DlInt32 index)
 {
 	DlFloat64 fixEndForce[2*DOF_PER_NODE];
 	DlFloat64 disp[2*DOF_PER_NODE];
@@ -1174,18 +1852,25 @@ DoAssembleLoads::assembleLoads(const ElementImp* elem)
 			}
 			
 			if (hasDisp) {
-				DlMatrix<DlFloat64> m(2*DOF_PER_NODE,2*DOF_PER_NODE);
-				elem->Stiffness(m, true);
+				ElementMatrix em;
+				const DlFloat64* m;
+				if (_cache) {
+					m = _cache->GetMatrix(index);
+				} else {
+					elem->Stiffness(em, true);
+					m = em.data();
+				}
+				
 				DlInt32* dofPtr = dof;
 				//	compute the fixed end forces 
-				for (DlInt32 i = 1; i <= 2*DOF_PER_NODE; ++i, ++dofPtr) {
+				for (DlInt32 i = 0; i < 2*DOF_PER_NODE; ++i, ++dofPtr) {
 					if (*dofPtr > 0) {
 						
 						DlFloat* dPtr = disp;
 						DlFloat64 sum = 0;
-						DlSliceIter<DlFloat64> row(m.row(i));
+						const DlFloat64* row = m + i * 2*DOF_PER_NODE;
 						
-						for (DlInt32 j = 1; j <= 2*DOF_PER_NODE; ++j, ++dPtr) {
+						for (DlInt32 j = 0; j < 2*DOF_PER_NODE; ++j, ++dPtr) {
 							sum += row[j] * (*dPtr);
 						}
 						
@@ -1204,50 +1889,82 @@ DoAssembleLoads::assembleLoads(const ElementImp* elem)
 //      recover the forces for this element.
 //
 //  const ElementImp* elem -> the element
+//  DlInt32 index          -> the index of the element in the list.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
 DoRecoverForces::recoverForces(const ElementImp* elem, DlInt32 index)
 {
-	DlInt32 dof[2*DOF_PER_NODE];
-	DlMatrix<DlFloat64> m(2*DOF_PER_NODE,2*DOF_PER_NODE);
+	DlInt32 elemDof[2*DOF_PER_NODE];
 	DlFloat64 fixEndForce[2*DOF_PER_NODE];
 	DlFloat64 displacements[2*DOF_PER_NODE];
 
-	elem->GetDOF(dof);
-
 	_results.GetDisplacement(elem->StartNode(), displacements);
 	_results.GetDisplacement(elem->EndNode(), displacements+DOF_PER_NODE);
 
-	elem->Stiffness(m, true);
 	if (!elem->FixedEndForces(fixEndForce, _results.GetLoadCase()))
 		std::memset(fixEndForce, 0, sizeof(fixEndForce));
+	
+	if (_cache) {
+		_cache->Multiply(index, displacements, fixEndForce, 1);
+		setForces(_results, elem, index, _cache->GetDOF(index), fixEndForce);
+		return;
+	}
+	
+	ElementMatrix m;
+	elem->Stiffness(m, true);
+	elem->GetDOF(elemDof);
 		
 	DlFloat64* outPtr = fixEndForce;
 	for (DlInt32 i = 1; i <= 2*DOF_PER_NODE; ++i, ++outPtr) {
 		
 		DlFloat64 sum = *outPtr;
 		DlFloat64* inPtr = displacements;
-		DlSliceIter<DlFloat64> row(m.row(i));
+		ElementMatrix::Row row(m.row(i));
 		for (DlInt32 j = 1; j <= 2*DOF_PER_NODE; ++j, ++inPtr)
 			sum += row[j] * (*inPtr);
 		
-		 *outPtr = DlChop(sum, kFloatTolerance);
-		 
-		 if (dof[i-1] < 0)
-		 	_results.SetReaction(-dof[i-1], *outPtr);
+		*outPtr = sum;
+	}
+	
+	setForces(_results, elem, index, elemDof, fixEndForce);
+}
+
+//----------------------------------------------------------------------------------------
+//  DoRecoverForces::setForces                                                      static
+//
+//      store the reactions, end forces and ratios of an element from its node
+//		forces.
+//
+//  LoadCaseResults& results   <-> the results.
+//  const ElementImp* elem     -> the element
+//  DlInt32 index              -> the index of the element in the list.
+//  const DlInt32* dof         -> the element's equations.
+//  DlFloat64* forces          <-> the node forces, chopped on return.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+DoRecoverForces::setForces(LoadCaseResults& results, const ElementImp* elem,
+						DlInt32 index, const DlInt32* dof, DlFloat64* forces)
+{
+	for (DlInt32 i = 0; i < 2*DOF_PER_NODE; ++i) {
+		forces[i] = DlChop(forces[i], kFloatTolerance);
+		
+		if (dof[i] < 0)
+			results.SetReaction(-dof[i], forces[i]);
 	}
 	
 	//	ok now we have in residuals, the node forces due to the displacement.
     //	convert to element local forces    
-	_results.SetEndForces(index, elem->GetLocalForce(fixEndForce));	
+	results.SetEndForces(index, elem->GetLocalForce(forces));	
 
 	//	compute the scale factors
-	_results.SetDispRatio(elem->MaxDisplacementPerLength(index, _results));
-	_results.SetShearRatio(elem->MaxForcePerLength(1, index, _results));
-	_results.SetAxialRatio(elem->MaxForcePerLength(0, index, _results));
-	_results.SetMomentRatio(elem->MaxForcePerLength(2, index, _results));
+	results.SetDispRatio(elem->MaxDisplacementPerLength(index, results));
+	results.SetShearRatio(elem->MaxForcePerLength(1, index, results));
+	results.SetAxialRatio(elem->MaxForcePerLength(0, index, results));
+	results.SetMomentRatio(elem->MaxForcePerLength(2, index, results));
 }
 
 //	eof
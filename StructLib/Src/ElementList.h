@@ -38,6 +38,7 @@
 
 #include <valarray>
 #include <set>
+#include <unordered_map>
 
 class	frame_data;
 class	StrInputStream;
@@ -46,6 +47,11 @@ class	Element;
 class	LoadCaseResults;
 class	ElemLoadList;
 class	PropertyList;
+class	SparseLDL;
+class	PCGSolver;
+class	DlThreadPool;
+class	ElementMatrixCache;
+class	SkylineFile;
 
 //--------------------------------------- Class ------------------------------------------
 
@@ -57,12 +63,28 @@ public:
 
 	ElementList();
 
+	//	give the elements the stamp of the structure the list holds. Without
+	//	one the grid and the attached index are built for each query.
+	void				SetVersion(StructureVersion* version);
+
+	//	the attached element queries look in an index of the elements at each
+	//	node, built when first needed and kept up to date as elements are
+	//	added, removed and reconnected. An element reconnected other than
+	//	through Reconnect has the index built again on the next query.
 	ElementEnumerator 	Attached(const NodeList* nodes) const;
+	ElementEnumerator 	Attached(const NodeImp* node) const;
 	ElementEnumerator	Select(const NodeList* nodes) const;
+	//	the hit tests search a grid of the element bounds, kept like the
+	//	grid of NodeList.
 	ElementEnumerator	Select(const WorldRect& rect) const;
 	ElementImp*			SelectOne(const WorldRect & r, DlFloat64& loc) const;
+	//	update the grid for the elements attached to nodes that were just
+	//	moved. geometry is the stamp's Geometry from before they moved.
+	void				Moved(const NodeList* movedNodes, DlUInt32 geometry);
 	DlInt32 			CountAttached(const NodeImp* node) const; 
 	bool				IsDuplicate(const NodeImp* n1, const NodeImp* n2) const;
+	//	connect e to start and end, updating the index and the grid.
+	void				Reconnect(ElementImp* e, const NodeImp* start, const NodeImp* end);
 
 	ElementEnumerator	FindAttachedProperty(const Property& prop) const;
 	ElementEnumerator	FindAttachedLoad(LoadCase lc, const ElementLoad& l) const;
@@ -89,12 +111,35 @@ public:
 	// build the starts vector by determining the minimum dof attached to each node.
 	void			SetStarts(std::valarray<DlInt32>& starts, DlInt32 maxDof) const;
 	
+	//	each of these takes the element matrices from cache when there is one,
+	//	rather than computing them.
+	//	threadOrder adds the elements in the order of the parallel assembly,
+	//	so the matrix is the same as one assembled with any number of threads.
 	void			AssembleStiffness(std::valarray<DlFloat64>& mat, 
-						const std::valarray<DlInt32>& maxa) const;
-
-	void			AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc) const;
-
-	void			RecoverResults(LoadCaseResults& results) const;
+						const std::valarray<DlInt32>& maxa,
+						const ElementMatrixCache* cache = nullptr,
+						bool threadOrder = false) const;
+	//	assemble in parallel. The result does not depend on the thread count.
+	void			AssembleStiffness(std::valarray<DlFloat64>& mat, 
+						const std::valarray<DlInt32>& maxa, DlThreadPool& pool,
+						const ElementMatrixCache* cache = nullptr) const;
+	//	assemble into a file, a panel of columns of about memory bytes at a time.
+	void			AssembleStiffness(SkylineFile& mat, const std::valarray<DlInt32>& maxa,
+						DlInt64 memory, const ElementMatrixCache* cache = nullptr) const;
+	void			AssembleStiffness(SparseLDL& mat,
+						const ElementMatrixCache* cache = nullptr) const;
+	void			AssembleStiffness(PCGSolver& mat,
+						const ElementMatrixCache* cache = nullptr) const;
+
+	void			AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc,
+						const ElementMatrixCache* cache = nullptr) const;
+
+	void			RecoverResults(LoadCaseResults& results,
+						const ElementMatrixCache* cache = nullptr) const;
+	//	recover several load cases, multiplying each element's matrix by the
+	//	displacements of all of them at once.
+	void			RecoverResults(const std::vector<LoadCaseResults*>& results,
+						const ElementMatrixCache& cache, DlThreadPool* pool = nullptr) const;
 
 	//	build the list by reading it
 	void			Read(StrInputStream& inp, DlInt32 count, const frame_data& data);
@@ -104,6 +149,36 @@ public:
 	virtual DlUInt32	GetListID() const;
 	static const ElementList* GetList(const ElementEnumerator& l) { return l.GetList(); }
 	static ElementList* GetList(ElementEnumerator& l) { return l.GetList(); }
+
+protected:
+	virtual void	Changed(bool isAdd, ElementImp* elem);
+	virtual void	Changed(bool isAdd, const EnumeratorImp<ElementImp, Element>* list);
+
+private:
+	//	group the elements so no two in a group share an equation.
+	void			ColorElements(DlInt32 numEqs, std::vector<DlInt32>& order,
+						std::vector<DlInt32>& colorStarts) const;
+
+	typedef std::unordered_map<const NodeImp*, std::vector<ElementImp*> > AttachedMap;
+
+	const SpatialGrid<ElementImp>&	grid() const;
+	const AttachedMap&				attachedIndex() const;
+	static const std::vector<ElementImp*>&
+									attached(const AttachedMap& index, const NodeImp* n);
+	void							attach(ElementImp* e) const;
+	void							detach(ElementImp* e, const NodeImp* start, const NodeImp* end) const;
+	ElementEnumerator				inListOrder(const std::vector<ElementImp*>& elems) const;
+
+	StructureVersion*				itsVersion;
+
+	mutable SpatialGrid<ElementImp>	itsGrid;
+	mutable bool					itsGridValid;
+	mutable DlUInt32				itsGridGeometry;	//	itsVersion->Geometry when built
+	mutable DlInt32					itsGridLength;		//	element count when built
+
+	mutable AttachedMap				itsAttached;
+	mutable bool					itsAttachedValid;
+	mutable DlUInt32				itsAttachedConnectivity;	//	itsVersion->Connectivity when built
 };
 
 //--------------------------------------- Inlines ----------------------------------------
@@ -0,0 +1,173 @@
+/*+
+ *	File:		ElementMatrixCache.cpp
+ *
+ *	Contains:	Element stiffness matrices kept for one analysis
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "ElementMatrixCache.h"
+#include "ElementList.h"
+#include "DlThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+using namespace DlArray;
+
+//	elements whose matrices are computed by one task of the pool
+const DlInt32 kBuildChunk = 64;
+
+//--------------------------------------- Methods ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  ElementMatrixCache::ElementMatrixCache                                     constructor
+//
+//      construct an empty cache.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ElementMatrixCache::ElementMatrixCache()
+	: itsCount(0)
+	, itsMatrices(nullptr)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementMatrixCache::Build
+//
+//      compute the full stiffness and equations of every element. Each matrix
+//		is a multiple of kFixedMatrixAlign bytes, so aligning the first aligns
+//		them all.
+//
+//  const ElementList& elems   -> the elements.
+//  DlThreadPool* pool         -> the threads to use, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementMatrixCache::Build(const ElementList& elems, DlThreadPool* pool)
+{
+	static_assert(kMatrixSize * sizeof(DlFloat64) % kFixedMatrixAlign == 0,
+		"element matrices must keep their alignment");
+
+	itsCount = elems.Length();
+
+	const size_t pad = kFixedMatrixAlign / sizeof(DlFloat64);
+	itsStorage.assign(itsCount * kMatrixSize + pad, 0.0);
+	itsDOF.resize(itsCount * kElemDOF);
+
+	uintptr_t start = reinterpret_cast<uintptr_t>(itsStorage.data());
+	uintptr_t offset = (kFixedMatrixAlign - start % kFixedMatrixAlign) % kFixedMatrixAlign;
+	itsMatrices = itsStorage.data() + offset / sizeof(DlFloat64);
+
+	auto build = [&](DlInt32 chunk) {
+		DlInt32 last = std::min(itsCount, (chunk + 1) * kBuildChunk);
+		ElementMatrix m;
+		for (DlInt32 e = chunk * kBuildChunk; e < last; e++) {
+			const ElementImp* elem = elems.ElementAt(e);
+			elem->Stiffness(m, true);
+			std::copy(m.data(), m.data() + kMatrixSize, itsMatrices + e * kMatrixSize);
+			elem->GetDOF(&itsDOF[e * kElemDOF]);
+		}
+	};
+
+	DlInt32 chunks = (itsCount + kBuildChunk - 1) / kBuildChunk;
+	if (pool && chunks > 1) {
+		pool->ParallelFor(0, chunks, build);
+	} else {
+		for (DlInt32 c = 0; c < chunks; c++)
+			build(c);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementMatrixCache::SetMatrix
+//
+//      replace the stiffness of element e, whose equations are unchanged.
+//
+//  DlInt32 e              -> the element.
+//  const ElementMatrix& m -> its stiffness.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementMatrixCache::SetMatrix(DlInt32 e, const ElementMatrix& m)
+{
+	_DlAssert(e >= 0 && e < itsCount);
+	std::copy(m.data(), m.data() + kMatrixSize, itsMatrices + e * kMatrixSize);
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementMatrixCache::Clear
+//
+//      release the matrices.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementMatrixCache::Clear()
+{
+	itsCount = 0;
+	itsMatrices = nullptr;
+	itsStorage.clear();
+	itsStorage.shrink_to_fit();
+	itsDOF.clear();
+	itsDOF.shrink_to_fit();
+}
+
+//----------------------------------------------------------------------------------------
+//  ElementMatrixCache::Multiply
+//
+//      add the product of element e's stiffness and each of count vectors. The
+//		terms of each row are summed in column order, as an uncached product is.
+//
+//  DlInt32 e              -> the element.
+//  const DlFloat64* x     -> count vectors of kElemDOF displacements.
+//  DlFloat64* y           <-> count vectors of kElemDOF forces to add to.
+//  DlInt32 count          -> the number of vectors.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ElementMatrixCache::Multiply(DlInt32 e, const DlFloat64* x, DlFloat64* y,
+							DlInt32 count) const
+{
+	const DlFloat64* k = GetMatrix(e);
+
+	for (DlInt32 c = 0; c < count; c++, x += kElemDOF, y += kElemDOF) {
+		const DlFloat64* row = k;
+		for (DlInt32 i = 0; i < kElemDOF; i++, row += kElemDOF) {
+			DlFloat64 sum = y[i];
+			for (DlInt32 j = 0; j < kElemDOF; j++)
+				sum += row[j] * x[j];
+			y[i] = sum;
+		}
+	}
+}
+
+//	eof
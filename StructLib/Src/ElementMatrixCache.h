@@ -0,0 +1,88 @@
+/*+
+ *	File:		ElementMatrixCache.h
+ *
+ *	Contains:	Element stiffness matrices kept for one analysis
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_ElementMatrixCache
+#define _H_ElementMatrixCache
+
+//---------------------------------- Includes ----------------------------------
+
+#include "ElementImp.h"
+
+#include <vector>
+
+class ElementList;
+class DlThreadPool;
+
+//---------------------------------- Class -------------------------------------
+
+//	Holds the full stiffness and equation numbers of every element, so
+//	assembly, settlement loads and force recovery compute each matrix once.
+//	An analysis builds one for itself, or uses the one StiffnessCache keeps
+//	between analyses. The matrices are stored row major, one after another,
+//	in a single block aligned like ElementMatrix.
+class ElementMatrixCache
+{
+public:
+	enum { kElemDOF = 2*DOF_PER_NODE, kMatrixSize = kElemDOF * kElemDOF };
+
+	ElementMatrixCache();
+
+	//	compute the matrix of every element in elems, using pool if there is one.
+	void				Build(const ElementList& elems, DlThreadPool* pool = nullptr);
+
+	//	replace the matrix of element e.
+	void				SetMatrix(DlInt32 e, const ElementMatrix& m);
+
+	//	forget every matrix.
+	void				Clear();
+
+	DlInt32				GetCount() const { return itsCount; }
+
+	//	the 0-based row major stiffness of element e.
+	const DlFloat64*	GetMatrix(DlInt32 e) const { return itsMatrices + e * kMatrixSize; }
+
+	//	the equations of element e, as from ElementImp::GetDOF.
+	const DlInt32*		GetDOF(DlInt32 e) const { return &itsDOF[e * kElemDOF]; }
+
+	//	y[c] += K x[c] for the count vectors of kElemDOF values in x and y.
+	void				Multiply(DlInt32 e, const DlFloat64* x, DlFloat64* y,
+							DlInt32 count) const;
+
+private:
+	ElementMatrixCache(const ElementMatrixCache& c);
+	ElementMatrixCache& operator=(const ElementMatrixCache& c);
+
+	DlInt32					itsCount;
+	std::vector<DlFloat64>	itsStorage;		//	the matrices, with room to align them
+	DlFloat64*				itsMatrices;	//	the first matrix in itsStorage
+	std::vector<DlInt32>	itsDOF;			//	equations of each element
+};
+
+#endif
+
+//	eof
@@ -59,6 +59,8 @@ public:
 	//	add element(s)
 	bool			Add(T* elem);
 	bool			Add(const EnumeratorImp<T, Pub>* list);
+	//	add a block of new elements with one message
+	void			Append(T* const* elems, DlInt32 count);
 	//	insert. dont use if using contains or locate!
 //	void			Insert(BaseIter where, T* elem);
 	//	remove element(s)
@@ -85,6 +87,10 @@ public:
 	void			SendMessage(bool isAdd, const EnumeratorImp<T, Pub>* list);
 
 protected:
+	//	called when elements were added or removed, before the listeners are
+	//	told. A list of this means the whole list may have changed.
+	virtual void	Changed(bool, T*) {}
+	virtual void	Changed(bool, const EnumeratorImp<T, Pub>*) {}
 
 };
 
@@ -166,6 +172,28 @@ EnumeratorImp<T,Pub>::Add(const EnumeratorImp<T,Pub>* list)
 	return added;
 }
 
+//----------------------------------------------------------------------------------------
+//  EnumeratorImp<T,Pub>::Append
+//
+//      add a block of new elements, such as a list read from a file. The
+//		list is sent as the added elements, so it is meant for filling an
+//		empty list.
+//
+//  T* const* elems    -> the elements.
+//  DlInt32 count      -> the number of elements.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T, class Pub> inline
+void
+EnumeratorImp<T,Pub>::Append(T* const* elems, DlInt32 count)
+{
+	if (count > 0) {
+		BaseEnumerator::Append(reinterpret_cast<void* const*>(elems), count);
+		SendMessage(true, this);
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //	EnumeratorImp<T,Pub>::insert
 //
@@ -299,6 +327,7 @@ template <class T, class Pub> inline
 void 
 EnumeratorImp<T,Pub>::Erase()
 {
+	Changed(false, this);
 	Reset();
 	while(HasMore()) {
 		delete Next();
@@ -386,6 +415,7 @@ EnumeratorImp<T,Pub>::Write(StrOutputStream& s, const frame_data& data) const
 template <class T, class Pub> inline void 
 EnumeratorImp<T,Pub>::SendMessage(bool isAdd, T* elem)
 {
+	Changed(isAdd, elem);
 	Pub n(elem);
 	ListMessage m;
 	m.id = GetListID();
@@ -396,6 +426,7 @@ EnumeratorImp<T,Pub>::SendMessage(bool isAdd, T* elem)
 template <class T, class Pub> inline void 
 EnumeratorImp<T,Pub>::SendMessage(bool isAdd, const EnumeratorImp<T, Pub>* list)
 {
+	Changed(isAdd, list);
 	ListMessage m;
 	m.id = GetListID();
 	m.element = (void*)list;
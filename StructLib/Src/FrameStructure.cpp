@@ -52,6 +52,12 @@
 #include "LoadCaseAction.h"
 
 #include "PropertyImp.h"
+#include "ResultEnvelope.h"
+#include "StrBinaryFormat.h"
+#include "ResultsFile.h"
+#include "DlException.h"
+
+#include <cstdio>
 
 //+--------------------------------- Classes -----------------------------------
 
@@ -359,7 +365,7 @@ FrameStructure::StitchNodes(const NodeEnumerator& nodes, DlFloat64 tol, bool sti
 Action* 
 FrameStructure::MoveNodes(const NodeEnumerator& nodes, const WorldPoint& offset)
 {
-	return new MoveNodeAction(nodes, offset);
+	return new MoveNodeAction(itsData, nodes, offset);
 }
 
 //----------------------------------------------------------------------------------------
@@ -1398,6 +1404,35 @@ FrameStructure::InitAnalysis(AnalysisData* data)
 	itsData->InitAnalysis(data);
 }
 
+//----------------------------------------------------------------------------------------
+//  FrameStructure::GetAnalysisOptions
+//
+//      return the options used for analysis.
+//
+//  returns const AnalysisOptions& <- the options.
+//----------------------------------------------------------------------------------------
+const AnalysisOptions&
+FrameStructure::GetAnalysisOptions() const
+{
+	return itsData->GetAnalysisOptions();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SetAnalysisOptions
+//
+//      set the options used for analysis. The options take effect at the next call to
+//		InitAnalysis. Throws if incremental and mixedPrecision are both set.
+//
+//  const AnalysisOptions& options -> the new options.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SetAnalysisOptions(const AnalysisOptions& options)
+{
+	itsData->SetAnalysisOptions(options);
+}
+
 //----------------------------------------------------------------------------------------
 //  FrameStructure::Analyze
 //
@@ -1413,6 +1448,96 @@ FrameStructure::Analyze(DlListener* listener)
 	itsData->Analyze(listener);
 }
 
+//----------------------------------------------------------------------------------------
+//  FrameStructure::CombineResults
+//
+//      build the results of the load case combinations together.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::CombineResults()
+{
+	itsData->CombineResults();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::GetAnalysisTimings
+//
+//      return the time spent in each phase of the last analysis.
+//
+//  returns const AnalysisTimings& <- the timings.
+//----------------------------------------------------------------------------------------
+const AnalysisTimings&
+FrameStructure::GetAnalysisTimings() const
+{
+	return itsData->GetAnalysisTimings();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::GetAnalysisTelemetry
+//
+//      return what the last analysis did and what it cost.
+//
+//  returns const AnalysisTelemetry& <- the telemetry.
+//----------------------------------------------------------------------------------------
+const AnalysisTelemetry&
+FrameStructure::GetAnalysisTelemetry() const
+{
+	return itsData->GetAnalysisTelemetry();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::ComputeEnvelope
+//
+//      find the envelope of the results.
+//
+//  ResultEnvelope& envelope   <- the extremes and their load cases.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::ComputeEnvelope(ResultEnvelope& envelope) const
+{
+	envelope.Compute(*itsData);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SampleResults
+//
+//      sample a result along several elements at once.
+//
+//  const ElementEnumerator& elems     -> the elements.
+//  LoadCase lc                        -> the load case.
+//  ElementResultKind kind             -> force or displacement.
+//  DlInt32 dof                        -> the component.
+//  const std::vector<DlFloat64>& u    -> the locations [0, 1] along each element.
+//  std::vector<DlFloat64>& values     <- u.size() values per element.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SampleResults(const ElementEnumerator& elems, LoadCase lc,
+							  ElementResultKind kind, DlInt32 dof,
+							  const std::vector<DlFloat64>& u,
+							  std::vector<DlFloat64>& values) const
+{
+	const DlInt32 count = u.size();
+	values.assign(elems.Length() * count, 0);
+	
+	std::shared_ptr<const LoadCaseResults> res = itsData->GetResults(lc);
+	if (!res || count == 0)
+		return;
+	
+	//	the whole list is in index order, so only a selection needs looking up
+	bool allElements = elems.GetList() == &itsData->Elements();
+	for (DlInt32 i = 0; i < elems.Length(); i++) {
+		ElementImp* elem = elems.At(i);
+		DlInt32 index = allElements ? i : itsData->ElemToIndex(elem);
+		elem->SampleResults(kind, dof, index, u.data(), count, *res, &values[i * count]);
+	}
+}
+
 #pragma mark -
 #pragma mark ======== IO =======
 #pragma mark -
@@ -1447,6 +1572,77 @@ FrameStructure::Save(StrOutputStream& output)
 	itsData->write(output);
 }
 
+//----------------------------------------------------------------------------------------
+//  FrameStructure::LoadBinary
+//
+//      read this structure from a binary file, which is memory mapped.
+//
+//  const char* path       -> the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::LoadBinary(const char* path)
+{
+	StrMappedFile file(path);
+	itsData->readBinary(file.Data(), file.Length());
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::LoadBinary
+//
+//      read this structure from a binary file image.
+//
+//  const void* image      -> the file.
+//  DlUInt64 length        -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::LoadBinary(const void* image, DlUInt64 length)
+{
+	itsData->readBinary(image, length);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SaveBinary
+//
+//      write this structure to a binary file.
+//
+//  const char* path       -> the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SaveBinary(const char* path) const
+{
+	std::vector<DlUInt8> image;
+	itsData->writeBinary(image);
+
+	std::FILE* f = fopen(path, "wb");
+	if (!f)
+		throw DlException("Failed to open %s for writing", path);
+
+	bool failed = fwrite(&image[0], 1, image.size(), f) != image.size();
+	if (fclose(f) != 0 || failed)
+		throw DlException("Failed to write %s", path);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SaveBinary
+//
+//      write this structure as a binary file image.
+//
+//  std::vector<DlUInt8>& image    <- the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SaveBinary(std::vector<DlUInt8>& image) const
+{
+	itsData->writeBinary(image);
+}
+
 //----------------------------------------------------------------------------------------
 //  FrameStructure::LoadResults
 //
@@ -1461,6 +1657,80 @@ FrameStructure::LoadResults(StrInputStream& input)
 {
 }
 
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SaveResults
+//
+//      write the results to a results file.
+//
+//  const char* path       -> the file.
+//  bool compress          -> compress the columns.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SaveResults(const char* path, bool compress) const
+{
+	std::vector<DlUInt8> image;
+	itsData->writeResults(image, compress);
+
+	std::FILE* f = fopen(path, "wb");
+	if (!f)
+		throw DlException("Failed to open %s for writing", path);
+
+	bool failed = fwrite(&image[0], 1, image.size(), f) != image.size();
+	if (fclose(f) != 0 || failed)
+		throw DlException("Failed to write %s", path);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::SaveResults
+//
+//      write the results as a results file image.
+//
+//  std::vector<DlUInt8>& image    <- the file.
+//  bool compress                  -> compress the columns.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::SaveResults(std::vector<DlUInt8>& image, bool compress) const
+{
+	itsData->writeResults(image, compress);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::LoadResults
+//
+//      read the results from a results file, which is memory mapped.
+//
+//  const char* path       -> the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::LoadResults(const char* path)
+{
+	ResultsFile file(path);
+	itsData->readResults(file);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameStructure::LoadResults
+//
+//      read the results from a results file image.
+//
+//  const void* image      -> the file.
+//  DlUInt64 length        -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameStructure::LoadResults(const void* image, DlUInt64 length)
+{
+	ResultsFile file(image, length);
+	itsData->readResults(file);
+}
+
 #pragma mark -
 #pragma mark ====== Results ======
 #pragma mark -
@@ -1498,9 +1768,9 @@ FrameStructure::GetMergedResultTypes() const
 //
 //  LoadCase lc                    -> the load case.
 //
-//  returns const LoadCaseResults* <- the results.
+//  returns std::shared_ptr<const LoadCaseResults>  <- the results.
 //----------------------------------------------------------------------------------------
-const LoadCaseResults*
+std::shared_ptr<const LoadCaseResults>
 FrameStructure::GetResults() const
 {
 	return itsData->GetResults(itsData->GetActiveLoadCase());
@@ -69,23 +69,110 @@ LoadCaseResults::LoadCaseResults(LoadCase lc, const LoadCaseCombination& combo,
 	, _displacementMagnifier(1.0)
 	, _combination(&combo)
 {
-	const LoadCaseResults* base = nullptr;
+	sizeResults(data);
+
+	const vector<DlFloat32>& factors = combo.GetFactors();
+		 
+	for (int i = 0; i < factors.size(); i++) {
+		if (fabs(factors[i]) > 1.0e-6) {
+			addLoadCase(data.GetResults(i).get(), factors[i]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseResults::LoadCaseResults                                          constructor
+//
+//      Construct results for a combination from values that were combined
+//      elsewhere. The scales start empty; AddScales fills them in.
+//
+//  LoadCase lc                        -> the load case.
+//  const LoadCaseCombination& combo   -> the combination factors.
+//  const frame_data& data             -> the structure.
+//  const DlFloat64* values            -> the combined values, packed as by Pack.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+LoadCaseResults::LoadCaseResults(LoadCase lc, const LoadCaseCombination& combo, const frame_data& data,
+								 const DlFloat64* values)
+	: _loadCase(lc)
+	, _combination(&combo)
+	, _dispScale(0)
+	, _momScale(0)
+	, _shearScale(0)
+	, _axialScale(0)
+	, _displacementMagnifier(1.0)
+{
+	sizeResults(data);
+	
+	for (std::size_t i = 0; i < _displacement.size(); i++)
+		_displacement[i] = *values++;
+	for (std::size_t i = 0; i < _reactions.size(); i++)
+		_reactions[i] = *values++;
+	for (std::size_t i = 0; i < _elemForces.size(); i++, values += DOF_PER_NODE)
+		_elemForces[i] = ElementForce(values);
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseResults::sizeResults                                                  private
+//
+//      size a combination like the results of the first analyzed load case.
+//		Throws if no load case has results.
+//
+//  const frame_data& data     -> the structure.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+LoadCaseResults::sizeResults(const frame_data& data)
+{
+	std::shared_ptr<const LoadCaseResults> base;
 	for (int i = 0; i < data.CountResults(); i++) {
-		if ((base = data.GetResults(i)) != nullptr) {
+		if (data.IsDefinedLoadCase(i) && (base = data.GetResults(i)) != nullptr) {
 			break;
 		}
 	}
 	
+	if (!base)
+		throw DlException("No load case has results to combine.");
+	
 	_displacement.resize(base->_displacement.size());
 	_reactions.resize(base->_reactions.size());
 	_elemForces.resize(base->_elemForces.size());
+}
 
-	const vector<DlFloat32>& factors = combo.GetFactors();
-		 
-	for (int i = 0; i < factors.size(); i++) {
-		if (fabs(factors[i]) > 1.0e-6) {
-			addLoadCase(data.GetResults(i), factors[i]);
-		}
+//----------------------------------------------------------------------------------------
+//  LoadCaseResults::PackedCount
+//
+//      return the number of values written by Pack.
+//
+//  returns std::size_t    <- displacements, reactions and element force components.
+//----------------------------------------------------------------------------------------
+std::size_t
+LoadCaseResults::PackedCount() const
+{
+	return _displacement.size() + _reactions.size() + _elemForces.size() * DOF_PER_NODE;
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseResults::Pack
+//
+//      copy the displacements, reactions and element forces end to end.
+//
+//  DlFloat64* values  <- PackedCount values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+LoadCaseResults::Pack(DlFloat64* values) const
+{
+	for (std::size_t i = 0; i < _displacement.size(); i++)
+		*values++ = _displacement[i];
+	for (std::size_t i = 0; i < _reactions.size(); i++)
+		*values++ = _reactions[i];
+	for (std::size_t i = 0; i < _elemForces.size(); i++) {
+		for (int j = 0; j < DOF_PER_NODE; j++)
+			*values++ = _elemForces[i][j];
 	}
 }
 
@@ -130,16 +217,34 @@ LoadCaseResults::GetDisplacement(const NodeImp* nd, DlFloat64 disp[DOF_PER_NODE]
 void
 LoadCaseResults::addLoadCase(const LoadCaseResults* res, DlFloat64 factor)
 {
-	_displacement += res->_displacement * factor;
-	_reactions += res->_reactions * factor;
+	for (std::size_t i = 0; i < _displacement.size(); i++)
+		_displacement[i] += res->_displacement[i] * factor;
+	for (std::size_t i = 0; i < _reactions.size(); i++)
+		_reactions[i] += res->_reactions[i] * factor;
 	
 	for (int i = 0; i < _elemForces.size(); i++)
     	_elemForces[i].Add(res->_elemForces[i], factor);
 	
-	UpdateDisplacementScale(fabs(res->DisplacementScale() / factor));
-	UpdateMomentScale(fabs(res->MomentScale() / factor));
-	UpdateShearScale(fabs(res->ShearScale() / factor));
-	UpdateAxialScale(fabs(res->AxialScale() / factor));
+	AddScales(*res, factor);
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseResults::AddScales
+//
+//      narrow the plot scales to fit the given load case multiplied by factor.
+//
+//  const LoadCaseResults& res -> the load case being combined.
+//  DlFloat64 factor           -> the factor.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+LoadCaseResults::AddScales(const LoadCaseResults& res, DlFloat64 factor)
+{
+	UpdateDisplacementScale(fabs(res.DisplacementScale() / factor));
+	UpdateMomentScale(fabs(res.MomentScale() / factor));
+	UpdateShearScale(fabs(res.ShearScale() / factor));
+	UpdateAxialScale(fabs(res.AxialScale() / factor));
 }
 
 //----------------------------------------------------------------------------------------
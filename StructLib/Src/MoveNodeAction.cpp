@@ -16,11 +16,15 @@
 #include "DlPlatform.h"
 #include "MoveNodeAction.h"
 #include "NodeImp.h"
+#include "frame_data.h"
+#include "StructureVersion.h"
 
 //---------------------------------- Methods -----------------------------------
 
-MoveNodeAction::MoveNodeAction(const NodeEnumerator& nodes, const WorldPoint& offset)
+MoveNodeAction::MoveNodeAction(frame_data* structure, const NodeEnumerator& nodes,
+							   const WorldPoint& offset)
 	: Action("Move Nodes")
+	, _structure(structure)
 	, _list(nodes)
 	, _offset(offset)
 {
@@ -46,11 +50,17 @@ void MoveNodeAction::Redo()
 void
 MoveNodeAction::moveBy(const WorldPoint& offset)
 {
+	DlUInt32 geometry = _structure->GetStructureVersion().Geometry();
+	
 	_list.Reset();
 	while (_list.HasMore()) {
 		NodeImp* n = _list.Next();
 		n->SetCoords(n->GetCoords() + offset);
 	}
+	
+	const NodeList* moved = NodeList::GetList(_list);
+	_structure->Elements().Moved(moved, geometry);
+	_structure->Nodes().Moved(moved, geometry);
 }
 
 /*
@@ -20,12 +20,15 @@
 #include "WorldPoint.h"
 #include "NodeList.h"
 
+class frame_data;
+
 //---------------------------------- Class -------------------------------------
 
 class	MoveNodeAction : public Action
 {
 public:
-	MoveNodeAction(const NodeEnumerator& nodes, const WorldPoint& offset);
+	//	the hit testing grids of structure are updated as the nodes move
+	MoveNodeAction(frame_data* structure, const NodeEnumerator& nodes, const WorldPoint& offset);
 
 	virtual ~MoveNodeAction();
 	
@@ -36,6 +39,7 @@ private:
 
 	void moveBy(const WorldPoint& offset);
 
+	frame_data*		_structure;
 	NodeEnumerator 	_list;
 	WorldPoint 		_offset;
 };
@@ -121,10 +121,12 @@ void
 Node::SetCoord(DlInt32 which, const char* str)
 {
 	_DlAssert(which >= 0 && which < 2);
+	WorldPoint p = imp->GetCoords();
 	if (which == 0)
-		imp->GetCoords().x() = UnitTable::ParseValue(str, UnitsLength);
+		p.x() = UnitTable::ParseValue(str, UnitsLength);
 	else
-		imp->GetCoords().y() = UnitTable::ParseValue(str, UnitsLength);
+		p.y() = UnitTable::ParseValue(str, UnitsLength);
+	imp->SetCoords(p);
 }
 
 //----------------------------------------------------------------------------------------
@@ -139,7 +141,7 @@ Node::SetCoord(DlInt32 which, const char* str)
 void
 Node::SetCoords(const WorldPoint& pt)
 {
-	imp->GetCoords() = pt;
+	imp->SetCoords(pt);
 }
 
 //	restraint access
@@ -35,35 +35,16 @@
 #include <valarray>
 #include "StrInputStream.h"
 #include "StrOutputStream.h"
+#include "StrBinaryFormat.h"
 #include "frame_data.h"
+#include "GPSRenum.h"
 
 //---------------------------------- Methods -----------------------------------
 
 #if DlDebugging
-int NodeImp::_idGen = 0;
+std::atomic<int> NodeImp::_idGen(0);
 #endif
 
-class FindAttachedElement
-{
-public:
-
-	FindAttachedElement(const NodeImp * theNode) 
-		: itsNode(theNode) {}
-//	~FindAttachedElement() { decReference(itsList); }
-	
-	void operator() (const ElementImp* elem, DlUInt32) const
-	{
-		if (elem->StartNode() == itsNode || elem->EndNode() == itsNode)
-			ElementList::GetList(const_cast<ElementEnumerator&>(itsList))->Add(const_cast<ElementImp *>(elem));
-	}
-
-	const NodeImp* itsNode;
-	ElementEnumerator itsList;
-private:
-    FindAttachedElement(const FindAttachedElement& a);
-    FindAttachedElement& operator=(const FindAttachedElement& a);
-};
-
 //
 //	public interface
 //
@@ -79,6 +60,7 @@ private:
 NodeImp::NodeImp(const WorldPoint & c) 
 	: _coords(c)
 	, _restraint(0)
+	, _version(nullptr)
 #if DlDebugging
 	, _id(_idGen++)
 #endif
@@ -97,8 +79,9 @@ NodeImp::NodeImp(const WorldPoint & c)
 //  returns nothing
 //----------------------------------------------------------------------------------------
 NodeImp::NodeImp(StrInputStream & input, const frame_data &data)
+	: _version(nullptr)
 #if DlDebugging
-	: _id(_idGen++)
+	, _id(_idGen++)
 #endif
 {
 	DlInt32 i;
@@ -130,6 +113,37 @@ NodeImp::NodeImp(StrInputStream & input, const frame_data &data)
 	}
 }
 
+//----------------------------------------------------------------------------------------
+//  NodeImp::NodeImp                                                          constructor
+//
+//      construct a node from a binary record.
+//
+//  const StrBinaryNode& rec       -> the node.
+//  const StrBinaryLoadRef* loads  -> the loads, from rec.firstLoad.
+//  const frame_data& data         -> the data object.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+NodeImp::NodeImp(const StrBinaryNode& rec, const StrBinaryLoadRef* loads, const frame_data &data)
+	: _coords(rec.coords[0], rec.coords[1])
+	, _restraint(rec.restraint)
+	, _version(nullptr)
+#if DlDebugging
+	, _id(_idGen++)
+#endif
+{
+	for (DlInt32 i = 0; i < DOF_PER_NODE; i++)
+		_equations[i] = rec.equations[i];
+
+	//	the loads were written in load case order
+	_loads.reserve(rec.loadCount);
+	for (DlUInt32 i = 0; i < rec.loadCount; i++) {
+		NodeLoadImp* imp = data.IndexToNodeLoad(loads[i].loadCase, loads[i].load);
+		if (imp != nullptr)
+			AssignLoad(loads[i].loadCase, imp);
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  NodeImp::NodeImp                                                          constructor
 //
@@ -142,6 +156,7 @@ NodeImp::NodeImp(StrInputStream & input, const frame_data &data)
 NodeImp::NodeImp(const NodeImp& n)
 	: _coords(n._coords)
 	, _restraint(n._restraint)
+	, _version(nullptr)
 #if DlDebugging
 , _id(_idGen++)
 #endif
@@ -177,6 +192,35 @@ NodeImp::Write(StrOutputStream & output, const frame_data & data) const
 	}
 }
 
+//----------------------------------------------------------------------------------------
+//  NodeImp::WriteRecord
+//
+//      fill in the binary record for this node.
+//
+//  StrBinaryNode& rec                         <- the node.
+//  std::vector<StrBinaryLoadRef>& loads       <- the loads are appended.
+//  const frame_data & data                    -> the data object.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeImp::WriteRecord(StrBinaryNode& rec, std::vector<StrBinaryLoadRef>& loads,
+					 const frame_data & data) const
+{
+	rec.coords[0] = _coords.x();
+	rec.coords[1] = _coords.y();
+	rec.restraint = _restraint;
+	for (DlInt32 i = 0; i < DOF_PER_NODE; i++)
+		rec.equations[i] = _equations[i];
+
+	rec.firstLoad = loads.size();
+	rec.loadCount = _loads.size();
+	for (auto p : _loads) {
+		StrBinaryLoadRef ref = { p.first, data.NodeLoadToIndex(p.first, p.second) };
+		loads.push_back(ref);
+	}
+}
+
 //------------------------------------------------------------------------------
 //	NodeImp::findAttached
 //
@@ -188,9 +232,7 @@ NodeImp::Write(StrOutputStream & output, const frame_data & data) const
 ElementEnumerator 
 NodeImp::FindAttached(const ElementList& elems)
 {
-	FindAttachedElement	finder(this);
-	elems.Foreach(finder);
-	return finder.itsList;
+	return elems.Attached(this);
 }
 
 //------------------------------------------------------------------------------
@@ -231,6 +273,23 @@ NodeImp::SetEquationNumbers(DlInt32 * total, DlInt32 * react)
 	}
 }
 
+//------------------------------------------------------------------------------
+//	NodeImp::RenumberEquations
+//
+//		map the equation numbers for this node to the renumbered equations.
+//		Reaction numbers are unchanged.
+//
+//	renum				->	the renumbering.
+//------------------------------------------------------------------------------
+void
+NodeImp::RenumberEquations(const GPSRenum& renum)
+{
+	for (int i = 0; i < DOF_PER_NODE; i++) {
+		if (_equations[i] > 0)
+			_equations[i] = renum.mapDof(_equations[i]);
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  NodeImp::AssignLoad
 //
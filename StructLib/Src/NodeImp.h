@@ -37,7 +37,9 @@
 #include "DlAssert.h"
 #include "Node.h"
 #include "ElementEnumerator.h"
+#include "StructureVersion.h"
 
+#include <atomic>
 #include <valarray>
 
 class frame_data;
@@ -47,6 +49,9 @@ class StrInputStream;
 class StrOutputStream;
 
 class ElementList;
+class GPSRenum;
+struct StrBinaryNode;
+struct StrBinaryLoadRef;
 
 //---------------------------------- Class -------------------------------------
 
@@ -60,6 +65,7 @@ public:
 
 	NodeImp(const WorldPoint & c);
 	NodeImp(StrInputStream & input, const frame_data &data);
+	NodeImp(const StrBinaryNode& rec, const StrBinaryLoadRef* loads, const frame_data &data);
 	NodeImp(const NodeImp& n);
 
 	NodeImp& operator=(const NodeImp& i) = delete;
@@ -70,7 +76,6 @@ public:
 
 	//	coordinate access
 	const WorldPoint&	GetCoords() const;
-	WorldPoint&			GetCoords();
 	void				SetCoords(const WorldPoint& newLoc);
 
 	//	restraint access
@@ -86,12 +91,16 @@ public:
 //
 //	Internal interface
 //
+	//	the stamp of the structure this node is in, bumped by the setters
+	void				SetVersion(StructureVersion* version) { _version = version; }
+
 	//	find the elements attached to this node
 	ElementEnumerator	FindAttached(const ElementList& elems);
 
 	//	find the minimum eq for node
 	DlInt32				MinEquation(DlInt32 currMin) const;
 	void				SetEquationNumbers(DlInt32* total, DlInt32* react);
+	void				RenumberEquations(const GPSRenum& renum);
 	DlInt32				GetEquationNumber(DlInt32 i) const;
 
 	//	user interface
@@ -106,9 +115,11 @@ public:
 						UpdateLoadCombination(LoadCase lc, const std::vector<DlFloat32>& factors);
 
 	void				Write(StrOutputStream & output, const frame_data & data) const;
+	void				WriteRecord(StrBinaryNode& rec, std::vector<StrBinaryLoadRef>& loads,
+									const frame_data & data) const;
 	
 #if DlDebugging
-	static int		_idGen;
+	static std::atomic<int>	_idGen;
 	int				_id;
 #endif
 
@@ -116,6 +127,7 @@ private:
 
 	WorldPoint				_coords;
 	DlUInt32				_restraint;
+	StructureVersion*		_version;
 	DlInt32					_equations[DOF_PER_NODE];
 	
 	LoadList	_loads;
@@ -169,6 +181,8 @@ inline void
 NodeImp::SetFixed(DlInt32 dof) 
 {
 	_restraint |= (1<<dof);
+	if (_version)
+		_version->Changed();
 }
 
 //----------------------------------------------------------------------------------------
@@ -184,6 +198,8 @@ inline void
 NodeImp::SetFree(DlInt32 dof) 
 {
 	_restraint &= ~(1<<dof);
+	if (_version)
+		_version->Changed();
 }
 
 //------------------------------------------------------------------------------
@@ -246,6 +262,8 @@ inline DlUInt32
 NodeImp::SetRestraint(DlUInt32 restCode) {
 	DlUInt32 old = _restraint;
 	_restraint = restCode;
+	if (_version)
+		_version->Changed();
 	return old;
 }
 
@@ -262,19 +280,6 @@ NodeImp::GetCoords() const
 	return _coords;
 }
 
-//------------------------------------------------------------------------------
-//	NodeImp::GetCoords
-//
-//		external coordinate access.
-//
-//	returns				<-	node coordinates.
-//------------------------------------------------------------------------------
-inline WorldPoint & 
-NodeImp::GetCoords()  
-{
-	return _coords;
-}
-
 //------------------------------------------------------------------------------
 //	NodeImp::SetCoords
 //
@@ -286,6 +291,8 @@ inline void
 NodeImp::SetCoords(const WorldPoint& newLoc) 
 {
 	_coords = newLoc;
+	if (_version)
+		_version->Moved(this);
 }
 
 //	user interface
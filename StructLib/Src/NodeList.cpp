@@ -35,28 +35,18 @@
 #include "StrMessage.h"
 
 #include "ElementList.h"
+#include "GPSRenum.h"
+#include "StructureVersion.h"
+#include "DlThreadPool.h"
 
-//--------------------------------------- Class ------------------------------------------
-//
-//	NodeSelector
-//
-//		add all nodes within r to the list.
-//
-class	NodeSelector 
-{
-public:
-	NodeSelector(const WorldRect& r) 
-		: _rect(r) {}
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
 
-	void operator () (const NodeImp* n, DlInt32)
-	{
-		if (n->Hit(_rect))
-			NodeList::GetList(_list)->Add(const_cast<NodeImp*>(n));
-	}
+//	nodes searched for a stitch partner by one task of the pool
+const DlInt32 kStitchChunk = 1024;
 
-	NodeEnumerator _list;
-	const WorldRect& _rect;
-};
+//--------------------------------------- Class ------------------------------------------
 
 //
 //	MaxLoadCaseFinder
@@ -76,35 +66,6 @@ public:
 //	bool* _lcs;
 //};
 
-//
-//	NearestNodeFinder
-//
-//		find the node closest to p.
-//
-class	NearestNodeFinder 
-{
-public:
-	NearestNodeFinder(const WorldPoint& p) 
-		: _point(p)
-		, _node(0)
-		, _dist(-1) {}
-	
-	//	operator for foreach
-	void operator() (const NodeImp* n, DlInt32) 
-	{
-		DlFloat64 d = WorldPoint::dist(n->GetCoords(), _point);
-		if (d < _dist || _dist == -1)
-		{
-			_dist = d;
-			_node = n;
-		}
-	}
-	
-	const WorldPoint& _point;
-	const NodeImp* _node;
-	DlFloat64	_dist;
-};
-
 //
 //	LoadAssembler
 //
@@ -160,6 +121,91 @@ public:
 	NodeEnumerator _list;
 };
 
+//
+//	EquationRenumberer
+//
+//		map the equation numbers for each node.
+//
+class EquationRenumberer {
+public:
+	EquationRenumberer(const GPSRenum& renum)
+		: _renum(renum) {}
+	
+	void operator() (NodeImp* n, DlInt32) {
+		n->RenumberEquations(_renum);
+	}
+	
+	const GPSRenum& _renum;
+};
+
+//
+//	NodeBuckets
+//
+//		the nodes hashed by the cell of a tol sized grid holding each, so a
+//		node is only compared with the nodes in the cells around its own.
+//		The cells are a little larger than tol so rounding cannot put two
+//		nodes that are within tol more than a cell apart.
+//
+class NodeBuckets {
+public:
+	NodeBuckets(DlFloat64 tol, DlInt32 capacity)
+		: _tol(tol)
+		, _mtol(tol * 1.414)
+		, _cellSize(tol * 1.01) {
+		_coords.reserve(capacity);
+		_cells.reserve(capacity);
+	}
+	
+	//	add a node. nodes are numbered in the order they are added.
+	void Add(const WorldPoint& c) {
+		_cells[cellKey(cellIndex(c.x()), cellIndex(c.y()))].push_back(_coords.size());
+		_coords.push_back(c);
+	}
+	
+	//	call p(index) for each node added that is within tol of c, using the
+	//	same test as the pairwise comparison.
+	template <class P> void Near(const WorldPoint& c, P p) const {
+		DlInt32 x = cellIndex(c.x());
+		DlInt32 y = cellIndex(c.y());
+		for (DlInt32 i = x - 1; i <= x + 1; i++) {
+			for (DlInt32 j = y - 1; j <= y + 1; j++) {
+				CellMap::const_iterator cell = _cells.find(cellKey(i, j));
+				if (cell == _cells.end())
+					continue;
+				for (DlInt32 n : cell->second) {
+					const WorldPoint& nc = _coords[n];
+					if (nc.manhattan(c) < _mtol && nc.dist(c) < _tol)
+						p(n);
+				}
+			}
+		}
+	}
+	
+private:
+	typedef std::unordered_map<DlInt64, std::vector<DlInt32> > CellMap;
+	
+	//	clamped like SpatialGrid's, so neighbouring cells stay neighbours.
+	DlInt32 cellIndex(DlFloat64 c) const {
+		const DlInt32 limit = 1 << 30;
+		DlFloat64 i = std::floor(c / _cellSize);
+		if (!(i > -limit))
+			return -limit;
+		if (!(i < limit))
+			return limit;
+		return DlInt32(i);
+	}
+	
+	static DlInt64 cellKey(DlInt32 x, DlInt32 y) {
+		return DlInt64((DlUInt64(DlUInt32(x)) << 32) | DlUInt32(y));
+	}
+	
+	DlFloat64 _tol;
+	DlFloat64 _mtol;
+	DlFloat64 _cellSize;
+	std::vector<WorldPoint> _coords;
+	CellMap _cells;
+};
+
 //--------------------------------------- Methods ----------------------------------------
 
 //----------------------------------------------------------------------------------------
@@ -173,9 +219,32 @@ NodeList::NodeList()
 	: itsNumEquations(0)
 	, itsNumReactions(0)
 	, itsNumMatrixElems(0)
+	, itsInitialMatrixElems(0)
+	, itsVersion(nullptr)
+	, itsGridValid(false)
+	, itsGridGeometry(0)
+	, itsGridLength(0)
 {
 }
 
+//----------------------------------------------------------------------------------------
+//  NodeList::SetVersion
+//
+//      give the nodes, and those added later, the stamp of the structure.
+//
+//  StructureVersion* version  -> the stamp.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeList::SetVersion(StructureVersion* version)
+{
+	itsVersion = version;
+	for (DlInt32 i = 0; i < Length(); i++)
+		ElementAt(i)->SetVersion(version);
+	itsGridValid = false;
+}
+
 //----------------------------------------------------------------------------------------
 //  NodeList::GetListID
 //
@@ -201,15 +270,25 @@ NodeList::GetListID() const
 NodeEnumerator 
 NodeList::Select(const WorldRect& r) const
 {
-	NodeSelector s(r);
-	Foreach(s);
-	return s._list;
+	std::vector<NodeImp*> found;
+	auto hit = [&r, &found](NodeImp* n) {
+		if (n->Hit(r))
+			found.push_back(n);
+	};
+	grid().Search(r, hit);
+	sortByIndex(found);
+
+	NodeEnumerator list;
+	if (!found.empty())
+		GetList(list)->Append(&found[0], found.size());
+	return list;
 }
 
 //----------------------------------------------------------------------------------------
 //  NodeList::Nearest
 //
-//      return the nearest node to p.
+//      return the nearest node to p. Of nodes the same distance away, the first
+//		in the list.
 //
 //  const WorldPoint& p    -> point
 //
@@ -218,9 +297,18 @@ NodeList::Select(const WorldRect& r) const
 NodeImp* 
 NodeList::Nearest(const WorldPoint& p) const
 {
-	NearestNodeFinder f(p);
-	Foreach(f);
-	return const_cast<NodeImp*>(f._node);
+	NodeImp* nearest = 0;
+	DlFloat64 best = -1;
+	auto closer = [this, &p, &nearest, &best](NodeImp* n) {
+		DlFloat64 d = WorldPoint::dist(n->GetCoords(), p);
+		if (best == -1 || d < best || (d == best && IndexOf(n) < IndexOf(nearest))) {
+			best = d;
+			nearest = n;
+		}
+		return best;
+	};
+	grid().SearchNear(p, closer);
+	return nearest;
 }
 
 //----------------------------------------------------------------------------------------
@@ -235,15 +323,19 @@ NodeList::Nearest(const WorldPoint& p) const
 NodeImp*
 NodeList::SelectOne(const WorldRect& r) const
 {
-	Reset();
-	
-	while(HasMore()) {
-		const NodeImp* n = Next();
-		if (r.contains(n->GetCoords()))
-			return const_cast<NodeImp*>(n);
-	}
-
-	return 0;
+	NodeImp* first = 0;
+	DlInt32 firstIndex = 0;
+	auto hit = [this, &r, &first, &firstIndex](NodeImp* n) {
+		if (r.contains(n->GetCoords())) {
+			DlInt32 index = IndexOf(n);
+			if (!first || index < firstIndex) {
+				first = n;
+				firstIndex = index;
+			}
+		}
+	};
+	grid().Search(r, hit);
+	return first;
 }
 
 //----------------------------------------------------------------------------------------
@@ -258,15 +350,158 @@ NodeList::SelectOne(const WorldRect& r) const
 NodeImp*
 NodeList::Find(const WorldPoint& p) const
 {
-	Reset();
+	NodeImp* first = 0;
+	DlInt32 firstIndex = 0;
+	auto same = [this, &p, &first, &firstIndex](NodeImp* n) {
+		if (n->GetCoords() == p) {
+			DlInt32 index = IndexOf(n);
+			if (!first || index < firstIndex) {
+				first = n;
+				firstIndex = index;
+			}
+		}
+	};
+	grid().Search(WorldRect(p, p), same);
+	return first;
+}
+
+//----------------------------------------------------------------------------------------
+//  NodeList::Moved
+//
+//      move nodes that were just moved to their new cells. If anything else
+//		moved since the grid was built, it is left to be built again.
+//
+//  const NodeList* movedNodes -> the nodes moved.
+//  DlUInt32 geometry          -> the Geometry stamp before they moved.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeList::Moved(const NodeList* movedNodes, DlUInt32 geometry)
+{
+	if (!itsVersion || !itsGridValid || itsGridGeometry != geometry)
+		return;
+
+	for (DlInt32 i = 0; i < movedNodes->Length(); i++) {
+		NodeImp* n = movedNodes->ElementAt(i);
+		if (itsGrid.Contains(n))
+			itsGrid.Insert(n, WorldRect(n->GetCoords(), n->GetCoords()));
+	}
+	itsGridGeometry = itsVersion->Geometry();
+}
+
+//----------------------------------------------------------------------------------------
+//  NodeList::Changed                                                           protected
+//
+//      add or remove a node from the grid.
+//
+//  bool isAdd             -> true if added.
+//  NodeImp* elem          -> the node.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeList::Changed(bool isAdd, NodeImp* elem)
+{
+	if (isAdd && itsVersion)
+		elem->SetVersion(itsVersion);
 	
-	while(HasMore()) {
-		const NodeImp* n = Next();
-		if (n->GetCoords() == p)
-			return const_cast<NodeImp*>(n);
+	if (!itsGridValid)
+		return;
+
+	if (isAdd)
+		itsGrid.Insert(elem, WorldRect(elem->GetCoords(), elem->GetCoords()));
+	else
+		itsGrid.Remove(elem);
+}
+
+//----------------------------------------------------------------------------------------
+//  NodeList::Changed                                                           protected
+//
+//      add or remove nodes from the grid. When most of the list changed, the
+//		grid is built again when next needed.
+//
+//  bool isAdd                                 -> true if added.
+//  const EnumeratorImp<NodeImp, Node>* list   -> the nodes.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeList::Changed(bool isAdd, const EnumeratorImp<NodeImp, Node>* list)
+{
+	if (isAdd && itsVersion) {
+		for (DlInt32 i = 0; i < list->Length(); i++)
+			list->ElementAt(i)->SetVersion(itsVersion);
+	}
+	
+	if (!itsGridValid)
+		return;
+
+	if (list == this || list->Length() > itsGrid.Count()) {
+		itsGridValid = false;
+		itsGrid.Reset(1);
+		return;
 	}
 
-	return 0;
+	for (DlInt32 i = 0; i < list->Length(); i++)
+		Changed(isAdd, list->ElementAt(i));
+}
+
+//----------------------------------------------------------------------------------------
+//  NodeList::grid                                                                private
+//
+//      return the grid, building it if nodes moved or twice as many were
+//		added since it was built.
+//
+//  returns const SpatialGrid<NodeImp>&    <- the grid.
+//----------------------------------------------------------------------------------------
+const SpatialGrid<NodeImp>&
+NodeList::grid() const
+{
+	DlInt32 count = Length();
+	if (itsVersion && itsGridValid && itsGridGeometry == itsVersion->Geometry()
+			&& count <= 2 * itsGridLength + 64)
+		return itsGrid;
+
+	WorldRect bounds;
+	for (DlInt32 i = 0; i < count; i++) {
+		const WorldPoint& p = ElementAt(i)->GetCoords();
+		if (i == 0)
+			bounds = WorldRect(p, p);
+		else
+			bounds.addBounds(p);
+	}
+
+	itsGrid.Reset(SpatialGrid<NodeImp>::ChooseCellSize(bounds, count, 0));
+	for (DlInt32 i = 0; i < count; i++) {
+		NodeImp* n = ElementAt(i);
+		itsGrid.Insert(n, WorldRect(n->GetCoords(), n->GetCoords()));
+	}
+
+	itsGridValid = itsVersion != nullptr;
+	itsGridGeometry = itsVersion ? itsVersion->Geometry() : 0;
+	itsGridLength = count;
+	return itsGrid;
+}
+
+//----------------------------------------------------------------------------------------
+//  NodeList::sortByIndex                                                         private
+//
+//      put nodes found in the grid back in list order.
+//
+//  std::vector<NodeImp*>& nodes   <-> the nodes.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+NodeList::sortByIndex(std::vector<NodeImp*>& nodes) const
+{
+	std::vector<std::pair<DlInt32, NodeImp*> > order(nodes.size());
+	for (std::size_t i = 0; i < nodes.size(); i++)
+		order[i] = std::make_pair(IndexOf(nodes[i]), nodes[i]);
+	std::sort(order.begin(), order.end());
+	for (std::size_t i = 0; i < nodes.size(); i++)
+		nodes[i] = order[i].second;
 }
 
 //----------------------------------------------------------------------------------------
@@ -300,100 +535,113 @@ NodeList::FindAttachedLoad(LoadCase lc, NodeLoad theLoad) const
 bool
 NodeList::Duplicates(const NodeList* movedNodes, DlFloat64 tol) const 
 {
-	DlFloat64 mtol = tol * 1.414;
+	if (!(tol > 0))
+		return false;
+	
 	DlInt32 totalLen = Length();
 
 	if (movedNodes) {
 		
+		//	bucket the moved nodes and look for each of the others among them.
 		DlInt32 len = movedNodes->Length();
-		for(DlInt32 j = 0; j < totalLen; ++j) {
+		NodeBuckets buckets(tol, len);
+		for (DlInt32 i = 0; i < len; ++i)
+			buckets.Add(movedNodes->ElementAt(i)->GetCoords());
+		
+		bool found = false;
+		for(DlInt32 j = 0; j < totalLen && !found; ++j) {
 			NodeImp* keepNode = ElementAt(j);
-			if (!movedNodes->Contains(keepNode)) {
-				const WorldPoint& c = keepNode->GetCoords();
-			
-				for (DlInt32 i = 0; i < len; ++i) {
-					NodeImp* testNode = movedNodes->ElementAt(i);
-					const WorldPoint& testCoords(testNode->GetCoords());
-
-					if (testCoords.manhattan(c) < mtol) {
-						if (testCoords.dist(c) < tol) {
-							return true;
-						}
-					}
-				}
-			}
+			if (!movedNodes->Contains(keepNode))
+				buckets.Near(keepNode->GetCoords(), [&](DlInt32) { found = true; });
 		}
+		return found;
 	} else {
-		for (DlInt32 i = 0; i < totalLen; i++) {
-			const WorldPoint& c1 = ElementAt(i)->GetCoords();
-			for (DlInt32 j = i + 1; j < totalLen; j++) {
-				const WorldPoint& c2 = ElementAt(j)->GetCoords();
-				if (c2.manhattan(c1) < mtol) {
-					if (c2.dist(c1) < tol) {
-						return true;
-					}
-				}
-			}
+		
+		//	check each node against those before it, then add it.
+		NodeBuckets buckets(tol, totalLen);
+		bool found = false;
+		for (DlInt32 i = 0; i < totalLen && !found; i++) {
+			const WorldPoint& c = ElementAt(i)->GetCoords();
+			buckets.Near(c, [&](DlInt32) { found = true; });
+			buckets.Add(c);
 		}
+		return found;
 	}
-	return false;
 }
 
 //----------------------------------------------------------------------------------------
 //  NodeList::StitchMap
 //
-//      Create a Map of nodes to nodes at the same location.
+//      Create a Map of nodes to nodes at the same location. A moved node is
+//		replaced by the first other node within tol. Without moved nodes, each
+//		node is replaced by the last node before it within tol.
 //
-//  const NodeList* movedNodes  -> the point
-//  NodeCloneMap& nodeMap       -> the replacement map
+//  const NodeList* movedNodes  -> the nodes to replace, or null for all.
+//  DlFloat64 tol               -> how close needed.
+//  NodeCloneMap& nodeMap       <-> the replacement map
+//  DlThreadPool* pool          -> the threads to use, or nullptr.
 //
-//  returns NodeImp*       <- the node.
+//  returns nothing
 //----------------------------------------------------------------------------------------
 void
-NodeList::StitchMap(const NodeList* movedNodes, DlFloat64 tol, NodeCloneMap& nodeMap) const 
+NodeList::StitchMap(const NodeList* movedNodes, DlFloat64 tol, NodeCloneMap& nodeMap,
+					DlThreadPool* pool) const 
 {
+	if (!(tol > 0))
+		return;
+	
 	//	we want to check each node in moved Nodes against all the node not in
 	//	moved nodes.
-	DlFloat64 mtol = tol * 1.414;
 	DlInt32 totalLen = Length();
 	
 	if (movedNodes) {
 		DlInt32 len = movedNodes->Length();
+		NodeBuckets buckets(tol, len);
+		for (DlInt32 i = 0; i < len; ++i)
+			buckets.Add(movedNodes->ElementAt(i)->GetCoords());
 			
 		for(DlInt32 j = 0; j < totalLen; ++j) {
 			NodeImp* keepNode = ElementAt(j);
 			if (!movedNodes->Contains(keepNode)) {
-				const WorldPoint& c = keepNode->GetCoords();
-			
-				for (DlInt32 i = 0; i < len; ++i) {
+				buckets.Near(keepNode->GetCoords(), [&](DlInt32 i) {
 					NodeImp* testNode = movedNodes->ElementAt(i);
-					if (nodeMap.find(testNode) == nodeMap.end()) {
-						
-						const WorldPoint& testCoords(testNode->GetCoords());
-				
-						if (testCoords.manhattan(c) < mtol) {
-							if (testCoords.dist(c) < tol) {
-								nodeMap[testNode] = keepNode;
-							}
-						}
-					}
-				}
+					if (nodeMap.find(testNode) == nodeMap.end())
+						nodeMap[testNode] = keepNode;
+				});
 			}
 		} 
 	} else {
 		
-		for (DlInt32 i = 0; i < totalLen; i++) {
-			NodeImp* n1 = ElementAt(i);
-			const WorldPoint& c1 = n1->GetCoords();
-			for (DlInt32 j = i + 1; j < totalLen; j++) {
-				NodeImp* n2 = ElementAt(j);
-				const WorldPoint& c2 = n2->GetCoords();
-				if (c2.manhattan(c1) < mtol) {
-					if (c2.dist(c1) < tol) {
-						nodeMap[n2] = n1;
-					}
-				}
+		NodeBuckets buckets(tol, totalLen);
+		for (DlInt32 i = 0; i < totalLen; i++)
+			buckets.Add(ElementAt(i)->GetCoords());
+		
+		//	the search for each node only reads the buckets, so the nodes are
+		//	split into chunks for the threads.
+		std::vector<DlInt32> keep(totalLen, -1);
+		auto match = [&](DlInt32 chunk) {
+			DlInt32 last = std::min(totalLen, (chunk + 1) * kStitchChunk);
+			for (DlInt32 j = chunk * kStitchChunk; j < last; j++) {
+				DlInt32 k = -1;
+				buckets.Near(ElementAt(j)->GetCoords(), [&](DlInt32 i) {
+					if (i < j && i > k)
+						k = i;
+				});
+				keep[j] = k;
 			}
+		};
+		
+		DlInt32 chunks = (totalLen + kStitchChunk - 1) / kStitchChunk;
+		if (pool && chunks > 1) {
+			pool->ParallelFor(0, chunks, match);
+		} else {
+			for (DlInt32 c = 0; c < chunks; c++)
+				match(c);
+		}
+		
+		for (DlInt32 j = 0; j < totalLen; j++) {
+			if (keep[j] >= 0)
+				nodeMap[ElementAt(j)] = ElementAt(keep[j]);
 		}
 	}
 }
@@ -502,15 +750,21 @@ NodeList::SetStarts(const ElementList* elems)
 //----------------------------------------------------------------------------------------
 //  NodeList::PrepareToAnalyze
 //
-//      Assign equation numbers and compute the columns starts.
+//      Assign equation numbers and compute the columns starts. If minimizeProfile is
+//		set, the equations are renumbered using GPSRenum when that reduces the profile.
 //
 //  const ElementList* elems   -> the list of elements.
+//  bool minimizeProfile       -> true to renumber the equations.
+//  DlFloat64* startsTime      <- seconds in SetStarts, or nullptr.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
-NodeList::PrepareToAnalyze(const ElementList* elems)
+NodeList::PrepareToAnalyze(const ElementList* elems, bool minimizeProfile, DlFloat64* startsTime)
 {
+	typedef std::chrono::steady_clock Clock;
+	Clock::duration inStarts(0);
+	
 	//	first compute all the equation numbers
 	Reset();
 	
@@ -521,14 +775,40 @@ NodeList::PrepareToAnalyze(const ElementList* elems)
 		Next()->SetEquationNumbers(&itsNumEquations, &itsNumReactions);
 	}
 	
-	//	here, if desired we can minimize the profile by calling
-	//  elems->GetConnectivity(connect, starts)
-	//	GPSRenum...
+	//	compute the columns for the original numbering
+	Clock::time_point start = Clock::now();
+	SetStarts(elems);
+	inStarts += Clock::now() - start;
+	itsInitialMatrixElems = itsNumMatrixElems;
 	
-	//	then map the current equation numbers to the new ones.
+	if (minimizeProfile && itsNumEquations > 1) {
+		std::valarray<DlInt32> connect;
+		std::valarray<DlInt32> starts;
+		elems->GetConnectivity(itsNumEquations, connect, starts);
+		
+		//	GPSRenum requires every equation to be attached to some element. If not,
+		//	the matrix is singular anyway, so leave the numbering alone.
+		bool connected = true;
+		for (DlInt32 i = 0; i < itsNumEquations && connected; i++)
+			connected = starts[i+1] > starts[i];
+		
+		if (connected) {
+			GPSRenum renum(connect, starts);
+			if (renum.isBetter()) {
+				//	map the current equation numbers to the new ones and
+				//	recompute the columns.
+				EquationRenumberer r(renum);
+				Foreach(r);
+				
+				start = Clock::now();
+				SetStarts(elems);
+				inStarts += Clock::now() - start;
+			}
+		}
+	}
 	
-	//	compute the number of equations and set the columns
-	SetStarts(elems);
+	if (startsTime)
+		*startsTime = std::chrono::duration<DlFloat64>(inStarts).count();
 }
 
 ////----------------------------------------------------------------------------------------
@@ -550,16 +830,20 @@ NodeList::PrepareToAnalyze(const ElementList* elems)
 //----------------------------------------------------------------------------------------
 //  NodeList::AssembleLoads
 //
-//      assemble the node loads.
+//      assemble the node loads. The list is indexed rather than iterated, so
+//		several load cases can be assembled at once.
 //
-//  s  -> 
+//  std::valarray<DlFloat64>& rhs  <-> the vector of loads.
+//  LoadCase lc                    -> the load case.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
 void
-NodeList::AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc) {
+NodeList::AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc) const {
 	LoadAssembler assembler(rhs, lc);
-	Foreach(assembler);
+	DlInt32 count = Length();
+	for (DlInt32 i = 0; i < count; i++)
+		assembler(ElementAt(i), i);
 }
 
 //----------------------------------------------------------------------------------------
@@ -35,12 +35,14 @@
 #include "NodeEnumerator.h"
 #include "WorldRect.h"
 #include "NodeImp.h"
+#include "SpatialGrid.h"
 
 class Node;
 class StrInputStream;
 class StrOutputStream;
 class ElementList;
 class NodeLoadList;
+class DlThreadPool;
 
 typedef std::map<const NodeImp*, NodeImp*>					NodeCloneMap;
 typedef std::map<const NodeImp*, NodeImp*>::iterator		NodeCloneMapIter;
@@ -54,13 +56,26 @@ public:
 
 	NodeList();
 	
+	//	give the nodes the stamp of the structure the list holds. Without one
+	//	the grid is built for each search.
+	void				SetVersion(StructureVersion* version);
+	
+	//	the hit tests search a grid of the nodes, built when first needed and
+	//	kept up to date as nodes are added and removed. A node moved other
+	//	than through Moved has the grid built again on the next search.
 	NodeEnumerator 		Select(const WorldRect & r) const;
 	NodeImp * 			Nearest(const WorldPoint & p) const;
 	NodeImp *			SelectOne(const WorldRect & r) const;
 	NodeImp *			Find(const WorldPoint & p) const;
 	NodeEnumerator		FindAttachedLoad(LoadCase lc, NodeLoad theLoad) const;
+	//	update the grid for nodes that were just moved. geometry is the
+	//	stamp's Geometry from before they moved.
+	void				Moved(const NodeList* movedNodes, DlUInt32 geometry);
+	//	find nodes within tol of each other. Nodes are hashed by a tol sized
+	//	grid, so only nearby nodes are compared.
 	bool				Duplicates(const NodeList* movedNodes, DlFloat64 tol) const;
-	void 				StitchMap(const NodeList* movedNodes, DlFloat64 tol, NodeCloneMap& nodeMap) const;
+	void 				StitchMap(const NodeList* movedNodes, DlFloat64 tol, NodeCloneMap& nodeMap,
+							DlThreadPool* pool = nullptr) const;
 
 	//	clone this list into newNodes, with loads going to newLoads.
 	//	create and return a map of the original node pointer to the new ones.
@@ -69,7 +84,11 @@ public:
 
 	void				ShallowClone(NodeList* newNodes, NodeCloneMap& nodeMap) const;
 
-	void				PrepareToAnalyze(const ElementList *elems);
+	//	assign equation numbers. If minimizeProfile is true, the equations are
+	//	renumbered to reduce the skyline profile. The seconds spent finding the
+	//	column starts are put in startsTime if given.
+	void				PrepareToAnalyze(const ElementList *elems, bool minimizeProfile = false,
+							DlFloat64* startsTime = nullptr);
 
 //	void				UpdateLoadCase(bool* isAssigned) const;
 
@@ -82,11 +101,12 @@ public:
 	DlInt32				GetEquationCount() const;
 	DlInt32				GetReactionCount() const;
 	DlInt32				GetMatrixSize() const;
+	DlInt32				GetInitialMatrixSize() const;
 	
 	const std::valarray<DlInt32>&	
 						GetStarts() const;
 						
-	void				AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc);
+	void				AssembleLoads(std::valarray<DlFloat64>& rhs, LoadCase lc) const;
 	
 	// return a list of nodes where the loads have no effect.
 	NodeEnumerator		CheckLoadEquations(NodeLoadType theType) const;
@@ -100,16 +120,31 @@ public:
 	static const NodeList* GetList(const NodeEnumerator& l) { return l.GetList(); }
 	static NodeList* GetList(NodeEnumerator& l) { return l.GetList(); }
 
+protected:
+
+	virtual void	Changed(bool isAdd, NodeImp* elem);
+	virtual void	Changed(bool isAdd, const EnumeratorImp<NodeImp, Node>* list);
+
 private:
 
 	void SetStarts(const ElementList *elems); 
 	
+	const SpatialGrid<NodeImp>&	grid() const;
+	void						sortByIndex(std::vector<NodeImp*>& nodes) const;
+	
 	DlInt32	itsNumEquations;
 	DlInt32 itsNumReactions;
 	DlInt32 itsNumMatrixElems;
+	DlInt32 itsInitialMatrixElems;	//	matrix size before renumbering
 	
 	std::valarray<DlInt32>	itsStarts;	//	row starts
 //	std::valarray<double>	itsMatrix;
+	
+	StructureVersion*				itsVersion;
+	mutable SpatialGrid<NodeImp>	itsGrid;
+	mutable bool					itsGridValid;
+	mutable DlUInt32				itsGridGeometry;	//	itsVersion->Geometry when built
+	mutable DlInt32					itsGridLength;		//	node count when built
 
 };
 
@@ -139,6 +174,12 @@ NodeList::GetMatrixSize() const
 	return itsNumMatrixElems;
 }
 
+inline DlInt32
+NodeList::GetInitialMatrixSize() const
+{
+	return itsInitialMatrixElems;
+}
+
 
 #if 0
 inline void NodeList::Add(const Node& n) 
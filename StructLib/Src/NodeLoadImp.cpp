@@ -33,6 +33,7 @@
 
 #include "StrInputStream.h"
 #include "StrOutputStream.h"
+#include "StrBinaryFormat.h"
 #include "DlAssert.h"
 
 //---------------------------------- Class -------------------------------------
@@ -51,6 +52,15 @@ NodeLoadImp::NodeLoadImp(StrInputStream& input, const frame_data& )
 	}
 }
 
+NodeLoadImp::NodeLoadImp(const StrBinaryNodeLoad& rec)
+	: _isCombo(false)
+{
+	for (int i = 0; i < DOF_PER_NODE; i++) {
+		_type[i] = (NodeLoadType)rec.type[i];
+		_load[i] = rec.value[i];
+	}
+}
+
 void
 NodeLoadImp::SetValue(DlInt32 whichDof, double value)
 {
@@ -81,6 +91,16 @@ NodeLoadImp::Write(StrOutputStream& output, const frame_data& ) const
 	}
 }
 
+void
+NodeLoadImp::WriteRecord(StrBinaryNodeLoad& rec) const
+{
+	rec.reserved = 0;
+	for (int i = 0; i < DOF_PER_NODE; i++) {
+		rec.type[i] = (DlInt32)_type[i];
+		rec.value[i] = _load[i];
+	}
+}
+
 void NodeLoadImp::Add(const NodeLoadImp* imp, DlFloat32 fact)
 {
 	_isCombo = true;
@@ -40,6 +40,7 @@
 class StrInputStream;
 class StrOutputStream;
 class frame_data;
+struct StrBinaryNodeLoad;
 
 const UnitType kNodeLoadUnits[2][DOF_PER_NODE] = {
 	{UnitsForce, UnitsForce, UnitsMoment},
@@ -51,6 +52,7 @@ class NodeLoadImp
 public:
 	NodeLoadImp();
 	NodeLoadImp(StrInputStream& input, const frame_data& data);
+	explicit NodeLoadImp(const StrBinaryNodeLoad& rec);
 //	NodeLoadImp(DlFloat64 values[DOF_PER_NODE]);
 
 	DlFloat64 GetValue(DlInt32 whichDof) const { return _load[whichDof]; }
@@ -61,6 +63,7 @@ public:
 	bool	operator==(const NodeLoadImp& p) const;
 
 	void	Write(StrOutputStream& output, const frame_data& data) const;
+	void	WriteRecord(StrBinaryNodeLoad& rec) const;
 
 	void	Clear() {
 		memset(_type, 0, sizeof(_type));
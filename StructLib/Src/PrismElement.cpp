@@ -43,6 +43,8 @@
 #include "PointEnumeratorImp.h"
 #include "PropertyFactory.h"
 
+#include <algorithm>
+
 using namespace DlArray;
 
 //---------------------------------- Definitions -------------------------------
@@ -95,21 +97,21 @@ const ElementFactory::ElementProcs PrismElement::sElementProcs = {
 	PrismElement::CreateResultTypes
 };
 
-static void	
+template <class Matrix> static void	
 trussKernal(DlFloat64 e, DlFloat64 a, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix);
+	Matrix& m, bool fullMatrix);
 
-static void	
+template <class Matrix> static void	
 leftKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix);
+	Matrix& m, bool fullMatrix);
 
-static void	
+template <class Matrix> static void	
 rightKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix);
+	Matrix& m, bool fullMatrix);
 
-static void	
+template <class Matrix> static void	
 frameKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix);
+	Matrix& m, bool fullMatrix);
 
 //---------------------------------- Methods -----------------------------------
 
@@ -158,6 +160,38 @@ PrismElement::PrismElement(StrInputStream& inp, const frame_data& data)
 //----------------------------------------------------------------------------------------
 void
 PrismElement::Stiffness(DlMatrix<DlFloat64>& m, bool fullMatrix) const
+{
+	stiffness(m, fullMatrix);
+}
+
+//----------------------------------------------------------------------------------------
+//  PrismElement::Stiffness
+//
+//      Compute the stiffness for this element without allocating.
+//
+//  ElementMatrix& m       -> the matrix
+//  bool fullMatrix        -> true if full matrix, otherwise only upper diagonal.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+PrismElement::Stiffness(ElementMatrix& m, bool fullMatrix) const
+{
+	stiffness(m, fullMatrix);
+}
+
+//----------------------------------------------------------------------------------------
+//  PrismElement::stiffness                                                        private
+//
+//      Compute the stiffness for this element into either kind of matrix.
+//
+//  Matrix& m              -> the matrix
+//  bool fullMatrix        -> true if full matrix, otherwise only upper diagonal.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class Matrix> void
+PrismElement::stiffness(Matrix& m, bool fullMatrix) const
 {
 	const WorldPoint& n1 = _nodes[0]->GetCoords();
 	const WorldPoint& n2 = _nodes[1]->GetCoords();
@@ -390,6 +424,65 @@ PrismElement::GetElementForce(double x, const ElementForce& feForce, LoadCase lc
 	frc = ElementForce(forces);
 }
 
+//----------------------------------------------------------------------------------------
+//  PrismElement::GetForceRange
+//
+//      Compute the least and greatest element forces along the element. The
+//      axial and shear forces vary linearly, so their extremes are at the ends.
+//      The moment is parabolic and may also peak where the shear is zero.
+//
+//  const ElementForce& feForce    -> the element forces at 0
+//  LoadCase lc                    -> the load case
+//  ElementForce& least            <- the least value of each force
+//  ElementForce& greatest         <- the greatest value of each force
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+PrismElement::GetForceRange(const ElementForce& feForce, LoadCase lc,
+							ElementForce& least, ElementForce& greatest) const
+{
+	DlFloat64	lateralLoad = 0;
+	DlFloat64	axialLoad = 0;
+
+	const ElemLoadImp* load = GetLoad(lc);
+	if (load) {
+		lateralLoad = load->GetValue(ElementLoadLateral);
+		axialLoad = load->GetValue(ElementLoadAxial);
+	}
+
+	DlFloat64 len = Length();
+	DlFloat64 atStart[DOF_PER_NODE];
+	DlFloat64 atEnd[DOF_PER_NODE];
+	atStart[AXIAL_COMPONENT] = feForce[AXIAL_COMPONENT];
+	atStart[SHEAR_COMPONENT] = feForce[SHEAR_COMPONENT];
+	atStart[MOMENT_COMPONENT] = feForce[MOMENT_COMPONENT];
+	atEnd[AXIAL_COMPONENT] = feForce[AXIAL_COMPONENT] - axialLoad * len;
+	atEnd[SHEAR_COMPONENT] = feForce[SHEAR_COMPONENT] - lateralLoad * len;
+	atEnd[MOMENT_COMPONENT] = feForce[MOMENT_COMPONENT] + 
+								(feForce[SHEAR_COMPONENT] - lateralLoad * len / 2.0) * len;
+
+	DlFloat64 lo[DOF_PER_NODE];
+	DlFloat64 hi[DOF_PER_NODE];
+	for (int i = 0; i < DOF_PER_NODE; i++) {
+		lo[i] = std::min(atStart[i], atEnd[i]);
+		hi[i] = std::max(atStart[i], atEnd[i]);
+	}
+
+	if (lateralLoad != 0) {
+		DlFloat64 x = feForce[SHEAR_COMPONENT] / lateralLoad;
+		if (x > 0 && x < len) {
+			DlFloat64 peak = feForce[MOMENT_COMPONENT] + 
+								(feForce[SHEAR_COMPONENT] - lateralLoad * x / 2.0) * x;
+			lo[MOMENT_COMPONENT] = std::min(lo[MOMENT_COMPONENT], peak);
+			hi[MOMENT_COMPONENT] = std::max(hi[MOMENT_COMPONENT], peak);
+		}
+	}
+
+	least = ElementForce(lo);
+	greatest = ElementForce(hi);
+}
+
 // Convert DOF forces into local force list.
 //----------------------------------------------------------------------------------------
 //  PrismElement::GetLocalForce
@@ -725,6 +818,90 @@ PrismElement::computePinnedEndSlope(const ElementCompData& data,const LoadCaseRe
 	return slope;
 }
 
+//----------------------------------------------------------------------------------------
+//  PrismElement::SampleResults
+//
+//      sample a force or displacement at several points along the element.
+//      Every result is a polynomial of at most fourth degree in u, so the
+//      element data is gathered once into its coefficients and the samples
+//      are a single loop of multiply-adds.
+//
+//  ElementResultKind kind     -> force or displacement.
+//  DlInt32 dof                -> the component.
+//  DlInt32 index              -> the element index.
+//  const DlFloat64* u         -> the locations [0, 1].
+//  DlInt32 count              -> the number of locations.
+//  const LoadCaseResults& res -> the results.
+//  DlFloat64* values          <- the value at each location.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+PrismElement::SampleResults(ElementResultKind kind, DlInt32 dof, DlInt32 index,
+							const DlFloat64* u, DlInt32 count,
+							const LoadCaseResults& res, DlFloat64* values) const
+{
+	const ElementForce& frc = res.GetElementForce(index);
+	ElementCompData data;
+	computeElementData(frc, res, data);
+	
+	const DlFloat64 len = data.len;
+	DlFloat64 c[5] = { 0, 0, 0, 0, 0 };
+	
+	if (kind == ElementResultForce) {
+		switch(dof)
+		{
+			case 0:
+				c[0] = frc[AXIAL_COMPONENT];
+				c[1] = -data.axialLoad * len;
+				break;
+			case 1:
+				c[0] = frc[SHEAR_COMPONENT];
+				c[1] = -data.lateralLoad * len;
+				break;
+			case 2:
+				c[0] = frc[MOMENT_COMPONENT];
+				c[1] = frc[SHEAR_COMPONENT] * len;
+				c[2] = -data.lateralLoad * len * len / 2.0;
+				break;
+		}
+	} else {
+		DlFloat64 displacements[DOF_PER_NODE];
+		res.GetDisplacement(StartNode(), displacements);
+		DlFloat64 slope = displacements[2];
+		if (data.isPinnedLeft && dof != 0)
+			slope = computePinnedEndSlope(data, res);
+		
+		const DlFloat64 m0 = data.moment - data.premoment;
+		switch(dof)
+		{
+			case 0:
+				c[0] = data.cost * displacements[0] + data.sint * displacements[1];
+				c[1] = -data.axialForce * len / data.ea;
+				c[2] = -0.5 * data.axialLoad * len * len / data.ea;
+				break;
+			case 1:
+				c[0] = data.cost * displacements[1] - data.sint * displacements[0];
+				c[1] = -slope * len;
+				c[2] = m0 * len * len / (2.0 * data.ei);
+				c[3] = data.shearForce * len * len * len / (6.0 * data.ei);
+				c[4] = -data.lateralLoad * len * len * len * len / (24.0 * data.ei);
+				break;
+			case 2:
+				c[0] = slope;
+				c[1] = -m0 * len / data.ei;
+				c[2] = -data.shearForce * len * len / (2.0 * data.ei);
+				c[3] = data.lateralLoad * len * len * len / (6.0 * data.ei);
+				break;
+		}
+	}
+	
+	for (DlInt32 i = 0; i < count; i++) {
+		const DlFloat64 x = u[i];
+		values[i] = c[0] + x * (c[1] + x * (c[2] + x * (c[3] + x * c[4])));
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  PrismElement::DisplacedCoords
 //
@@ -1488,18 +1665,16 @@ PrismElement::CreateResultTypes()
 //
 //      fill the symmetric elements in the given symmetric matrix
 //
-//  DlMatrix<DlFloat64>& m -> the matrix
+//  Matrix& m              -> the matrix
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-static void
-fillMatrix(DlMatrix<DlFloat64>& m)
+template <class Matrix> static void
+fillMatrix(Matrix& m)
 {
 	for (DlInt32 j = 1; j <= 6; j++) {
-		DlSliceIter<DlFloat64> r(m.row(j));
-		DlSliceIter<DlFloat64> c(m.col(j));
 		for (DlInt32 k = j+1; k <= 6; k++) {
-			c[k] = r[k];
+			m[k][j] = m[j][k];
 		}
 	}
 }
@@ -1514,14 +1689,14 @@ fillMatrix(DlMatrix<DlFloat64>& m)
 //  DlFloat64 l            -> the length
 //  DlFloat64 c            -> the cosine
 //  DlFloat64 s            -> the sine
-//  DlMatrix<DlFloat64>& m <-> the stiffness matrix
+//  Matrix& m              <-> the stiffness matrix
 //  bool fullMatrix        -> true to compute the lower diagonal too.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-static void	
+template <class Matrix> static void	
 trussKernal(DlFloat64 e, DlFloat64 a, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix)
+	Matrix& m, bool fullMatrix)
 {	
 	DlFloat64 eal = e * a / l;
 	DlFloat64 csq = c*c;
@@ -1570,14 +1745,14 @@ trussKernal(DlFloat64 e, DlFloat64 a, DlFloat64 l, DlFloat64 c, DlFloat64 s,
 //  DlFloat64 l            -> the length
 //  DlFloat64 c            -> the cosine
 //  DlFloat64 s            -> the sine
-//  DlMatrix<DlFloat64>& m <-> the stiffness matrix
+//  Matrix& m              <-> the stiffness matrix
 //  bool fullMatrix        -> true to compute the lower diagonal too.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-static void	
+template <class Matrix> static void	
 leftKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-		DlMatrix<DlFloat64>& m, bool fullMatrix)
+		Matrix& m, bool fullMatrix)
 {	
 	DlFloat64 eal = e * a / l;
 	DlFloat64 eil = 3.0 * e * i / l;
@@ -1635,14 +1810,14 @@ leftKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFl
 //  DlFloat64 l            -> the length
 //  DlFloat64 c            -> the cosine
 //  DlFloat64 s            -> the sine
-//  DlMatrix<DlFloat64>& m <-> the stiffness matrix
+//  Matrix& m              <-> the stiffness matrix
 //  bool fullMatrix        -> true to compute the lower diagonal too.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-static void	
+template <class Matrix> static void	
 rightKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix)
+	Matrix& m, bool fullMatrix)
 {	
 	DlFloat64 eal = e * a / l;
 	DlFloat64 eil = 3.0 * e * i / l;
@@ -1701,14 +1876,14 @@ rightKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlF
 //  DlFloat64 l            -> the length
 //  DlFloat64 c            -> the cosine
 //  DlFloat64 s            -> the sine
-//  DlMatrix<DlFloat64>& m <-> the stiffness matrix
+//  Matrix& m              <-> the stiffness matrix
 //  bool fullMatrix        -> true to compute the lower diagonal too.
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-static void	
+template <class Matrix> static void	
 frameKernal(DlFloat64 e, DlFloat64 a, DlFloat64 i, DlFloat64 l, DlFloat64 c, DlFloat64 s, 
-	DlMatrix<DlFloat64>& m, bool fullMatrix)
+	Matrix& m, bool fullMatrix)
 {	
 	DlFloat64 eal = e * a / l;
 	DlFloat64 eil = 2.0 * e * i / l;
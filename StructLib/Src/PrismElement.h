@@ -56,6 +56,7 @@ public:
 			
 	virtual const char* GetType() const { return sElemType; }
 	virtual void Stiffness(DlArray::DlMatrix<DlFloat64>& m, bool fullMatrix) const;
+	virtual void Stiffness(ElementMatrix& m, bool fullMatrix) const;
 	virtual bool FixedEndForces(DlFloat64 loads[2*DOF_PER_NODE], LoadCase loadCase) const;
 
 //	virtual void Read(StrInputStream& inp, const frame_data& data);
@@ -68,6 +69,8 @@ public:
     // return the element forces at where in load case lc
 	virtual void GetElementForce(double where, const ElementForce& feForce, LoadCase lc, ElementForce& force) const;
 	virtual ElementForce GetLocalForce(const DlFloat64 globalForces[DOF_PER_NODE]) const;
+	virtual void GetForceRange(const ElementForce& feForce, LoadCase lc,
+							   ElementForce& least, ElementForce& greatest) const;
     
 	// returns a diagram for the force for DOF dof
 	virtual DlInt32 ForceDOFCoords(DlInt32 dof, DlInt32 index, PointEnumeratorImp* pts, const LoadCaseResults& res) const;
@@ -88,6 +91,10 @@ public:
 	// currently only called by structure-test.
 	virtual DlFloat64 DOFDispAt(DlInt32 dof, DlInt32 index, DlFloat64 u, const LoadCaseResults& res) const;
 
+	virtual void SampleResults(ElementResultKind kind, DlInt32 dof, DlInt32 index,
+							   const DlFloat64* u, DlInt32 count,
+							   const LoadCaseResults& res, DlFloat64* values) const;
+
 	//
 	// Element results for table
 	//
@@ -139,6 +146,8 @@ private:
 	
 	const static ElementFactory::ElementProcs sElementProcs;
 
+	template <class Matrix> void stiffness(Matrix& m, bool fullMatrix) const;
+
 	DlFloat64 computePinnedEndSlope(const ElementCompData& data, const LoadCaseResults& results) const;
 
 	void computeElementData(const ElementForce& frc, const LoadCaseResults& results, ElementCompData& data) const;
@@ -36,6 +36,7 @@
 #include "PropertyTypeList.h"
 #include "StrInputStream.h"
 #include "StrOutputStream.h"
+#include "DlException.h"
 #include "frame_data.h"
 #include "PropertyFactory.h"
 
@@ -54,6 +55,7 @@
 PropertyImp::PropertyImp(const char* title, const PropertyTypeList * propTypes)
 	: _propTypes(propTypes)
 	, _title(title)
+	, _version(nullptr)
 {
 	_values.resize(propTypes->Length());
 	
@@ -87,6 +89,7 @@ PropertyImp::PropertyImp(const PropertyImp& cloneMe)
 	: _propTypes(cloneMe.GetPropertyTypes())
 	, _values(cloneMe._values)
 	, _title(cloneMe._title)
+	, _version(nullptr)
 {
 }
 
@@ -107,6 +110,8 @@ PropertyImp::operator=(const PropertyImp& cloneMe)
         _propTypes = cloneMe.GetPropertyTypes();
 		_values = cloneMe._values;
 		_title = cloneMe._title;
+		if (_version)
+			_version->Changed(this);
     }
     return *this;
 }
@@ -404,3 +409,73 @@ PropertyImp::Write(StrOutputStream& strm, const frame_data& ) const
 		}
 	}
 }
+
+//----------------------------------------------------------------------------------------
+//  PropertyImp::Read
+//
+//      set the values from a binary property record. Int and bool values are
+//		stored as doubles.
+//
+//  const DlFloat64* values    -> the values.
+//  DlUInt32 count             -> the number of values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+PropertyImp::Read(const DlFloat64* values, DlUInt32 count)
+{
+	if (count != static_cast<DlUInt32>(_propTypes->Length()))
+		throw DlException("Property has %u values instead of %u.", count,
+						  (DlUInt32)_propTypes->Length());
+
+	auto valPtr = std::begin(_values);
+	for (DlInt32 i = 0; i < _propTypes->Length(); i++, valPtr++)
+	{
+		switch (_propTypes->GetDataType(i)) {
+		case PropDataFloat:
+			valPtr->floatValue = values[i];
+			break;
+		case PropDataInt:
+			valPtr->intValue = (DlInt32)values[i];
+			break;
+		case PropDataBool:
+			valPtr->boolValue = values[i] != 0;
+			break;
+		default:
+			_DlAssert("invalid property type" == NULL);
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  PropertyImp::WriteRecord
+//
+//      append the values for a binary property record.
+//
+//  std::vector<DlFloat64>& values <- the values are appended.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+PropertyImp::WriteRecord(std::vector<DlFloat64>& values) const
+{
+	auto valPtr = std::begin(_values);
+	for (DlInt32 i = 0; i < _propTypes->Length(); i++, valPtr++)
+	{
+		switch (_propTypes->GetDataType(i)) {
+		case PropDataFloat:
+			values.push_back(valPtr->floatValue);
+			break;
+		case PropDataInt:
+			values.push_back(valPtr->intValue);
+			break;
+		case PropDataBool:
+			values.push_back(valPtr->boolValue ? 1 : 0);
+			break;
+		default:
+			_DlAssert("invalid property type" == NULL);
+			break;
+		}
+	}
+}
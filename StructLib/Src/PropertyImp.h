@@ -35,8 +35,10 @@
 #include "DlAssert.h"
 #include "PropertyTypeList.h"
 #include "UnitTable.h"
+#include "StructureVersion.h"
 #include <memory>
 #include <valarray>
+#include <vector>
 
 //---------------------------------- Class -------------------------------------
 
@@ -77,6 +79,9 @@ public:
 
 	void Read(StrInputStream& strm, const frame_data& data);
 	void Write(StrOutputStream& strm, const frame_data& data) const;
+	//	the values of a binary property record, in the order of the types
+	void Read(const DlFloat64* values, DlUInt32 count);
+	void WriteRecord(std::vector<DlFloat64>& values) const;
 
 	bool	operator==(const PropertyTypeList * e) const;
 	bool	operator==(const PropertyImp& p) const;
@@ -96,6 +101,9 @@ public:
 	const char* GetAssociatedElementType() const;
 	bool		IsElementType(const char* elementType) const;
 	
+	//	the stamp of the structure this property is in, bumped by the setters
+	void		SetVersion(StructureVersion* version) { _version = version; }
+	
 private:
 	DlInt32		GetIndex(const char* id) const;
 	
@@ -108,6 +116,7 @@ private:
 	const PropertyTypeList* 		_propTypes;
 	std::valarray<PropertyValue>	_values;
 	std::string						_title;
+	StructureVersion*				_version;
 };
 
 inline bool PropertyImp::operator==(const PropertyTypeList * e) const 
@@ -166,6 +175,8 @@ PropertyImp::SetFloatValue(DlInt32 index, DlFloat64 val)
 	_DlAssert(_propTypes->GetDataType(index) == PropDataFloat);
 	
 	_values[index].floatValue = val;
+	if (_version)
+		_version->Changed(this);
 }
 
 inline
@@ -176,6 +187,8 @@ PropertyImp::SetIntValue(DlInt32 index, DlInt32 val)
 	_DlAssert(_propTypes->GetDataType(index) == PropDataInt);
 	
 	_values[index].intValue = val;
+	if (_version)
+		_version->Changed(this);
 }
 
 inline
@@ -186,6 +199,8 @@ PropertyImp::SetBoolValue(DlInt32 index, DlBoolean val)
 	_DlAssert(_propTypes->GetDataType(index) == PropDataBool);
 	
 	_values[index].boolValue = val;
+	if (_version)
+		_version->Changed(this);
 }
 
 inline
@@ -71,6 +71,7 @@ private:
 //	size					->	the number of initial elements
 //------------------------------------------------------------------------------
 PropertyList::PropertyList() 
+	: itsVersion(nullptr)
 {
 }
 
@@ -80,6 +81,54 @@ PropertyList::GetListID() const
 	return PropertyListID;
 }
 
+//------------------------------------------------------------------------------
+//	PropertyList::SetVersion
+//
+//		give the properties, and those added later, the stamp of the
+//		structure.
+//
+//	version					->	the stamp.
+//------------------------------------------------------------------------------
+void
+PropertyList::SetVersion(StructureVersion* version)
+{
+	itsVersion = version;
+	for (DlInt32 i = 0; i < Length(); i++)
+		ElementAt(i)->SetVersion(version);
+}
+
+//------------------------------------------------------------------------------
+//	PropertyList::Changed								protected
+//
+//		give an added property the stamp.
+//
+//	isAdd					->	true if added.
+//	elem					->	the property.
+//------------------------------------------------------------------------------
+void
+PropertyList::Changed(bool isAdd, PropertyImp* elem)
+{
+	if (isAdd && itsVersion)
+		elem->SetVersion(itsVersion);
+}
+
+//------------------------------------------------------------------------------
+//	PropertyList::Changed								protected
+//
+//		give added properties the stamp.
+//
+//	isAdd					->	true if added.
+//	list					->	the properties.
+//------------------------------------------------------------------------------
+void
+PropertyList::Changed(bool isAdd, const EnumeratorImp<PropertyImp, Property>* list)
+{
+	if (isAdd && itsVersion) {
+		for (DlInt32 i = 0; i < list->Length(); i++)
+			list->ElementAt(i)->SetVersion(itsVersion);
+	}
+}
+
 //------------------------------------------------------------------------------
 //	PropertyList::findByType
 //
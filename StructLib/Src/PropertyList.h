@@ -48,6 +48,8 @@ public:
 	PropertyList();
 
 	DlUInt32	GetListID() const;
+	//	give the properties the stamp of the structure the list holds
+	void			SetVersion(StructureVersion* version);
 	//	build the list by reading it
 	void			Read(StrInputStream& inp, DlInt32 count, const frame_data& data);
 	void 			Write(StrOutputStream & out, const frame_data& data) const;
@@ -66,6 +68,13 @@ public:
 //
 	static const PropertyList* GetList(const PropertyEnumerator& l) { return l.GetList(); }
 	static PropertyList* GetList(PropertyEnumerator& l) { return l.GetList(); }
+
+protected:
+	virtual void	Changed(bool isAdd, PropertyImp* elem);
+	virtual void	Changed(bool isAdd, const EnumeratorImp<PropertyImp, Property>* list);
+
+private:
+	StructureVersion*	itsVersion;
 };
 
 //---------------------------------- Inlines -----------------------------------
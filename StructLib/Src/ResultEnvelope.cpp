@@ -0,0 +1,272 @@
+/*+
+ *	File:		ResultEnvelope.cpp
+ *
+ *	Contains:	Governing results over all load cases and combinations
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "ResultEnvelope.h"
+#include "CombinationEngine.h"
+#include "frame_data.h"
+#include "NodeLoadImp.h"
+#include "DlThreadPool.h"
+
+#include <limits>
+#include <memory>
+
+using namespace std;
+
+//	elements or nodes handed to a thread at a time
+const DlInt32 kEnvelopeChunk = 64;
+
+//--------------------------------------- Methods ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  updateEnvelope                                                                 static
+//
+//      widen the extremes to take in value from load case lc.
+//
+//  EnvelopeValue& least   <> the least so far.
+//  EnvelopeValue& most    <> the greatest so far.
+//  DlFloat64 lo           -> the least value in this load case.
+//  DlFloat64 hi           -> the greatest value in this load case.
+//  LoadCase lc            -> the load case.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+static inline void
+updateEnvelope(EnvelopeValue& least, EnvelopeValue& most, DlFloat64 lo, DlFloat64 hi, LoadCase lc)
+{
+	if (lo < least.value) {
+		least.value = lo;
+		least.loadCase = lc;
+	}
+	if (hi > most.value) {
+		most.value = hi;
+		most.loadCase = lc;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::ResultEnvelope                                             constructor
+//
+//      construct an empty envelope.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultEnvelope::ResultEnvelope()
+	: itsElementCount(0)
+	, itsNodeCount(0)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::Compute
+//
+//      find the extremes over all the load cases and combinations in one pass.
+//      The load cases come first, straight from their results, and then the
+//      combinations as the CombinationEngine forms them. Each batch is split
+//      among the threads by element and node.
+//
+//  const frame_data& data     -> the analyzed structure.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultEnvelope::Compute(const frame_data& data)
+{
+	itsElementCount = 0;
+	itsNodeCount = 0;
+	itsMinForce.clear();
+	itsMaxForce.clear();
+	itsMinDisp.clear();
+	itsMaxDisp.clear();
+	
+	if (!data.Analyzed())
+		return;
+	
+	CombinationEngine engine(data);
+	if (engine.GetBasisCount() == 0)
+		return;
+	
+	itsElementCount = data.Elements().Length();
+	itsNodeCount = data.Nodes().Length();
+	
+	const EnvelopeValue least = { numeric_limits<DlFloat64>::max(), 0 };
+	const EnvelopeValue most = { -numeric_limits<DlFloat64>::max(), 0 };
+	itsMinForce.assign(itsElementCount * DOF_PER_NODE, least);
+	itsMaxForce.assign(itsElementCount * DOF_PER_NODE, most);
+	itsMinDisp.assign(itsNodeCount * DOF_PER_NODE, least);
+	itsMaxDisp.assign(itsNodeCount * DOF_PER_NODE, most);
+	
+	std::unique_ptr<DlThreadPool> pool;
+	DlUInt32 threads = data.GetAnalysisOptions().solverThreads;
+	if (threads != 1)
+		pool.reset(NEW DlThreadPool(threads));
+	
+	std::vector<LoadCase> cases;
+	for (DlInt32 i = 0; i < engine.GetBasisCount(); i++)
+		cases.push_back(engine.GetBasisLoadCase(i));
+	addCases(data, engine, cases.data(), cases.size(), engine.GetBasis(0), pool.get());
+	
+	auto combine = [&](DlInt32 first, DlInt32 count, const DlFloat64* values) {
+		cases.clear();
+		for (DlInt32 i = 0; i < count; i++)
+			cases.push_back(engine.GetLoadCase(first + i));
+		addCases(data, engine, cases.data(), count, values, pool.get());
+	};
+	engine.StreamBatches(combine);
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::addCases                                                      private
+//
+//      take a batch of load cases into the envelope.
+//
+//  const frame_data& data             -> the structure.
+//  const CombinationEngine& engine    -> the packed layout.
+//  const LoadCase* cases              -> the load case of each row.
+//  DlInt32 count                      -> the number of rows.
+//  const DlFloat64* values            -> the packed results, one row per load case.
+//  DlThreadPool* pool                 -> the threads to use, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultEnvelope::addCases(const frame_data& data, const CombinationEngine& engine,
+						 const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+						 DlThreadPool* pool)
+{
+	const DlInt32 elemChunks = (itsElementCount + kEnvelopeChunk - 1) / kEnvelopeChunk;
+	const DlInt32 nodeChunks = (itsNodeCount + kEnvelopeChunk - 1) / kEnvelopeChunk;
+	
+	//	each chunk updates its own elements or nodes, so they need no locking.
+	auto addChunk = [&](DlInt32 chunk) {
+		if (chunk < elemChunks) {
+			DlInt32 first = chunk * kEnvelopeChunk;
+			addElements(data, engine, cases, count, values,
+						first, min(first + kEnvelopeChunk, itsElementCount));
+		} else {
+			DlInt32 first = (chunk - elemChunks) * kEnvelopeChunk;
+			addNodes(data, engine, cases, count, values,
+					 first, min(first + kEnvelopeChunk, itsNodeCount));
+		}
+	};
+	
+	if (pool) {
+		pool->ParallelFor(0, elemChunks + nodeChunks, addChunk);
+	} else {
+		for (DlInt32 chunk = 0; chunk < elemChunks + nodeChunks; chunk++)
+			addChunk(chunk);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::addElements                                                   private
+//
+//      take the forces along elements [first, last) into the envelope.
+//
+//  const frame_data& data             -> the structure.
+//  const CombinationEngine& engine    -> the packed layout.
+//  const LoadCase* cases              -> the load case of each row.
+//  DlInt32 count                      -> the number of rows.
+//  const DlFloat64* values            -> the packed results.
+//  DlInt32 first                      -> the first element.
+//  DlInt32 last                       -> one past the last element.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultEnvelope::addElements(const frame_data& data, const CombinationEngine& engine,
+							const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+							DlInt32 first, DlInt32 last)
+{
+	const size_t n = engine.GetValueCount();
+	const DlInt32 offset = engine.GetElementForceOffset();
+	const ElementList& elems = data.Elements();
+	
+	for (DlInt32 e = first; e < last; e++) {
+		const ElementImp* elem = elems.ElementAt(e);
+		EnvelopeValue* least = &itsMinForce[e * DOF_PER_NODE];
+		EnvelopeValue* most = &itsMaxForce[e * DOF_PER_NODE];
+		
+		for (DlInt32 c = 0; c < count; c++) {
+			ElementForce feForce(values + c * n + offset + e * DOF_PER_NODE);
+			ElementForce lo, hi;
+			elem->GetForceRange(feForce, cases[c], lo, hi);
+			for (DlInt32 j = 0; j < DOF_PER_NODE; j++)
+				updateEnvelope(least[j], most[j], lo[j], hi[j], cases[c]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope::addNodes                                                      private
+//
+//      take the displacements of nodes [first, last) into the envelope. A
+//      restrained DOF moves only by a displacement applied in the load case.
+//
+//  const frame_data& data             -> the structure.
+//  const CombinationEngine& engine    -> the packed layout.
+//  const LoadCase* cases              -> the load case of each row.
+//  DlInt32 count                      -> the number of rows.
+//  const DlFloat64* values            -> the packed results.
+//  DlInt32 first                      -> the first node.
+//  DlInt32 last                       -> one past the last node.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultEnvelope::addNodes(const frame_data& data, const CombinationEngine& engine,
+						 const LoadCase* cases, DlInt32 count, const DlFloat64* values,
+						 DlInt32 first, DlInt32 last)
+{
+	const size_t n = engine.GetValueCount();
+	const NodeList& nodes = data.Nodes();
+	
+	for (DlInt32 i = first; i < last; i++) {
+		const NodeImp* nd = nodes.ElementAt(i);
+		EnvelopeValue* least = &itsMinDisp[i * DOF_PER_NODE];
+		EnvelopeValue* most = &itsMaxDisp[i * DOF_PER_NODE];
+		
+		for (DlInt32 c = 0; c < count; c++) {
+			const DlFloat64* disp = values + c * n;
+			const NodeLoadImp* load = nd->GetLoad(cases[c]);
+			for (DlInt32 j = 0; j < DOF_PER_NODE; j++) {
+				DlInt32 eq = nd->GetEquationNumber(j);
+				DlFloat64 d = 0;
+				if (eq > 0)
+					d = disp[eq - 1];
+				else if (load && load->GetType(j) == NodeLoadIsDisp)
+					d = load->GetValue(j);
+				updateEnvelope(least[j], most[j], d, d, cases[c]);
+			}
+		}
+	}
+}
+
+//	eof
@@ -0,0 +1,554 @@
+/*+
+ *	File:		ResultsFile.cpp
+ *
+ *	Contains:	Random access to a saved results file
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlPlatform.h"
+#include "ResultsFile.h"
+#include "StrBinaryFormat.h"
+#include "DlAssert.h"
+#include "DlException.h"
+
+#include <algorithm>
+#include <cstring>
+
+//---------------------------------- Class -------------------------------------
+
+//	writes bits, most significant first.
+class ColumnBitWriter
+{
+public:
+	ColumnBitWriter(std::vector<DlUInt8>& data) : _data(data), _byte(0), _bits(0) {}
+
+	void	Put(DlUInt64 value, int count);
+	void	Flush();
+
+private:
+	std::vector<DlUInt8>&	_data;
+	DlUInt8					_byte;
+	int						_bits;
+};
+
+//	reads bits written by ColumnBitWriter.
+class ColumnBitReader
+{
+public:
+	ColumnBitReader(const DlUInt8* data, DlUInt64 length)
+		: _data(data), _length(length), _pos(0), _bits(0) {}
+
+	DlUInt64	Get(int count);
+
+private:
+	const DlUInt8*	_data;
+	DlUInt64		_length;
+	DlUInt64		_pos;
+	int				_bits;
+};
+
+//---------------------------------- Statics -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  leadingZeros                                                                   static
+//
+//      count the zero bits above the highest one bit.
+//
+//  DlUInt64 x             -> the bits, not 0.
+//
+//  returns int            <- the count.
+//----------------------------------------------------------------------------------------
+static inline int
+leadingZeros(DlUInt64 x)
+{
+	int n = 0;
+	while ((x & (DlUInt64(1) << 63)) == 0) {
+		x <<= 1;
+		n++;
+	}
+	return n;
+}
+
+//----------------------------------------------------------------------------------------
+//  trailingZeros                                                                  static
+//
+//      count the zero bits below the lowest one bit.
+//
+//  DlUInt64 x             -> the bits, not 0.
+//
+//  returns int            <- the count.
+//----------------------------------------------------------------------------------------
+static inline int
+trailingZeros(DlUInt64 x)
+{
+	int n = 0;
+	while ((x & 1) == 0) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+}
+
+//---------------------------------- Methods -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  ColumnBitWriter::Put
+//
+//      write the low count bits of value.
+//
+//  DlUInt64 value         -> the bits.
+//  int count              -> the number of bits, at most 64.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ColumnBitWriter::Put(DlUInt64 value, int count)
+{
+	while (count > 0) {
+		int take = std::min(count, 8 - _bits);
+		DlUInt8 chunk = (value >> (count - take)) & ((1u << take) - 1);
+		_byte |= chunk << (8 - _bits - take);
+		_bits += take;
+		count -= take;
+		if (_bits == 8) {
+			_data.push_back(_byte);
+			_byte = 0;
+			_bits = 0;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ColumnBitWriter::Flush
+//
+//      write the last partial byte.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ColumnBitWriter::Flush()
+{
+	if (_bits > 0) {
+		_data.push_back(_byte);
+		_byte = 0;
+		_bits = 0;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ColumnBitReader::Get
+//
+//      read count bits.
+//
+//  int count              -> the number of bits, at most 64.
+//
+//  returns DlUInt64       <- the bits.
+//----------------------------------------------------------------------------------------
+DlUInt64
+ColumnBitReader::Get(int count)
+{
+	DlUInt64 value = 0;
+	while (count > 0) {
+		if (_pos >= _length)
+			throw DlException("Results column is damaged");
+
+		int take = std::min(count, 8 - _bits);
+		DlUInt64 chunk = (_data[_pos] >> (8 - _bits - take)) & ((1u << take) - 1);
+		value = (value << take) | chunk;
+		_bits += take;
+		count -= take;
+		if (_bits == 8) {
+			_pos++;
+			_bits = 0;
+		}
+	}
+	return value;
+}
+
+//----------------------------------------------------------------------------------------
+//  EncodeResultColumn
+//
+//      compress a column. The first value is kept whole. Each one after is
+//		xored with the one before, then written as a 0 bit if they are the
+//		same, or as a 1 bit, 5 bits of leading zeros, 6 bits of length less
+//		one and the bits between the leading and trailing zeros.
+//
+//  const DlFloat64* values        -> the values.
+//  DlUInt32 count                 -> the number of values.
+//  std::vector<DlUInt8>& data     <- the compressed values are appended.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+EncodeResultColumn(const DlFloat64* values, DlUInt32 count, std::vector<DlUInt8>& data)
+{
+	ColumnBitWriter bits(data);
+	DlUInt64 prev = 0;
+	for (DlUInt32 i = 0; i < count; i++) {
+		DlUInt64 curr;
+		memcpy(&curr, &values[i], sizeof(curr));
+
+		if (i == 0) {
+			bits.Put(curr, 64);
+		} else {
+			DlUInt64 x = curr ^ prev;
+			if (x == 0) {
+				bits.Put(0, 1);
+			} else {
+				int lead = std::min(leadingZeros(x), 31);
+				int trail = trailingZeros(x);
+				int len = 64 - lead - trail;
+				bits.Put(1, 1);
+				bits.Put(lead, 5);
+				bits.Put(len - 1, 6);
+				bits.Put(x >> trail, len);
+			}
+		}
+		prev = curr;
+	}
+	bits.Flush();
+}
+
+//----------------------------------------------------------------------------------------
+//  DecodeResultColumn
+//
+//      decompress a column written by EncodeResultColumn.
+//
+//  const DlUInt8* data    -> the compressed values.
+//  DlUInt64 length        -> the length of data.
+//  DlUInt32 count         -> the number of values.
+//  DlFloat64* values      <- the values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+DecodeResultColumn(const DlUInt8* data, DlUInt64 length, DlUInt32 count, DlFloat64* values)
+{
+	ColumnBitReader bits(data, length);
+	DlUInt64 prev = 0;
+	for (DlUInt32 i = 0; i < count; i++) {
+		DlUInt64 curr;
+		if (i == 0) {
+			curr = bits.Get(64);
+		} else if (bits.Get(1) == 0) {
+			curr = prev;
+		} else {
+			int lead = bits.Get(5);
+			int len = bits.Get(6) + 1;
+			if (lead + len > 64)
+				throw DlException("Results column is damaged");
+			curr = prev ^ (bits.Get(len) << (64 - lead - len));
+		}
+		memcpy(&values[i], &curr, sizeof(curr));
+		prev = curr;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::ResultsFile                                                  constructor
+//
+//      map a results file.
+//
+//  const char* path       -> the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultsFile::ResultsFile(const char* path)
+	: itsFile(NEW StrMappedFile(path))
+{
+	init(itsFile->Data(), itsFile->Length());
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::ResultsFile                                                  constructor
+//
+//      read a results file image.
+//
+//  const void* image      -> the file.
+//  DlUInt64 length        -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultsFile::ResultsFile(const void* image, DlUInt64 length)
+{
+	init(image, length);
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::~ResultsFile                                                  destructor
+//
+//      unmap the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultsFile::~ResultsFile()
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::init                                                             private
+//
+//      find the sections and check the column index against the data.
+//
+//  const void* image      -> the file.
+//  DlUInt64 length        -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultsFile::init(const void* image, DlUInt64 length)
+{
+	itsReader.reset(NEW StrBinaryReader(image, length));
+
+	const StrBinaryResults* results;
+	if (itsReader->GetSection(kStrBinaryResults, results) != 1)
+		throw DlException("Not a results file");
+	itsNodeCount = results->nodeCount;
+	itsElementCount = results->elementCount;
+
+	itsCaseCount = itsReader->GetSection(kStrBinaryResultCases, itsCases);
+	itsColumnCount = itsReader->GetSection(kStrBinaryResultColumns, itsColumns);
+	itsDataLength = itsReader->GetSection(kStrBinaryResultData, itsData);
+
+	const DlUInt32 columnsPerCase = ResultQuantityCount * DOF_PER_NODE;
+	for (DlUInt32 i = 0; i < itsCaseCount; i++) {
+		const StrBinaryResultCase& c = itsCases[i];
+		if ((i > 0 && c.loadCase <= itsCases[i - 1].loadCase) || c.firstColumn > itsColumnCount
+				|| columnsPerCase > itsColumnCount - c.firstColumn)
+			throw DlException("Bad load case in results file");
+	}
+
+	for (DlUInt64 i = 0; i < itsColumnCount; i++) {
+		const StrBinaryResultColumn& col = itsColumns[i];
+		bool ok = col.quantity < ResultQuantityCount && col.component < DOF_PER_NODE
+			&& col.count == GetColumnLength(ResultQuantity(col.quantity))
+			&& col.offset <= itsDataLength && col.length <= itsDataLength - col.offset;
+		if (col.encoding == kStrBinaryColumnRaw) {
+			ok = ok && col.offset % sizeof(DlFloat64) == 0
+				&& col.length == DlUInt64(col.count) * sizeof(DlFloat64);
+		} else if (col.encoding != kStrBinaryColumnXor) {
+			ok = false;
+		}
+		if (!ok)
+			throw DlException("Bad column in results file");
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetNodeCount
+//
+//      return the number of nodes in the structure saved.
+//
+//  returns DlUInt32       <- the number of nodes.
+//----------------------------------------------------------------------------------------
+DlUInt32
+ResultsFile::GetNodeCount() const
+{
+	return itsNodeCount;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetElementCount
+//
+//      return the number of elements in the structure saved.
+//
+//  returns DlUInt32       <- the number of elements.
+//----------------------------------------------------------------------------------------
+DlUInt32
+ResultsFile::GetElementCount() const
+{
+	return itsElementCount;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetLoadCaseCount
+//
+//      return the number of load cases saved.
+//
+//  returns DlUInt32       <- the number of load cases.
+//----------------------------------------------------------------------------------------
+DlUInt32
+ResultsFile::GetLoadCaseCount() const
+{
+	return itsCaseCount;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetLoadCase
+//
+//      return one of the load cases saved.
+//
+//  DlUInt32 which         -> the index, less than GetLoadCaseCount.
+//
+//  returns LoadCase       <- the load case.
+//----------------------------------------------------------------------------------------
+LoadCase
+ResultsFile::GetLoadCase(DlUInt32 which) const
+{
+	_DlAssert(which < itsCaseCount);
+	return itsCases[which].loadCase;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::HasLoadCase
+//
+//      return true if load case lc was saved.
+//
+//  LoadCase lc            -> the load case.
+//
+//  returns bool           <- true if saved.
+//----------------------------------------------------------------------------------------
+bool
+ResultsFile::HasLoadCase(LoadCase lc) const
+{
+	const StrBinaryResultCase* end = itsCases + itsCaseCount;
+	const StrBinaryResultCase* c = std::lower_bound(itsCases, end, lc,
+		[](const StrBinaryResultCase& c, LoadCase lc) { return LoadCase(c.loadCase) < lc; });
+	return c != end && LoadCase(c->loadCase) == lc;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetCase
+//
+//      return the record of load case lc.
+//
+//  LoadCase lc                        -> the load case.
+//
+//  returns const StrBinaryResultCase& <- the record.
+//----------------------------------------------------------------------------------------
+const StrBinaryResultCase&
+ResultsFile::GetCase(LoadCase lc) const
+{
+	const StrBinaryResultCase* end = itsCases + itsCaseCount;
+	const StrBinaryResultCase* c = std::lower_bound(itsCases, end, lc,
+		[](const StrBinaryResultCase& c, LoadCase lc) { return LoadCase(c.loadCase) < lc; });
+	if (c == end || LoadCase(c->loadCase) != lc)
+		throw DlException("Load case %u is not in the results file", lc);
+	return *c;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::GetColumnLength
+//
+//      return the number of values in a column.
+//
+//  ResultQuantity q       -> the quantity.
+//
+//  returns DlUInt32       <- the node or element count.
+//----------------------------------------------------------------------------------------
+DlUInt32
+ResultsFile::GetColumnLength(ResultQuantity q) const
+{
+	return q == ResultElementForce ? itsElementCount : itsNodeCount;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::findColumn                                                       private
+//
+//      find the column for a quantity and component of load case lc.
+//
+//  LoadCase lc                            -> the load case.
+//  ResultQuantity q                       -> the quantity.
+//  DlInt32 component                      -> the component.
+//
+//  returns const StrBinaryResultColumn&   <- the column.
+//----------------------------------------------------------------------------------------
+const StrBinaryResultColumn&
+ResultsFile::findColumn(LoadCase lc, ResultQuantity q, DlInt32 component) const
+{
+	_DlAssert(q >= 0 && q < ResultQuantityCount && component >= 0 && component < DOF_PER_NODE);
+
+	const StrBinaryResultCase& c = GetCase(lc);
+	const StrBinaryResultColumn& col = itsColumns[c.firstColumn + q * DOF_PER_NODE + component];
+	if (LoadCase(col.loadCase) != lc || col.quantity != q || col.component != component)
+		throw DlException("Bad column in results file");
+	return col;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::ReadColumn
+//
+//      read one column.
+//
+//  LoadCase lc            -> the load case.
+//  ResultQuantity q       -> the quantity.
+//  DlInt32 component      -> the component.
+//  DlFloat64* values      <- GetColumnLength(q) values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultsFile::ReadColumn(LoadCase lc, ResultQuantity q, DlInt32 component, DlFloat64* values) const
+{
+	const StrBinaryResultColumn& col = findColumn(lc, q, component);
+	if (col.encoding == kStrBinaryColumnRaw)
+		memcpy(values, itsData + col.offset, col.length);
+	else
+		DecodeResultColumn(itsData + col.offset, col.length, col.count, values);
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::ReadColumn
+//
+//      read one column into a vector.
+//
+//  LoadCase lc                        -> the load case.
+//  ResultQuantity q                   -> the quantity.
+//  DlInt32 component                  -> the component.
+//  std::vector<DlFloat64>& values     <- the values.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+ResultsFile::ReadColumn(LoadCase lc, ResultQuantity q, DlInt32 component,
+						std::vector<DlFloat64>& values) const
+{
+	values.resize(GetColumnLength(q));
+	if (!values.empty())
+		ReadColumn(lc, q, component, &values[0]);
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFile::MapColumn
+//
+//      return an uncompressed column in place.
+//
+//  LoadCase lc                -> the load case.
+//  ResultQuantity q           -> the quantity.
+//  DlInt32 component          -> the component.
+//
+//  returns const DlFloat64*   <- the values, or nullptr if compressed.
+//----------------------------------------------------------------------------------------
+const DlFloat64*
+ResultsFile::MapColumn(LoadCase lc, ResultQuantity q, DlInt32 component) const
+{
+	const StrBinaryResultColumn& col = findColumn(lc, q, component);
+	if (col.encoding != kStrBinaryColumnRaw)
+		return nullptr;
+	return reinterpret_cast<const DlFloat64*>(itsData + col.offset);
+}
+
+//	eof
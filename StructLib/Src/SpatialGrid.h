@@ -0,0 +1,493 @@
+/*+
+ *	File:		SpatialGrid.h
+ *
+ *	Contains:	Uniform grid of items by their bounds, for hit testing
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	The plane is cut into square cells and each item is kept in the cells its
+ *	bounds touch. Only the cells that hold items are stored, so the grid
+ *	grows with the items rather than with the area. An item that would touch
+ *	more than kSpatialGridMaxCells cells, such as a long brace across the
+ *	structure, is kept in a list that every search looks through instead.
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_SpatialGrid
+#define _H_SpatialGrid
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+#include "WorldRect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+//---------------------------------- Declares ----------------------------------
+
+const DlInt32 kSpatialGridMaxCells = 64;
+
+//---------------------------------- Class -------------------------------------
+
+template <class T>
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+	SpatialGrid(const SpatialGrid& g);
+	SpatialGrid& operator=(const SpatialGrid& g);
+
+	//	empty the grid and set the size of a cell
+	void		Reset(DlFloat64 cellSize);
+	bool		IsEmpty() const					{ return itsItems.empty(); }
+	DlInt32		Count() const					{ return itsItems.size(); }
+	DlFloat64	CellSize() const				{ return itsCellSize; }
+
+	//	add item, or move it if it is already in the grid
+	void		Insert(T* item, const WorldRect& bounds);
+	void		Remove(T* item);
+	bool		Contains(const T* item) const;
+
+	//	call p(item) once for each item whose bounds intersect r
+	template <class P> void Search(const WorldRect& r, P& p) const;
+
+	//	call p(item) for the items in rings of cells around pt, until the
+	//	cells left are further from pt than the nearest item found. p returns
+	//	the distance to the nearest item so far, or -1 if there is none.
+	template <class P> void SearchNear(const WorldPoint& pt, P& p) const;
+
+	//	a cell size that puts a few items in each cell, for count items of
+	//	about itemSize spread over bounds
+	static DlFloat64	ChooseCellSize(const WorldRect& bounds, DlInt32 count, DlFloat64 itemSize);
+
+private:
+	struct Entry {
+		T*				item;
+		WorldRect		bounds;
+		DlInt32			cells[4];		//	left, bottom, right, top or all 0 if large
+		bool			large;
+		mutable DlUInt32	mark;
+	};
+
+	typedef std::vector<Entry*>						Cell;
+	typedef std::unordered_map<DlInt64, Cell>		CellMap;
+	typedef std::unordered_map<const T*, Entry>		EntryMap;
+
+	DlInt32			cellIndex(DlFloat64 c) const;
+	static DlInt64	cellKey(DlInt32 x, DlInt32 y)	{ return DlInt64((DlUInt64(DlUInt32(x)) << 32) | DlUInt32(y)); }
+	void			link(Entry& e);
+	void			unlink(Entry& e);
+	template <class P> void visit(const Cell& cell, P& p) const;
+
+	DlFloat64			itsCellSize;
+	CellMap				itsCells;
+	EntryMap			itsItems;
+	Cell				itsLarge;
+	DlInt32				itsExtent[4];	//	of the occupied cells
+	mutable DlUInt32	itsMark;
+};
+
+//---------------------------------- Inlines -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::SpatialGrid                                               constructor
+//
+//      construct an empty grid.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline
+SpatialGrid<T>::SpatialGrid()
+	: itsCellSize(1)
+	, itsMark(0)
+{
+	itsExtent[0] = itsExtent[1] = itsExtent[2] = itsExtent[3] = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::SpatialGrid                                               constructor
+//
+//      copy a grid. The cells hold pointers to the entries, so they are built
+//		again for the copies.
+//
+//  const SpatialGrid& g   -> the grid to copy.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline
+SpatialGrid<T>::SpatialGrid(const SpatialGrid& g)
+	: itsCellSize(g.itsCellSize)
+	, itsMark(0)
+{
+	itsExtent[0] = itsExtent[1] = itsExtent[2] = itsExtent[3] = 0;
+	for (const auto& e : g.itsItems)
+		Insert(e.second.item, e.second.bounds);
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::operator=
+//
+//      copy a grid.
+//
+//  const SpatialGrid& g   -> the grid to copy.
+//
+//  returns SpatialGrid&   <- this grid.
+//----------------------------------------------------------------------------------------
+template <class T> inline SpatialGrid<T>&
+SpatialGrid<T>::operator=(const SpatialGrid& g)
+{
+	if (this != &g) {
+		Reset(g.itsCellSize);
+		for (const auto& e : g.itsItems)
+			Insert(e.second.item, e.second.bounds);
+	}
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::Reset
+//
+//      empty the grid.
+//
+//  DlFloat64 cellSize     -> the size of a cell, greater than 0.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+SpatialGrid<T>::Reset(DlFloat64 cellSize)
+{
+	itsCellSize = cellSize > 0 ? cellSize : 1;
+	itsCells.clear();
+	itsItems.clear();
+	itsLarge.clear();
+	itsExtent[0] = itsExtent[1] = itsExtent[2] = itsExtent[3] = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::Insert
+//
+//      add an item, or move it to new bounds.
+//
+//  T* item                    -> the item.
+//  const WorldRect& bounds    -> its bounds.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+SpatialGrid<T>::Insert(T* item, const WorldRect& bounds)
+{
+	bool added = itsItems.find(item) == itsItems.end();
+	Entry& e = itsItems[item];
+	if (!added)
+		unlink(e);
+
+	e.item = item;
+	e.bounds = bounds;
+	e.mark = itsMark;
+	link(e);
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::Remove
+//
+//      remove an item if it is in the grid.
+//
+//  T* item                -> the item.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+SpatialGrid<T>::Remove(T* item)
+{
+	typename EntryMap::iterator found = itsItems.find(item);
+	if (found != itsItems.end()) {
+		unlink(found->second);
+		itsItems.erase(found);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::Contains
+//
+//      return true if the item is in the grid.
+//
+//  const T* item          -> the item.
+//
+//  returns bool           <- true if found.
+//----------------------------------------------------------------------------------------
+template <class T> inline bool
+SpatialGrid<T>::Contains(const T* item) const
+{
+	return itsItems.find(item) != itsItems.end();
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::Search
+//
+//      call p for each item whose bounds intersect r.
+//
+//  const WorldRect& r     -> the rectangle.
+//  P& p                   -> called as p(T*).
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> template <class P> inline void
+SpatialGrid<T>::Search(const WorldRect& r, P& p) const
+{
+	if (itsItems.empty())
+		return;
+
+	++itsMark;
+	DlInt32 left = std::max(cellIndex(r.left()), itsExtent[0]);
+	DlInt32 bottom = std::max(cellIndex(r.bottom()), itsExtent[1]);
+	DlInt32 right = std::min(cellIndex(r.right()), itsExtent[2]);
+	DlInt32 top = std::min(cellIndex(r.top()), itsExtent[3]);
+
+	auto test = [&r, &p](T* item, const WorldRect& bounds) {
+		if (r.intersects(bounds))
+			p(item);
+	};
+
+	//	a rectangle covering more cells than there are items is faster
+	//	checked against each item
+	if (left <= right && bottom <= top
+			&& DlFloat64(right - left + 1) * (top - bottom + 1) > itsCells.size()) {
+		for (const auto& c : itsCells)
+			visit(c.second, test);
+	} else {
+		for (DlInt32 x = left; x <= right; x++) {
+			for (DlInt32 y = bottom; y <= top; y++) {
+				typename CellMap::const_iterator c = itsCells.find(cellKey(x, y));
+				if (c != itsCells.end())
+					visit(c->second, test);
+			}
+		}
+	}
+	visit(itsLarge, test);
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::SearchNear
+//
+//      call p for the items in rings of cells around pt, until the items
+//		outside the rings searched are further away than the nearest found.
+//
+//  const WorldPoint& pt   -> the point.
+//  P& p                   -> called as p(T*), returns the nearest distance so far.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> template <class P> inline void
+SpatialGrid<T>::SearchNear(const WorldPoint& pt, P& p) const
+{
+	if (itsItems.empty())
+		return;
+
+	++itsMark;
+	DlFloat64 best = -1;
+	auto test = [&p, &best](T* item, const WorldRect&) {
+		best = p(item);
+	};
+	visit(itsLarge, test);
+
+	DlInt32 cx = cellIndex(pt.x());
+	DlInt32 cy = cellIndex(pt.y());
+	DlInt32 rings = std::max(std::max(cx - itsExtent[0], itsExtent[2] - cx),
+							 std::max(cy - itsExtent[1], itsExtent[3] - cy));
+
+	for (DlInt32 k = 0; k <= rings; k++) {
+		//	every cell in ring k is at least k - 1 cells from pt
+		if (best >= 0 && best <= (k - 1) * itsCellSize)
+			break;
+
+		for (DlInt32 x = cx - k; x <= cx + k; x++) {
+			DlInt32 step = (x == cx - k || x == cx + k) ? 1 : 2 * k;
+			for (DlInt32 y = cy - k; y <= cy + k; y += std::max(step, 1)) {
+				typename CellMap::const_iterator c = itsCells.find(cellKey(x, y));
+				if (c != itsCells.end())
+					visit(c->second, test);
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::ChooseCellSize                                                static
+//
+//      choose a cell size for about four items a cell.
+//
+//  const WorldRect& bounds    -> the bounds of all the items.
+//  DlInt32 count              -> the number of items.
+//  DlFloat64 itemSize         -> the typical width or height of an item.
+//
+//  returns DlFloat64          <- the cell size.
+//----------------------------------------------------------------------------------------
+template <class T> inline DlFloat64
+SpatialGrid<T>::ChooseCellSize(const WorldRect& bounds, DlInt32 count, DlFloat64 itemSize)
+{
+	DlFloat64 w = bounds.width();
+	DlFloat64 h = bounds.height();
+	DlFloat64 size = 0;
+	if (count > 0) {
+		if (w > 0 && h > 0)
+			size = 2 * std::sqrt(w * h / count);
+		else
+			size = 4 * std::max(w, h) / count;
+	}
+
+	size = std::max(size, itemSize);
+	if (!(size > 0) || !std::isfinite(size))
+		size = 1;
+	return size;
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::cellIndex                                                     private
+//
+//      return the cell holding coordinate c, clamped to keep the keys unique.
+//
+//  DlFloat64 c            -> the coordinate.
+//
+//  returns DlInt32        <- the cell.
+//----------------------------------------------------------------------------------------
+template <class T> inline DlInt32
+SpatialGrid<T>::cellIndex(DlFloat64 c) const
+{
+	const DlInt32 limit = 1 << 30;
+	DlFloat64 i = std::floor(c / itsCellSize);
+	if (!(i > -limit))
+		return -limit;
+	if (!(i < limit))
+		return limit;
+	return DlInt32(i);
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::link                                                          private
+//
+//      add an entry to the cells its bounds touch.
+//
+//  Entry& e               -> the entry.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+SpatialGrid<T>::link(Entry& e)
+{
+	DlInt32 left = cellIndex(e.bounds.left());
+	DlInt32 bottom = cellIndex(e.bounds.bottom());
+	DlInt32 right = cellIndex(e.bounds.right());
+	DlInt32 top = cellIndex(e.bounds.top());
+
+	e.large = DlFloat64(right - left + 1) * (top - bottom + 1) > kSpatialGridMaxCells;
+	if (e.large) {
+		e.cells[0] = e.cells[1] = e.cells[2] = e.cells[3] = 0;
+		itsLarge.push_back(&e);
+		return;
+	}
+
+	if (itsCells.empty()) {
+		itsExtent[0] = left;
+		itsExtent[1] = bottom;
+		itsExtent[2] = right;
+		itsExtent[3] = top;
+	} else {
+		itsExtent[0] = std::min(itsExtent[0], left);
+		itsExtent[1] = std::min(itsExtent[1], bottom);
+		itsExtent[2] = std::max(itsExtent[2], right);
+		itsExtent[3] = std::max(itsExtent[3], top);
+	}
+
+	e.cells[0] = left;
+	e.cells[1] = bottom;
+	e.cells[2] = right;
+	e.cells[3] = top;
+	for (DlInt32 x = left; x <= right; x++) {
+		for (DlInt32 y = bottom; y <= top; y++)
+			itsCells[cellKey(x, y)].push_back(&e);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::unlink                                                        private
+//
+//      remove an entry from its cells. The extent is left as it is, so it may
+//		cover cells that are now empty.
+//
+//  Entry& e               -> the entry.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+SpatialGrid<T>::unlink(Entry& e)
+{
+	auto drop = [&e](Cell& cell) {
+		typename Cell::iterator i = std::find(cell.begin(), cell.end(), &e);
+		if (i != cell.end()) {
+			*i = cell.back();
+			cell.pop_back();
+		}
+	};
+
+	if (e.large) {
+		drop(itsLarge);
+		return;
+	}
+
+	for (DlInt32 x = e.cells[0]; x <= e.cells[2]; x++) {
+		for (DlInt32 y = e.cells[1]; y <= e.cells[3]; y++) {
+			typename CellMap::iterator c = itsCells.find(cellKey(x, y));
+			if (c != itsCells.end()) {
+				drop(c->second);
+				if (c->second.empty())
+					itsCells.erase(c);
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  SpatialGrid<T>::visit                                                         private
+//
+//      call p for each entry of a cell not yet seen by this search.
+//
+//  const Cell& cell       -> the cell.
+//  P& p                   -> called as p(T*, const WorldRect&).
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> template <class P> inline void
+SpatialGrid<T>::visit(const Cell& cell, P& p) const
+{
+	for (const Entry* e : cell) {
+		if (e->mark != itsMark) {
+			e->mark = itsMark;
+			p(e->item, e->bounds);
+		}
+	}
+}
+
+#endif
+
+//	eof
@@ -0,0 +1,255 @@
+/*+
+ *	File:		StiffnessCache.cpp
+ *
+ *	Contains:	Element stiffness and skyline cache for reanalysis
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "StiffnessCache.h"
+#include "ElementList.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace DlArray;
+
+const DlInt32 kElemDOF = 2*DOF_PER_NODE;
+
+//--------------------------------------- Methods ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::StiffnessCache                                             constructor
+//
+//      construct an empty cache.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StiffnessCache::StiffnessCache()
+	: itsNumEquations(0)
+	, itsFactoredColumns(0)
+	, itsChanged(0)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::Invalidate
+//
+//      release the cached matrices so the next update rebuilds them.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StiffnessCache::Invalidate()
+{
+	itsNumEquations = 0;
+	itsFactoredColumns = 0;
+	itsMatrices.Clear();
+	itsMaxa.resize(0);
+	itsMatrix.resize(0);
+	itsFactor.resize(0);
+}
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::Update
+//
+//      bring the matrix up to date with the elements. If the equation numbering
+//		is unchanged, only the elements edited since the last update are
+//		computed again: those reconnected or given another property, those
+//		with a changed property and those at a moved node. The columns of the
+//		matrix the changed ones touch are then summed again from every
+//		element, in the order a rebuild sums them, so the matrix stays the same
+//		as a rebuilt one however many updates it has been through. Otherwise
+//		the matrix is rebuilt.
+//
+//  const ElementList& elems           -> the elements.
+//  const std::valarray<DlInt32>& maxa -> the diagonal indices.
+//  const StructureEdits& edits        -> the edits since the last update.
+//  DlThreadPool* pool                 -> the threads to compute a rebuild with, or nullptr.
+//
+//  returns DlInt32                    <- the first column to factor.
+//----------------------------------------------------------------------------------------
+DlInt32
+StiffnessCache::Update(const ElementList& elems, const std::valarray<DlInt32>& maxa,
+					   const StructureEdits& edits, DlThreadPool* pool)
+{
+	itsChanged = 0;
+	
+	if (edits.all || !isSameStructure(elems, maxa)) {
+		rebuild(elems, maxa, pool);
+		return 1;
+	}
+	
+	DlInt32 first = itsFactoredColumns + 1;
+	DlInt32 count = elems.Length();
+	std::vector<bool> columns(itsNumEquations + 1, false);
+	ElementMatrix m;
+	
+	for (DlInt32 e = 0; e < count; e++) {
+		const ElementImp* elem = elems.ElementAt(e);
+		if (edits.elements.count(elem) == 0 && edits.properties.count(elem->GetProperty()) == 0
+				&& edits.nodes.count(elem->StartNode()) == 0 && edits.nodes.count(elem->EndNode()) == 0)
+			continue;
+		
+		elem->Stiffness(m, true);
+		if (std::equal(m.data(), m.data() + kElemDOF * kElemDOF, itsMatrices.GetMatrix(e)))
+			continue;
+		
+		itsMatrices.SetMatrix(e, m);
+		itsChanged++;
+		
+		//	the lowest equation is the first column the element touches
+		const DlInt32* dof = itsMatrices.GetDOF(e);
+		for (DlInt32 i = 0; i < kElemDOF; i++) {
+			if (dof[i] > 0) {
+				columns[dof[i]] = true;
+				first = std::min(first, dof[i]);
+			}
+		}
+	}
+	
+	if (itsChanged > 0) {
+		DlOneBasedConstIter<DlInt32> diag(itsMaxa);
+		for (DlInt32 c = 1; c <= itsNumEquations; c++) {
+			if (columns[c])
+				std::fill(&itsMatrix[diag[c] - 1], &itsMatrix[0] + diag[c + 1] - 1, 0.0);
+		}
+		
+		for (DlInt32 e = 0; e < count; e++)
+			scatter(itsMatrices.GetMatrix(e), itsMatrices.GetDOF(e), &columns);
+	}
+	
+	if (first <= itsNumEquations) {
+		DlInt32 start = itsMaxa[first - 1] - 1;
+		std::slice tail(start, itsMatrix.size() - start, 1);
+		itsFactor[tail] = itsMatrix[tail];
+		itsFactoredColumns = first - 1;
+	}
+	
+	return first;
+}
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::isSameStructure                                               private
+//
+//      return true if the equation numbering matches the cache.
+//
+//  const ElementList& elems           -> the elements.
+//  const std::valarray<DlInt32>& maxa -> the diagonal indices.
+//
+//  returns bool                       <- true if the cached matrix can be patched.
+//----------------------------------------------------------------------------------------
+bool
+StiffnessCache::isSameStructure(const ElementList& elems, 
+						const std::valarray<DlInt32>& maxa) const
+{
+	DlInt32 count = elems.Length();
+	
+	if (itsMaxa.size() == 0 || itsMaxa.size() != maxa.size() || 
+			itsMatrices.GetCount() != count)
+		return false;
+	
+	for (size_t i = 0; i < maxa.size(); i++) {
+		if (itsMaxa[i] != maxa[i])
+			return false;
+	}
+	
+	for (DlInt32 e = 0; e < count; e++) {
+		DlInt32 dof[kElemDOF];
+		elems.ElementAt(e)->GetDOF(dof);
+		if (!std::equal(dof, dof + kElemDOF, itsMatrices.GetDOF(e)))
+			return false;
+	}
+	
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::rebuild                                                        private
+//
+//      compute every element stiffness and assemble the matrix.
+//
+//  const ElementList& elems           -> the elements.
+//  const std::valarray<DlInt32>& maxa -> the diagonal indices.
+//  DlThreadPool* pool                 -> the threads to use, or nullptr.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StiffnessCache::rebuild(const ElementList& elems, const std::valarray<DlInt32>& maxa,
+						DlThreadPool* pool)
+{
+	DlInt32 count = elems.Length();
+	
+	itsNumEquations = static_cast<DlInt32>(maxa.size()) - 1;
+	itsFactoredColumns = 0;
+	itsMaxa.resize(maxa.size());
+	itsMaxa = maxa;
+	
+	itsMatrix.resize(maxa[itsNumEquations] - 1);
+	itsMatrix = 0.0;
+	
+	itsMatrices.Build(elems, pool);
+	for (DlInt32 e = 0; e < count; e++)
+		scatter(itsMatrices.GetMatrix(e), itsMatrices.GetDOF(e));
+	
+	itsChanged = count;
+	itsFactor.resize(itsMatrix.size());
+	itsFactor = itsMatrix;
+}
+
+//----------------------------------------------------------------------------------------
+//  StiffnessCache::scatter                                                        private
+//
+//      add the upper triangle of an element stiffness into the matrix.
+//
+//  const DlFloat64* m                 -> the 0-based row major element stiffness.
+//  const DlInt32* dof                 -> the element equations.
+//  const std::vector<bool>* columns   -> the columns to add to, or nullptr for all.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StiffnessCache::scatter(const DlFloat64* m, const DlInt32* dof, const std::vector<bool>* columns)
+{
+	DlOneBasedConstIter<DlInt32>	maxa(itsMaxa);
+	DlOneBasedIter<DlFloat64>		a(itsMatrix);
+	
+	for (DlInt32 i = 0; i < kElemDOF; ++i) {
+		if (dof[i] > 0) {
+			for (DlInt32 j = i; j < kElemDOF; j++) {
+				if (dof[j] > 0) {
+					DlInt32 r = std::min(dof[i], dof[j]);
+					DlInt32 c = std::max(dof[i], dof[j]);
+					if (columns == nullptr || (*columns)[c])
+						a[maxa[c] + c - r] += m[i * kElemDOF + j];
+				}
+			}
+		}
+	}
+}
+
+//	eof
@@ -0,0 +1,100 @@
+/*+
+ *	File:		StiffnessCache.h
+ *
+ *	Contains:	Element stiffness and skyline cache for reanalysis
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_StiffnessCache
+#define _H_StiffnessCache
+
+//---------------------------------- Includes ----------------------------------
+
+#include "ElementMatrixCache.h"
+#include "StructureVersion.h"
+
+#include <valarray>
+#include <vector>
+
+class ElementList;
+class DlThreadPool;
+
+//---------------------------------- Class -------------------------------------
+
+//	Keeps each element's stiffness and equation numbers, the assembled skyline
+//	and its factor between analyses. The element matrices are also read by
+//	the loads and force recovery of the analysis. When the structure is edited
+//	without changing its topology, Update computes only the edited elements,
+//	sums again only the matrix columns whose elements changed, and returns the
+//	first column that must be factored again. Columns of a skyline LDL' to the
+//	left of that are unchanged.
+class StiffnessCache
+{
+public:
+	StiffnessCache();
+
+	//	forget everything, so the next update rebuilds the matrix.
+	void				Invalidate();
+
+	//	bring the matrix up to date with elems, numbered by maxa, after the
+	//	edits since the last update. Returns the first column that is not
+	//	factored, or numEqs + 1 if the factor is current. The factor holds the
+	//	matrix from that column on.
+	DlInt32				Update(const ElementList& elems, const std::valarray<DlInt32>& maxa,
+							const StructureEdits& edits, DlThreadPool* pool = nullptr);
+
+	//	call after the factor is complete.
+	void				SetFactored() { itsFactoredColumns = itsNumEquations; }
+
+	//	the element matrices as of the last update.
+	const ElementMatrixCache&	GetMatrices() const { return itsMatrices; }
+
+	std::valarray<DlFloat64>&	GetFactor() { return itsFactor; }
+	const std::valarray<DlFloat64>&	GetFactor() const { return itsFactor; }
+
+	//	the number of elements whose stiffness changed in the last update.
+	DlInt32				GetChangedCount() const { return itsChanged; }
+
+private:
+
+	bool				isSameStructure(const ElementList& elems,
+							const std::valarray<DlInt32>& maxa) const;
+	void				rebuild(const ElementList& elems, const std::valarray<DlInt32>& maxa,
+							DlThreadPool* pool);
+	void				scatter(const DlFloat64* m, const DlInt32* dof,
+							const std::vector<bool>* columns = nullptr);
+
+	DlInt32						itsNumEquations;
+	DlInt32						itsFactoredColumns;	//	leading columns of itsFactor that are factored
+	DlInt32						itsChanged;
+
+	ElementMatrixCache			itsMatrices;	//	stiffness and equations of each element
+	std::valarray<DlInt32>		itsMaxa;		//	diagonal indices
+	std::valarray<DlFloat64>	itsMatrix;		//	assembled skyline
+	std::valarray<DlFloat64>	itsFactor;		//	factored skyline
+};
+
+#endif
+
+//	eof
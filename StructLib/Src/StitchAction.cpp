@@ -8,6 +8,12 @@
 
 #include "DlPlatform.h"
 #include "StitchAction.h"
+#include "DlThreadPool.h"
+
+#include <memory>
+
+//	nodes in a stitch of everything before the threads are used
+const DlInt32 kParallelStitch = 20000;
 
 
 StitchAction::StitchAction(frame_data* structure, const NodeList* stitchNodes, DlFloat64 tol, bool stitchAll) 
@@ -17,7 +23,12 @@ StitchAction::StitchAction(frame_data* structure, const NodeList* stitchNodes, D
 	if (tol == 0)
 		tol = kDefaultTol;
 	if (stitchAll) {
-		stitchNodes->StitchMap(NULL, tol, _dupNodes);
+		//	a large import is worth searching with the analysis threads.
+		std::unique_ptr<DlThreadPool> pool;
+		DlUInt32 threads = structure->GetAnalysisOptions().solverThreads;
+		if (threads != 1 && stitchNodes->Length() >= kParallelStitch)
+			pool.reset(NEW DlThreadPool(threads));
+		stitchNodes->StitchMap(NULL, tol, _dupNodes, pool.get());
 	} else {
 		_dest->Nodes().StitchMap(stitchNodes, tol, _dupNodes);
 	}
@@ -91,8 +102,7 @@ StitchAction::Undo()
 		printf("swapping start node %d for node %d\n", elem->StartNode()->_id, start->_id);
 		printf("swapping end node %d for node %d\n", elem->EndNode()->_id, end->_id);
 #endif
-		elem->SetStartNode(start);
-		elem->SetEndNode(end);
+		elems.Reconnect(elem, start, end);
 	}
 	
 	_changedElements = ElementEnumerator();
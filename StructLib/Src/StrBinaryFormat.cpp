@@ -0,0 +1,312 @@
+/*+
+ *	File:		StrBinaryFormat.cpp
+ *
+ *	Contains:	Writer, reader and file mapping for the binary structure file
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlPlatform.h"
+#include "StrBinaryFormat.h"
+#include "DlException.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if TARG_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//---------------------------------- Statics -----------------------------------
+
+static_assert(sizeof(StrBinaryHeader) == 32, "header layout");
+static_assert(sizeof(StrBinarySection) == 24, "section layout");
+static_assert(sizeof(StrBinaryNodeLoad) % 8 == 0, "node load layout");
+static_assert(sizeof(StrBinaryNode) % 8 == 0, "node layout");
+
+//----------------------------------------------------------------------------------------
+//  alignUp                                                                        static
+//
+//      round up to the section alignment.
+//
+//  DlUInt64 offset        -> the offset.
+//
+//  returns DlUInt64       <- the aligned offset.
+//----------------------------------------------------------------------------------------
+static inline DlUInt64
+alignUp(DlUInt64 offset)
+{
+	return (offset + kStrBinaryAlignment - 1) & ~DlUInt64(kStrBinaryAlignment - 1);
+}
+
+//---------------------------------- Methods -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryWriter::StrBinaryWriter                                          constructor
+//
+//      construct the writer. Offset 0 of the string section is the empty string.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrBinaryWriter::StrBinaryWriter()
+{
+	AddString("");
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryWriter::AddString
+//
+//      add a string to the string section.
+//
+//  const char* str        -> the string.
+//
+//  returns DlUInt32       <- the offset of the string.
+//----------------------------------------------------------------------------------------
+DlUInt32
+StrBinaryWriter::AddString(const char* str)
+{
+	auto found = itsStringOffsets.find(str);
+	if (found != itsStringOffsets.end())
+		return found->second;
+
+	DlUInt32 offset = itsStrings.size();
+	itsStrings.insert(itsStrings.end(), str, str + strlen(str) + 1);
+	itsStringOffsets[str] = offset;
+	return offset;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryWriter::Write
+//
+//      write the file to image. The string section comes first.
+//
+//  std::vector<DlUInt8>& image    <- the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrBinaryWriter::Write(std::vector<DlUInt8>& image)
+{
+	std::vector<Pending> sections;
+	Pending strings = { kStrBinaryStrings, 1, itsStrings.size(), &itsStrings[0] };
+	sections.push_back(strings);
+	sections.insert(sections.end(), itsSections.begin(), itsSections.end());
+
+	std::vector<StrBinarySection> table(sections.size());
+	DlUInt64 offset = alignUp(sizeof(StrBinaryHeader) + table.size() * sizeof(StrBinarySection));
+	for (size_t i = 0; i < sections.size(); i++) {
+		table[i].kind = sections[i].kind;
+		table[i].recordSize = sections[i].recordSize;
+		table[i].offset = offset;
+		table[i].count = sections[i].count;
+		offset = alignUp(offset + sections[i].count * sections[i].recordSize);
+	}
+
+	StrBinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kStrBinaryMagic, sizeof(header.magic));
+	header.byteOrder = kStrBinaryByteOrder;
+	header.formatVersion = kStrBinaryFormatVersion;
+	header.length = offset;
+	header.sectionCount = table.size();
+
+	image.assign(offset, 0);
+	memcpy(&image[0], &header, sizeof(header));
+	memcpy(&image[sizeof(header)], &table[0], table.size() * sizeof(StrBinarySection));
+	for (size_t i = 0; i < sections.size(); i++) {
+		if (sections[i].count > 0)
+			memcpy(&image[table[i].offset], sections[i].records,
+				   sections[i].count * sections[i].recordSize);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryReader::StrBinaryReader                                          constructor
+//
+//      check the header and the section table.
+//
+//  const void* image      -> the file.
+//  DlUInt64 length        -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrBinaryReader::StrBinaryReader(const void* image, DlUInt64 length)
+	: itsImage(static_cast<const DlUInt8*>(image))
+	, itsSections(nullptr)
+	, itsSectionCount(0)
+	, itsStrings(nullptr)
+	, itsStringsLength(0)
+{
+	if (length < sizeof(StrBinaryHeader))
+		throw DlException("File too short");
+
+	const StrBinaryHeader* header = reinterpret_cast<const StrBinaryHeader*>(itsImage);
+	if (memcmp(header->magic, kStrBinaryMagic, sizeof(header->magic)) != 0)
+		throw DlException("Not a binary frame file");
+	if (header->byteOrder != kStrBinaryByteOrder)
+		throw DlException("Binary frame file has the wrong byte order");
+	if (header->formatVersion != kStrBinaryFormatVersion)
+		throw DlException("Binary frame file version %u is not supported", header->formatVersion);
+	if (header->length > length)
+		throw DlException("File too short");
+
+	length = header->length;
+	if (header->sectionCount > (length - sizeof(StrBinaryHeader)) / sizeof(StrBinarySection))
+		throw DlException("Bad section table");
+
+	itsSections = reinterpret_cast<const StrBinarySection*>(itsImage + sizeof(StrBinaryHeader));
+	itsSectionCount = header->sectionCount;
+
+	for (DlUInt32 i = 0; i < itsSectionCount; i++) {
+		const StrBinarySection& s = itsSections[i];
+		if (s.recordSize == 0 || s.offset % kStrBinaryAlignment != 0 || s.offset > length
+				|| s.count > (length - s.offset) / s.recordSize)
+			throw DlException("Bad section %u", i);
+	}
+
+	const StrBinarySection* strings = findSection(kStrBinaryStrings, 1);
+	if (strings == nullptr || strings->count == 0 || itsImage[strings->offset + strings->count - 1] != 0)
+		throw DlException("Bad string section");
+	itsStrings = reinterpret_cast<const char*>(itsImage + strings->offset);
+	itsStringsLength = strings->count;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryReader::GetString
+//
+//      return a string. The string section ends with a null, so every offset
+//		in it is a string.
+//
+//  DlUInt32 offset        -> the offset in the string section.
+//
+//  returns const char*    <- the string.
+//----------------------------------------------------------------------------------------
+const char*
+StrBinaryReader::GetString(DlUInt32 offset) const
+{
+	if (offset >= itsStringsLength)
+		throw DlException("Bad string offset %u", offset);
+	return itsStrings + offset;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryReader::findSection
+//
+//      find the first section of a kind.
+//
+//  DlUInt32 kind                  -> the section kind.
+//  DlUInt32 recordSize            -> the size the caller expects.
+//
+//  returns const StrBinarySection*    <- the section or nullptr.
+//----------------------------------------------------------------------------------------
+const StrBinarySection*
+StrBinaryReader::findSection(DlUInt32 kind, DlUInt32 recordSize) const
+{
+	for (DlUInt32 i = 0; i < itsSectionCount; i++) {
+		if (itsSections[i].kind == kind) {
+			if (itsSections[i].recordSize != recordSize)
+				throw DlException("Bad record size in section %u", i);
+			return &itsSections[i];
+		}
+	}
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrMappedFile::StrMappedFile                                              constructor
+//
+//      map or read the file.
+//
+//  const char* path       -> the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrMappedFile::StrMappedFile(const char* path)
+	: itsData(nullptr)
+	, itsLength(0)
+	, itsMapped(false)
+{
+#if TARG_OS_UNIX
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		throw DlException("Failed to open %s", path);
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw DlException("Failed to read %s", path);
+	}
+
+	itsLength = info.st_size;
+	if (itsLength > 0) {
+		void* data = mmap(nullptr, itsLength, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			itsData = data;
+			itsMapped = true;
+		}
+	}
+	close(fd);
+
+	if (itsMapped || itsLength == 0)
+		return;
+#endif
+
+	std::FILE* f = fopen(path, "rb");
+	if (!f)
+		throw DlException("Failed to open %s", path);
+
+	char buf[16384];
+	size_t len;
+	while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+		itsCopy.insert(itsCopy.end(), buf, buf + len);
+
+	bool failed = ferror(f) != 0;
+	fclose(f);
+	if (failed)
+		throw DlException("Failed to read %s", path);
+
+	itsLength = itsCopy.size();
+	itsData = itsCopy.empty() ? nullptr : &itsCopy[0];
+}
+
+//----------------------------------------------------------------------------------------
+//  StrMappedFile::~StrMappedFile                                              destructor
+//
+//      unmap the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrMappedFile::~StrMappedFile()
+{
+#if TARG_OS_UNIX
+	if (itsMapped)
+		munmap(const_cast<void*>(itsData), itsLength);
+#endif
+}
+
+//	eof
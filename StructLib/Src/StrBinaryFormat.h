@@ -0,0 +1,314 @@
+/*+
+ *	File:		StrBinaryFormat.h
+ *
+ *	Contains:	Layout of the memory mapped structure and results files
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	The file is a StrBinaryHeader, a table of StrBinarySection entries and
+ *	the sections. Each section is an array of fixed size records aligned to
+ *	kStrBinaryAlignment, so a mapped file is read in place. Nodes, elements
+ *	and properties refer to each other by index, to strings by offset into
+ *	the string section and to their loads by a range of StrBinaryLoadRef
+ *	records.
+ *
+ *	A results file uses the same container. Each load case has a column
+ *	for every component of the node displacements, node reactions and
+ *	element forces, found through the column index. A column is either the
+ *	values themselves, aligned so they can be used in place, or the values
+ *	compressed by ResultsFile's lossless codec.
+ *
+ *	Values are in the byte order of the host that wrote the file. A reader
+ *	on a host with the other order rejects the file; the stream format
+ *	remains the portable one.
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_StrBinaryFormat
+#define _H_StrBinaryFormat
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+#include "StrDefines.h"
+#include "ElementLoad.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+//---------------------------------- Declares ----------------------------------
+
+const char kStrBinaryMagic[8] = { 'F', 'r', 'a', 'm', 'e', 'B', 'i', 'n' };
+const DlUInt32 kStrBinaryByteOrder = 0x01020304;
+//	a reader refuses other versions. Bump it when a record changes.
+const DlUInt32 kStrBinaryFormatVersion = 1;
+const DlUInt32 kStrBinaryAlignment = 16;
+
+//	section kinds
+const DlUInt32 kStrBinaryFrame 			= 'frme';	//	one StrBinaryFrame
+const DlUInt32 kStrBinaryStrings 		= 'strs';	//	null terminated strings
+const DlUInt32 kStrBinaryNodeLoads 		= 'nlod';	//	StrBinaryNodeLoad
+const DlUInt32 kStrBinaryElemLoads 		= 'elod';	//	StrBinaryElemLoad
+const DlUInt32 kStrBinaryProperties 	= 'prop';	//	StrBinaryProperty
+const DlUInt32 kStrBinaryPropValues 	= 'pval';	//	DlFloat64
+const DlUInt32 kStrBinaryNodes 			= 'node';	//	StrBinaryNode
+const DlUInt32 kStrBinaryNodeLoadRefs 	= 'nref';	//	StrBinaryLoadRef
+const DlUInt32 kStrBinaryElements 		= 'elem';	//	StrBinaryElement
+const DlUInt32 kStrBinaryElemLoadRefs 	= 'eref';	//	StrBinaryLoadRef
+const DlUInt32 kStrBinaryCombinations 	= 'cmbo';	//	StrBinaryCombination
+const DlUInt32 kStrBinaryFactors 		= 'fact';	//	DlFloat32
+const DlUInt32 kStrBinaryLoadCases 		= 'lcas';	//	StrBinaryLoadCase
+
+const DlUInt32 kStrBinaryResults 		= 'rslt';	//	one StrBinaryResults
+const DlUInt32 kStrBinaryResultCases 	= 'rcas';	//	StrBinaryResultCase
+const DlUInt32 kStrBinaryResultColumns 	= 'rcol';	//	StrBinaryResultColumn
+const DlUInt32 kStrBinaryResultData 	= 'rdat';	//	the columns
+
+//	column encodings
+const DlUInt32 kStrBinaryColumnRaw 		= 0;		//	DlFloat64 values
+const DlUInt32 kStrBinaryColumnXor 		= 1;		//	compressed
+
+//---------------------------------- Records -----------------------------------
+
+struct StrBinaryHeader {
+	char		magic[8];
+	DlUInt32	byteOrder;
+	DlUInt32	formatVersion;
+	DlUInt64	length;				//	of the whole file
+	DlUInt32	sectionCount;
+	DlUInt32	reserved;
+};
+
+struct StrBinarySection {
+	DlUInt32	kind;
+	DlUInt32	recordSize;
+	DlUInt64	offset;				//	from the start of the file
+	DlUInt64	count;				//	of records
+};
+
+struct StrBinaryFrame {
+	DlInt32		majorVersion;
+	DlInt32		minorVersion;
+	DlUInt32	activeElementType;	//	string
+	DlInt32		activeProperty;
+};
+
+struct StrBinaryNodeLoad {
+	DlInt32		type[DOF_PER_NODE];
+	DlInt32		reserved;
+	DlFloat64	value[DOF_PER_NODE];
+};
+
+struct StrBinaryElemLoad {
+	DlFloat64	value[ElementLoadCount];
+};
+
+struct StrBinaryProperty {
+	DlUInt32	elementType;		//	string
+	DlUInt32	title;				//	string
+	DlUInt32	firstValue;
+	DlUInt32	valueCount;
+};
+
+struct StrBinaryNode {
+	DlFloat64	coords[2];
+	DlUInt32	restraint;
+	DlInt32		equations[DOF_PER_NODE];
+	DlUInt32	firstLoad;
+	DlUInt32	loadCount;
+};
+
+struct StrBinaryElement {
+	DlUInt32	elementType;		//	string
+	DlInt32		nodes[2];
+	DlInt32		property;
+	DlUInt32	firstLoad;
+	DlUInt32	loadCount;
+};
+
+struct StrBinaryLoadRef {
+	DlInt32		loadCase;
+	DlInt32		load;
+};
+
+struct StrBinaryCombination {
+	DlUInt32	firstFactor;
+	DlUInt32	factorCount;
+};
+
+struct StrBinaryLoadCase {
+	DlInt32		combination;
+	DlUInt32	name;				//	string
+};
+
+struct StrBinaryResults {
+	DlUInt32	nodeCount;
+	DlUInt32	elementCount;
+	DlUInt32	reserved[2];
+};
+
+//	the columns of a case are in ResultQuantity and then component order.
+struct StrBinaryResultCase {
+	DlInt32		loadCase;
+	DlUInt32	firstColumn;
+	DlFloat64	dispScale;
+	DlFloat64	momentScale;
+	DlFloat64	shearScale;
+	DlFloat64	axialScale;
+	DlFloat64	magnifier;
+};
+
+struct StrBinaryResultColumn {
+	DlInt32		loadCase;
+	DlUInt16	quantity;			//	ResultQuantity
+	DlUInt16	component;
+	DlUInt32	encoding;
+	DlUInt32	count;				//	of values
+	DlUInt64	offset;				//	in the data section
+	DlUInt64	length;				//	in bytes
+};
+
+//---------------------------------- Class -------------------------------------
+
+//	lays out the sections of a file. The records are not copied until Write,
+//	so they must not change until then.
+class StrBinaryWriter
+{
+public:
+	StrBinaryWriter();
+
+	//	add a section of records
+	template <class T> void AddSection(DlUInt32 kind, const std::vector<T>& records);
+	//	add a string to the string section and return its offset. each
+	//	string is stored once.
+	DlUInt32	AddString(const char* str);
+
+	//	write the header, section table and sections to image
+	void		Write(std::vector<DlUInt8>& image);
+
+private:
+	struct Pending {
+		DlUInt32		kind;
+		DlUInt32		recordSize;
+		DlUInt64		count;
+		const void*		records;
+	};
+
+	std::vector<Pending>				itsSections;
+	std::vector<char>					itsStrings;
+	std::map<std::string, DlUInt32>		itsStringOffsets;
+};
+
+//---------------------------------- Class -------------------------------------
+
+//	checks a file image and finds its sections. The image must stay valid
+//	while the reader and the records it returns are used. Throws
+//	DlException if the image is not a file this version can read.
+class StrBinaryReader
+{
+public:
+	StrBinaryReader(const void* image, DlUInt64 length);
+
+	//	find a section. returns the number of records, or 0 and nullptr if
+	//	the section is missing.
+	template <class T> DlUInt64	GetSection(DlUInt32 kind, const T*& records) const;
+	//	return the string at offset in the string section
+	const char*	GetString(DlUInt32 offset) const;
+
+private:
+	const StrBinarySection*	findSection(DlUInt32 kind, DlUInt32 recordSize) const;
+
+	const DlUInt8*				itsImage;
+	const StrBinarySection*		itsSections;
+	DlUInt32					itsSectionCount;
+	const char*					itsStrings;
+	DlUInt64					itsStringsLength;
+};
+
+//---------------------------------- Class -------------------------------------
+
+//	a read only view of a whole file. The file is memory mapped where the
+//	host allows, and read into memory otherwise.
+class StrMappedFile
+{
+public:
+	explicit StrMappedFile(const char* path);
+	~StrMappedFile();
+
+	const void*	Data() const		{ return itsData; }
+	DlUInt64	Length() const		{ return itsLength; }
+
+private:
+	StrMappedFile(const StrMappedFile& f);
+	StrMappedFile& operator=(const StrMappedFile& f);
+
+	const void*				itsData;
+	DlUInt64				itsLength;
+	bool					itsMapped;
+	std::vector<DlUInt8>	itsCopy;
+};
+
+//---------------------------------- Inlines -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryWriter::AddSection
+//
+//      add a section of records.
+//
+//  DlUInt32 kind                  -> the section kind.
+//  const std::vector<T>& records  -> the records.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+StrBinaryWriter::AddSection(DlUInt32 kind, const std::vector<T>& records)
+{
+	Pending p = { kind, sizeof(T), records.size(), records.empty() ? nullptr : &records[0] };
+	itsSections.push_back(p);
+}
+
+//----------------------------------------------------------------------------------------
+//  StrBinaryReader::GetSection
+//
+//      find a section.
+//
+//  DlUInt32 kind          -> the section kind.
+//  const T*& records      <- the records, or nullptr.
+//
+//  returns DlUInt64       <- the number of records.
+//----------------------------------------------------------------------------------------
+template <class T> inline DlUInt64
+StrBinaryReader::GetSection(DlUInt32 kind, const T*& records) const
+{
+	const StrBinarySection* s = findSection(kind, sizeof(T));
+	if (s == nullptr || s->count == 0) {
+		records = nullptr;
+		return 0;
+	}
+
+	records = reinterpret_cast<const T*>(itsImage + s->offset);
+	return s->count;
+}
+
+#endif
+
+//	eof
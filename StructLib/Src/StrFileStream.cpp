@@ -0,0 +1,447 @@
+/*+
+ *	File:		StrFileStream.cpp
+ *
+ *	Contains:	Structure input and output streams on a DlStream
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlPlatform.h"
+#include "StrFileStream.h"
+#include "DlStream.h"
+#include "DlException.h"
+#include "DlString.h"
+
+#include <algorithm>
+#include <cstring>
+
+//---------------------------------- Statics -----------------------------------
+
+//	the values are stored big endian, most significant byte first.
+
+static inline DlUInt32
+getBE32(const DlUInt8* b)
+{
+	return (DlUInt32(b[0]) << 24) | (DlUInt32(b[1]) << 16) | (DlUInt32(b[2]) << 8) | b[3];
+}
+
+static inline DlUInt64
+getBE64(const DlUInt8* b)
+{
+	return (DlUInt64(getBE32(b)) << 32) | getBE32(b + 4);
+}
+
+static inline void
+putBE32(DlUInt32 v, DlUInt8* b)
+{
+	b[0] = v >> 24;
+	b[1] = v >> 16;
+	b[2] = v >> 8;
+	b[3] = v;
+}
+
+static inline void
+putBE64(DlUInt64 v, DlUInt8* b)
+{
+	putBE32(v >> 32, b);
+	putBE32(static_cast<DlUInt32>(v), b + 4);
+}
+
+//---------------------------------- Methods -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::StrFileInputStream                                    constructor
+//
+//      construct the reader. The stream must outlive the reader.
+//
+//  DlStream& stream       -> the stream to read.
+//  DlUInt32 bufferLen     -> the size of the read buffer.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrFileInputStream::StrFileInputStream(DlStream& stream, DlUInt32 bufferLen)
+	: itsStream(stream)
+	, itsBuffer(bufferLen > 0 ? bufferLen : static_cast<DlUInt32>(kDefaultBufferLen))
+	, itsPos(0)
+	, itsLen(0)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::~StrFileInputStream                                    destructor
+//
+//      destruct the reader.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrFileInputStream::~StrFileInputStream()
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::fill
+//
+//      read the next buffer from the stream.
+//
+//  returns bool   <- false if the stream is at its end.
+//----------------------------------------------------------------------------------------
+bool
+StrFileInputStream::fill()
+{
+	itsPos = 0;
+	itsLen = itsStream.ReadBytes(&itsBuffer[0], itsBuffer.size());
+	return itsLen > 0;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::eof
+//
+//      return true if there is nothing left to read.
+//
+//  returns bool   <- true at the end of the stream.
+//----------------------------------------------------------------------------------------
+bool
+StrFileInputStream::eof()
+{
+	return itsPos == itsLen && !fill();
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::getOne
+//
+//      read one byte.
+//
+//  returns DlUInt8    <- the byte.
+//----------------------------------------------------------------------------------------
+inline DlUInt8
+StrFileInputStream::getOne()
+{
+	if (itsPos == itsLen && !fill())
+		throw DlException("File too short");
+	return itsBuffer[itsPos++];
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::getBuffer
+//
+//      read len bytes, refilling the buffer as needed.
+//
+//  DlUInt8* buf       <- the bytes.
+//  DlUInt32 len       -> the number of bytes.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileInputStream::getBuffer(DlUInt8* buf, DlUInt32 len)
+{
+	while (len > 0) {
+		if (itsPos == itsLen && !fill())
+			throw DlException("File too short");
+
+		DlUInt32 count = std::min(len, itsLen - itsPos);
+		memcpy(buf, &itsBuffer[itsPos], count);
+		itsPos += count;
+		buf += count;
+		len -= count;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetBool
+//
+//      read a bool.
+//
+//  returns bool   <- the value.
+//----------------------------------------------------------------------------------------
+bool
+StrFileInputStream::GetBool()
+{
+	return getOne() != 0;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetByte
+//
+//      read a byte.
+//
+//  returns DlUInt8    <- the value.
+//----------------------------------------------------------------------------------------
+DlUInt8
+StrFileInputStream::GetByte()
+{
+	return getOne();
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetInt
+//
+//      read an int.
+//
+//  returns DlInt32    <- the value.
+//----------------------------------------------------------------------------------------
+DlInt32
+StrFileInputStream::GetInt()
+{
+	DlUInt8 b[sizeof(DlInt32)];
+	getBuffer(b, sizeof(b));
+	return static_cast<DlInt32>(getBE32(b));
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetFloat
+//
+//      read a float.
+//
+//  returns DlFloat32  <- the value.
+//----------------------------------------------------------------------------------------
+DlFloat32
+StrFileInputStream::GetFloat()
+{
+	DlUInt8 b[sizeof(DlFloat32)];
+	getBuffer(b, sizeof(b));
+
+	DlUInt32 bits = getBE32(b);
+	DlFloat32 val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetDouble
+//
+//      read a double.
+//
+//  returns DlFloat64  <- the value.
+//----------------------------------------------------------------------------------------
+DlFloat64
+StrFileInputStream::GetDouble()
+{
+	DlUInt8 b[sizeof(DlFloat64)];
+	getBuffer(b, sizeof(b));
+
+	DlUInt64 bits = getBE64(b);
+	DlFloat64 val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileInputStream::GetString
+//
+//      read a null terminated string.
+//
+//  returns DlString   <- the value.
+//----------------------------------------------------------------------------------------
+DlString
+StrFileInputStream::GetString()
+{
+	DlString str;
+	while (true) {
+		char c = static_cast<char>(getOne());
+		if (c == 0)
+			break;
+		str += c;
+	}
+	return str;
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::StrFileOutputStream                                  constructor
+//
+//      construct the writer. The stream must outlive the writer.
+//
+//  DlStream& stream       -> the stream to write.
+//  DlUInt32 bufferLen     -> the size of the write buffer.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrFileOutputStream::StrFileOutputStream(DlStream& stream, DlUInt32 bufferLen)
+	: itsStream(stream)
+	, itsBuffer(bufferLen > 0 ? bufferLen : static_cast<DlUInt32>(kDefaultBufferLen))
+	, itsPos(0)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::~StrFileOutputStream                                  destructor
+//
+//      write what is left in the buffer. Call Flush first to see any errors.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+StrFileOutputStream::~StrFileOutputStream()
+{
+	try {
+		Flush();
+	} catch (...) {
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::Flush
+//
+//      write the buffer to the stream.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::Flush()
+{
+	if (itsPos > 0) {
+		DlUInt32 len = itsPos;
+		itsPos = 0;
+		if (itsStream.WriteBytes(&itsBuffer[0], len) != len)
+			throw DlException("Failed to write file");
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::putBuffer
+//
+//      buffer len bytes.
+//
+//  const DlUInt8* buf     -> the bytes.
+//  DlUInt32 len           -> the number of bytes.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::putBuffer(const DlUInt8* buf, DlUInt32 len)
+{
+	while (len > 0) {
+		if (itsPos == itsBuffer.size())
+			Flush();
+
+		DlUInt32 count = std::min<DlUInt32>(len, itsBuffer.size() - itsPos);
+		memcpy(&itsBuffer[itsPos], buf, count);
+		itsPos += count;
+		buf += count;
+		len -= count;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutBool
+//
+//      write a bool.
+//
+//  bool val           -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutBool(bool val)
+{
+	PutByte(val ? 0xff : 0);
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutByte
+//
+//      write a byte.
+//
+//  DlUInt8 val        -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutByte(DlUInt8 val)
+{
+	putBuffer(&val, sizeof(val));
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutInt
+//
+//      write an int.
+//
+//  DlInt32 val        -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutInt(DlInt32 val)
+{
+	DlUInt8 b[sizeof(val)];
+	putBE32(static_cast<DlUInt32>(val), b);
+	putBuffer(b, sizeof(b));
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutFloat
+//
+//      write a float.
+//
+//  DlFloat32 val      -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutFloat(DlFloat32 val)
+{
+	DlUInt32 bits;
+	memcpy(&bits, &val, sizeof(bits));
+
+	DlUInt8 b[sizeof(val)];
+	putBE32(bits, b);
+	putBuffer(b, sizeof(b));
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutDouble
+//
+//      write a double.
+//
+//  DlFloat64 val      -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutDouble(DlFloat64 val)
+{
+	DlUInt64 bits;
+	memcpy(&bits, &val, sizeof(bits));
+
+	DlUInt8 b[sizeof(val)];
+	putBE64(bits, b);
+	putBuffer(b, sizeof(b));
+}
+
+//----------------------------------------------------------------------------------------
+//  StrFileOutputStream::PutString
+//
+//      write a string with its null terminator.
+//
+//  const char* str    -> the value.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StrFileOutputStream::PutString(const char* str)
+{
+	putBuffer(reinterpret_cast<const DlUInt8*>(str), strlen(str) + 1);
+}
+
+//	eof
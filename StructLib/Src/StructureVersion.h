@@ -0,0 +1,138 @@
+/*+
+ *	File:		StructureVersion.h
+ *
+ *	Contains:	Counter of edits that change the stiffness of a structure
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_StructureVersion
+#define _H_StructureVersion
+
+//---------------------------------- Includes ----------------------------------
+
+#include "DlTypes.h"
+
+#include <unordered_set>
+
+class NodeImp;
+class ElementImp;
+class PropertyImp;
+
+//---------------------------------- Class -------------------------------------
+
+//	The items edited since the record was last taken. When there were too
+//	many to keep, all is set and the sets are empty.
+struct StructureEdits
+{
+	StructureEdits() : all(false) {}
+	
+	std::unordered_set<const NodeImp*>		nodes;		//	moved
+	std::unordered_set<const ElementImp*>	elements;	//	reconnected or given another property
+	std::unordered_set<const PropertyImp*>	properties;	//	with changed values
+	bool									all;
+};
+
+//	A stamp that changes whenever a node of one structure moves, a restraint
+//	or element property changes, or an element is connected to other nodes.
+//	frame_data keeps one and gives it to the nodes, elements and properties
+//	added to its lists, and their setters bump it. An analysis records it with
+//	its factored matrix, and the matrix is still good as long as the stamp has
+//	not changed.
+//
+//	Geometry is a second stamp that changes only when a node moves or an
+//	element is connected to other nodes. The hit testing grids of NodeList
+//	and ElementList are good as long as it has not changed.
+//
+//	Connectivity changes only when an element is connected to other nodes.
+//	The index of the elements at each node in ElementList is good as long
+//	as it has not changed.
+//
+//	The edits that can change an element's stiffness are also recorded with
+//	the item edited, so the incremental analysis knows which elements to
+//	compute again. frame_data takes the record at each analysis.
+//
+//	Each structure is edited from one thread, so the stamps are not atomic.
+class StructureVersion
+{
+public:
+	//	past this many items the record just notes that all may have changed
+	enum { kMaxEdits = 4096 };
+
+	StructureVersion() : itsVersion(0), itsGeometry(0), itsConnectivity(0) {}
+
+	DlUInt32	Current() const		{ return itsVersion; }
+	void		Changed()			{ itsVersion++; }
+	void		Changed(const ElementImp* e)	{ record(itsEdits.elements, e); Changed(); }
+	void		Changed(const PropertyImp* p)	{ record(itsEdits.properties, p); Changed(); }
+
+	DlUInt32	Geometry() const	{ return itsGeometry; }
+	void		Moved()				{ itsGeometry++; Changed(); }
+	void		Moved(const NodeImp* n)	{ record(itsEdits.nodes, n); Moved(); }
+	DlUInt32	Connectivity() const	{ return itsConnectivity; }
+	void		Reconnected(const ElementImp* e)	{ record(itsEdits.elements, e); itsConnectivity++; Moved(); }
+
+	//	move the record to edits and start a new one.
+	void		TakeEdits(StructureEdits& edits)	{ edits = std::move(itsEdits); itsEdits = StructureEdits(); }
+
+private:
+	StructureVersion(const StructureVersion&) = delete;
+	StructureVersion& operator=(const StructureVersion&) = delete;
+
+	template <class T> void	record(std::unordered_set<const T*>& items, const T* item);
+
+	DlUInt32		itsVersion;
+	DlUInt32		itsGeometry;
+	DlUInt32		itsConnectivity;
+	StructureEdits	itsEdits;
+};
+
+//---------------------------------- Inlines -----------------------------------
+
+//----------------------------------------------------------------------------------------
+//  StructureVersion::record                                               private inline
+//
+//      add an edited item to the record, or give up on the record once it is
+//		too long.
+//
+//  std::unordered_set<const T*>& items    <> the items of its kind.
+//  const T* item                          -> the item.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+template <class T> inline void
+StructureVersion::record(std::unordered_set<const T*>& items, const T* item)
+{
+	if (itsEdits.all)
+		return;
+	
+	items.insert(item);
+	if (itsEdits.nodes.size() + itsEdits.elements.size() + itsEdits.properties.size() > kMaxEdits) {
+		itsEdits = StructureEdits();
+		itsEdits.all = true;
+	}
+}
+
+#endif
+
+//	eof
@@ -36,24 +36,133 @@
 #include "StrOutputStream.h"
 #include "DlString.h"
 #include "colsol.h"
+#include "DlThreadPool.h"
+#include "SparseLDL.h"
+#include "PCGSolver.h"
+#include "StiffnessCache.h"
+#include "ElementMatrixCache.h"
+#include "SkylineFile.h"
+#include "CombinationEngine.h"
+#include "StructureVersion.h"
 #include "ElementFactory.h"
 #include "PropertyFactory.h"
+#include "StrBinaryFormat.h"
+#include "ResultsFile.h"
+#include "DlException.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+//---------------------------------- Functions ---------------------------------
+
+//	the FNV-1a offset basis, where every load signature starts
+static const DlUInt64 kSignatureSeed = 14695981039346656037ULL;
+
+//	mix size bytes at p into the signature sig.
+static DlUInt64
+addSignature(DlUInt64 sig, const void* p, std::size_t size)
+{
+	const unsigned char* b = static_cast<const unsigned char*>(p);
+	for (std::size_t i = 0; i < size; i++) {
+		sig ^= b[i];
+		sig *= 1099511628211ULL;
+	}
+	return sig;
+}
+
+//	throw unless records first to first + count are among size records.
+static void
+checkRange(DlUInt64 first, DlUInt64 count, DlUInt64 size, const char* what)
+{
+	if (first > size || count > size - first)
+		throw DlException("Bad %s in binary frame file", what);
+}
+
+//	hand the items read so far to their list, which then owns them.
+template <class List, class T> static void
+appendItems(List& list, std::vector<T*>& items)
+{
+	list.Append(items.empty() ? nullptr : &items[0], items.size());
+	items.clear();
+}
 
 //---------------------------------- Class -------------------------------------
 
 class SolverProgress : public EqSolveProgress, public DlBroadcaster
 {
 public:
-	SolverProgress(DlListener* listener);
+	SolverProgress(DlListener* listener, AnalysisTelemetry* telemetry = nullptr);
 	
 	bool	Broadcast();
 	//	called for transitions
 	virtual bool SetStage(EqSolveProgress::Stage stage);
 	//	return false to cancel analysis
 	virtual bool Processing(DlInt32 i, DlInt32 n);
+	//	return false to cancel analysis
+	virtual bool Iteration(DlInt32 i, DlInt32 maxIter, DlFloat64 residual);
+	//	keeps the least and greatest pivots in the telemetry
+	virtual void Pivot(DlInt32 i, DlFloat64 pivot);
 private:
 
 	AnalysisBroadcast	_data;
+	AnalysisTelemetry*	_telemetry;
+};
+
+//	Counts the load cases finished by several threads and passes the count on
+//	to one progress object, one case at a time. Once the progress object
+//	cancels, every case that checks afterwards stops as well.
+class LoadCaseProgress
+{
+public:
+	LoadCaseProgress(EqSolveProgress* progress, DlInt32 total);
+	
+	//	throw if the analysis was cancelled
+	void	Check() const;
+	//	call when a case is done; throws if the analysis was cancelled
+	void	Finished();
+
+private:
+	LoadCaseProgress(const LoadCaseProgress& p);
+	LoadCaseProgress& operator=(const LoadCaseProgress& p);
+
+	EqSolveProgress*	_progress;
+	std::mutex			_lock;
+	DlInt32				_done;
+	DlInt32				_total;
+	std::atomic<bool>	_cancelled;
+};
+
+//	Times the phases of an analysis, which run one after another. Each Lap
+//	returns the seconds since the last one.
+class PhaseTimer
+{
+	typedef std::chrono::steady_clock Clock;
+public:
+	PhaseTimer() : _last(Clock::now()) {}
+	
+	DlFloat64	Lap();
+
+private:
+	Clock::time_point	_last;
+};
+
+//	Marks the results of a structure as in use by the calling thread while
+//	combinations are built or dropped. A call from a second thread at the
+//	same time throws, calls nested on the same thread are fine.
+class ResultsAccess
+{
+public:
+	explicit ResultsAccess(std::atomic<std::thread::id>& owner);
+	~ResultsAccess();
+
+private:
+	ResultsAccess(const ResultsAccess& a);
+	ResultsAccess& operator=(const ResultsAccess& a);
+
+	std::atomic<std::thread::id>&	_owner;
+	bool							_outer;
 };
 
 //----------------------------------------------------------------------------------------
@@ -71,8 +180,24 @@ frame_data::frame_data(const char* defaultPropName)
 	, itsActiveLoadCase(0)
 	, itsActiveElementType(ElementFactory::sElementFactory.GetDefaultElementType())
 	, itsActiveProperty(0)
+	, itsUseCount(0)
+	, itsCombinationBytes(0)
+	, itsFactorVersion(0)
+	, itsFactored(false)
 	, defaultPropertyTitle(defaultPropName)
 {
+	itsAnalysisOptions.solver = AnalysisSolverSkyline;
+	itsAnalysisOptions.minimizeProfile = false;
+	itsAnalysisOptions.solverThreads = 1;
+	itsAnalysisOptions.preconditioner = AnalysisPreconditionerIncompleteCholesky;
+	itsAnalysisOptions.tolerance = 1.0e-10;
+	itsAnalysisOptions.maxIterations = 0;
+	itsAnalysisOptions.incremental = false;
+	itsAnalysisOptions.combinationMemory = 0;
+	itsAnalysisOptions.mixedPrecision = false;
+	itsAnalysisOptions.solverMemory = 0;
+	itsAnalysisOptions.reproducibleAssembly = false;
+	itsTelemetry = AnalysisTelemetry();
 	setupProperties();
 	CreateLoadCase("default");
 }
@@ -104,7 +229,24 @@ frame_data::frame_data(const NodeList* nodes, const ElementList* elements, bool
 	: itsMajorVersion(kCurrentMajorVersion)
 	, itsMinorVersion(kCurrentMinorVersion)
 	, itsActiveLoadCase(0)
+	, itsUseCount(0)
+	, itsCombinationBytes(0)
+	, itsFactorVersion(0)
+	, itsFactored(false)
 {
+	itsAnalysisOptions.solver = AnalysisSolverSkyline;
+	itsAnalysisOptions.minimizeProfile = false;
+	itsAnalysisOptions.solverThreads = 1;
+	itsAnalysisOptions.preconditioner = AnalysisPreconditionerIncompleteCholesky;
+	itsAnalysisOptions.tolerance = 1.0e-10;
+	itsAnalysisOptions.maxIterations = 0;
+	itsAnalysisOptions.incremental = false;
+	itsAnalysisOptions.combinationMemory = 0;
+	itsAnalysisOptions.mixedPrecision = false;
+	itsAnalysisOptions.solverMemory = 0;
+	itsAnalysisOptions.reproducibleAssembly = false;
+	itsTelemetry = AnalysisTelemetry();
+
 	//	now we need to fix up the loads and elements
 	NodeCloneMap theNodeMap;
 
@@ -143,8 +285,6 @@ frame_data::read(StrInputStream & s)
 	
 	clear();
 
-	fprintf(stderr, "minor v = %d", itsMinorVersion);
-	
 	// FIXME: take this out
 //	itsMinorVersion = 4;
 	
@@ -235,12 +375,438 @@ frame_data::write(StrOutputStream& s) const
 	}
 }
 
+//----------------------------------------------------------------------------------------
+//  frame_data::readBinary
+//
+//      read the frame_data from a binary file image. The records are used in
+//		place, so each list is built in one pass without going through a stream.
+//
+//  const void* image  -> the file.
+//  DlUInt64 length    -> the length of the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::readBinary(const void* image, DlUInt64 length)
+{
+	StrBinaryReader file(image, length);
+
+	const StrBinaryFrame* frame;
+	const StrBinaryNodeLoad* nodeLoads;
+	const StrBinaryElemLoad* elemLoads;
+	const StrBinaryProperty* props;
+	const DlFloat64* values;
+	const StrBinaryNode* nodes;
+	const StrBinaryLoadRef* nodeRefs;
+	const StrBinaryElement* elems;
+	const StrBinaryLoadRef* elemRefs;
+	const StrBinaryCombination* combinations;
+	const DlFloat32* factors;
+	const StrBinaryLoadCase* cases;
+
+	if (file.GetSection(kStrBinaryFrame, frame) != 1)
+		throw DlException("Not a binary frame file");
+
+	DlUInt64 nodeLoadCount = file.GetSection(kStrBinaryNodeLoads, nodeLoads);
+	DlUInt64 elemLoadCount = file.GetSection(kStrBinaryElemLoads, elemLoads);
+	DlUInt64 propCount = file.GetSection(kStrBinaryProperties, props);
+	DlUInt64 valueCount = file.GetSection(kStrBinaryPropValues, values);
+	DlUInt64 nodeCount = file.GetSection(kStrBinaryNodes, nodes);
+	DlUInt64 nodeRefCount = file.GetSection(kStrBinaryNodeLoadRefs, nodeRefs);
+	DlUInt64 elemCount = file.GetSection(kStrBinaryElements, elems);
+	DlUInt64 elemRefCount = file.GetSection(kStrBinaryElemLoadRefs, elemRefs);
+	DlUInt64 comboCount = file.GetSection(kStrBinaryCombinations, combinations);
+	DlUInt64 factorCount = file.GetSection(kStrBinaryFactors, factors);
+	DlUInt64 caseCount = file.GetSection(kStrBinaryLoadCases, cases);
+
+	//	check the references first, so the lists are only built from good
+	//	records.
+	for (DlUInt64 i = 0; i < propCount; i++)
+		checkRange(props[i].firstValue, props[i].valueCount, valueCount, "property");
+	for (DlUInt64 i = 0; i < nodeCount; i++)
+		checkRange(nodes[i].firstLoad, nodes[i].loadCount, nodeRefCount, "node");
+	for (DlUInt64 i = 0; i < elemCount; i++) {
+		const StrBinaryElement& e = elems[i];
+		checkRange(e.firstLoad, e.loadCount, elemRefCount, "element");
+		if (e.nodes[0] < 0 || e.nodes[0] >= DlInt64(nodeCount) || e.nodes[1] < 0 || e.nodes[1] >= DlInt64(nodeCount)
+				|| e.property >= DlInt64(propCount))
+			throw DlException("Bad element in binary frame file");
+	}
+	for (DlUInt64 i = 0; i < comboCount; i++)
+		checkRange(combinations[i].firstFactor, combinations[i].factorCount, factorCount, "combination");
+	for (DlUInt64 i = 0; i < caseCount; i++) {
+		if (cases[i].combination >= DlInt64(comboCount))
+			throw DlException("Bad load case in binary frame file");
+	}
+	if (frame->activeProperty >= DlInt64(propCount))
+		throw DlException("Bad property in binary frame file");
+
+	itsMajorVersion = frame->majorVersion;
+	itsMinorVersion = frame->minorVersion;
+
+	clear();
+
+	std::vector<NodeLoadImp*> newNodeLoads;
+	newNodeLoads.reserve(nodeLoadCount);
+	for (DlUInt64 i = 0; i < nodeLoadCount; i++)
+		newNodeLoads.push_back(NEW NodeLoadImp(nodeLoads[i]));
+	appendItems(itsNodeLoads, newNodeLoads);
+
+	std::vector<ElemLoadImp*> newElemLoads;
+	newElemLoads.reserve(elemLoadCount);
+	for (DlUInt64 i = 0; i < elemLoadCount; i++)
+		newElemLoads.push_back(NEW ElemLoadImp(elemLoads[i]));
+	appendItems(itsElemLoads, newElemLoads);
+
+	std::vector<PropertyImp*> newProps;
+	newProps.reserve(propCount);
+	for (DlUInt64 i = 0; i < propCount; i++) {
+		const char* elemName = file.GetString(props[i].elementType);
+		std::unique_ptr<PropertyImp> prop(PropertyFactory::sPropertyFactory.CreateProperty("", elemName));
+		if (!prop.get()) {
+			appendItems(itsProperties, newProps);
+			throw DlException("Unknown element type \"%s\".", elemName);
+		}
+		prop->setTitle(file.GetString(props[i].title));
+		try {
+			prop->Read(values + props[i].firstValue, props[i].valueCount);
+		} catch (...) {
+			appendItems(itsProperties, newProps);
+			throw;
+		}
+		newProps.push_back(prop.release());
+	}
+	appendItems(itsProperties, newProps);
+
+	std::vector<NodeImp*> newNodes;
+	newNodes.reserve(nodeCount);
+	for (DlUInt64 i = 0; i < nodeCount; i++)
+		newNodes.push_back(NEW NodeImp(nodes[i], nodeRefs + nodes[i].firstLoad, *this));
+	appendItems(itsNodes, newNodes);
+
+	//	most structures have one or two element types, so remember the last
+	//	type name rather than looking each one up.
+	std::vector<ElementImp*> newElems;
+	newElems.reserve(elemCount);
+	const ElementFactory& factory = ElementFactory::sElementFactory;
+	DlUInt32 lastType = 0;
+	const char* typeName = "";
+	for (DlUInt64 i = 0; i < elemCount; i++) {
+		const StrBinaryElement& e = elems[i];
+		if (i == 0 || e.elementType != lastType) {
+			lastType = e.elementType;
+			typeName = file.GetString(lastType);
+		}
+
+		ElementImp* elem = factory.CreateElement(typeName, IndexToNode(e.nodes[0]),
+												 IndexToNode(e.nodes[1]), IndexToProp(e.property));
+		if (elem == nullptr) {
+			appendItems(itsElements, newElems);
+			throw DlException("Element of type %s could not be created.", typeName);
+		}
+		elem->AssignLoads(elemRefs + e.firstLoad, e.loadCount, *this);
+		newElems.push_back(elem);
+	}
+	appendItems(itsElements, newElems);
+
+	itsActiveElementType = file.GetString(frame->activeElementType);
+	itsActiveProperty = IndexToProp(frame->activeProperty);
+
+	combos.reserve(comboCount);
+	for (DlUInt64 i = 0; i < comboCount; i++) {
+		const DlFloat32* f = factors + combinations[i].firstFactor;
+		combos.push_back(LoadCaseCombination(std::vector<DlFloat32>(f, f + combinations[i].factorCount)));
+	}
+
+	itsLoadCases.reserve(caseCount);
+	for (DlUInt64 i = 0; i < caseCount; i++) {
+		itsLoadCases.push_back(LoadCaseEntry(cases[i].combination, file.GetString(cases[i].name)));
+		if (cases[i].combination >= 0)
+			updateLoadCombos(i, combos[cases[i].combination].GetFactors());
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::writeBinary
+//
+//      write the frame_data as a binary file image.
+//
+//  std::vector<DlUInt8>& image    <- the file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::writeBinary(std::vector<DlUInt8>& image) const
+{
+	StrBinaryWriter file;
+
+	std::vector<StrBinaryFrame> frame(1);
+	frame[0].majorVersion = kCurrentMajorVersion;
+	frame[0].minorVersion = kCurrentMinorVersion;
+	frame[0].activeElementType = file.AddString(itsActiveElementType);
+	frame[0].activeProperty = PropToIndex(itsActiveProperty);
+
+	std::vector<StrBinaryNodeLoad> nodeLoads(itsNodeLoads.size());
+	for (DlUInt32 i = 0; i < nodeLoads.size(); i++)
+		itsNodeLoads.ElementAt(i)->WriteRecord(nodeLoads[i]);
+
+	std::vector<StrBinaryElemLoad> elemLoads(itsElemLoads.size());
+	for (DlUInt32 i = 0; i < elemLoads.size(); i++)
+		itsElemLoads.ElementAt(i)->WriteRecord(elemLoads[i]);
+
+	std::vector<StrBinaryProperty> props(itsProperties.size());
+	std::vector<DlFloat64> values;
+	for (DlUInt32 i = 0; i < props.size(); i++) {
+		const PropertyImp* prop = itsProperties.ElementAt(i);
+		props[i].elementType = file.AddString(prop->GetAssociatedElementType());
+		props[i].title = file.AddString(prop->getTitle());
+		props[i].firstValue = values.size();
+		prop->WriteRecord(values);
+		props[i].valueCount = values.size() - props[i].firstValue;
+	}
+
+	std::vector<StrBinaryNode> nodes(itsNodes.size());
+	std::vector<StrBinaryLoadRef> nodeRefs;
+	for (DlUInt32 i = 0; i < nodes.size(); i++)
+		itsNodes.ElementAt(i)->WriteRecord(nodes[i], nodeRefs, *this);
+
+	std::vector<StrBinaryElement> elems(itsElements.size());
+	std::vector<StrBinaryLoadRef> elemRefs;
+	for (DlUInt32 i = 0; i < elems.size(); i++) {
+		const ElementImp* elem = itsElements.ElementAt(i);
+		elems[i].elementType = file.AddString(elem->GetType());
+		elem->WriteRecord(elems[i], elemRefs, *this);
+	}
+
+	std::vector<StrBinaryCombination> combinations(combos.size());
+	std::vector<DlFloat32> factors;
+	for (DlUInt32 i = 0; i < combos.size(); i++) {
+		const std::vector<DlFloat32>& f = combos[i].GetFactors();
+		combinations[i].firstFactor = factors.size();
+		combinations[i].factorCount = f.size();
+		factors.insert(factors.end(), f.begin(), f.end());
+	}
+
+	std::vector<StrBinaryLoadCase> cases(itsLoadCases.size());
+	for (DlUInt32 i = 0; i < cases.size(); i++) {
+		cases[i].combination = itsLoadCases[i].first;
+		cases[i].name = file.AddString(itsLoadCases[i].second.c_str());
+	}
+
+	file.AddSection(kStrBinaryFrame, frame);
+	file.AddSection(kStrBinaryNodeLoads, nodeLoads);
+	file.AddSection(kStrBinaryElemLoads, elemLoads);
+	file.AddSection(kStrBinaryProperties, props);
+	file.AddSection(kStrBinaryPropValues, values);
+	file.AddSection(kStrBinaryNodes, nodes);
+	file.AddSection(kStrBinaryNodeLoadRefs, nodeRefs);
+	file.AddSection(kStrBinaryElements, elems);
+	file.AddSection(kStrBinaryElemLoadRefs, elemRefs);
+	file.AddSection(kStrBinaryCombinations, combinations);
+	file.AddSection(kStrBinaryFactors, factors);
+	file.AddSection(kStrBinaryLoadCases, cases);
+	file.Write(image);
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::readResults
+//
+//      take the load case results from a results file saved for this structure.
+//		The equations are numbered again, so the file need not match the
+//		numbering it was saved with.
+//
+//  const ResultsFile& file    -> the results.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::readResults(const ResultsFile& file)
+{
+	if (file.GetNodeCount() != static_cast<DlUInt32>(itsNodes.Length())
+		|| file.GetElementCount() != static_cast<DlUInt32>(itsElements.Length()))
+		throw DlException("Results file does not match current structure.");
+
+	DlUInt32 lcCount = GetLoadCaseCount();
+	for (LoadCase lc = 0; lc < lcCount; lc++) {
+		if (IsDefinedLoadCase(lc) && !file.HasLoadCase(lc))
+			throw DlException("Results file has no results for load case %u.", lc);
+	}
+
+	discardSolution();
+	itsNodes.PrepareToAnalyze(&itsElements, itsAnalysisOptions.minimizeProfile);
+	ClearAnalysis(true);
+
+	DlInt32 nodeCount = itsNodes.Length();
+	DlInt32 elemCount = itsElements.Length();
+	std::vector<DlFloat64> disp[DOF_PER_NODE];
+	std::vector<DlFloat64> react[DOF_PER_NODE];
+	std::vector<DlFloat64> force[DOF_PER_NODE];
+
+	for (LoadCase lc = 0; lc < lcCount; lc++) {
+		if (!IsDefinedLoadCase(lc))
+			continue;
+
+		for (DlInt32 c = 0; c < DOF_PER_NODE; c++) {
+			file.ReadColumn(lc, ResultDisplacement, c, disp[c]);
+			file.ReadColumn(lc, ResultReaction, c, react[c]);
+			file.ReadColumn(lc, ResultElementForce, c, force[c]);
+		}
+
+		LoadCaseResults* res = NEW LoadCaseResults(lc, itsNodes, itsElements);
+		results[lc].reset(res);
+
+		std::valarray<DlFloat64>& displacements = res->GetDisplacements();
+		std::valarray<DlFloat64>& reactions = res->GetReactions();
+		for (DlInt32 i = 0; i < nodeCount; i++) {
+			const NodeImp* node = itsNodes.ElementAt(i);
+			for (DlInt32 c = 0; c < DOF_PER_NODE; c++) {
+				DlInt32 eq = node->GetEquationNumber(c);
+				if (eq > 0)
+					displacements[eq - 1] = disp[c][i];
+				else if (eq < 0)
+					reactions[-eq - 1] = react[c][i];
+			}
+		}
+
+		for (DlInt32 i = 0; i < elemCount; i++) {
+			DlFloat64 vals[DOF_PER_NODE];
+			for (DlInt32 c = 0; c < DOF_PER_NODE; c++)
+				vals[c] = force[c][i];
+			res->SetEndForces(i, ElementForce(vals));
+		}
+
+		const StrBinaryResultCase& scales = file.GetCase(lc);
+		res->UpdateDisplacementScale(scales.dispScale);
+		res->UpdateMomentScale(scales.momentScale);
+		res->UpdateShearScale(scales.shearScale);
+		res->UpdateAxialScale(scales.axialScale);
+		res->SetDisplacementMagnifier(scales.magnifier);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::writeResults
+//
+//      write the results of each load case as a results file image. Each node
+//		has its displacements and reactions, 0 where there are none, so the
+//		file does not depend on the equation numbering.
+//
+//  std::vector<DlUInt8>& image    <- the file.
+//  bool compress                  -> compress columns where it makes them smaller.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::writeResults(std::vector<DlUInt8>& image, bool compress) const
+{
+	StrBinaryWriter file;
+
+	DlInt32 nodeCount = itsNodes.Length();
+	DlInt32 elemCount = itsElements.Length();
+
+	std::vector<StrBinaryResults> header(1);
+	header[0].nodeCount = nodeCount;
+	header[0].elementCount = elemCount;
+	header[0].reserved[0] = header[0].reserved[1] = 0;
+
+	std::vector<StrBinaryResultCase> cases;
+	std::vector<StrBinaryResultColumn> columns;
+	std::vector<DlUInt8> data;
+	std::vector<DlFloat64> values[ResultQuantityCount][DOF_PER_NODE];
+
+	for (LoadCase lc = 0; lc < results.size() && lc < GetLoadCaseCount(); lc++) {
+		const LoadCaseResults* res = results[lc].get();
+		if (res == nullptr || !IsDefinedLoadCase(lc))
+			continue;
+
+		for (DlInt32 c = 0; c < DOF_PER_NODE; c++) {
+			values[ResultDisplacement][c].resize(nodeCount);
+			values[ResultReaction][c].resize(nodeCount);
+			values[ResultElementForce][c].resize(elemCount);
+		}
+
+		const std::valarray<DlFloat64>& reactions = res->GetReactions();
+		for (DlInt32 i = 0; i < nodeCount; i++) {
+			const NodeImp* node = itsNodes.ElementAt(i);
+			DlFloat64 disp[DOF_PER_NODE];
+			res->GetDisplacement(node, disp);
+			for (DlInt32 c = 0; c < DOF_PER_NODE; c++) {
+				DlInt32 eq = node->GetEquationNumber(c);
+				values[ResultDisplacement][c][i] = disp[c];
+				values[ResultReaction][c][i] = eq < 0 ? reactions[-eq - 1] : 0;
+			}
+		}
+
+		for (DlInt32 i = 0; i < elemCount; i++) {
+			const ElementForce& force = res->GetElementForce(i);
+			for (DlInt32 c = 0; c < DOF_PER_NODE; c++)
+				values[ResultElementForce][c][i] = force[c];
+		}
+
+		StrBinaryResultCase rc;
+		rc.loadCase = lc;
+		rc.firstColumn = columns.size();
+		rc.dispScale = res->DisplacementScale();
+		rc.momentScale = res->MomentScale();
+		rc.shearScale = res->ShearScale();
+		rc.axialScale = res->AxialScale();
+		rc.magnifier = res->GetDisplacementMagnifier();
+		cases.push_back(rc);
+
+		for (DlInt32 q = 0; q < ResultQuantityCount; q++) {
+			for (DlInt32 c = 0; c < DOF_PER_NODE; c++) {
+				const std::vector<DlFloat64>& v = values[q][c];
+
+				//	keep raw columns aligned so they can be used in place
+				data.resize((data.size() + sizeof(DlFloat64) - 1) & ~(sizeof(DlFloat64) - 1));
+
+				StrBinaryResultColumn col;
+				col.loadCase = lc;
+				col.quantity = q;
+				col.component = c;
+				col.encoding = kStrBinaryColumnRaw;
+				col.count = v.size();
+				col.offset = data.size();
+
+				DlUInt64 rawLength = v.size() * sizeof(DlFloat64);
+				if (compress && !v.empty()) {
+					EncodeResultColumn(&v[0], v.size(), data);
+					if (data.size() - col.offset < rawLength)
+						col.encoding = kStrBinaryColumnXor;
+					else
+						data.resize(col.offset);
+				}
+
+				if (col.encoding == kStrBinaryColumnRaw) {
+					const DlUInt8* raw = reinterpret_cast<const DlUInt8*>(v.empty() ? nullptr : &v[0]);
+					data.insert(data.end(), raw, raw + rawLength);
+				}
+
+				col.length = data.size() - col.offset;
+				columns.push_back(col);
+			}
+		}
+	}
+
+	file.AddSection(kStrBinaryResults, header);
+	file.AddSection(kStrBinaryResultCases, cases);
+	file.AddSection(kStrBinaryResultColumns, columns);
+	file.AddSection(kStrBinaryResultData, data);
+	file.Write(image);
+}
+
 void
 frame_data::ListenToMessage(DlUInt32 msg, void* data) const
 {
 	frame_data* fd = const_cast<frame_data*>(this);
 	
-	if (msg == MessageNodeLoadAssignmentChanged) {
+	if (msg >= MessageListAddOne && msg <= MessageListRemoveMultiple) {
+		//	nodes or elements were added or removed, so the cached matrix
+		//	no longer matches the structure.
+		fd->itsVersion.Changed();
+		if (itsStiffnessCache)
+			itsStiffnessCache->Invalidate();
+	} else if (msg == MessageNodeLoadAssignmentChanged) {
 		for (int i = 0; i < itsLoadCases.size(); i++) {
 			if (itsLoadCases[i].first >= 0)
 				fd->updateNodeLoadCombos(i, combos[itsLoadCases[i].first].GetFactors());
@@ -280,6 +846,25 @@ frame_data::Analyzed() const {
 	return results.size() > 0;
 }
 
+//----------------------------------------------------------------------------------------
+//  frame_data::SetAnalysisOptions
+//
+//      set the options used for analysis. The kept skyline of an incremental
+//		analysis is in double precision, so it can't be factored in single.
+//
+//  const AnalysisOptions& options -> the new options.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::SetAnalysisOptions(const AnalysisOptions& options)
+{
+	if (options.incremental && options.mixedPrecision)
+		throw DlException("Incremental analysis can't use mixed precision");
+	
+	itsAnalysisOptions = options;
+}
+
 //----------------------------------------------------------------------------------------
 //  frame_data::InitAnalysis
 //
@@ -292,12 +877,17 @@ frame_data::Analyzed() const {
 void
 frame_data::InitAnalysis(AnalysisData* data) 
 {
-	itsNodes.PrepareToAnalyze(&itsElements);
+	PhaseTimer timer;
+	itsNodes.PrepareToAnalyze(&itsElements, itsAnalysisOptions.minimizeProfile, 
+		&itsTelemetry.timings.starts);
+	itsTelemetry.timings.numbering = timer.Lap() - itsTelemetry.timings.starts;
 
 	data->nodeCount = itsNodes.Length();
 	data->elemCount = itsElements.Length();
 	data->eqCount = itsNodes.GetEquationCount();
 	data->lcCount = GetLoadCaseCount();
+	data->initialProfile = itsNodes.GetInitialMatrixSize();
+	data->profile = itsNodes.GetMatrixSize();
 }
 
 //----------------------------------------------------------------------------------------
@@ -316,51 +906,333 @@ frame_data::Analyze(DlListener* l)
 		
 //		DlUInt32 lcCount = GetLoadCaseCount();
 		
-		SolverProgress	progress(l);
-		//	first create the matrix	
-		valarray<DlFloat64>	matrix(0.0, itsNodes.GetMatrixSize());
-		itsElements.AssembleStiffness(matrix, itsNodes.GetStarts());
+		SolverProgress	progress(l, &itsTelemetry);
+		DlInt32 neq = itsNodes.GetEquationCount();
+		
+		const valarray<DlFloat64>*	factor = &itsFactor;
+		std::unique_ptr<SparseLDL>	sparse;
+		std::unique_ptr<PCGSolver>	iterative;
+		std::unique_ptr<DlThreadPool>	pool;
+		
+		if (itsAnalysisOptions.solverThreads != 1)
+			pool.reset(NEW DlThreadPool(itsAnalysisOptions.solverThreads));
+		
+		bool skyline = itsAnalysisOptions.solver == AnalysisSolverSkyline;
+		bool incremental = skyline && itsAnalysisOptions.incremental;
+		bool mixed = skyline && !incremental && itsAnalysisOptions.mixedPrecision;
+		
+		//	a skyline too large for the memory allowed is factored in a file
+		DlUInt64 memory = itsAnalysisOptions.solverMemory;
+		bool outOfCore = skyline && !incremental && !mixed && memory > 0
+			&& itsNodes.GetMatrixSize() * sizeof(DlFloat64) > memory;
+		
+		if (!incremental)
+			itsStiffnessCache.reset();
+		if (!mixed)
+			itsMixedFactor.reset();
+		if (!outOfCore)
+			itsFileFactor.reset();
+		if (!skyline || incremental || mixed || outOfCore)
+			itsFactor.resize(0);
+		
+		//	the factor from the last analysis is good if no edit since then
+		//	changed the stiffness and the equations are numbered the same.
+		DlUInt32 version = itsVersion.Current();
+		valarray<DlInt32> numbering;
+		getNumbering(numbering);
+		
+		bool kept = incremental ? itsStiffnessCache != nullptr
+			: mixed ? itsMixedFactor != nullptr
+			: outOfCore ? itsFileFactor != nullptr
+			: itsFactor.size() > 0;
+		
+		bool reuse = skyline && itsFactored && itsFactorVersion == version && kept
+			&& numbering.size() == itsFactorNumbering.size()
+			&& std::equal(std::begin(numbering), std::end(numbering), std::begin(itsFactorNumbering));
+		
+		if (!reuse)
+			discardSolution();
+		
+		//	every element matrix is computed at most once, then read by
+		//	assembly, the settlement loads and force recovery. The incremental
+		//	cache keeps its own between analyses, and a kept factor needs
+		//	them only if a load case is solved.
+		PhaseTimer timer;
+		ElementMatrixCache built;
+		const ElementMatrixCache* matrices = nullptr;
+		if (reuse && incremental) {
+			matrices = &itsStiffnessCache->GetMatrices();
+		} else if (!reuse && !incremental) {
+			built.Build(itsElements, pool.get());
+			matrices = &built;
+		}
+		itsTelemetry.timings.assembly = timer.Lap();
+		itsTelemetry.timings.factor = itsTelemetry.timings.solve = itsTelemetry.timings.recovery = 0;
+		
+		DlInt64 skylineSize = itsNodes.GetMatrixSize();
+		itsTelemetry.equations = neq;
+		itsTelemetry.skylineSize = skylineSize;
+		itsTelemetry.averageColumnHeight = neq > 0 ? static_cast<DlFloat64>(skylineSize) / neq : 0;
+		itsTelemetry.caseSolveTimes.assign(itsLoadCases.size(), 0.0);
+		
+		//	a kept factor keeps the pivots found when it was made
+		if (!reuse) {
+			itsTelemetry.minPivot = itsTelemetry.maxPivot = 0;
+			itsTelemetry.minPivotEquation = 0;
+		}
+		
+		if (reuse) {
+			//	only loads changed
+			if (incremental)
+				factor = &itsStiffnessCache->GetFactor();
+		} else if (itsAnalysisOptions.solver == AnalysisSolverIterative) {
+			valarray<DlInt32> connect;
+			valarray<DlInt32> starts;
+			itsElements.GetConnectivity(neq, connect, starts);
+			
+			PCGSolver::Preconditioner precond = PCGSolver::IncompleteCholesky;
+			if (itsAnalysisOptions.preconditioner == AnalysisPreconditionerJacobi)
+				precond = PCGSolver::Jacobi;
+			else if (itsAnalysisOptions.preconditioner == AnalysisPreconditionerGaussSeidel)
+				precond = PCGSolver::SymmetricGaussSeidel;
+			
+			iterative.reset(NEW PCGSolver(connect, starts, precond));
+			iterative->setTolerance(itsAnalysisOptions.tolerance);
+			iterative->setMaxIterations(itsAnalysisOptions.maxIterations);
+			itsElements.AssembleStiffness(*iterative, matrices);
+			itsTelemetry.timings.assembly += timer.Lap();
+			
+			iterative->factor(true, &progress);
+		} else if (itsAnalysisOptions.solver == AnalysisSolverSparse) {
+			//	build the sparse matrix from the element connectivity
+			valarray<DlInt32> connect;
+			valarray<DlInt32> starts;
+			itsElements.GetConnectivity(neq, connect, starts);
+			
+			sparse.reset(NEW SparseLDL(connect, starts));
+			itsElements.AssembleStiffness(*sparse, matrices);
+			itsTelemetry.timings.assembly += timer.Lap();
+			
+			sparse->factor(true, &progress);
+		} else if (mixed) {
+			//	the solver takes the assembled matrix and keeps a single
+			//	precision factor of it, refining each solution.
+			valarray<DlFloat64> matrix(0.0, itsNodes.GetMatrixSize());
+			
+			if (pool)
+				itsElements.AssembleStiffness(matrix, itsNodes.GetStarts(), *pool, matrices);
+			else
+				itsElements.AssembleStiffness(matrix, itsNodes.GetStarts(), matrices,
+											  itsAnalysisOptions.reproducibleAssembly);
+			itsTelemetry.timings.assembly += timer.Lap();
+			
+			itsMixedFactor.reset(NEW ColsolMixed(neq, matrix, itsNodes.GetStarts()));
+			itsMixedFactor->factor(true, &progress, pool.get());
+		} else if (outOfCore) {
+			itsFileFactor.reset(NEW SkylineFile);
+			itsElements.AssembleStiffness(*itsFileFactor, itsNodes.GetStarts(), memory, matrices);
+			itsTelemetry.timings.assembly += timer.Lap();
+			colsolDecompFile(neq, *itsFileFactor, itsNodes.GetStarts(), memory, true, &progress);
+		} else if (itsAnalysisOptions.incremental) {
+			//	patch the matrix kept from the last analysis with the edits
+			//	since, and factor the columns from the first one that changed.
+			if (!itsStiffnessCache)
+				itsStiffnessCache.reset(NEW StiffnessCache);
+			
+			StructureEdits edits;
+			itsVersion.TakeEdits(edits);
+			DlInt32 first = itsStiffnessCache->Update(itsElements, itsNodes.GetStarts(), edits, pool.get());
+			valarray<DlFloat64>& cached = itsStiffnessCache->GetFactor();
+			matrices = &itsStiffnessCache->GetMatrices();
+			itsTelemetry.timings.assembly += timer.Lap();
+			
+			if (first <= neq) {
+				if (pool) {
+					colsolDecompParallel(neq, cached, itsNodes.GetStarts(), *pool, true, &progress, 0, first);
+				} else {
+					colsolDecompFrom(neq, cached, itsNodes.GetStarts(), first, true, &progress);
+				}
+				itsStiffnessCache->SetFactored();
+			}
+			
+			//	the columns before first were not factored again, so take
+			//	the pivots from the whole diagonal.
+			DlArray::DlOneBasedConstIter<DlInt32> maxa(itsNodes.GetStarts());
+			for (DlInt32 n = 1; n <= neq; n++)
+				progress.Pivot(n, cached[maxa[n] - 1]);
+			
+			factor = &cached;
+		} else {
+			//	first create the matrix	and then solve it
+			itsFactor.resize(itsNodes.GetMatrixSize(), 0.0);
+			
+			if (pool) {
+				itsElements.AssembleStiffness(itsFactor, itsNodes.GetStarts(), *pool, matrices);
+				itsTelemetry.timings.assembly += timer.Lap();
+				colsolDecompParallel(neq, itsFactor, itsNodes.GetStarts(), *pool, true, &progress);
+			} else {
+				itsElements.AssembleStiffness(itsFactor, itsNodes.GetStarts(), matrices,
+											  itsAnalysisOptions.reproducibleAssembly);
+				itsTelemetry.timings.assembly += timer.Lap();
+				colsol(true, neq, itsFactor, itsNodes.GetStarts(), 0, true, &progress);
+			}
+		}
 		
-		//	and solve it
-		colsol(true, itsNodes.GetEquationCount(), matrix, itsNodes.GetStarts(), 0, true, &progress);
+		itsTelemetry.timings.factor = timer.Lap();
 		
+		DlFloat64 solveFlops = 0;
+		itsTelemetry.factorFlops = 0;
+		if (sparse) {
+			sparse->operations(itsTelemetry.factorFlops, solveFlops);
+		} else if (skyline) {
+			colsolOperations(neq, itsNodes.GetStarts(), itsTelemetry.factorFlops, solveFlops);
+			if (reuse)
+				itsTelemetry.factorFlops = 0;
+		}
+		
+		if (skyline) {
+			itsFactored = true;
+			itsFactorVersion = version;
+			itsFactorNumbering.resize(numbering.size());
+			itsFactorNumbering = numbering;
+		}
+		
+		//	this moves the results of each load case to itsSolved.
 		ClearAnalysis(true);
+		itsSolved.resize(itsLoadCases.size(), nullptr);
+		itsSolvedLoads.resize(itsLoadCases.size(), 0);
+		
+		//	assemble the loads for every load case into one block of rhs vectors
+		//	so the back substitution makes a single pass over the matrix.
+		std::vector<LoadCaseResults*> solved;
 		
 		for (LoadCase i = 0; i < itsLoadCases.size(); i++) {
 			
 			if (IsDefinedLoadCase(i)) {
 				
-				LoadCaseResults* res = NEW LoadCaseResults(i, itsNodes, itsElements);
-				results[i] = res;
-			
-				itsElements.AssembleLoads(res->GetDisplacements(), i);
-				itsNodes.AssembleLoads(res->GetDisplacements(), i);
-				
-				colsol(false, itsNodes.GetEquationCount(), matrix, itsNodes.GetStarts(), 
-					&res->GetDisplacements(), true, &progress);
+				//	take the last results if this load case has the same loads
+				DlUInt64 loads = loadSignature(i);
+				if (itsSolved[i] && itsSolvedLoads[i] == loads) {
+					results[i] = std::move(itsSolved[i]);
+					continue;
+				}
 				
-				itsElements.RecoverResults(*res);
+				LoadCaseResults* res = NEW LoadCaseResults(i, itsNodes, itsElements);
+				results[i].reset(res);
+				itsSolvedLoads[i] = loads;
 				
-	#if DlDebugging
-				for (int i = 0; i < res->GetReactions().size(); i++) {
-					printf("reaction in dof %d is %.2lf\n", i+1, res->GetReactions()[i]);
-				}
-	#endif
+				solved.push_back(res);
 			} else {
 				results[i] = nullptr;
 			}
 		}
 		
-		// and the combinations.
-		for (LoadCase i = 0; i < itsLoadCases.size(); i++) {
-			const auto& p = itsLoadCases[i];
-			if (p.first >= 0) {
-				results[i] = NEW LoadCaseResults(i, combos[p.first], *this);
+		//	whatever was not taken no longer matches a load case.
+		for (std::size_t i = 0; i < itsSolved.size(); i++)
+			itsSolved[i].reset();
+		
+		DlInt32 nrhs = solved.size();
+		
+		if (!matrices && nrhs > 0) {
+			built.Build(itsElements, pool.get());
+			matrices = &built;
+			itsTelemetry.timings.assembly += timer.Lap();
+		}
+		
+		if (pool && skyline && !mixed && !outOfCore && nrhs > 1) {
+			//	each load case only reads the factor and the structure and
+			//	writes its own results, so the cases are solved at once.
+			LoadCaseProgress cases(&progress, nrhs);
+			pool->ParallelFor(0, nrhs, [&](DlInt32 r) {
+				cases.Check();
+				
+				PhaseTimer caseTimer;
+				LoadCaseResults* res = solved[r];
+				itsElements.AssembleLoads(res->GetDisplacements(), res->GetLoadCase(), matrices);
+				itsNodes.AssembleLoads(res->GetDisplacements(), res->GetLoadCase());
+				colsolBackSub(neq, *factor, itsNodes.GetStarts(), &res->GetDisplacements());
+				itsTelemetry.caseSolveTimes[res->GetLoadCase()] = caseTimer.Lap();
+				
+				cases.Finished();
+			});
+		} else {
+			PhaseTimer caseTimer;
+			for (DlInt32 r = 0; r < nrhs; r++) {
+				LoadCaseResults* res = solved[r];
+				itsElements.AssembleLoads(res->GetDisplacements(), res->GetLoadCase(), matrices);
+				itsNodes.AssembleLoads(res->GetDisplacements(), res->GetLoadCase());
+				itsTelemetry.caseSolveTimes[res->GetLoadCase()] = caseTimer.Lap();
+			}
+			
+			valarray<DlFloat64> rhs(neq * nrhs);
+			for (DlInt32 r = 0; r < nrhs; r++)
+				rhs[std::slice(r * neq, neq, 1)] = solved[r]->GetDisplacements();
+			
+			if (nrhs > 0) {
+				if (iterative)
+					iterative->solve(&rhs, nrhs, &progress);
+				else if (sparse)
+					sparse->solve(&rhs, nrhs, &progress);
+				else if (mixed)
+					itsMixedFactor->solve(&rhs, nrhs, &progress, pool.get());
+				else if (outOfCore)
+					colsolBackSubFile(neq, *itsFileFactor, itsNodes.GetStarts(), &rhs, nrhs,
+						memory, &progress);
+				else
+					colsolBackSubMulti(neq, *factor, itsNodes.GetStarts(), &rhs, nrhs, &progress);
 			}
+			
+			for (DlInt32 r = 0; r < nrhs; r++)
+				solved[r]->GetDisplacements() = rhs[std::slice(r * neq, neq, 1)];
+			
+			//	the cases are solved together, so each gets an equal share
+			DlFloat64 share = nrhs > 0 ? caseTimer.Lap() / nrhs : 0;
+			for (DlInt32 r = 0; r < nrhs; r++)
+				itsTelemetry.caseSolveTimes[solved[r]->GetLoadCase()] += share;
 		}
+		
+		if (mixed)
+			solveFlops *= 1 + itsMixedFactor->iterations();
+		itsTelemetry.solveFlops = solveFlops * nrhs;
+		
+		//	the element matrices are held alongside the global matrix
+		DlInt64 skylineBytes = skylineSize * sizeof(DlFloat64);
+		DlInt64 matrixBytes = skylineBytes;
+		if (iterative)
+			matrixBytes = iterative->storedSize() * sizeof(DlFloat64);
+		else if (sparse)
+			matrixBytes = sparse->factorSize() * sizeof(DlFloat64);
+		else if (mixed)
+			matrixBytes = skylineSize * (sizeof(DlFloat64) + sizeof(DlFloat32));
+		else if (outOfCore)
+			matrixBytes = std::min<DlInt64>(memory, skylineBytes) + neq * sizeof(DlFloat64);
+		else if (incremental)
+			matrixBytes = 2 * skylineBytes;
+		
+		DlInt64 elementMatrices = matrices ? matrices->GetCount() : 0;
+		itsTelemetry.peakMatrixBytes = matrixBytes
+			+ elementMatrices * ElementMatrixCache::kMatrixSize * sizeof(DlFloat64);
+		
+		itsTelemetry.timings.solve = timer.Lap();
+		
+		if (nrhs > 0)
+			itsElements.RecoverResults(solved, *matrices, pool.get());
+		itsTelemetry.timings.recovery = timer.Lap();
+		
+	#if DlDebugging
+		for (DlInt32 r = 0; r < nrhs; r++) {
+			const LoadCaseResults* res = solved[r];
+			for (int i = 0; i < res->GetReactions().size(); i++) {
+				printf("reaction in dof %d is %.2lf\n", i+1, res->GetReactions()[i]);
+			}
+		}
+	#endif
+		
+		// the combinations are built by GetResults when they are needed.
 
 	} catch(EqSolveFailure& solFailed) {
 		ClearAnalysis(false);
+		discardSolution();
 		
 		switch(solFailed.getReason()) {
 		case EqSolveFailure::UserCancelled:
@@ -371,12 +1243,19 @@ frame_data::Analyze(DlListener* l)
 			throw DlException("Analysis failed! Matrix singularity detected at equation %d.", 
 				solFailed.getEquation());
 			break;
+		case EqSolveFailure::NotConverged:
+			throw DlException("Analysis failed! Solution did not converge in %d iterations.", 
+				solFailed.getEquation());
+			break;
 		}
 		
 		throw DlException("Analysis failed.");
 	
 	} catch(std::exception& ex) {
 		ClearAnalysis(0);
+		discardSolution();
+		//	the kept matrix may be half updated
+		itsStiffnessCache.reset();
 		throw DlException(ex.what());
 	}
 	
@@ -556,19 +1435,170 @@ frame_data::IndexToProp(DlInt32 index) const
 //----------------------------------------------------------------------------------------
 //  frame_data::GetResults
 //
-//      return the results for the specified load case.
+//      return the results for the specified load case. The results of a 
+//		combination are built on first use and may be dropped again by a later
+//		call for another combination. The handle keeps them until it is let go.
 //
 //  LoadCase lc                    -> the load case.
 //
-//  returns const LoadCaseResults* <- the property.
+//  returns std::shared_ptr<const LoadCaseResults> <- the results.
 //----------------------------------------------------------------------------------------
-const LoadCaseResults* 
+std::shared_ptr<const LoadCaseResults>
 frame_data::GetResults(LoadCase lc) const 
 {
-	if (results.size() > lc)
+	if (results.size() > lc) {
+		if (lc < itsLoadCases.size() && !IsDefinedLoadCase(lc))
+			return getCombination(lc);
+		return results[lc];
+	}
+
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::getCombination                                                     private
+//
+//      return the results for combination lc, building them from the load case
+//		results if needed. Then drop the least recently used combinations 
+//		until the rest fit in the memory budget.
+//
+//  LoadCase lc                                -> the combination.
+//
+//  returns std::shared_ptr<LoadCaseResults>   <- the results.
+//----------------------------------------------------------------------------------------
+std::shared_ptr<LoadCaseResults>
+frame_data::getCombination(LoadCase lc) const
+{
+	ResultsAccess access(itsResultsThread);
+	
+	if (itsCombinationUse.size() < results.size())
+		itsCombinationUse.resize(results.size(), 0);
+	
+	itsCombinationUse[lc] = ++itsUseCount;
+	if (results[lc])
 		return results[lc];
+	
+	//	with no budget every combination is kept anyway, so build them all
+	//	together the first time one is asked for.
+	if (itsAnalysisOptions.combinationMemory == 0) {
+		CombineResults();
+		if (results[lc])
+			return results[lc];
+	}
+	
+	std::shared_ptr<LoadCaseResults> res(NEW LoadCaseResults(lc, combos[itsLoadCases[lc].first], *this));
+	results[lc] = res;
+	itsCombinationBytes += res->LoadCaseSize();
+	
+	DlUInt64 budget = itsAnalysisOptions.combinationMemory;
+	while (budget > 0 && itsCombinationBytes > budget) {
+		LoadCase oldest = lc;
+		for (LoadCase i = 0; i < results.size(); i++) {
+			if (i != lc && results[i] && !IsDefinedLoadCase(i)
+					&& (oldest == lc || itsCombinationUse[i] < itsCombinationUse[oldest]))
+				oldest = i;
+		}
+		
+		if (oldest == lc)
+			break;
+		dropCombination(oldest);
+	}
+	
+	return res;
+}
 
-	return NULL;
+//----------------------------------------------------------------------------------------
+//  frame_data::CombineResults
+//
+//      build the results of the combinations that are missing, all in one
+//      pass through the CombinationEngine. Past the combination memory the
+//      rest are left to be built when asked for.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::CombineResults() const
+{
+	if (!Analyzed() || combos.empty())
+		return;
+	
+	ResultsAccess access(itsResultsThread);
+	if (itsCombinationUse.size() < results.size())
+		itsCombinationUse.resize(results.size(), 0);
+	
+	PhaseTimer timer;
+	CombinationEngine engine(*this);
+	if (engine.GetBasisCount() == 0)
+		return;
+	
+	DlUInt64 budget = itsAnalysisOptions.combinationMemory;
+	std::vector<bool> pending(results.size(), false);
+	auto build = [&](DlInt32 which, const DlFloat64* values) {
+		LoadCase lc = engine.GetLoadCase(which);
+		if (results[lc] || (budget > 0 && itsCombinationBytes >= budget))
+			return;
+		
+		LoadCaseResults* res = NEW LoadCaseResults(lc, combos[itsLoadCases[lc].first], *this, values);
+		results[lc].reset(res);
+		itsCombinationUse[lc] = ++itsUseCount;
+		itsCombinationBytes += res->LoadCaseSize();
+		pending[lc] = true;
+	};
+	
+	engine.Stream(build);
+	
+	for (LoadCase lc = 0; lc < results.size(); lc++)
+		scaleCombination(lc, pending);
+	
+	itsTelemetry.timings.combination = timer.Lap();
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::scaleCombination                                                   private
+//
+//      fit the plot scales of a combination built by CombineResults to the
+//      load cases it combines, as the combining constructor would. A
+//      combination of combinations is scaled after those it combines.
+//
+//  LoadCase lc                    -> the combination.
+//  std::vector<bool>& pending     <> the combinations not yet scaled.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::scaleCombination(LoadCase lc, std::vector<bool>& pending) const
+{
+	if (!pending[lc])
+		return;
+	pending[lc] = false;
+	
+	const std::vector<DlFloat32>& factors = combos[itsLoadCases[lc].first].GetFactors();
+	for (LoadCase i = 0; i < factors.size() && i < results.size(); i++) {
+		if (std::fabs(factors[i]) > 1.0e-6) {
+			scaleCombination(i, pending);
+			if (results[i])
+				results[lc]->AddScales(*results[i], factors[i]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::dropCombination                                                    private
+//
+//      let go of the results for combination lc. They are freed once no
+//		handle from GetResults holds them.
+//
+//  LoadCase lc    -> the combination.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::dropCombination(LoadCase lc) const
+{
+	if (results[lc]) {
+		itsCombinationBytes -= results[lc]->LoadCaseSize();
+		results[lc].reset();
+	}
 }
 
 //----------------------------------------------------------------------------------------
@@ -584,8 +1614,9 @@ frame_data::GetResults(LoadCase lc) const
 void
 frame_data::SetDisplacementMagnifier(LoadCase lc, DlFloat64 mag)
 {
-	if (results.size() > lc)
-		results[lc]->SetDisplacementMagnifier(mag);
+	LoadCaseResults* res = const_cast<LoadCaseResults*>(GetResults(lc).get());
+	if (res)
+		res->SetDisplacementMagnifier(mag);
 }
 
 //----------------------------------------------------------------------------------------
@@ -755,8 +1786,7 @@ frame_data::AddLoadCaseCombination(const char* name, const LoadCaseCombination&
 	
 	if (Analyzed()) {
 		_DlAssert(results.size() + 1 == itsLoadCases.size());
-		LoadCase curr = results.size();
-		results.push_back(NEW LoadCaseResults(curr, combo, *this));
+		results.push_back(nullptr);
 	}
 }
 
@@ -783,17 +1813,17 @@ frame_data::UpdateLoadCaseCombination(LoadCase lc, const char* name,
 	
 	updateLoadCombos(lc, val.GetFactors());
 
-	if (Analyzed()) {
-		delete results[lc];
-		results[lc] = NEW LoadCaseResults(lc, val, *this);
-	}
+	if (Analyzed())
+		dropCombination(lc);
 }
 
 //----------------------------------------------------------------------------------------
 //  frame_data::ClearAnalysis
 //
 //      Clear the analysis data and update the number of element in the result
-//		vector. Pass 0 to indicate no analysis results.
+//		vector. Pass 0 to indicate no analysis results. While the factored
+//		matrix is kept, the results of each load case are moved to itsSolved
+//		so the next analysis can take those whose loads did not change.
 //
 //  DlInt32 newLoadCases   -> the new number of load cases.
 //
@@ -803,9 +1833,17 @@ void
 frame_data::ClearAnalysis(bool createLoadCases)
 {
 	for (std::size_t i = 0; i < results.size(); i++) {
-		delete results[i];
-        results[i] = 0;
+		if (itsFactored && results[i] && i < itsLoadCases.size()
+				&& itsLoadCases[i].first < 0 && i < itsSolvedLoads.size()) {
+			if (itsSolved.size() <= i)
+				itsSolved.resize(i + 1);
+			itsSolved[i] = std::move(results[i]);
+		}
+        results[i].reset();
 	}
+	
+	itsCombinationUse.clear();
+	itsCombinationBytes = 0;
 
 	if (createLoadCases) {
 		results.resize(itsLoadCases.size());
@@ -885,6 +1923,10 @@ frame_data::setupProperties()
 	itsElemLoads.IncReference();
 	itsProperties.IncReference();
 
+	itsNodes.SetVersion(&itsVersion);
+	itsElements.SetVersion(&itsVersion);
+	itsProperties.SetVersion(&itsVersion);
+	
 	// and listen for changed to the loads
 	itsNodes.AddListener(this);
 	itsElements.AddListener(this);
@@ -945,6 +1987,96 @@ frame_data::clear()
 	combos.clear();
 	
 	ClearAnalysis(0);
+	discardSolution();
+	itsStiffnessCache.reset();
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::discardSolution
+//
+//      forget the factored matrix and the load case results kept for the next
+//		analysis.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::discardSolution()
+{
+	itsSolved.clear();
+	itsSolvedLoads.clear();
+	itsFactor.resize(0);
+	itsMixedFactor.reset();
+	itsFileFactor.reset();
+	itsFactorNumbering.resize(0);
+	itsFactored = false;
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::getNumbering
+//
+//      return the equation numbers of every node in order.
+//
+//  std::valarray<DlInt32>& numbering  <- DOF_PER_NODE equations for each node.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+frame_data::getNumbering(std::valarray<DlInt32>& numbering) const
+{
+	DlInt32 count = itsNodes.Length();
+	numbering.resize(count * DOF_PER_NODE);
+	for (DlInt32 i = 0; i < count; i++) {
+		const NodeImp* n = itsNodes.ElementAt(i);
+		for (DlInt32 j = 0; j < DOF_PER_NODE; j++)
+			numbering[i * DOF_PER_NODE + j] = n->GetEquationNumber(j);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  frame_data::loadSignature
+//
+//      return a hash of everything load case lc applies to the structure: the
+//		node loads, which include settlements, and the fixed end forces of
+//		each element.
+//		Two analyses of the same structure give the same results for a load
+//		case whose signature did not change.
+//
+//  LoadCase lc        -> the load case.
+//
+//  returns DlUInt64   <- the signature.
+//----------------------------------------------------------------------------------------
+DlUInt64
+frame_data::loadSignature(LoadCase lc) const
+{
+	DlUInt64 sig = kSignatureSeed;
+	
+	DlInt32 count = itsNodes.Length();
+	for (DlInt32 i = 0; i < count; i++) {
+		const NodeLoadImp* ld = itsNodes.ElementAt(i)->GetLoad(lc);
+		if (ld) {
+			DlInt32 types[DOF_PER_NODE];
+			DlFloat64 values[DOF_PER_NODE];
+			for (DlInt32 j = 0; j < DOF_PER_NODE; j++) {
+				types[j] = ld->GetType(j);
+				values[j] = ld->GetValue(j);
+			}
+			sig = addSignature(sig, &i, sizeof(i));
+			sig = addSignature(sig, types, sizeof(types));
+			sig = addSignature(sig, values, sizeof(values));
+		}
+	}
+	
+	count = itsElements.Length();
+	for (DlInt32 i = 0; i < count; i++) {
+		const ElementImp* elem = itsElements.ElementAt(i);
+		DlFloat64 values[2*DOF_PER_NODE];
+		if (elem->FixedEndForces(values, lc)) {
+			sig = addSignature(sig, &i, sizeof(i));
+			sig = addSignature(sig, values, sizeof(values));
+		}
+	}
+	
+	return sig;
 }
 
 //----------------------------------------------------------------------------------------
@@ -956,12 +2088,14 @@ frame_data::clear()
 //
 //  returns nothing
 //----------------------------------------------------------------------------------------
-SolverProgress::SolverProgress(DlListener* listener) 
+SolverProgress::SolverProgress(DlListener* listener, AnalysisTelemetry* telemetry) 
+	: _telemetry(telemetry)
 {
 	_data.stage = AnalysisStageInit;
 	_data.reason = FailureReasonNoFailure;
 	_data.eqNum = 0;
 	_data.total = 0;
+	_data.residual = 0;
 	_data.cancel = false;
 	if (listener)
 		AddListener(listener);
@@ -1011,6 +2145,51 @@ SolverProgress::Processing(DlInt32 i, DlInt32 n)
 	return Broadcast();
 }
 
+//----------------------------------------------------------------------------------------
+//  SolverProgress::Iteration
+//
+//      call after each iteration of the iterative solver.
+//		return false to cancel analysis
+//
+//  DlInt32 i          -> the current iteration.
+//  DlInt32 maxIter    -> the iteration cap.
+//  DlFloat64 residual -> the relative residual.
+//
+//  returns bool       <- false to cancel analysis.
+//----------------------------------------------------------------------------------------
+bool
+SolverProgress::Iteration(DlInt32 i, DlInt32 maxIter, DlFloat64 residual) 
+{
+	_data.residual = residual;
+	return Processing(i, maxIter);
+}
+
+//----------------------------------------------------------------------------------------
+//  SolverProgress::Pivot
+//
+//      called with each pivot of the factor. A minPivotEquation of 0 means
+//		no pivot has been seen yet.
+//
+//  DlInt32 i          -> the equation.
+//  DlFloat64 pivot    -> its pivot.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+SolverProgress::Pivot(DlInt32 i, DlFloat64 pivot)
+{
+	if (!_telemetry)
+		return;
+	
+	bool first = _telemetry->minPivotEquation == 0;
+	if (first || fabs(pivot) < fabs(_telemetry->minPivot)) {
+		_telemetry->minPivot = pivot;
+		_telemetry->minPivotEquation = i;
+	}
+	if (first || fabs(pivot) > fabs(_telemetry->maxPivot))
+		_telemetry->maxPivot = pivot;
+}
+
 //----------------------------------------------------------------------------------------
 //  SolverProgress::Broadcast
 //
@@ -1025,5 +2204,106 @@ SolverProgress::Broadcast()
 	return !_data.cancel;
 }
 
+//----------------------------------------------------------------------------------------
+//  LoadCaseProgress::LoadCaseProgress                                        constructor
+//
+//      construct a progress counter for total load cases.
+//
+//  EqSolveProgress* progress  -> the progress object to report to.
+//  DlInt32 total              -> the number of load cases.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+LoadCaseProgress::LoadCaseProgress(EqSolveProgress* progress, DlInt32 total)
+	: _progress(progress)
+	, _done(0)
+	, _total(total)
+	, _cancelled(false)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseProgress::Check
+//
+//      throw if the analysis was cancelled.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+LoadCaseProgress::Check() const
+{
+	if (_cancelled)
+		throw EqSolveFailure(EqSolveFailure::UserCancelled, 0);
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadCaseProgress::Finished
+//
+//      count a finished load case and report it.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+LoadCaseProgress::Finished()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	
+	Check();
+	if (_progress && !_progress->Processing(++_done, _total)) {
+		_cancelled = true;
+		throw EqSolveFailure(EqSolveFailure::UserCancelled, _done);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  PhaseTimer::Lap
+//
+//      the time since the timer was made or last lapped.
+//
+//  returns the seconds of the phase
+//----------------------------------------------------------------------------------------
+DlFloat64
+PhaseTimer::Lap()
+{
+	Clock::time_point now = Clock::now();
+	DlFloat64 seconds = std::chrono::duration<DlFloat64>(now - _last).count();
+	_last = now;
+	return seconds;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsAccess::ResultsAccess                                              constructor
+//
+//      take the results for this thread, unless it already has them.
+//
+//  std::atomic<std::thread::id>& owner    <> the thread using the results.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultsAccess::ResultsAccess(std::atomic<std::thread::id>& owner)
+	: _owner(owner)
+	, _outer(false)
+{
+	std::thread::id self = std::this_thread::get_id();
+	std::thread::id none;
+	if (_owner.compare_exchange_strong(none, self))
+		_outer = true;
+	else if (none != self)
+		throw DlException("The results of a structure were read from two threads at once.");
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsAccess::~ResultsAccess                                              destructor
+//
+//      give the results up if this took them.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+ResultsAccess::~ResultsAccess()
+{
+	if (_outer)
+		_owner.store(std::thread::id());
+}
+
 
 //	eof
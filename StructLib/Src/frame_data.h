@@ -39,8 +39,16 @@
 #include "DlListener.h"
 #include "LoadCaseResults.h"
 #include "LoadCaseCombination.h"
+#include "FrameStructure.h"
 
-struct AnalysisData;
+#include <atomic>
+#include <memory>
+#include <thread>
+
+class StiffnessCache;
+class ColsolMixed;
+class SkylineFile;
+class ResultsFile;
 
 //---------------------------------- Class -------------------------------------
 
@@ -57,6 +65,13 @@ public:
 
 	void read(StrInputStream& s);
 	void write(StrOutputStream& s) const;
+	//	the binary file, see StrBinaryFormat.h
+	void readBinary(const void* image, DlUInt64 length);
+	void writeBinary(std::vector<DlUInt8>& image) const;
+	//	the results file, see ResultsFile.h. Only load cases are saved; the
+	//	combinations are built from them when asked for.
+	void readResults(const ResultsFile& file);
+	void writeResults(std::vector<DlUInt8>& image, bool compress) const;
 
 	void AddListener(DlListener* l);
 	void RemoveListener(DlListener* l);
@@ -83,6 +98,13 @@ public:
 	void InitAnalysis(AnalysisData* data);
 	void Analyze(DlListener* listener);
 
+	const AnalysisOptions&	GetAnalysisOptions() const		{ return itsAnalysisOptions; }
+	const AnalysisTimings&	GetAnalysisTimings() const		{ return itsTelemetry.timings; }
+	const AnalysisTelemetry&	GetAnalysisTelemetry() const	{ return itsTelemetry; }
+	//	bumped by edits to this structure's nodes, elements and properties
+	const StructureVersion&	GetStructureVersion() const		{ return itsVersion; }
+	void					SetAnalysisOptions(const AnalysisOptions& options);
+
 	DlInt32	NodeLoadToIndex(LoadCase lc, const NodeLoadImp * ld) const;
 	DlInt32 NodeToIndex(const NodeImp * nd) const;
 	DlInt32 ElemToIndex(const ElementImp * elem) const;
@@ -95,9 +117,16 @@ public:
 	ElemLoadImp*	IndexToElemLoad(LoadCase lc, DlInt32 index) const;
 	PropertyImp*	IndexToProp(DlInt32 index) const;
 
-	const LoadCaseResults*	GetResults(LoadCase lc) const;
+	//	the handle keeps a combination alive after a later call drops it.
+	//	Combinations are built and dropped by these const calls, so a
+	//	structure's results are read from one thread at a time.
+	std::shared_ptr<const LoadCaseResults>	GetResults(LoadCase lc) const;
 	DlInt32					CountResults() const;
 	
+	// build the results of every combination in one pass, as far as the
+	// combination memory allows.
+	void					CombineResults() const;
+	
 //
 // load cases
 //
@@ -153,8 +182,19 @@ private:
 	void updateElemLoadCombos(LoadCase lc, const std::vector<DlFloat32>& factors);
 	void updateLoadCombos(LoadCase lc, const std::vector<DlFloat32>& factors);
 	
+	std::shared_ptr<LoadCaseResults>	getCombination(LoadCase lc) const;
+	void				dropCombination(LoadCase lc) const;
+	void				scaleCombination(LoadCase lc, std::vector<bool>& pending) const;
+	
+	void		discardSolution();
+	void		getNumbering(std::valarray<DlInt32>& numbering) const;
+	DlUInt64	loadSignature(LoadCase lc) const;
+	
 //	LoadCaseResults* combineLoadCases(const LoadCaseCombination& which) const;
 
+	//	given to the items of the lists below
+	StructureVersion	itsVersion;
+	
 	NodeList		itsNodes;
 	ElementList		itsElements;
 	NodeLoadList	itsNodeLoads;
@@ -171,9 +211,42 @@ private:
 	DlString		itsActiveElementType;
 	PropertyImp*	itsActiveProperty;
 	
-	std::vector<LoadCaseResults*>	results;
+	//	combination results are left null until GetResults builds them.
+	mutable std::vector<std::shared_ptr<LoadCaseResults> >	results;
 	std::vector<LoadCaseCombination> combos;
 	
+	//	when each combination result was last asked for, and the size of
+	//	those built. Past itsAnalysisOptions.combinationMemory bytes the least
+	//	recently used are dropped, to be built again when next asked for.
+	mutable std::vector<DlUInt32>	itsCombinationUse;
+	mutable DlUInt32				itsUseCount;
+	mutable std::size_t				itsCombinationBytes;
+	//	the thread building or dropping combinations, if any
+	mutable std::atomic<std::thread::id>	itsResultsThread;
+	
+	AnalysisOptions	itsAnalysisOptions;
+	mutable AnalysisTelemetry	itsTelemetry;	//	CombineResults sets the combination time
+	
+	//	kept between analyses when itsAnalysisOptions.incremental is set
+	std::unique_ptr<StiffnessCache>	itsStiffnessCache;
+	
+	//	the factored skyline from the last analysis, the equation numbering it
+	//	was built with and itsVersion at the time. If neither has
+	//	changed, only the loads did and the factor can be used again.
+	std::valarray<DlFloat64>	itsFactor;
+	std::valarray<DlInt32>		itsFactorNumbering;
+	//	takes the place of itsFactor when itsAnalysisOptions.mixedPrecision is set
+	std::unique_ptr<ColsolMixed>	itsMixedFactor;
+	//	and when the skyline is larger than itsAnalysisOptions.solverMemory
+	std::unique_ptr<SkylineFile>	itsFileFactor;
+	DlUInt32					itsFactorVersion;
+	bool						itsFactored;
+	
+	//	results of the load cases moved aside by ClearAnalysis, and the
+	//	signature of the loads each load case was solved for.
+	std::vector<std::shared_ptr<LoadCaseResults> >	itsSolved;
+	std::vector<DlUInt64>			itsSolvedLoads;
+	
 	DlInt32 itsMajorVersion;
 	DlInt32 itsMinorVersion;
 	
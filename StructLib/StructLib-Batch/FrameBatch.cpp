@@ -0,0 +1,375 @@
+/*+
+ *	File:		FrameBatch.cpp
+ *
+ *	Contains:	Analyze frame documents from the command line
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	Reads each .frame document named on the command line, analyzes it and
+ *	writes the displacements and element forces of every load case to a
+ *	text file. Up to -jobs documents are analyzed at once. For example
+ *
+ *		FrameBatch -jobs 8 -output results *.frame
+ *
+ *	writes results/<name>.frame.txt for each model. A line is printed for
+ *	each document as it finishes, and the exit status is 1 if any failed.
+ *	Structures saved with FrameStructure::SaveBinary are read as well.
+ *
+ *	Documents are read and results written with stdio, but DlPlatform.h
+ *	still includes Carbon, so the tool builds only where the Mac headers,
+ *	or stand-ins for them, are found.
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "DlException.h"
+#include "DlParseArgs.h"
+#include "DlStrStream.h"
+#include "DlThreadPool.h"
+#include "FrameStructure.h"
+#include "LoadCaseResults.h"
+#include "Node.h"
+#include "StrBinaryFormat.h"
+#include "StrErrCode.h"
+#include "StrFileStream.h"
+#include "WorldRect.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//--------------------------------------- Statics ----------------------------------------
+
+static std::mutex sOutputLock;
+
+//----------------------------------------------------------------------------------------
+//  loadDocument                                                                   static
+//
+//      read a document saved by the Frame application. The window, view and
+//		grid settings in front of the structure are read and dropped.
+//
+//  StrInputStream& input  -> the document.
+//  FrameStructure& frame  <- the structure.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+static void
+loadDocument(StrInputStream& input, FrameStructure& frame)
+{
+	input.GetString();			//	window frame
+	LoadCase active = input.GetInt();
+	input.GetInt();				//	drawing flags
+	input.GetString();			//	element type
+
+	for (int i = 0; i < 4; i++)	//	screen rectangle
+		input.GetInt();
+	WorldRect world(input);
+
+	input.GetDouble();			//	grid spacing
+	input.GetDouble();
+	input.GetBool();			//	grid snap and visibility
+	input.GetBool();
+	input.GetInt();				//	units
+
+	frame.Load(input);
+	frame.SetActiveLoadCase(active);
+}
+
+//----------------------------------------------------------------------------------------
+//  readFile                                                                       static
+//
+//      read a whole file with stdio, so the tool needs none of the Mac file
+//		classes.
+//
+//  const char* path       -> the file.
+//
+//  returns std::string    <- its contents.
+//----------------------------------------------------------------------------------------
+static std::string
+readFile(const char* path)
+{
+	std::FILE* f = fopen(path, "rb");
+	if (!f)
+		throw DlException("Failed to open %s", path);
+	
+	std::string contents;
+	char buf[16384];
+	size_t len;
+	while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+		contents.append(buf, len);
+	
+	bool failed = ferror(f) != 0;
+	fclose(f);
+	if (failed)
+		throw DlException("Failed to read %s", path);
+	return contents;
+}
+
+//----------------------------------------------------------------------------------------
+//  isBinaryDocument                                                               static
+//
+//      return true if the file starts like a binary structure file.
+//
+//  const char* path       -> the document.
+//
+//  returns bool           <- true for a binary file.
+//----------------------------------------------------------------------------------------
+static bool
+isBinaryDocument(const char* path)
+{
+	char magic[sizeof(kStrBinaryMagic)];
+	std::FILE* f = fopen(path, "rb");
+	if (!f)
+		return false;
+	bool binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+		&& memcmp(magic, kStrBinaryMagic, sizeof(magic)) == 0;
+	fclose(f);
+	return binary;
+}
+
+//----------------------------------------------------------------------------------------
+//  writeResults                                                                   static
+//
+//      write the displacements and element end forces of each load case.
+//
+//  FrameStructure& frame  -> the analyzed structure.
+//  FILE* f                -> the output file.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+static void
+writeResults(FrameStructure& frame, std::FILE* f)
+{
+	DlInt32 nodes = frame.GetNodes().Length();
+	DlInt32 elems = frame.GetElements().Length();
+
+	for (DlUInt32 lc = 0; lc < frame.GetLoadCaseCount(); lc++) {
+		frame.SetActiveLoadCase(lc);
+		std::shared_ptr<const LoadCaseResults> res = frame.GetResults();
+		if (!res)
+			continue;
+
+		fprintf(f, "load case,%u,%s\n", lc, frame.GetLoadCaseName(lc));
+		fprintf(f, "node,x,y,theta\n");
+		for (DlInt32 n = 0; n < nodes; n++) {
+			DlFloat64 disp[DOF_PER_NODE];
+			res->GetDisplacement(frame.GetNode(n), disp);
+			fprintf(f, "%d,%.9g,%.9g,%.9g\n", n, disp[0], disp[1], disp[2]);
+		}
+
+		fprintf(f, "element,axial,shear,moment\n");
+		for (DlInt32 e = 0; e < elems; e++) {
+			const ElementForce& frc = res->GetElementForce(e);
+			fprintf(f, "%d,%.9g,%.9g,%.9g\n", e, frc[0], frc[1], frc[2]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  analyzeDocument                                                                static
+//
+//      load, analyze and write the results of one document.
+//
+//  const char* path           -> the document.
+//  const std::string& output  -> the results file.
+//  const AnalysisOptions& opt -> the solver options.
+//  AnalysisData& data         <- the size of the analysis.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+static void
+analyzeDocument(const char* path, const std::string& output, const AnalysisOptions& opt,
+				AnalysisData& data)
+{
+	FrameStructure frame("default");
+	if (isBinaryDocument(path)) {
+		frame.LoadBinary(path);
+	} else {
+		DlStrStream file(readFile(path));
+		StrFileInputStream input(file);
+		loadDocument(input, frame);
+	}
+
+	if (!frame.CanAnalyze())
+		throw DlException("Nothing to analyze");
+
+	AnalysisOptions options = frame.GetAnalysisOptions();
+	options.solver = opt.solver;
+	options.solverThreads = opt.solverThreads;
+	options.minimizeProfile = opt.minimizeProfile;
+	frame.SetAnalysisOptions(options);
+
+	frame.InitAnalysis(&data);
+	frame.Analyze(nullptr);
+	frame.CombineResults();
+
+	std::FILE* f = fopen(output.c_str(), "w");
+	if (!f)
+		throw DlException("Failed to open %s for writing", output.c_str());
+
+	writeResults(frame, f);
+	bool failed = ferror(f) != 0;
+	if (fclose(f) != 0 || failed)
+		throw DlException("Failed to write %s", output.c_str());
+}
+
+//----------------------------------------------------------------------------------------
+//  resultsPath                                                                    static
+//
+//      return the name of the results file for a document.
+//
+//  const char* path       -> the document.
+//  const char* dir        -> the output directory, or empty for the document's.
+//
+//  returns std::string    <- the results file.
+//----------------------------------------------------------------------------------------
+static std::string
+resultsPath(const char* path, const char* dir)
+{
+	std::string name(path);
+	if (*dir) {
+		std::string::size_type slash = name.find_last_of('/');
+		if (slash != std::string::npos)
+			name.erase(0, slash + 1);
+		name = std::string(dir) + "/" + name;
+	}
+	return name + ".txt";
+}
+
+//----------------------------------------------------------------------------------------
+//  main
+//
+//      analyze the documents.
+//
+//  int argc               -> the number of arguments.
+//  const char* argv[]     -> the arguments.
+//
+//  returns int            <- 0 if every document was analyzed.
+//----------------------------------------------------------------------------------------
+int
+main(int argc, const char* argv[])
+{
+	typedef std::chrono::steady_clock Clock;
+
+	DlInt32 jobs = 0;
+	DlInt32 threads = 1;
+	const char* solver = "skyline";
+	const char* output = "";
+	bool renumber = false;
+	bool help = false;
+
+	const DlUInt32 kOptionalInt = DlParseArgTypeInt | DlParseArgTypeOptional;
+	const DlUInt32 kOptionalString = DlParseArgTypeString | DlParseArgTypeOptional;
+
+	DlParseArgSpecifier spec[] = {
+		  { "-jobs",	kOptionalInt,		"documents to analyze at once, 0 for all cores", false, nullptr, { &jobs } }
+		, { "-threads",	kOptionalInt,		"solver threads for each document", false, nullptr, { &threads } }
+		, { "-solver",	kOptionalString,	"skyline, sparse or iterative", false, nullptr, { &solver } }
+		, { "-output",	kOptionalString,	"the directory for the results", false, nullptr, { &output } }
+		, { "-renumber", DlParseArgTypeBool,	"renumber to reduce the profile", false, nullptr, { &renumber } }
+		, { "-help",	DlParseArgTypeBool,	"print this message", false, nullptr, { &help } }
+	};
+	const int specCount = sizeof(spec) / sizeof(spec[0]);
+
+	int first;
+	try {
+		first = DlParseArgs(argc, argv, spec, specCount);
+	} catch (DlException& ex) {
+		DlParseArgsPrintUsage(argv[0], ex.what(), spec, specCount);
+		return 1;
+	}
+
+	if (help || first >= argc) {
+		DlParseArgsPrintUsage(argv[0], "Analyze frame documents: FrameBatch [options] file...",
+							  spec, specCount, help ? stdout : stderr);
+		return help ? 0 : 1;
+	}
+
+	AnalysisOptions options = AnalysisOptions();
+	options.solver = AnalysisSolverSkyline;
+	if (strcmp(solver, "sparse") == 0) {
+		options.solver = AnalysisSolverSparse;
+	} else if (strcmp(solver, "iterative") == 0) {
+		options.solver = AnalysisSolverIterative;
+	} else if (strcmp(solver, "skyline") != 0) {
+		fprintf(stderr, "unknown solver %s\n", solver);
+		return 1;
+	}
+	options.solverThreads = threads;
+	options.minimizeProfile = renumber;
+
+	const DlInt32 count = argc - first;
+	if (jobs <= 0)
+		jobs = DlThreadPool::DefaultThreadCount();
+	if (jobs > count)
+		jobs = count;
+
+	std::atomic<DlInt32> failures(0);
+
+	//	each document has its own structure, with its own stamp of the
+	//	changes, so the only shared state is the output and the debugging
+	//	ids, which are atomic.
+	DlThreadPool pool(jobs);
+	pool.ParallelFor(0, count, [&](DlInt32 i) {
+		const char* path = argv[first + i];
+		Clock::time_point start = Clock::now();
+
+		AnalysisData data = AnalysisData();
+		const char* error = nullptr;
+		std::string message;
+		try {
+			analyzeDocument(path, resultsPath(path, output), options, data);
+		} catch (DlException& ex) {
+			message = ex.what();
+			error = message.c_str();
+		} catch (StrErrCode err) {
+			//	the code is four characters, as the Frame application shows it
+			char code[5] = { char(err >> 24), char(err >> 16), char(err >> 8), char(err), 0 };
+			message = std::string("error (") + code + ")";
+			error = message.c_str();
+		} catch (std::exception& ex) {
+			message = ex.what();
+			error = message.c_str();
+		}
+
+		DlFloat64 wall = std::chrono::duration<DlFloat64>(Clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(sOutputLock);
+		if (error) {
+			failures++;
+			fprintf(stderr, "%s: %s\n", path, error);
+		} else {
+			printf("%s: %d nodes, %d elements, %d equations, %.3f s\n",
+				   path, data.nodeCount, data.elemCount, data.eqCount, wall);
+			fflush(stdout);
+		}
+	});
+
+	return failures > 0 ? 1 : 0;
+}
+
+//	eof
@@ -0,0 +1,237 @@
+/*+
+ *	File:		FrameBench.cpp
+ *
+ *	Contains:	Solver benchmarks on synthetic frames
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *	Builds one of the synthetic frames, analyzes it and writes a line of
+ *	JSON for each run, with the size of the problem, the seconds spent in
+ *	each phase of the analysis and the peak memory of the process. For
+ *	example
+ *
+ *		FrameBench -model tower -size 200 -cases 8 -threads 4 -repeat 3
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "DlException.h"
+#include "DlParseArgs.h"
+#include "FrameStructure.h"
+#include "FrameGenerators.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+//--------------------------------------- Statics ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  peakMemory                                                                     static
+//
+//      the most memory the process has used so far.
+//
+//  returns DlInt64    <- the peak resident size in kilobytes, or 0 if unknown.
+//----------------------------------------------------------------------------------------
+static DlInt64
+peakMemory()
+{
+#if defined(_WIN32)
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+//  buildModel                                                                     static
+//
+//      build the named model. The frames are size bays by size stories, the
+//		tower is 4 bays by size stories, the truss has size panels and the
+//		random graph is size by size nodes.
+//
+//  FrameStructure& frame  -> the empty frame.
+//  const char* model      -> frame, tower, truss or random.
+//  DlInt32 size           -> the size of the model.
+//  DlInt32 cases          -> the number of load cases.
+//  DlInt32 combinations   -> the number of load combinations.
+//  DlUInt32 seed          -> the seed of the random values.
+//
+//  returns bool           <- false if the model is unknown.
+//----------------------------------------------------------------------------------------
+static bool
+buildModel(FrameStructure& frame, const char* model, DlInt32 size, DlInt32 cases,
+		   DlInt32 combinations, DlUInt32 seed)
+{
+	FrameGenerator gen(frame, seed);
+
+	if (strcmp(model, "frame") == 0)
+		gen.MultistoryFrame(size, size);
+	else if (strcmp(model, "tower") == 0)
+		gen.BracedTower(4, size);
+	else if (strcmp(model, "truss") == 0)
+		gen.LongSpanTruss(size);
+	else if (strcmp(model, "random") == 0)
+		gen.RandomGraph(size, size);
+	else
+		return false;
+
+	gen.AddLoadCases(cases, combinations);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+//  main
+//
+//      run the benchmark.
+//
+//  int argc               -> the number of arguments.
+//  const char* argv[]     -> the arguments.
+//
+//  returns int            <- 0 on success.
+//----------------------------------------------------------------------------------------
+int
+main(int argc, const char* argv[])
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const char* model = "frame";
+	const char* solver = "skyline";
+	DlInt32 size = 20;
+	DlInt32 cases = 1;
+	DlInt32 combinations = 0;
+	DlInt32 threads = 1;
+	DlInt32 memory = 0;
+	DlInt32 repeat = 1;
+	DlInt32 seed = 1;
+	bool renumber = false;
+	bool mixed = false;
+	bool help = false;
+
+	const DlUInt32 kOptionalInt = DlParseArgTypeInt | DlParseArgTypeOptional;
+	const DlUInt32 kOptionalString = DlParseArgTypeString | DlParseArgTypeOptional;
+
+	DlParseArgSpecifier spec[] = {
+		  { "-model",	kOptionalString,	"frame, tower, truss or random", false, nullptr, { &model } }
+		, { "-size",	kOptionalInt,		"stories, panels or nodes on a side", false, nullptr, { &size } }
+		, { "-cases",	kOptionalInt,		"the number of load cases", false, nullptr, { &cases } }
+		, { "-combinations", kOptionalInt,	"the number of load combinations", false, nullptr, { &combinations } }
+		, { "-threads",	kOptionalInt,		"solver threads, 0 for all cores", false, nullptr, { &threads } }
+		, { "-solver",	kOptionalString,	"skyline, sparse or iterative", false, nullptr, { &solver } }
+		, { "-mixed",	DlParseArgTypeBool,	"factor the skyline in single precision", false, nullptr, { &mixed } }
+		, { "-memory",	kOptionalInt,		"megabytes of skyline to keep in memory, 0 for all", false, nullptr, { &memory } }
+		, { "-renumber", DlParseArgTypeBool,	"renumber to reduce the profile", false, nullptr, { &renumber } }
+		, { "-repeat",	kOptionalInt,		"the number of runs", false, nullptr, { &repeat } }
+		, { "-seed",	kOptionalInt,		"the seed of the random values", false, nullptr, { &seed } }
+		, { "-help",	DlParseArgTypeBool,	"print this message", false, nullptr, { &help } }
+	};
+	const int specCount = sizeof(spec) / sizeof(spec[0]);
+
+	try {
+		DlParseArgs(argc, argv, spec, specCount);
+	} catch (DlException& ex) {
+		DlParseArgsPrintUsage(argv[0], ex.what(), spec, specCount);
+		return 1;
+	}
+
+	if (help) {
+		DlParseArgsPrintUsage(argv[0], "Analyze a synthetic frame and report the time of each phase.",
+							  spec, specCount, stdout);
+		return 0;
+	}
+
+	AnalysisSolver which = AnalysisSolverSkyline;
+	if (strcmp(solver, "sparse") == 0) {
+		which = AnalysisSolverSparse;
+	} else if (strcmp(solver, "iterative") == 0) {
+		which = AnalysisSolverIterative;
+	} else if (strcmp(solver, "skyline") != 0) {
+		fprintf(stderr, "unknown solver %s\n", solver);
+		return 1;
+	}
+
+	try {
+		for (DlInt32 run = 0; run < repeat; run++) {
+			//	a new frame each run, so nothing is kept from the last analysis.
+			FrameStructure frame("default");
+			if (!buildModel(frame, model, size, cases, combinations, seed)) {
+				fprintf(stderr, "unknown model %s\n", model);
+				return 1;
+			}
+
+			AnalysisOptions options = frame.GetAnalysisOptions();
+			options.solver = which;
+			options.minimizeProfile = renumber;
+			options.solverThreads = threads;
+			options.mixedPrecision = mixed;
+			options.solverMemory = static_cast<DlInt64>(memory) << 20;
+			frame.SetAnalysisOptions(options);
+
+			Clock::time_point start = Clock::now();
+
+			AnalysisData data;
+			frame.InitAnalysis(&data);
+			frame.Analyze(nullptr);
+			frame.CombineResults();
+
+			DlFloat64 wall = std::chrono::duration<DlFloat64>(Clock::now() - start).count();
+			const AnalysisTelemetry& tel = frame.GetAnalysisTelemetry();
+			const AnalysisTimings& t = tel.timings;
+
+			printf("{\"model\":\"%s\",\"size\":%d,\"run\":%d,\"solver\":\"%s\",\"mixed\":%s,"
+				   "\"threads\":%d,\"renumber\":%s,\"nodes\":%d,\"elements\":%d,\"dof\":%d,"
+				   "\"cases\":%d,\"combinations\":%d,\"initial_profile\":%d,\"profile\":%d,"
+				   "\"skyline_bytes\":%lld,\"numbering\":%.6f,\"starts\":%.6f,\"assembly\":%.6f,"
+				   "\"factor\":%.6f,\"solve\":%.6f,\"recovery\":%.6f,\"combination\":%.6f,"
+				   "\"factor_flops\":%.0f,\"solve_flops\":%.0f,\"matrix_bytes\":%lld,"
+				   "\"min_pivot\":%g,\"max_pivot\":%g,\"wall\":%.6f,\"peak_rss_kb\":%lld}\n",
+				   model, size, run, solver, mixed ? "true" : "false",
+				   threads, renumber ? "true" : "false", data.nodeCount, data.elemCount, data.eqCount,
+				   cases, combinations, data.initialProfile, data.profile,
+				   static_cast<long long>(data.profile) * sizeof(DlFloat64),
+				   t.numbering, t.starts, t.assembly, t.factor, t.solve, t.recovery, t.combination,
+				   tel.factorFlops, tel.solveFlops, static_cast<long long>(tel.peakMatrixBytes),
+				   tel.minPivot, tel.maxPivot,
+				   wall, static_cast<long long>(peakMemory()));
+			fflush(stdout);
+		}
+	} catch (DlException& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		return 1;
+	}
+
+	return 0;
+}
+
+//	eof
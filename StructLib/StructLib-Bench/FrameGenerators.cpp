@@ -0,0 +1,424 @@
+/*+
+ *	File:		FrameGenerators.cpp
+ *
+ *	Contains:	Synthetic frames for the solver benchmarks
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+//--------------------------------------- Includes ---------------------------------------
+
+#include "DlPlatform.h"
+#include "FrameGenerators.h"
+#include "Action.h"
+#include "Element.h"
+#include "LoadCaseCombination.h"
+#include "NodeLoad.h"
+#include "WorldPoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+typedef std::unique_ptr<Action> ActPtr;
+
+const DlFloat64 kBayWidth = 6.0;
+const DlFloat64 kStoryHeight = 3.5;
+
+//--------------------------------------- Methods ----------------------------------------
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::FrameGenerator                                             constructor
+//
+//      construct a generator adding to frame.
+//
+//  FrameStructure& frame  -> the frame to build, usually empty.
+//  DlUInt32 seed          -> the seed of the random models and loads.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+FrameGenerator::FrameGenerator(FrameStructure& frame, DlUInt32 seed)
+	: itsFrame(frame)
+	, itsRandom(seed)
+{
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::MultistoryFrame
+//
+//      build a moment frame.
+//
+//  DlInt32 bays       -> the number of bays.
+//  DlInt32 stories    -> the number of stories.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::MultistoryFrame(DlInt32 bays, DlInt32 stories)
+{
+	frame(bays, stories, false);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::BracedTower
+//
+//      build a moment frame with X braces.
+//
+//  DlInt32 bays       -> the number of bays.
+//  DlInt32 stories    -> the number of stories.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::BracedTower(DlInt32 bays, DlInt32 stories)
+{
+	frame(bays, stories, true);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::LongSpanTruss
+//
+//      build a simply supported Pratt truss. The chords are continuous and
+//		the verticals and diagonals are pinned at both ends.
+//
+//  DlInt32 panels     -> the number of panels.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::LongSpanTruss(DlInt32 panels)
+{
+	const DlFloat64 depth = kStoryHeight * (1 + panels / 16);
+	DlInt32 bottom = itsNodes.size();
+
+	for (DlInt32 i = 0; i <= panels; i++)
+		addNode(i * kBayWidth, 0);
+
+	DlInt32 top = itsNodes.size();
+	for (DlInt32 i = 0; i <= panels; i++)
+		addNode(i * kBayWidth, depth);
+
+	for (DlInt32 i = 0; i < panels; i++) {
+		addElement(bottom + i, bottom + i + 1);
+		addElement(top + i, top + i + 1);
+	}
+
+	for (DlInt32 i = 0; i <= panels; i++)
+		addElement(bottom + i, top + i, true);
+
+	//	the diagonals slope down toward mid span.
+	for (DlInt32 i = 0; i < panels; i++) {
+		if (2 * i < panels)
+			addElement(top + i, bottom + i + 1, true);
+		else
+			addElement(bottom + i, top + i + 1, true);
+	}
+
+	restrain(bottom, Node::FixX | Node::FixY);
+	restrain(bottom + panels, Node::FixY);
+
+	for (DlInt32 i = 1; i < panels; i++)
+		addJointLoad(bottom + i, 0, -1, 0);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::RandomGraph
+//
+//      build a frame whose connections and numbering are random. Every node
+//		is joined to the one to its left or the one below it, which makes a
+//		spanning tree, so the frame is connected.
+//
+//  DlInt32 columns    -> the number of nodes across.
+//  DlInt32 rows       -> the number of nodes up, with the first row fixed.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::RandomGraph(DlInt32 columns, DlInt32 rows)
+{
+	DlInt32 count = columns * rows;
+
+	std::vector<DlInt32> order(count);
+	for (DlInt32 g = 0; g < count; g++)
+		order[g] = g;
+	for (DlInt32 g = count - 1; g > 0; g--)
+		std::swap(order[g], order[itsRandom() % (g + 1)]);
+
+	std::vector<DlInt32> node(count);
+	for (DlInt32 k = 0; k < count; k++) {
+		DlInt32 g = order[k];
+		DlFloat64 x = (g % columns) + 0.5 * (uniform() - 0.5);
+		DlFloat64 y = (g / columns) + 0.5 * (uniform() - 0.5);
+		node[g] = addNode(x * kBayWidth, y * kStoryHeight);
+	}
+
+	std::vector<DlInt32> parent(count, -1);
+	for (DlInt32 g = 1; g < count; g++) {
+		DlInt32 i = g % columns;
+		DlInt32 j = g / columns;
+		if (i > 0 && (j == 0 || itsRandom() % 2))
+			parent[g] = g - 1;
+		else
+			parent[g] = g - columns;
+	}
+
+	for (DlInt32 g = 0; g < count; g++) {
+		DlInt32 i = g % columns;
+		DlInt32 j = g / columns;
+
+		if (i + 1 < columns && (parent[g + 1] == g || uniform() < 0.4))
+			addElement(node[g], node[g + 1]);
+		if (j + 1 < rows && (parent[g + columns] == g || uniform() < 0.4))
+			addElement(node[g], node[g + columns]);
+		if (i + 1 < columns && j + 1 < rows && uniform() < 0.3) {
+			if (itsRandom() % 2)
+				addElement(node[g], node[g + columns + 1]);
+			else
+				addElement(node[g + 1], node[g + columns]);
+		}
+	}
+
+	for (DlInt32 i = 0; i < columns; i++)
+		restrain(node[i], Node::FixX | Node::FixY | Node::FixTheta);
+
+	for (DlInt32 i = 0; i < columns; i++)
+		addJointLoad(node[(rows - 1) * columns + i], 1, -1, 0);
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::AddLoadCases
+//
+//      add load cases and combinations. Each new case puts a random load on
+//		four random free nodes, and each combination is a random factor of
+//		every case.
+//
+//  DlInt32 cases          -> the number of load cases wanted.
+//  DlInt32 combinations   -> the number of combinations to add.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::AddLoadCases(DlInt32 cases, DlInt32 combinations)
+{
+	std::vector<DlInt32> free;
+	for (DlInt32 n = 0; n < static_cast<DlInt32>(itsNodes.size()); n++) {
+		if (!itsRestrained[n])
+			free.push_back(n);
+	}
+
+	if (free.empty())
+		return;
+
+	char name[64];
+	for (DlInt32 lc = itsFrame.GetLoadCaseCount(); lc < cases; lc++) {
+		snprintf(name, sizeof(name), "case %d", lc);
+		ActPtr(itsFrame.CreateLoadCase(name))->Perform();
+
+		for (DlInt32 k = 0; k < 4; k++) {
+			DlInt32 n = free[itsRandom() % free.size()];
+			addJointLoad(n, uniform() - 0.5, -uniform(), lc);
+		}
+	}
+
+	DlInt32 basis = itsFrame.GetLoadCaseCount();
+	for (DlInt32 c = 0; c < combinations; c++) {
+		std::vector<DlFloat32> factors(basis);
+		for (DlInt32 lc = 0; lc < basis; lc++)
+			factors[lc] = 0.5 + uniform();
+
+		snprintf(name, sizeof(name), "combination %d", c);
+		ActPtr(itsFrame.AddLoadCaseCombination(name,
+				LoadCaseCombination(std::move(factors))))->Perform();
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::frame                                                          private
+//
+//      build a moment frame, with X braces if asked for. The nodes go floor
+//		by floor, left to right.
+//
+//  DlInt32 bays       -> the number of bays.
+//  DlInt32 stories    -> the number of stories.
+//  bool braced        -> true to brace every panel.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::frame(DlInt32 bays, DlInt32 stories, bool braced)
+{
+	DlInt32 first = itsNodes.size();
+	DlInt32 width = bays + 1;
+
+	for (DlInt32 j = 0; j <= stories; j++)
+		for (DlInt32 i = 0; i <= bays; i++)
+			addNode(i * kBayWidth, j * kStoryHeight);
+
+	for (DlInt32 j = 0; j < stories; j++) {
+		DlInt32 floor = first + j * width;
+		DlInt32 above = floor + width;
+
+		for (DlInt32 i = 0; i <= bays; i++)
+			addElement(floor + i, above + i);
+
+		for (DlInt32 i = 0; i < bays; i++) {
+			addElement(above + i, above + i + 1);
+			if (braced) {
+				addElement(floor + i, above + i + 1, true);
+				addElement(floor + i + 1, above + i, true);
+			}
+		}
+	}
+
+	for (DlInt32 i = 0; i <= bays; i++)
+		restrain(first + i, Node::FixX | Node::FixY | Node::FixTheta);
+
+	//	gravity at every floor node, and a lateral load on the left side.
+	for (DlInt32 j = 1; j <= stories; j++) {
+		for (DlInt32 i = 0; i <= bays; i++)
+			addJointLoad(first + j * width + i, i == 0 ? 1 : 0, -1, 0);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::addNode                                                        private
+//
+//      add a node to the frame.
+//
+//  DlFloat64 x        ->
+//  DlFloat64 y        ->
+//
+//  returns DlInt32    <- the index of the node.
+//----------------------------------------------------------------------------------------
+DlInt32
+FrameGenerator::addNode(DlFloat64 x, DlFloat64 y)
+{
+	Node n;
+	WorldPoint pt {x, y};
+
+	ActPtr(itsFrame.AddNode(pt, n))->Perform();
+	itsNodes.push_back(n);
+	itsRestrained.push_back(false);
+
+	return itsNodes.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::addElement                                                     private
+//
+//      add an element to the frame.
+//
+//  DlInt32 node1      -> node 1
+//  DlInt32 node2      -> node 2
+//  bool pinnedEnds    -> true to pin both ends.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::addElement(DlInt32 node1, DlInt32 node2, bool pinnedEnds)
+{
+	Element elem(0);
+	ActPtr(itsFrame.AddElement(itsNodes[node1], itsNodes[node2],
+				itsFrame.GetActiveElementType(), elem))->Perform();
+	
+	if (pinnedEnds)
+		ActPtr(itsFrame.AssignProperties({elem}, pinned()))->Perform();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::restrain                                                       private
+//
+//      restrain a node.
+//
+//  DlInt32 node       -> the node
+//  DlUInt32 restCode  -> the restraint.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::restrain(DlInt32 node, DlUInt32 restCode)
+{
+	ActPtr(itsFrame.SetRestraints({itsNodes[node]}, restCode))->Perform();
+	itsRestrained[node] = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::addJointLoad                                                   private
+//
+//      create a joint load and assign it to a node.
+//
+//  DlInt32 node       -> the node.
+//  DlFloat32 fx       -> the x load.
+//  DlFloat32 fy       -> the y load.
+//  LoadCase lc        -> the load case.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+FrameGenerator::addJointLoad(DlInt32 node, DlFloat32 fx, DlFloat32 fy, LoadCase lc)
+{
+	NodeLoad load(0);
+	ActPtr(itsFrame.CreateNodeLoad(load))->Perform();
+
+	load.SetValue(0, fx);
+	load.SetValue(1, fy);
+
+	itsFrame.SetActiveLoadCase(lc);
+	ActPtr(itsFrame.AssignNodeLoads({itsNodes[node]}, load))->Perform();
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::pinned                                                         private
+//
+//      the property of braces and truss web members, made the first time it
+//		is needed.
+//
+//  returns Property   <- a property pinned at both ends.
+//----------------------------------------------------------------------------------------
+Property
+FrameGenerator::pinned()
+{
+	if (itsPinned.Empty()) {
+		ActPtr(itsFrame.CreateProperty("pinned", itsPinned))->Perform();
+		ActPtr(itsFrame.ChangeProperty(itsPinned, kPropertyStartPinned, "true"))->Perform();
+		ActPtr(itsFrame.ChangeProperty(itsPinned, kPropertyEndPinned, "true"))->Perform();
+	}
+	
+	return itsPinned;
+}
+
+//----------------------------------------------------------------------------------------
+//  FrameGenerator::uniform                                                        private
+//
+//      a random value in [0, 1). This is taken straight from the generator,
+//		as the standard distributions differ from one library to another.
+//
+//  returns DlFloat64  <- the value.
+//----------------------------------------------------------------------------------------
+DlFloat64
+FrameGenerator::uniform()
+{
+	return itsRandom() / 4294967296.0;
+}
+
+//	eof
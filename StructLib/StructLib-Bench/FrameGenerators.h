@@ -0,0 +1,88 @@
+/*+
+ *	File:		FrameGenerators.h
+ *
+ *	Contains:	Synthetic frames for the solver benchmarks
+ *
+ *	Written by:	David C. Salmon
+ *
+ *	Copyright:	COPYRIGHT (C) 2026 By David C. Salmon.  *WORLDWIDE RIGHTS RESERVED*
+ *
+ *
+ *	To Do:
+-*/
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _H_FrameGenerators
+#define _H_FrameGenerators
+
+//---------------------------------- Includes ----------------------------------
+
+#include "FrameStructure.h"
+#include "Node.h"
+#include "Property.h"
+
+#include <random>
+#include <vector>
+
+//---------------------------------- Class -------------------------------------
+
+//	Builds frames of a given size through the FrameStructure actions, as a user
+//	would. Each model puts its loads in load case 0; AddLoadCases adds more
+//	cases and combinations. The same seed always builds the same frame.
+class FrameGenerator
+{
+public:
+	FrameGenerator(FrameStructure& frame, DlUInt32 seed = 1);
+
+	//	a moment frame of bays by stories, fixed at the base, with lateral
+	//	loads at each floor.
+	void	MultistoryFrame(DlInt32 bays, DlInt32 stories);
+
+	//	a moment frame with pin ended X braces in every panel.
+	void	BracedTower(DlInt32 bays, DlInt32 stories);
+
+	//	a Pratt truss of panels, simply supported, with both chords created
+	//	one after the other so the first numbering has a wide profile.
+	void	LongSpanTruss(DlInt32 panels);
+
+	//	columns by rows of jittered nodes, created in random order and joined
+	//	by a random spanning tree and some of the remaining neighbors.
+	void	RandomGraph(DlInt32 columns, DlInt32 rows);
+
+	//	add load cases up to cases, each loading a few random free nodes, and
+	//	combinations of them.
+	void	AddLoadCases(DlInt32 cases, DlInt32 combinations);
+
+private:
+	DlInt32		addNode(DlFloat64 x, DlFloat64 y);
+	void		addElement(DlInt32 node1, DlInt32 node2, bool pinnedEnds = false);
+	void		restrain(DlInt32 node, DlUInt32 restCode);
+	void		addJointLoad(DlInt32 node, DlFloat32 fx, DlFloat32 fy, LoadCase lc);
+	void		frame(DlInt32 bays, DlInt32 stories, bool braced);
+	DlFloat64	uniform();
+	Property	pinned();
+
+	FrameStructure&		itsFrame;
+	std::vector<Node>	itsNodes;
+	std::vector<bool>	itsRestrained;
+	std::mt19937		itsRandom;
+	Property			itsPinned;		//	for braces and web members
+};
+
+#endif
+
+//	eof
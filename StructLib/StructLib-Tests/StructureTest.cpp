@@ -28,6 +28,7 @@
 #include "FrameStructure.h"
 #include "Node.h"
 #include "Element.h"
+#include "Property.h"
 #include "WorldPoint.h"
 #include "NodeEnumerator.h"
 #include "ElementEnumerator.h"
@@ -35,6 +36,15 @@
 #include "ElementLoad.h"
 #include "LoadCaseResults.h"
 #include "NodeLoad.h"
+#include "ResultEnvelope.h"
+#include "ResultsFile.h"
+#include "StrFileStream.h"
+#include "DlStrStream.h"
+#include "DlThreadPool.h"
+#include "NodeList.h"
+#include "NodeImp.h"
+
+#include <random>
 
 #include "StructureTest.h"
 
@@ -271,6 +281,80 @@ StructLibTest::addJointLoad(DlInt32 nodeIndex, DlFloat xLoad, DlFloat yLoad, DlF
 	action->Perform();
 }
 
+//----------------------------------------------------------------------------------------
+//  StructLibTest::buildGrid
+//
+//      build a grid frame of size by size nodes, fixed along the bottom, with
+//		a joint load at the top corner.
+//
+//  int size   -> the number of nodes on a side.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StructLibTest::buildGrid(int size)
+{
+	for (auto j = 0; j < size; j++)
+		for (auto i = 0; i < size; i++)
+			addNode(i, j);
+	
+	for (auto j = 0; j < size; j++) {
+		for (auto i = 0; i < size; i++) {
+			if (i + 1 < size)
+				addElement(j * size + i, j * size + i + 1);
+			if (j + 1 < size)
+				addElement(j * size + i, (j + 1) * size + i);
+		}
+	}
+	
+	for (auto i = 0; i < size; i++)
+		addRestraint(i, Node::FixX | Node::FixY | Node::FixTheta);
+	
+	addJointLoad(size * size - 1, 1, -1, 0);
+}
+
+//----------------------------------------------------------------------------------------
+//  StructLibTest::analyze
+//
+//      analyze the frame with the given options.
+//
+//  const AnalysisOptions& options -> the options.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StructLibTest::analyze(const AnalysisOptions& options)
+{
+	frame->SetAnalysisOptions(options);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	ASSERT_NO_THROW(frame->Analyze(0));
+}
+
+//----------------------------------------------------------------------------------------
+//  StructLibTest::getDisplacements
+//
+//      get the displacements of every node for load case 0.
+//
+//  std::vector<DlFloat64>& disps  <- the displacements.
+//
+//  returns nothing
+//----------------------------------------------------------------------------------------
+void
+StructLibTest::getDisplacements(std::vector<DlFloat64>& disps) const
+{
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	disps.clear();
+	for (auto n = 0; n < frame->GetNodes().Length(); n++) {
+		DlFloat64 disp[DOF_PER_NODE];
+		res->GetDisplacement(frame->GetNode(n), disp);
+		disps.insert(disps.end(), disp, disp + DOF_PER_NODE);
+	}
+}
+
 //----------------------------------------------------------------------------------------
 //  printDisplacement                                                              static
 //
@@ -530,9 +614,9 @@ TEST_F(StructLibTest, BuildComplex)
 	ASSERT_NO_THROW(frame->Analyze(0));
 	
 	frame->SetActiveLoadCase(0);
-	const LoadCaseResults* res = frame->GetResults();
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
 
-	frame->DoForEachNode(printDisplacement, (void*)res);
+	frame->DoForEachNode(printDisplacement, (void*)res.get());
 
 //	operator new (256);
 	
@@ -647,7 +731,7 @@ TEST_F(StructLibTest,SBAnalyze)
 	
 	const Element& elem = frame->GetElement(0);
 	frame->SetActiveLoadCase(0);
-	const LoadCaseResults* res = frame->GetResults();
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
 	
 	const ElementForce& frc = res->GetElementForce(0);
 	
@@ -667,6 +751,1358 @@ TEST_F(StructLibTest,SBAnalyze)
 }
 
 
+//----------------------------------------------------------------------------------------
+//  SpatialSelection
+//
+//      hit test nodes and elements of a grid frame through its spatial index,
+//		checking the index follows nodes as they are moved and removed.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, SpatialSelection)
+{
+	const int size = 10;
+	buildGrid(size);
+	
+	EXPECT_EQ((NodeImp*)frame->FindNode(WorldPoint(3, 4)), (NodeImp*)frame->GetNode(4 * size + 3));
+	EXPECT_TRUE(frame->FindNode(WorldPoint(3.5, 4)).Empty());
+	EXPECT_EQ((NodeImp*)frame->SelectOneNode(WorldRect(WorldPoint(7, 2), 0.1)),
+			  (NodeImp*)frame->GetNode(2 * size + 7));
+	
+	//	the same elements, in the same order, as testing each one
+	WorldRect r(1.5, 1.5, 3.5, 2.5);
+	ElementEnumerator all = frame->GetElements();
+	std::vector<ElementImp*> expected;
+	for (DlInt32 i = 0; i < all.Length(); i++) {
+		Element e = all.At(i);
+		WorldPoint p1 = e.StartNode().GetCoords();
+		WorldPoint p2 = e.EndNode().GetCoords();
+		if ((r.contains(p1) && r.contains(p2)) || r.intersects(p1, p2))
+			expected.push_back(e);
+	}
+	ElementEnumerator hit = frame->SelectElements(r);
+	ASSERT_EQ(hit.Length(), DlInt32(expected.size()));
+	for (DlInt32 i = 0; i < hit.Length(); i++)
+		EXPECT_EQ((ElementImp*)hit.At(i), expected[i]);
+	
+	NodeEnumerator nodes = frame->SelectNodes(r);
+	ASSERT_EQ(nodes.Length(), 2);
+	EXPECT_EQ((NodeImp*)nodes.At(0), (NodeImp*)frame->GetNode(2 * size + 2));
+	EXPECT_EQ((NodeImp*)nodes.At(1), (NodeImp*)frame->GetNode(2 * size + 3));
+	
+	DlFloat64 loc = 0;
+	Element beam = frame->SelectOneElement(WorldRect(WorldPoint(2.25, 3), 0.1), loc);
+	ASSERT_FALSE(beam.Empty());
+	EXPECT_TRUE(beam.StartNode().GetCoords() == WorldPoint(2, 3));
+	EXPECT_TRUE(beam.EndNode().GetCoords() == WorldPoint(3, 3));
+	EXPECT_NEAR(loc, 0.25, 1.0e-12);
+	
+	//	the node is dragged, then the move is made an action
+	Node moving = frame->GetNode(5 * size + 5);
+	moving.SetCoords(WorldPoint(5.5, 5.5));
+	ActPtr move(frame->MoveNodes({moving}, WorldPoint(0.5, 0.5)));
+	move->Perform();
+	EXPECT_EQ((NodeImp*)frame->FindNode(WorldPoint(5.5, 5.5)), (NodeImp*)moving);
+	EXPECT_TRUE(frame->FindNode(WorldPoint(5, 5)).Empty());
+	beam = frame->SelectOneElement(WorldRect(WorldPoint(5.25, 4.75), 0.1), loc);
+	ASSERT_FALSE(beam.Empty());
+	EXPECT_EQ((NodeImp*)beam.EndNode(), (NodeImp*)moving);
+	
+	move->Perform();		//	undo
+	EXPECT_EQ((NodeImp*)frame->FindNode(WorldPoint(5, 5)), (NodeImp*)moving);
+	EXPECT_TRUE(frame->SelectOneElement(WorldRect(WorldPoint(5.25, 4.75), 0.1), loc).Empty());
+	
+	removeNode(5 * size + 5);
+	EXPECT_TRUE(frame->FindNode(WorldPoint(5, 5)).Empty());
+	EXPECT_TRUE(frame->SelectOneElement(WorldRect(WorldPoint(5, 5.5), 0.1), loc).Empty());
+	
+	addNode(5, 5);
+	EXPECT_FALSE(frame->FindNode(WorldPoint(5, 5)).Empty());
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  StitchDuplicates
+//
+//      add nodes just off the grid and check the duplicates found and stitched
+//		are the ones within the tolerance.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, StitchDuplicates)
+{
+	const int size = 10;
+	const DlFloat64 tol = 1.0e-3;
+	buildGrid(size);
+	
+	const DlInt32 dup = size * size;
+	addNode(3.0004, 4);
+	addNode(7, 2.002);
+	addElement(dup, 0);
+	const DlInt32 nodeCount = frame->GetNodes().Length();
+	Node original = frame->GetNode(4 * size + 3);
+	Node dupNode = frame->GetNode(dup);
+	Element attached = frame->GetElements().At(frame->GetElements().Length() - 1);
+	
+	EXPECT_TRUE(frame->DuplicateNodes({dupNode}, tol));
+	EXPECT_FALSE(frame->DuplicateNodes({frame->GetNode(dup + 1)}, tol));
+	
+	//	the later node is stitched to the earlier one, and its element follows
+	ActPtr stitch(frame->StitchNodes(frame->GetNodes(), tol, true));
+	stitch->Perform();
+	EXPECT_EQ(frame->GetNodes().Length(), nodeCount - 1);
+	EXPECT_EQ((NodeImp*)attached.StartNode(), (NodeImp*)original);
+	EXPECT_FALSE(frame->DuplicateNodes(frame->GetNodes(), tol));
+	
+	stitch->Perform();		//	undo
+	EXPECT_EQ(frame->GetNodes().Length(), nodeCount);
+	EXPECT_EQ((NodeImp*)attached.StartNode(), (NodeImp*)dupNode);
+	
+	//	only the given node is checked against the rest
+	stitch.reset(frame->StitchNodes({dupNode}, tol));
+	stitch->Perform();
+	EXPECT_EQ(frame->GetNodes().Length(), nodeCount - 1);
+	EXPECT_EQ((NodeImp*)attached.StartNode(), (NodeImp*)original);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  StitchMapChunks
+//
+//      stitch a few thousand jittered nodes, enough for several chunks, with the
+//		threads and check the map against comparing every pair of nodes.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, StitchMapChunks)
+{
+	const int size = 40;
+	const DlFloat64 tol = 1.0e-2;
+	std::mt19937 gen(12345);
+	std::uniform_real_distribution<DlFloat64> jitter(-tol, tol);
+	
+	//	three nodes around each grid point, some within tol of each other
+	NodeList nodes;
+	for (int i = 0; i < size; i++) {
+		for (int j = 0; j < size; j++) {
+			for (int k = 0; k < 3; k++)
+				nodes.Add(NEW NodeImp(WorldPoint(i + jitter(gen), j + jitter(gen))));
+		}
+	}
+	ASSERT_GT(nodes.Length(), 2 * 1024);
+	
+	NodeCloneMap expected;
+	for (DlInt32 j = 0; j < nodes.Length(); j++) {
+		const WorldPoint& c = nodes.ElementAt(j)->GetCoords();
+		for (DlInt32 i = j - 1; i >= 0; i--) {
+			const WorldPoint& nc = nodes.ElementAt(i)->GetCoords();
+			if (nc.manhattan(c) < tol * 1.414 && nc.dist(c) < tol) {
+				expected[nodes.ElementAt(j)] = nodes.ElementAt(i);
+				break;
+			}
+		}
+	}
+	EXPECT_FALSE(expected.empty());
+	
+	DlThreadPool pool(4);
+	NodeCloneMap pooled;
+	nodes.StitchMap(nullptr, tol, pooled, &pool);
+	EXPECT_EQ(pooled, expected);
+	
+	nodes.Erase();
+}
+
+//----------------------------------------------------------------------------------------
+//  AttachedElements
+//
+//      check the elements found at a node as elements are split, removed and put
+//		back against looking at every element.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, AttachedElements)
+{
+	const int size = 4;
+	buildGrid(size);
+	
+	auto expectAttached = [this](Node n) {
+		ElementEnumerator all = frame->GetElements();
+		std::vector<ElementImp*> expected;
+		for (DlInt32 i = 0; i < all.Length(); i++) {
+			Element e = all.At(i);
+			if ((NodeImp*)e.StartNode() == (NodeImp*)n || (NodeImp*)e.EndNode() == (NodeImp*)n)
+				expected.push_back(e);
+		}
+		ElementEnumerator attached = frame->AttachedElements(n);
+		ASSERT_EQ(attached.Length(), DlInt32(expected.size()));
+		for (DlInt32 i = 0; i < attached.Length(); i++)
+			EXPECT_EQ((ElementImp*)attached.At(i), expected[i]);
+	};
+	
+	Node center = frame->GetNode(size + 1);
+	Node right = frame->GetNode(size + 2);
+	expectAttached(center);
+	EXPECT_EQ(frame->AttachedElements(center).Length(), 4);
+	EXPECT_TRUE(frame->DuplicateElement(center, right));
+	EXPECT_TRUE(frame->DuplicateElement(right, center));
+	EXPECT_FALSE(frame->DuplicateElement(center, frame->GetNode(2 * size + 2)));
+	
+	Element hit;
+	ElementEnumerator atCenter = frame->AttachedElements(center);
+	for (DlInt32 i = 0; i < atCenter.Length(); i++) {
+		if ((NodeImp*)atCenter.At(i).EndNode() == (NodeImp*)right)
+			hit = atCenter.At(i);
+	}
+	ASSERT_FALSE(hit.Empty());
+	Node added;
+	ActPtr split(frame->SplitElement(hit, added, 0.5));
+	split->Perform();
+	expectAttached(center);
+	expectAttached(right);
+	EXPECT_EQ(frame->AttachedElements(added).Length(), 2);
+	EXPECT_FALSE(frame->DuplicateElement(center, right));
+	EXPECT_TRUE(frame->DuplicateElement(center, added));
+	
+	split->Perform();		//	undo
+	expectAttached(center);
+	EXPECT_TRUE(frame->DuplicateElement(center, right));
+	
+	removeNode(size + 2);
+	expectAttached(center);
+	EXPECT_EQ(frame->AttachedElements(center).Length(), 3);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  RenumberedBeam
+//
+//      build a simple beam with the nodes added alternately from each end, so that
+//		the original equation numbering has a large profile. Analyze with profile
+//		minimization and check the profile is reduced and the results are unchanged.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, RenumberedBeam)
+{
+	const int numNodes = 21;
+	const DlFloat64 offset = 1.0 / (numNodes - 1);
+	
+	// nodeAt[p] is the index of the node at position p along the beam.
+	std::vector<DlInt32> nodeAt(numNodes);
+	for (auto i = 0; i < numNodes; i++)
+	{
+		DlInt32 pos = (i % 2) == 0 ? i / 2 : numNodes - 1 - i / 2;
+		nodeAt[pos] = i;
+		addNode(pos * offset, 0.0);
+	}
+	
+	for (auto p = 0; p < numNodes - 1; p++)
+	{
+		addElement(nodeAt[p], nodeAt[p+1]);
+	}
+	
+	addRestraint(nodeAt[0], Node::FixX | Node::FixY);
+	addRestraint(nodeAt[numNodes - 1], Node::FixY);
+	
+	DlInt32 elemIndex = (numNodes - 1) / 2;
+	addJointLoad(nodeAt[elemIndex], 0, -1, 0);
+
+	ASSERT_TRUE(frame->CanAnalyze());
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.minimizeProfile = true;
+	frame->SetAnalysisOptions(options);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	
+	EXPECT_LT(theData.profile, theData.initialProfile);
+	
+	ASSERT_NO_THROW(frame->Analyze(0));
+	
+	// solution is PL/4 for moment, and P L^3 / 48EI
+	const Element& elem = frame->GetElement(elemIndex);
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	const ElementForce& frc = res->GetElementForce(elemIndex);
+	
+	DlFloat64 value = elem.GetResultValue(2, frc, *res);
+	EXPECT_NEAR(value, 0.25, 1.0e-7);
+	
+	value = elem.DOFDispAt(1, elemIndex, 0.0, *res);
+	EXPECT_NEAR(value, -1.0/48, 1.0e-5);
+
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  RenumberedParts
+//
+//      renumber two separate frames, so the equations fall in two groups, and
+//		check the results match those of the original numbering.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, RenumberedParts)
+{
+	const int size = 4;
+	
+	// the nodes of the two frames alternate, so the equations are spread out.
+	for (auto j = 0; j < size; j++) {
+		for (auto i = 0; i < size; i++) {
+			addNode(i, j);
+			addNode(i + 2 * size, j);
+		}
+	}
+	
+	for (auto part = 0; part < 2; part++) {
+		for (auto j = 0; j < size; j++) {
+			for (auto i = 0; i < size; i++) {
+				DlInt32 n = 2 * (j * size + i) + part;
+				if (i + 1 < size)
+					addElement(n, n + 2);
+				if (j + 1 < size)
+					addElement(n, n + 2 * size);
+			}
+		}
+	}
+	
+	for (auto i = 0; i < 2 * size; i++)
+		addRestraint(i, Node::FixX | Node::FixY | Node::FixTheta);
+	
+	addJointLoad(2 * size * (size - 1), 1, -1, 0);
+	addJointLoad(2 * size * size - 1, -1, 0, 0);
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	analyze(options);
+	std::vector<DlFloat64> original;
+	getDisplacements(original);
+	
+	options.minimizeProfile = true;
+	analyze(options);
+	std::vector<DlFloat64> renumbered;
+	getDisplacements(renumbered);
+	
+	ASSERT_EQ(renumbered.size(), original.size());
+	for (size_t i = 0; i < original.size(); i++)
+		EXPECT_NEAR(renumbered[i], original[i], 1.0e-12 * (1.0 + fabs(original[i])));
+	
+	const AnalysisTimings& timings = frame->GetAnalysisTimings();
+	EXPECT_GE(timings.numbering, 0.0);
+	EXPECT_GE(timings.starts, 0.0);
+	EXPECT_GT(timings.assembly + timings.factor + timings.solve, 0.0);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  ParallelBeam
+//
+//      analyze a simple beam using the parallel factorization and check the results.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, ParallelBeam)
+{
+	const int numNodes = 201;
+	const DlFloat64 offset = 1.0 / (numNodes - 1);
+	
+	for (auto i = 0; i < numNodes; i++)
+	{
+		addNode(i * offset, 0.0);
+	}
+	
+	for (auto i = 0; i < numNodes - 1; i++)
+	{
+		addElement(i, i+1);
+	}
+	
+	addRestraint(0, Node::FixX | Node::FixY);
+	addRestraint(numNodes - 1, Node::FixY);
+	
+	DlInt32 elemIndex = (numNodes - 1) / 2;
+	addJointLoad(elemIndex, 0, -1, 0);
+	
+	ASSERT_TRUE(frame->CanAnalyze());
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solverThreads = 4;
+	frame->SetAnalysisOptions(options);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	
+	ASSERT_NO_THROW(frame->Analyze(0));
+	
+	// solution is PL/4 for moment, and P L^3 / 48EI
+	const Element& elem = frame->GetElement(elemIndex);
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	const ElementForce& frc = res->GetElementForce(elemIndex);
+	
+	DlFloat64 value = elem.GetResultValue(2, frc, *res);
+	EXPECT_NEAR(value, 0.25, 1.0e-7);
+	
+	value = elem.DOFDispAt(1, elemIndex, 0.0, *res);
+	EXPECT_NEAR(value, -1.0/48, 1.0e-5);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  AnalysisTelemetry
+//
+//      analyze a beam and check the telemetry agrees with the analysis data.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, AnalysisTelemetry)
+{
+	const int numNodes = 11;
+	
+	for (auto i = 0; i < numNodes; i++)
+		addNode(i * 0.1, 0.0);
+	
+	for (auto i = 0; i < numNodes - 1; i++)
+		addElement(i, i+1);
+	
+	addRestraint(0, Node::FixX | Node::FixY);
+	addRestraint(numNodes - 1, Node::FixY);
+	addJointLoad(numNodes / 2, 0, -1, 0);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	ASSERT_NO_THROW(frame->Analyze(0));
+	
+	const AnalysisTelemetry& telemetry = frame->GetAnalysisTelemetry();
+	EXPECT_EQ(telemetry.equations, theData.eqCount);
+	EXPECT_EQ(telemetry.skylineSize, theData.profile);
+	EXPECT_GT(telemetry.averageColumnHeight, 1.0);
+	EXPECT_GT(telemetry.factorFlops, 0.0);
+	EXPECT_GT(telemetry.solveFlops, 0.0);
+	EXPECT_GE(telemetry.peakMatrixBytes, telemetry.skylineSize * (DlInt64)sizeof(DlFloat64));
+	
+	EXPECT_GT(telemetry.minPivotEquation, 0);
+	EXPECT_LE(telemetry.minPivotEquation, theData.eqCount);
+	EXPECT_GT(telemetry.minPivot, 0.0);
+	EXPECT_LE(telemetry.minPivot, telemetry.maxPivot);
+	
+	ASSERT_EQ(telemetry.caseSolveTimes.size(), 1u);
+	EXPECT_GE(telemetry.caseSolveTimes[0], 0.0);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  FileStreamRoundTrip
+//
+//      save a grid through a file stream with a small buffer, load it into a
+//		new structure and check the results match.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, FileStreamRoundTrip)
+{
+	buildGrid(4);
+	analyze(frame->GetAnalysisOptions());
+	std::vector<DlFloat64> original;
+	getDisplacements(original);
+	
+	DlStrStream stream;
+	{
+		StrFileOutputStream output(stream, 7);
+		frame->Save(output);
+		output.PutString("end");
+	}
+	
+	delete frame;
+	frame = NEW FrameStructure("default");
+	
+	StrFileInputStream input(stream, 5);
+	frame->Load(input);
+	EXPECT_STREQ(input.GetString().get(), "end");
+	EXPECT_TRUE(input.eof());
+	EXPECT_THROW(input.GetInt(), DlException);
+	
+	analyze(frame->GetAnalysisOptions());
+	std::vector<DlFloat64> loaded;
+	getDisplacements(loaded);
+	
+	ASSERT_EQ(loaded.size(), original.size());
+	for (size_t i = 0; i < original.size(); i++)
+		EXPECT_DOUBLE_EQ(loaded[i], original[i]);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  BinaryRoundTrip
+//
+//      save a grid with two load cases and a combination to a binary file,
+//		map it into a new structure and check it saves the same stream.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, BinaryRoundTrip)
+{
+	buildGrid(4);
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addLateralLoad(3, -2, 1);
+	ActPtr(frame->AddLoadCaseCombination("both",
+					LoadCaseCombination(std::vector<DlFloat32>{1.2, 1.6})))->Perform();
+	
+	auto saveStream = [this](std::vector<DlUInt8>& bytes) {
+		DlStrStream stream;
+		{
+			StrFileOutputStream output(stream);
+			frame->Save(output);
+		}
+		stream.Seek(0, DlFromStart);
+		DlUInt8 buf[256];
+		DlUInt32 len;
+		bytes.clear();
+		while ((len = stream.ReadBytes(buf, sizeof(buf))) > 0)
+			bytes.insert(bytes.end(), buf, buf + len);
+	};
+	
+	std::vector<DlUInt8> original;
+	saveStream(original);
+	
+	std::vector<DlUInt8> binary;
+	frame->SaveBinary(binary);
+	
+	delete frame;
+	frame = NEW FrameStructure("default");
+	frame->LoadBinary(&binary[0], binary.size());
+	
+	std::vector<DlUInt8> loaded;
+	saveStream(loaded);
+	EXPECT_EQ(loaded, original);
+	EXPECT_EQ(frame->GetLoadCaseCount(), 3u);
+	
+	//	a damaged image is refused rather than read
+	std::vector<DlUInt8> image;
+	frame->SaveBinary(image);
+	image[0] = 'X';
+	EXPECT_THROW(frame->LoadBinary(&image[0], image.size()), DlException);
+	EXPECT_THROW(frame->LoadBinary(&image[0], 16), DlException);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultsFileColumns
+//
+//      save the results of a grid raw and compressed, read single columns back
+//		and load them into a new copy of the structure.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, ResultsFileColumns)
+{
+	const int size = 4;
+	buildGrid(size);
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addLateralLoad(3, -2, 1);
+	ActPtr(frame->AddLoadCaseCombination("both",
+					LoadCaseCombination(std::vector<DlFloat32>{1.2, 1.6})))->Perform();
+	analyze(frame->GetAnalysisOptions());
+	
+	std::vector<DlUInt8> raw, packed, structure;
+	frame->SaveResults(raw);
+	frame->SaveResults(packed, true);
+	frame->SaveBinary(structure);
+	EXPECT_LT(packed.size(), raw.size());
+	
+	ResultsFile rawFile(&raw[0], raw.size());
+	ResultsFile packedFile(&packed[0], packed.size());
+	ASSERT_EQ(rawFile.GetLoadCaseCount(), 2u);
+	EXPECT_FALSE(rawFile.HasLoadCase(2));
+	EXPECT_EQ(rawFile.GetColumnLength(ResultElementForce), DlUInt32(2 * size * (size - 1)));
+	
+	frame->SetActiveLoadCase(1);
+	std::shared_ptr<const LoadCaseResults> wind = frame->GetResults();
+	for (int c = 0; c < DOF_PER_NODE; c++) {
+		std::vector<DlFloat64> forces;
+		packedFile.ReadColumn(1, ResultElementForce, c, forces);
+		const DlFloat64* mapped = rawFile.MapColumn(1, ResultElementForce, c);
+		ASSERT_TRUE(mapped != nullptr);
+		EXPECT_TRUE(packedFile.MapColumn(1, ResultReaction, c) == nullptr);
+		for (size_t e = 0; e < forces.size(); e++) {
+			EXPECT_EQ(forces[e], wind->GetElementForce(e)[c]);
+			EXPECT_EQ(mapped[e], forces[e]);
+		}
+	}
+	
+	std::vector<DlFloat64> original[2];
+	for (LoadCase lc = 0; lc < 2; lc++) {
+		frame->SetActiveLoadCase(lc);
+		const std::valarray<DlFloat64>& disp = frame->GetResults()->GetDisplacements();
+		original[lc].assign(std::begin(disp), std::end(disp));
+	}
+	
+	delete frame;
+	frame = NEW FrameStructure("default");
+	frame->LoadBinary(&structure[0], structure.size());
+	frame->LoadResults(&packed[0], packed.size());
+	for (LoadCase lc = 0; lc < 2; lc++) {
+		frame->SetActiveLoadCase(lc);
+		const std::valarray<DlFloat64>& disp = frame->GetResults()->GetDisplacements();
+		EXPECT_EQ(std::vector<DlFloat64>(std::begin(disp), std::end(disp)), original[lc]);
+	}
+	frame->SetActiveLoadCase(2);
+	EXPECT_TRUE(frame->GetResults() != nullptr);
+	
+	//	a damaged column is refused rather than read
+	std::vector<DlFloat64> values(DOF_PER_NODE);
+	std::vector<DlUInt8> bits;
+	EncodeResultColumn(&values[0], values.size(), bits);
+	EXPECT_THROW(DecodeResultColumn(&bits[0], 4, values.size(), &values[0]), DlException);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  ParallelAssembly
+//
+//      analyze a grid frame with different thread counts and check the results
+//		are identical when asked to be, and agree otherwise.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, ParallelAssembly)
+{
+	buildGrid(8);
+	
+	ASSERT_TRUE(frame->CanAnalyze());
+	
+	const DlUInt32 threads[] = { 1, 2, 4 };
+	std::vector<DlFloat64> disps[3];
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.reproducibleAssembly = true;
+	for (auto t = 0; t < 3; t++) {
+		options.solverThreads = threads[t];
+		analyze(options);
+		getDisplacements(disps[t]);
+	}
+	
+	for (size_t i = 0; i < disps[0].size(); i++) {
+		EXPECT_EQ(disps[1][i], disps[0][i]);
+		EXPECT_EQ(disps[2][i], disps[0][i]);
+	}
+	
+	//	a single thread in list order sums the terms differently
+	options.reproducibleAssembly = false;
+	options.solverThreads = 1;
+	analyze(options);
+	getDisplacements(disps[0]);
+	for (size_t i = 0; i < disps[0].size(); i++)
+		EXPECT_NEAR(disps[0][i], disps[1][i], 1.0e-12 * (1.0 + fabs(disps[1][i])));
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  ParallelLoadCases
+//
+//      solve several load cases on threads and check they match a serial solution.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, ParallelLoadCases)
+{
+	const int size = 6;
+	const int cases = 5;
+	buildGrid(size);
+	
+	for (auto lc = 1; lc < cases; lc++) {
+		ActPtr(frame->CreateLoadCase("case"))->Perform();
+		addJointLoad(size * (size - 1) + lc, lc, -1, 0, lc);
+	}
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solverThreads = 4;
+	analyze(options);
+	
+	std::valarray<DlFloat64> parallel[cases];
+	for (auto lc = 0; lc < cases; lc++) {
+		frame->SetActiveLoadCase(lc);
+		parallel[lc] = frame->GetResults()->GetDisplacements();
+	}
+	
+	// setting the coordinates counts as an edit, so every case is solved again
+	Node n = frame->GetNode(0);
+	n.SetCoords(n.GetCoords());
+	
+	options.solverThreads = 1;
+	analyze(options);
+	
+	for (auto lc = 0; lc < cases; lc++) {
+		frame->SetActiveLoadCase(lc);
+		const std::valarray<DlFloat64>& serial = frame->GetResults()->GetDisplacements();
+		ASSERT_EQ(serial.size(), parallel[lc].size());
+		for (size_t i = 0; i < serial.size(); i++)
+			EXPECT_NEAR(parallel[lc][i], serial[i], 1.0e-12 * (1.0 + fabs(serial[i])));
+	}
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  BatchedRecovery
+//
+//      check forces recovered for many load cases at once, in batches spread over
+//		the threads, match those of a single case scaled by the load.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, BatchedRecovery)
+{
+	const int size = 6;
+	const int cases = 20;
+	buildGrid(size);
+	
+	for (auto lc = 1; lc < cases; lc++) {
+		ActPtr(frame->CreateLoadCase("case"))->Perform();
+		addJointLoad(size * (size - 1) + 2, lc, -2 * lc, lc, lc);
+	}
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solverThreads = 4;
+	analyze(options);
+	
+	frame->SetActiveLoadCase(1);
+	std::shared_ptr<const LoadCaseResults> unit = frame->GetResults();
+	std::valarray<DlFloat64> reactions = unit->GetReactions();
+	std::vector<ElementForce> forces;
+	for (auto e = 0; e < frame->GetElements().Length(); e++)
+		forces.push_back(unit->GetElementForce(e));
+	
+	for (auto lc = 2; lc < cases; lc++) {
+		frame->SetActiveLoadCase(lc);
+		std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+		
+		for (size_t i = 0; i < reactions.size(); i++)
+			EXPECT_NEAR(res->GetReactions()[i], lc * reactions[i], 1.0e-9 * lc * (1.0 + fabs(reactions[i])));
+		
+		for (size_t e = 0; e < forces.size(); e++) {
+			for (int i = 0; i < DOF_PER_NODE; i++) {
+				EXPECT_NEAR(res->GetElementForce(e)[i], lc * forces[e][i], 
+					1.0e-9 * lc * (1.0 + fabs(forces[e][i])));
+			}
+		}
+	}
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  LazyCombinations
+//
+//      check combinations are built on demand, and rebuilt after they are dropped
+//		to stay within the memory budget, while a handle to one keeps it.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, LazyCombinations)
+{
+	const int size = 5;
+	buildGrid(size);
+	
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addJointLoad(size * (size - 1), 2, 0, 0, 1);
+	
+	ActPtr(frame->AddLoadCaseCombination("sum",
+				LoadCaseCombination(std::vector<DlFloat32>{1.0, 1.0})))->Perform();
+	ActPtr(frame->AddLoadCaseCombination("factored",
+				LoadCaseCombination(std::vector<DlFloat32>{1.2, 1.6})))->Perform();
+	
+	// room for only one combination
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.combinationMemory = 1;
+	analyze(options);
+	
+	frame->SetActiveLoadCase(0);
+	std::valarray<DlFloat64> dead = frame->GetResults()->GetDisplacements();
+	frame->SetActiveLoadCase(1);
+	std::valarray<DlFloat64> wind = frame->GetResults()->GetDisplacements();
+	
+	frame->SetActiveLoadCase(2);
+	frame->SetDisplacementMagnifier(3.0);
+	
+	const DlFloat32 deadFactor[] = { 1.0, 1.2 };
+	const DlFloat32 windFactor[] = { 1.0, 1.6 };
+	for (auto pass = 0; pass < 2; pass++) {
+		for (auto c = 0; c < 2; c++) {
+			frame->SetActiveLoadCase(2 + c);
+			const std::valarray<DlFloat64>& combined = frame->GetResults()->GetDisplacements();
+			for (size_t i = 0; i < dead.size(); i++) {
+				DlFloat64 expected = deadFactor[c] * dead[i] + windFactor[c] * wind[i];
+				EXPECT_NEAR(combined[i], expected, 1.0e-12 * (1.0 + fabs(expected)));
+			}
+		}
+	}
+	
+	// the first combination was dropped and built again
+	frame->SetActiveLoadCase(2);
+	EXPECT_EQ(frame->GetDisplacementMagnifier(), 1.0);
+	
+	// a handle outlives the combination being dropped
+	std::shared_ptr<const LoadCaseResults> sum = frame->GetResults();
+	std::valarray<DlFloat64> kept = sum->GetDisplacements();
+	frame->SetActiveLoadCase(3);
+	EXPECT_NE(frame->GetResults(), sum);
+	frame->SetActiveLoadCase(2);
+	EXPECT_NE(frame->GetResults(), sum);
+	for (size_t i = 0; i < kept.size(); i++)
+		EXPECT_EQ(sum->GetDisplacements()[i], kept[i]);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  CombineResults
+//
+//      build all the combinations at once, including one that combines others,
+//		and check them against the load cases.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, CombineResults)
+{
+	const int size = 5;
+	buildGrid(size);
+	
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addJointLoad(size * (size - 1), 2, 0, 0, 1);
+	
+	ActPtr(frame->AddLoadCaseCombination("sum",
+				LoadCaseCombination(std::vector<DlFloat32>{1.0, 1.0})))->Perform();
+	ActPtr(frame->AddLoadCaseCombination("factored",
+				LoadCaseCombination(std::vector<DlFloat32>{1.2, 1.6})))->Perform();
+	ActPtr(frame->AddLoadCaseCombination("nested",
+				LoadCaseCombination(std::vector<DlFloat32>{0, 0, 0.5, 1.0})))->Perform();
+	
+	analyze(frame->GetAnalysisOptions());
+	frame->CombineResults();
+	
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> dead = frame->GetResults();
+	frame->SetActiveLoadCase(1);
+	std::shared_ptr<const LoadCaseResults> wind = frame->GetResults();
+	
+	// the factors are stored in single precision
+	const DlFloat64 deadFactor[] = { 1.0, 1.2f, 0.5 + 1.2f };
+	const DlFloat64 windFactor[] = { 1.0, 1.6f, 0.5 + 1.6f };
+	for (auto c = 0; c < 3; c++) {
+		frame->SetActiveLoadCase(2 + c);
+		std::shared_ptr<const LoadCaseResults> combined = frame->GetResults();
+		
+		for (size_t i = 0; i < dead->GetDisplacements().size(); i++) {
+			DlFloat64 expected = deadFactor[c] * dead->GetDisplacements()[i]
+					+ windFactor[c] * wind->GetDisplacements()[i];
+			EXPECT_NEAR(combined->GetDisplacements()[i], expected, 1.0e-12 * (1.0 + fabs(expected)));
+		}
+		for (size_t i = 0; i < dead->GetReactions().size(); i++) {
+			DlFloat64 expected = deadFactor[c] * dead->GetReactions()[i]
+					+ windFactor[c] * wind->GetReactions()[i];
+			EXPECT_NEAR(combined->GetReactions()[i], expected, 1.0e-9 * (1.0 + fabs(expected)));
+		}
+		for (DlInt32 e = 0; e < 2 * size * (size - 1); e++) {
+			for (int j = 0; j < DOF_PER_NODE; j++) {
+				DlFloat64 expected = deadFactor[c] * dead->GetElementForce(e)[j]
+						+ windFactor[c] * wind->GetElementForce(e)[j];
+				EXPECT_NEAR(combined->GetElementForce(e)[j], expected, 1.0e-9 * (1.0 + fabs(expected)));
+			}
+		}
+	}
+	
+	// the plot scales follow the combinations as they are defined
+	frame->SetActiveLoadCase(2);
+	DlFloat64 sumScale = frame->GetResults()->MomentScale();
+	EXPECT_EQ(sumScale, std::min(dead->MomentScale(), wind->MomentScale()));
+	frame->SetActiveLoadCase(3);
+	DlFloat64 factoredScale = frame->GetResults()->MomentScale();
+	frame->SetActiveLoadCase(4);
+	EXPECT_EQ(frame->GetResults()->MomentScale(), std::min(sumScale / 0.5, factoredScale));
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  ResultEnvelope
+//
+//      find the envelope over load cases and combinations on threads, and check
+//		it against forces sampled along each element in each case.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, ResultEnvelope)
+{
+	const int size = 4;
+	const int numElems = 2 * size * (size - 1);
+	buildGrid(size);
+	
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addJointLoad(size * (size - 1), 2, 0, 0, 1);
+	for (auto e = 0; e < numElems; e += 3)
+		addLateralLoad(e, 0.5, 1);
+	
+	ActPtr(frame->AddLoadCaseCombination("factored",
+				LoadCaseCombination(std::vector<DlFloat32>{1.2, 1.6})))->Perform();
+	ActPtr(frame->AddLoadCaseCombination("uplift",
+				LoadCaseCombination(std::vector<DlFloat32>{0.9, -1.0})))->Perform();
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solverThreads = 4;
+	analyze(options);
+	
+	ResultEnvelope envelope;
+	frame->ComputeEnvelope(envelope);
+	ASSERT_EQ(envelope.GetElementCount(), numElems);
+	ASSERT_EQ(envelope.GetNodeCount(), size * size);
+	
+	const int cases = frame->GetLoadCaseCount();
+	const int samples = 200;
+	for (auto e = 0; e < numElems; e++) {
+		Element elem = frame->GetElement(e);
+		std::vector<DlFloat64> least(DOF_PER_NODE * cases, 1.0e300);
+		std::vector<DlFloat64> most(DOF_PER_NODE * cases, -1.0e300);
+		for (auto lc = 0; lc < cases; lc++) {
+			frame->SetActiveLoadCase(lc);
+			const ElementForce& feForce = frame->GetResults()->GetElementForce(e);
+			for (auto k = 0; k <= samples; k++) {
+				ElementForce f;
+				elem.GetElementForce(elem.Length() * k / samples, lc, feForce, f);
+				for (auto j = 0; j < DOF_PER_NODE; j++) {
+					least[lc * DOF_PER_NODE + j] = std::min(least[lc * DOF_PER_NODE + j], f[j]);
+					most[lc * DOF_PER_NODE + j] = std::max(most[lc * DOF_PER_NODE + j], f[j]);
+				}
+			}
+		}
+		
+		// the sampled extremes may fall just short of the exact ones
+		for (auto j = 0; j < DOF_PER_NODE; j++) {
+			const EnvelopeValue& lo = envelope.GetMinForce(e, j);
+			const EnvelopeValue& hi = envelope.GetMaxForce(e, j);
+			for (auto lc = 0; lc < cases; lc++) {
+				EXPECT_LE(lo.value, least[lc * DOF_PER_NODE + j] + 1.0e-9);
+				EXPECT_GE(hi.value, most[lc * DOF_PER_NODE + j] - 1.0e-9);
+			}
+			EXPECT_NEAR(lo.value, least[lo.loadCase * DOF_PER_NODE + j], 1.0e-4 * (1.0 + fabs(lo.value)));
+			EXPECT_NEAR(hi.value, most[hi.loadCase * DOF_PER_NODE + j], 1.0e-4 * (1.0 + fabs(hi.value)));
+		}
+	}
+	
+	for (auto i = 0; i < size * size; i++) {
+		for (auto lc = 0; lc < cases; lc++) {
+			frame->SetActiveLoadCase(lc);
+			DlFloat64 disp[DOF_PER_NODE];
+			frame->GetResults()->GetDisplacement(frame->GetNode(i), disp);
+			for (auto j = 0; j < DOF_PER_NODE; j++) {
+				EXPECT_LE(envelope.GetMinDisplacement(i, j).value, disp[j]);
+				EXPECT_GE(envelope.GetMaxDisplacement(i, j).value, disp[j]);
+				if (envelope.GetMaxDisplacement(i, j).loadCase == lc)
+					EXPECT_EQ(envelope.GetMaxDisplacement(i, j).value, disp[j]);
+			}
+		}
+	}
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  SampleResults
+//
+//      sample forces and displacements along every element at once, and check
+//		them against sampling one point at a time.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, SampleResults)
+{
+	const int size = 4;
+	const int numElems = 2 * size * (size - 1);
+	buildGrid(size);
+	for (auto e = 0; e < numElems; e += 2)
+		addLateralLoad(e, 0.25);
+	
+	analyze(frame->GetAnalysisOptions());
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	const std::vector<DlFloat64> u { 0, 0.1, 0.25, 0.5, 0.9, 1.0 };
+	const ElementResultKind kinds[] = { ElementResultForce, ElementResultDisplacement };
+	for (auto kind : kinds) {
+		for (auto dof = 0; dof < DOF_PER_NODE; dof++) {
+			std::vector<DlFloat64> values;
+			frame->SampleResults(frame->GetElements(), 0, kind, dof, u, values);
+			ASSERT_EQ(values.size(), numElems * u.size());
+			
+			for (auto e = 0; e < numElems; e++) {
+				Element elem = frame->GetElement(e);
+				for (size_t k = 0; k < u.size(); k++) {
+					DlFloat64 expected = kind == ElementResultForce
+							? elem.DOFForceAt(dof, e, u[k], *res)
+							: elem.DOFDispAt(dof, e, u[k], *res);
+					EXPECT_NEAR(values[e * u.size() + k], expected, 1.0e-10 * (1.0 + fabs(expected)));
+				}
+			}
+		}
+	}
+	
+	// a selection is sampled in the order given
+	std::vector<DlFloat64> values;
+	frame->SampleResults({frame->GetElement(3), frame->GetElement(1)}, 0,
+						 ElementResultForce, 2, u, values);
+	ASSERT_EQ(values.size(), 2 * u.size());
+	EXPECT_NEAR(values[0], frame->GetElement(3).DOFForceAt(2, 3, 0, *res), 1.0e-10);
+	EXPECT_NEAR(values[u.size()], frame->GetElement(1).DOFForceAt(2, 1, 0, *res), 1.0e-10);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  IncrementalReanalysis
+//
+//      edit a node and reanalyze using the kept matrix, and check the results
+//		match a full analysis.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, IncrementalReanalysis)
+{
+	const int size = 8;
+	buildGrid(size);
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.incremental = true;
+	analyze(options);
+	
+	std::vector<DlFloat64> first;
+	getDisplacements(first);
+	
+	// unchanged, so nothing is refactored
+	analyze(options);
+	std::vector<DlFloat64> again;
+	getDisplacements(again);
+	EXPECT_EQ(first, again);
+	
+	// move a node near the top, which keeps the topology
+	Node n = frame->GetNode(size * (size - 1) + 2);
+	WorldPoint pt = n.GetCoords();
+	n.SetCoords(WorldPoint(pt.x() + 0.25, pt.y() + 0.1));
+	
+	std::vector<DlFloat64> incremental;
+	analyze(options);
+	getDisplacements(incremental);
+	
+	options.incremental = false;
+	std::vector<DlFloat64> full;
+	analyze(options);
+	getDisplacements(full);
+	
+	ASSERT_EQ(incremental.size(), full.size());
+	for (size_t i = 0; i < full.size(); i++)
+		EXPECT_NEAR(incremental[i], full[i], 1.0e-10 * (1.0 + fabs(full[i])));
+	
+	EXPECT_NE(incremental, first);
+	
+	// many small edits leave the kept matrix as a rebuilt one would be, so
+	// the results match exactly
+	options.incremental = true;
+	analyze(options);
+	for (int i = 0; i < 10; i++) {
+		n.SetCoords(WorldPoint(pt.x() + 0.1 * (i % 3), pt.y() - 0.05 * (i % 2)));
+		analyze(options);
+	}
+	Property prop = frame->GetActiveProperty();
+	ActPtr(frame->ChangeProperty(prop, kPropertyArea, "20"))->Perform();
+	analyze(options);
+	getDisplacements(incremental);
+	
+	options.incremental = false;
+	analyze(options);
+	options.incremental = true;
+	std::vector<DlFloat64> rebuilt;
+	analyze(options);
+	getDisplacements(rebuilt);
+	EXPECT_EQ(incremental, rebuilt);
+	
+	// adding an element changes the topology
+	options.incremental = true;
+	analyze(options);
+	addElement(size * (size - 1), size * (size - 2) + 1);
+	
+	analyze(options);
+	getDisplacements(incremental);
+	
+	options.incremental = false;
+	analyze(options);
+	getDisplacements(full);
+	
+	for (size_t i = 0; i < full.size(); i++)
+		EXPECT_NEAR(incremental[i], full[i], 1.0e-10 * (1.0 + fabs(full[i])));
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  LoadOnlyReanalysis
+//
+//      change a load and reanalyze, and check only that load case is solved again
+//		with the kept factor.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, LoadOnlyReanalysis)
+{
+	const int size = 6;
+	buildGrid(size);
+	
+	ActPtr(frame->CreateLoadCase("wind"))->Perform();
+	addJointLoad(size * (size - 1), 2, 0, 0, 1);
+	
+	analyze(frame->GetAnalysisOptions());
+	
+	// a fresh result has a magnifier of one
+	frame->SetActiveLoadCase(0);
+	frame->SetDisplacementMagnifier(5.0);
+	std::valarray<DlFloat64> dead = frame->GetResults()->GetDisplacements();
+	frame->SetActiveLoadCase(1);
+	std::valarray<DlFloat64> wind = frame->GetResults()->GetDisplacements();
+	
+	// the application clears the results after every edit
+	frame->ClearResults();
+	NodeLoad load = frame->GetNode(size * (size - 1)).GetLoad(1);
+	ActPtr(frame->ChangeNodeLoad(load, 0, "4", NodeLoadUndefined))->Perform();
+	analyze(frame->GetAnalysisOptions());
+	
+	frame->SetActiveLoadCase(0);
+	EXPECT_EQ(frame->GetDisplacementMagnifier(), 5.0);
+	frame->SetActiveLoadCase(1);
+	EXPECT_EQ(frame->GetDisplacementMagnifier(), 1.0);
+	
+	const std::valarray<DlFloat64>& doubled = frame->GetResults()->GetDisplacements();
+	ASSERT_EQ(doubled.size(), wind.size());
+	for (size_t i = 0; i < wind.size(); i++)
+		EXPECT_NEAR(doubled[i], 2.0 * wind[i], 1.0e-12 * (1.0 + fabs(wind[i])));
+	EXPECT_EQ(frame->GetAnalysisTelemetry().factorFlops, 0.0);
+	
+	// editing another structure keeps this one's factor
+	{
+		FrameStructure other("default");
+		Node n1, n2;
+		ActPtr(other.AddNode(WorldPoint(0, 0), n1))->Perform();
+		ActPtr(other.AddNode(WorldPoint(1, 0), n2))->Perform();
+		n2.SetCoords(WorldPoint(2, 0));
+	}
+	frame->ClearResults();
+	ActPtr(frame->ChangeNodeLoad(load, 0, "6", NodeLoadUndefined))->Perform();
+	analyze(frame->GetAnalysisOptions());
+	EXPECT_EQ(frame->GetAnalysisTelemetry().factorFlops, 0.0);
+	
+	// moving a node changes the stiffness, so every load case is solved again,
+	// also when the coordinate is typed in.
+	frame->ClearResults();
+	Node n = frame->GetNode(size * (size - 1) + 2);
+	n.SetCoord(0, (std::to_string(n.GetCoords().x() + 0.25)).c_str());
+	analyze(frame->GetAnalysisOptions());
+	EXPECT_GT(frame->GetAnalysisTelemetry().factorFlops, 0.0);
+	
+	frame->SetActiveLoadCase(0);
+	EXPECT_EQ(frame->GetDisplacementMagnifier(), 1.0);
+	
+	const std::valarray<DlFloat64>& moved = frame->GetResults()->GetDisplacements();
+	EXPECT_GT(std::valarray<DlFloat64>(std::abs(moved - dead)).max(), 1.0e-12);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  MixedPrecision
+//
+//      analyze with a single precision factor and refinement, and check the results
+//		match a double precision analysis, also when only the loads change.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, MixedPrecision)
+{
+	const int size = 8;
+	buildGrid(size);
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	analyze(options);
+	std::vector<DlFloat64> full;
+	getDisplacements(full);
+	
+	options.mixedPrecision = true;
+	analyze(options);
+	std::vector<DlFloat64> mixed;
+	getDisplacements(mixed);
+	
+	ASSERT_EQ(mixed.size(), full.size());
+	for (size_t i = 0; i < full.size(); i++)
+		EXPECT_NEAR(mixed[i], full[i], 1.0e-10 * (1.0 + fabs(full[i])));
+	
+	// the kept factor solves for new loads, in parallel too
+	frame->ClearResults();
+	addJointLoad(size * (size - 1) + 1, 3, -1, 0, 0);
+	options.solverThreads = 2;
+	analyze(options);
+	getDisplacements(mixed);
+	
+	options.mixedPrecision = false;
+	analyze(options);
+	getDisplacements(full);
+	
+	// the kept incremental skyline is not factored in single precision
+	AnalysisOptions both = options;
+	both.incremental = true;
+	both.mixedPrecision = true;
+	EXPECT_THROW(frame->SetAnalysisOptions(both), DlException);
+	EXPECT_FALSE(frame->GetAnalysisOptions().mixedPrecision);
+	
+	for (size_t i = 0; i < full.size(); i++)
+		EXPECT_NEAR(mixed[i], full[i], 1.0e-10 * (1.0 + fabs(full[i])));
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  OutOfCore
+//
+//      analyze with the skyline in a file, and check the results match those
+//		in memory, also when only the loads change.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, OutOfCore)
+{
+	const int size = 8;
+	buildGrid(size);
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	analyze(options);
+	std::vector<DlFloat64> inMemory;
+	getDisplacements(inMemory);
+	
+	// a few columns of the skyline at a time
+	options.solverMemory = 2048;
+	analyze(options);
+	std::vector<DlFloat64> inFile;
+	getDisplacements(inFile);
+	
+	EXPECT_EQ(inFile, inMemory);
+	
+	frame->ClearResults();
+	addJointLoad(size * (size - 1) + 1, 3, -1, 0, 0);
+	analyze(options);
+	getDisplacements(inFile);
+	
+	options.solverMemory = 0;
+	analyze(options);
+	getDisplacements(inMemory);
+	
+	EXPECT_EQ(inFile, inMemory);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  SparseBeam
+//
+//      analyze a simple beam using the sparse solver and check the results.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, SparseBeam)
+{
+	const int numNodes = 201;
+	const DlFloat64 offset = 1.0 / (numNodes - 1);
+	
+	for (auto i = 0; i < numNodes; i++)
+	{
+		addNode(i * offset, 0.0);
+	}
+	
+	for (auto i = 0; i < numNodes - 1; i++)
+	{
+		addElement(i, i+1);
+	}
+	
+	addRestraint(0, Node::FixX | Node::FixY);
+	addRestraint(numNodes - 1, Node::FixY);
+	
+	DlInt32 elemIndex = (numNodes - 1) / 2;
+	addJointLoad(elemIndex, 0, -1, 0);
+	
+	ASSERT_TRUE(frame->CanAnalyze());
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solver = AnalysisSolverSparse;
+	frame->SetAnalysisOptions(options);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	
+	ASSERT_NO_THROW(frame->Analyze(0));
+	
+	// solution is PL/4 for moment, and P L^3 / 48EI
+	const Element& elem = frame->GetElement(elemIndex);
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	const ElementForce& frc = res->GetElementForce(elemIndex);
+	
+	DlFloat64 value = elem.GetResultValue(2, frc, *res);
+	EXPECT_NEAR(value, 0.25, 1.0e-7);
+	
+	value = elem.DOFDispAt(1, elemIndex, 0.0, *res);
+	EXPECT_NEAR(value, -1.0/48, 1.0e-5);
+	
+	finalize = true;
+}
+
+//----------------------------------------------------------------------------------------
+//  IterativeBeam
+//
+//      analyze a simple beam using the iterative solver and check the results.
+//
+//----------------------------------------------------------------------------------------
+TEST_F(StructLibTest, IterativeBeam)
+{
+	const int numNodes = 201;
+	const DlFloat64 offset = 1.0 / (numNodes - 1);
+	
+	for (auto i = 0; i < numNodes; i++)
+	{
+		addNode(i * offset, 0.0);
+	}
+	
+	for (auto i = 0; i < numNodes - 1; i++)
+	{
+		addElement(i, i+1);
+	}
+	
+	addRestraint(0, Node::FixX | Node::FixY);
+	addRestraint(numNodes - 1, Node::FixY);
+	
+	DlInt32 elemIndex = (numNodes - 1) / 2;
+	addJointLoad(elemIndex, 0, -1, 0);
+	
+	ASSERT_TRUE(frame->CanAnalyze());
+	
+	AnalysisOptions options = frame->GetAnalysisOptions();
+	options.solver = AnalysisSolverIterative;
+	options.preconditioner = AnalysisPreconditionerIncompleteCholesky;
+	frame->SetAnalysisOptions(options);
+	
+	AnalysisData theData;
+	frame->InitAnalysis(&theData);
+	
+	ASSERT_NO_THROW(frame->Analyze(0));
+	
+	// solution is PL/4 for moment, and P L^3 / 48EI
+	const Element& elem = frame->GetElement(elemIndex);
+	frame->SetActiveLoadCase(0);
+	std::shared_ptr<const LoadCaseResults> res = frame->GetResults();
+	
+	const ElementForce& frc = res->GetElementForce(elemIndex);
+	
+	DlFloat64 value = elem.GetResultValue(2, frc, *res);
+	EXPECT_NEAR(value, 0.25, 1.0e-7);
+	
+	value = elem.DOFDispAt(1, elemIndex, 0.0, *res);
+	EXPECT_NEAR(value, -1.0/48, 1.0e-5);
+	
+	finalize = true;
+}
+
 // Anaylze a larger structure (simple beam with 1000 elements).
 const int MAX_NODES = 10001;
 const DlFloat64 NODE_OFFSET = 1.0 / (MAX_NODES - 1);
@@ -746,7 +2182,7 @@ TEST_F(StructLibTest,ResultsLarger)
 	
 	{
 		frame->SetActiveLoadCase(0);
-		const LoadCaseResults* resLateral = frame->GetResults();
+		std::shared_ptr<const LoadCaseResults> resLateral = frame->GetResults();
 		
 		const ElementForce& frc = resLateral->GetElementForce(elemIndex);
 		
@@ -764,7 +2200,7 @@ TEST_F(StructLibTest,ResultsLarger)
 	{
 		frame->SetActiveLoadCase(1);
 		// solution is PL/4 for moment, and P L^3 / 48EI
-		const LoadCaseResults* resPoint = frame->GetResults();
+		std::shared_ptr<const LoadCaseResults> resPoint = frame->GetResults();
 		
 		const ElementForce& frcPoint = resPoint->GetElementForce(elemIndex);
 		
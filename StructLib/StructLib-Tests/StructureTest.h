@@ -53,6 +53,10 @@ protected:
 	void addJointLoad(DlInt32 nodeIndex, DlFloat xLoad, DlFloat yLoad, DlFloat zLoad);
 	void addJointLoad(DlInt32 nodeIndex, DlFloat xLoad, DlFloat yLoad, DlFloat zLoad, LoadCase lc);
 
+	void buildGrid(int size);
+	void analyze(const AnalysisOptions& options);
+	void getDisplacements(std::vector<DlFloat64>& disps) const;
+
 	static FrameStructure* frame;
 	static bool finalize;
 	